@@ -182,7 +182,8 @@ class TaskManager:
 
     def setupTaskChain(self, chainName, numThreads = None, tickClock = None,
                        threadPriority = None, frameBudget = None,
-                       frameSync = None, timeslicePriority = None):
+                       frameSync = None, timeslicePriority = None,
+                       workStealing = None):
         """Defines a new task chain.  Each task chain executes tasks
         potentially in parallel with all of the other task chains (if
         numThreads is more than zero).  When a new task is created, it
@@ -230,6 +231,13 @@ class TaskManager:
         meaning of priority so that certain tasks are run less often,
         in proportion to their time used and to their priority value.
         See AsyncTaskManager.setTimeslicePriority() for more.
+
+        workStealing is False in the default mode, in which all of the
+        threads on the task chain take their tasks from one shared
+        queue; or True to give each thread its own queue, with idle
+        threads stealing from the others.  This reduces contention
+        when there are many threads and many short tasks.  See
+        AsyncTaskChain.setWorkStealing() for more.
         """
         
         chain = self.mgr.makeTaskChain(chainName)
@@ -245,6 +253,8 @@ class TaskManager:
             chain.setFrameSync(frameSync)
         if timeslicePriority is not None:
             chain.setTimeslicePriority(timeslicePriority)
+        if workStealing is not None:
+            chain.setWorkStealing(workStealing)
 
     def hasTaskNamed(self, taskName):
         """Returns true if there is at least one task, active or
@@ -15,6 +15,15 @@
 #include "deletedBufferChain.h"
 #include "memoryHook.h"
 
+#ifdef USE_DELETED_CHAIN_CACHE
+DeletedBufferChain *DeletedBufferChain::_cached_chains[max_cached_chains];
+TVOLATILE AtomicAdjust::Integer DeletedBufferChain::_num_cached_chains = 0;
+pthread_key_t DeletedBufferChain::_cache_key;
+pthread_once_t DeletedBufferChain::_cache_key_once = PTHREAD_ONCE_INIT;
+DeletedBufferChain::ThreadCache *DeletedBufferChain::_thread_caches = NULL;
+pthread_mutex_t DeletedBufferChain::_thread_caches_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif  // USE_DELETED_CHAIN_CACHE
+
 ////////////////////////////////////////////////////////////////////
 //     Function: DeletedBufferChain::Constructor
 //       Access: Protected
@@ -24,6 +33,8 @@
 DeletedBufferChain::
 DeletedBufferChain(size_t buffer_size) {
   _deleted_chain = NULL;
+  _num_free = 0;
+  _num_allocated = 0;
   _buffer_size = buffer_size;
   _alloc_size = _buffer_size;
 
@@ -36,6 +47,31 @@ DeletedBufferChain(size_t buffer_size) {
   // reasons.
   _buffer_size = max(_buffer_size, sizeof(ObjectNode));
   _alloc_size = max(_alloc_size, sizeof(ObjectNode));
+
+#ifdef USE_DELETED_CHAIN_CACHE
+  pthread_once(&_cache_key_once, &make_cache_key);
+
+  // Each thread may hold up to about 16K worth of buffers of each
+  // size, but always at least a handful.
+  _cache_limit = min(max((size_t)16384 / _alloc_size, (size_t)8), (size_t)128);
+
+  // Claim the next slot in the per-thread cache tables.  If we run
+  // out of slots, this chain simply goes through the mutex every
+  // time, as it would without caching.
+  _cache_index = -1;
+  AtomicAdjust::Integer index;
+  do {
+    index = AtomicAdjust::get(_num_cached_chains);
+    if (index >= (AtomicAdjust::Integer)max_cached_chains) {
+      break;
+    }
+  } while (AtomicAdjust::compare_and_exchange(_num_cached_chains, index, index + 1) != index);
+
+  if (index < (AtomicAdjust::Integer)max_cached_chains) {
+    _cached_chains[index] = this;
+    _cache_index = (int)index;
+  }
+#endif  // USE_DELETED_CHAIN_CACHE
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -51,43 +87,60 @@ allocate(size_t size, TypeHandle type_handle) {
   //TAU_PROFILE("void *DeletedBufferChain::allocate(size_t, TypeHandle)", " ", TAU_USER);
   assert(size <= _buffer_size);
 
-  ObjectNode *obj;
+  ObjectNode *obj = NULL;
+  bool got_cache = false;
 
-  _lock.acquire();
-  if (_deleted_chain != (ObjectNode *)NULL) {
+#ifdef USE_DELETED_CHAIN_CACHE
+  Magazine *mag = get_magazine();
+  if (mag != (Magazine *)NULL) {
+    // Take a buffer from this thread's own cache, refilling the cache
+    // from the shared chain first if it has run dry.
+    got_cache = true;
+    if (mag->_head == (ObjectNode *)NULL) {
+      fill_magazine(mag);
+    }
+    obj = mag->_head;
+    if (obj != (ObjectNode *)NULL) {
+      mag->_head = obj->_next;
+      --(mag->_count);
+    }
+  }
+#endif  // USE_DELETED_CHAIN_CACHE
+
+  if (!got_cache) {
+    _lock.acquire();
     obj = _deleted_chain;
-    _deleted_chain = _deleted_chain->_next;
+    if (obj != (ObjectNode *)NULL) {
+      _deleted_chain = obj->_next;
+      --_num_free;
+    }
     _lock.release();
+  }
 
+  if (obj != (ObjectNode *)NULL) {
 #ifdef USE_DELETEDCHAINFLAG
     assert(obj->_flag == (AtomicAdjust::Integer)DCF_deleted);
     obj->_flag = DCF_alive;
 #endif  // USE_DELETEDCHAINFLAG
 
-    void *ptr = node_to_buffer(obj);
-
-#ifdef DO_MEMORY_USAGE
-    //    type_handle.dec_memory_usage(TypeHandle::MC_deleted_chain_inactive, _alloc_size);
-    type_handle.inc_memory_usage(TypeHandle::MC_deleted_chain_active, _alloc_size);
-#endif  // DO_MEMORY_USAGE
-
-    return ptr;
-  }
-  _lock.release();
-
-  // If we get here, the deleted_chain is empty; we have to allocate a
-  // new object from the system pool.
-
-  obj = (ObjectNode *)NeverFreeMemory::alloc(_alloc_size);
+  } else {
+    // If we get here, the deleted_chain is empty; we have to allocate
+    // a new object from the system pool.
+    obj = (ObjectNode *)NeverFreeMemory::alloc(_alloc_size);
+    AtomicAdjust::inc(_num_allocated);
 
 #ifdef USE_DELETEDCHAINFLAG
-  obj->_flag = DCF_alive;
+    obj->_flag = DCF_alive;
 #endif  // USE_DELETEDCHAINFLAG
+  }
 
   void *ptr = node_to_buffer(obj);
 
 #ifdef DO_MEMORY_USAGE
   type_handle.inc_memory_usage(TypeHandle::MC_deleted_chain_active, _alloc_size);
+  if (memory_hook->is_sampling_chains()) {
+    memory_hook->chain_alloc(ptr, _buffer_size, type_handle);
+  }
 #endif  // DO_MEMORY_USAGE
 
   return ptr;
@@ -112,6 +165,9 @@ deallocate(void *ptr, TypeHandle type_handle) {
 #ifdef DO_MEMORY_USAGE
   type_handle.dec_memory_usage(TypeHandle::MC_deleted_chain_active, _alloc_size);
   //  type_handle.inc_memory_usage(TypeHandle::MC_deleted_chain_inactive, _alloc_size);
+  if (memory_hook->is_sampling_chains()) {
+    memory_hook->chain_free(ptr);
+  }
 
 #endif  // DO_MEMORY_USAGE
 
@@ -128,10 +184,29 @@ deallocate(void *ptr, TypeHandle type_handle) {
   assert(orig_flag == (AtomicAdjust::Integer)DCF_alive);
 #endif  // USE_DELETEDCHAINFLAG
 
+#ifdef USE_DELETED_CHAIN_CACHE
+  Magazine *mag = get_magazine();
+  if (mag != (Magazine *)NULL) {
+    obj->_next = mag->_head;
+    mag->_head = obj;
+    ++(mag->_count);
+
+    if (mag->_count > _cache_limit) {
+      // This thread is freeing more than it allocates (for instance,
+      // it is deleting objects created by another thread).  Hand half
+      // of its cache back to the shared chain, where the other
+      // threads can get at it.
+      drain_magazine(mag, mag->_count - _cache_limit / 2);
+    }
+    return;
+  }
+#endif  // USE_DELETED_CHAIN_CACHE
+
   _lock.acquire();
 
   obj->_next = _deleted_chain;
   _deleted_chain = obj;
+  ++_num_free;
 
   _lock.release();
 
@@ -139,3 +214,173 @@ deallocate(void *ptr, TypeHandle type_handle) {
   PANDA_FREE_SINGLE(ptr);
 #endif  // USE_DELETED_CHAIN
 }
+
+////////////////////////////////////////////////////////////////////
+//     Function: DeletedBufferChain::get_num_cached
+//       Access: Public
+//  Description: Returns the number of deleted buffers currently held
+//               in the private caches of the various threads.  This
+//               is always 0 if USE_DELETED_CHAIN_CACHE is not
+//               defined.
+//
+//               This is not synchronized with the threads that own
+//               the caches, and is meant only for reporting.
+////////////////////////////////////////////////////////////////////
+size_t DeletedBufferChain::
+get_num_cached() const {
+#ifdef USE_DELETED_CHAIN_CACHE
+  if (_cache_index < 0) {
+    return 0;
+  }
+
+  size_t count = 0;
+  pthread_mutex_lock(&_thread_caches_lock);
+  for (ThreadCache *cache = _thread_caches;
+       cache != (ThreadCache *)NULL;
+       cache = cache->_next) {
+    count += cache->_magazines[_cache_index]._count;
+  }
+  pthread_mutex_unlock(&_thread_caches_lock);
+  return count;
+
+#else  // USE_DELETED_CHAIN_CACHE
+  return 0;
+#endif  // USE_DELETED_CHAIN_CACHE
+}
+
+#ifdef USE_DELETED_CHAIN_CACHE
+////////////////////////////////////////////////////////////////////
+//     Function: DeletedBufferChain::fill_magazine
+//       Access: Private
+//  Description: Moves a batch of deleted buffers from the shared
+//               chain into the indicated (empty) thread cache.  If
+//               the shared chain is empty too, the cache is left
+//               empty.
+////////////////////////////////////////////////////////////////////
+void DeletedBufferChain::
+fill_magazine(Magazine *mag) {
+  size_t batch = max(_cache_limit / 2, (size_t)1);
+
+  _lock.acquire();
+  ObjectNode *head = _deleted_chain;
+  ObjectNode *tail = NULL;
+  ObjectNode *node = head;
+  size_t count = 0;
+  while (node != (ObjectNode *)NULL && count < batch) {
+    tail = node;
+    node = node->_next;
+    ++count;
+  }
+  _deleted_chain = node;
+  _num_free -= count;
+  _lock.release();
+
+  if (tail != (ObjectNode *)NULL) {
+    tail->_next = mag->_head;
+    mag->_head = head;
+    mag->_count += count;
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: DeletedBufferChain::drain_magazine
+//       Access: Private
+//  Description: Moves the first count buffers from the indicated
+//               thread cache back onto the shared chain.
+////////////////////////////////////////////////////////////////////
+void DeletedBufferChain::
+drain_magazine(Magazine *mag, size_t count) {
+  assert(count <= mag->_count);
+  if (count == 0) {
+    return;
+  }
+
+  // Walk to the end of the run we are giving back before we take the
+  // lock.
+  ObjectNode *head = mag->_head;
+  ObjectNode *tail = head;
+  for (size_t i = 1; i < count; ++i) {
+    tail = tail->_next;
+  }
+  mag->_head = tail->_next;
+  mag->_count -= count;
+
+  _lock.acquire();
+  tail->_next = _deleted_chain;
+  _deleted_chain = head;
+  _num_free += count;
+  _lock.release();
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: DeletedBufferChain::make_thread_cache
+//       Access: Private, Static
+//  Description: Allocates and records the table of buffer caches for
+//               the current thread.  This is called the first time a
+//               thread allocates or frees a buffer through any
+//               DeletedBufferChain.
+////////////////////////////////////////////////////////////////////
+DeletedBufferChain::ThreadCache *DeletedBufferChain::
+make_thread_cache() {
+  ThreadCache *cache = (ThreadCache *)PANDA_MALLOC_SINGLE(sizeof(ThreadCache));
+  memset(cache, 0, sizeof(ThreadCache));
+
+  pthread_mutex_lock(&_thread_caches_lock);
+  cache->_next = _thread_caches;
+  if (_thread_caches != (ThreadCache *)NULL) {
+    _thread_caches->_prev = cache;
+  }
+  _thread_caches = cache;
+  pthread_mutex_unlock(&_thread_caches_lock);
+
+  pthread_setspecific(_cache_key, cache);
+  return cache;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: DeletedBufferChain::make_cache_key
+//       Access: Private, Static
+//  Description: Creates the thread-local key that stores each
+//               thread's ThreadCache.  Called once, via
+//               pthread_once().
+////////////////////////////////////////////////////////////////////
+void DeletedBufferChain::
+make_cache_key() {
+  int result = pthread_key_create(&_cache_key, &flush_thread_cache);
+  assert(result == 0);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: DeletedBufferChain::flush_thread_cache
+//       Access: Private, Static
+//  Description: Called by the thread library when a thread that has
+//               a ThreadCache exits.  Returns all of the thread's
+//               cached buffers to their shared chains, and frees the
+//               cache.
+////////////////////////////////////////////////////////////////////
+void DeletedBufferChain::
+flush_thread_cache(void *data) {
+  ThreadCache *cache = (ThreadCache *)data;
+
+  int num_chains = (int)AtomicAdjust::get(_num_cached_chains);
+  for (int i = 0; i < num_chains && i < (int)max_cached_chains; ++i) {
+    Magazine *mag = &cache->_magazines[i];
+    if (mag->_count != 0) {
+      _cached_chains[i]->drain_magazine(mag, mag->_count);
+    }
+  }
+
+  pthread_mutex_lock(&_thread_caches_lock);
+  if (cache->_prev != (ThreadCache *)NULL) {
+    cache->_prev->_next = cache->_next;
+  } else {
+    _thread_caches = cache->_next;
+  }
+  if (cache->_next != (ThreadCache *)NULL) {
+    cache->_next->_prev = cache->_prev;
+  }
+  pthread_mutex_unlock(&_thread_caches_lock);
+
+  PANDA_FREE_SINGLE(cache);
+}
+#endif  // USE_DELETED_CHAIN_CACHE
@@ -38,6 +38,16 @@
 #define USE_DELETEDCHAINFLAG 1
 #endif // NDEBUG
 
+#if defined(USE_DELETED_CHAIN) && defined(THREAD_POSIX_IMPL)
+// With true Posix threads, each thread keeps a small private cache (a
+// "magazine") of deleted buffers for each DeletedBufferChain, so that
+// the common allocate/deallocate pairs never touch the shared mutex.
+// Buffers move between the thread caches and the shared chain in
+// batches.  We need pthread_key_create() to flush a thread's caches
+// when it exits, so this is not available on other platforms.
+#define USE_DELETED_CHAIN_CACHE 1
+#endif
+
 #ifdef USE_DELETEDCHAINFLAG
 enum DeletedChainFlag {
   DCF_deleted = 0xfeedba0f,
@@ -73,6 +83,11 @@ public:
   INLINE bool validate(void *ptr);
   INLINE size_t get_buffer_size() const;
 
+  INLINE size_t get_num_allocated() const;
+  INLINE size_t get_num_free() const;
+  size_t get_num_cached() const;
+  INLINE size_t get_num_active() const;
+
 private:
   class ObjectNode {
   public:
@@ -96,11 +111,56 @@ private:
   static INLINE size_t get_flag_reserved_bytes();
 
   ObjectNode *_deleted_chain;
+  size_t _num_free;
   
   MutexImpl _lock;
   size_t _buffer_size;
   size_t _alloc_size;
 
+  // The total number of buffers ever obtained from NeverFreeMemory.
+  TVOLATILE AtomicAdjust::Integer _num_allocated;
+
+#ifdef USE_DELETED_CHAIN_CACHE
+  // One of these per thread, per DeletedBufferChain.
+  class Magazine {
+  public:
+    ObjectNode *_head;
+    size_t _count;
+  };
+
+  // The set of all magazines for a particular thread, indexed by
+  // _cache_index.
+  enum { max_cached_chains = 256 };
+  class ThreadCache {
+  public:
+    Magazine _magazines[max_cached_chains];
+    ThreadCache *_next;
+    ThreadCache *_prev;
+  };
+
+  INLINE Magazine *get_magazine();
+  void fill_magazine(Magazine *mag);
+  void drain_magazine(Magazine *mag, size_t count);
+
+  static ThreadCache *make_thread_cache();
+  static void make_cache_key();
+  static void flush_thread_cache(void *data);
+
+  int _cache_index;
+  size_t _cache_limit;
+
+  static DeletedBufferChain *_cached_chains[max_cached_chains];
+  static TVOLATILE AtomicAdjust::Integer _num_cached_chains;
+  static pthread_key_t _cache_key;
+  static pthread_once_t _cache_key_once;
+
+  // All of the live ThreadCaches, so get_num_cached() can count them.
+  // This is a raw pthread mutex, rather than a MutexImpl, so that it
+  // is valid before static init.
+  static ThreadCache *_thread_caches;
+  static pthread_mutex_t _thread_caches_lock;
+#endif  // USE_DELETED_CHAIN_CACHE
+
   friend class MemoryHook;
 };
 
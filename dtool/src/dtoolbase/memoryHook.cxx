@@ -140,6 +140,8 @@ MemoryHook() {
   _total_mmap_size = 0;
   _max_heap_size = ~(size_t)0;
 #endif
+
+  _sample_chains = false;
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -149,6 +151,7 @@ MemoryHook() {
 ////////////////////////////////////////////////////////////////////
 MemoryHook::
 MemoryHook(const MemoryHook &copy) :
+  _sample_chains(copy._sample_chains),
   _page_size(copy._page_size)
 {
 #ifdef DO_MEMORY_USAGE
@@ -524,6 +527,31 @@ void MemoryHook::
 mark_pointer(void *, size_t, ReferenceCount *) {
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: MemoryHook::chain_alloc
+//       Access: Public, Virtual
+//  Description: This special method exists only to provide a callback
+//               hook into MemoryUsage.  It is called by
+//               DeletedBufferChain, if is_sampling_chains() is true,
+//               when it hands out the indicated buffer of the
+//               indicated size for an object of the indicated type.
+////////////////////////////////////////////////////////////////////
+void MemoryHook::
+chain_alloc(void *, size_t, TypeHandle) {
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: MemoryHook::chain_free
+//       Access: Public, Virtual
+//  Description: This special method exists only to provide a callback
+//               hook into MemoryUsage.  It is called by
+//               DeletedBufferChain, if is_sampling_chains() is true,
+//               when the indicated buffer is returned to it.
+////////////////////////////////////////////////////////////////////
+void MemoryHook::
+chain_free(void *) {
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: MemoryHook::get_deleted_chain
 //       Access: Public
@@ -550,6 +578,33 @@ get_deleted_chain(size_t buffer_size) {
   return chain;
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: MemoryHook::write_deleted_chains
+//       Access: Public
+//  Description: Writes a one-line report for each DeletedBufferChain
+//               size class: the number of buffers ever allocated,
+//               the number in use, the number on the shared free
+//               chain, and the number held in per-thread caches.
+////////////////////////////////////////////////////////////////////
+void MemoryHook::
+write_deleted_chains(ostream &out) {
+  out << "DeletedBufferChains (size: allocated, active, free, cached):\n";
+
+  _lock.acquire();
+  DeletedChains::const_iterator dci;
+  for (dci = _deleted_chains.begin(); dci != _deleted_chains.end(); ++dci) {
+    const DeletedBufferChain *chain = (*dci).second;
+    size_t num_allocated = chain->get_num_allocated();
+    if (num_allocated != 0) {
+      out << "  " << (*dci).first << ": " << num_allocated
+          << ", " << chain->get_num_active()
+          << ", " << chain->get_num_free()
+          << ", " << chain->get_num_cached() << "\n";
+    }
+  }
+  _lock.release();
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: MemoryHook::alloc_fail
 //       Access: Protected, Virtual
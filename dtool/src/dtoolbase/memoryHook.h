@@ -22,6 +22,7 @@
 #include <map>
 
 class DeletedBufferChain;
+class TypeHandle;
 
 ////////////////////////////////////////////////////////////////////
 //       Class : MemoryHook
@@ -68,7 +69,12 @@ public:
 
   virtual void mark_pointer(void *ptr, size_t orig_size, ReferenceCount *ref_ptr);
 
+  INLINE bool is_sampling_chains() const;
+  virtual void chain_alloc(void *ptr, size_t size, TypeHandle type_handle);
+  virtual void chain_free(void *ptr);
+
   DeletedBufferChain *get_deleted_chain(size_t buffer_size);
+  void write_deleted_chains(ostream &out);
 
   virtual void alloc_fail(size_t attempted_size);
 
@@ -91,6 +97,12 @@ protected:
   virtual void overflow_heap_size();
 #endif  // DO_MEMORY_USAGE
 
+protected:
+  // Set by a derived class that wants DeletedBufferChain to call
+  // chain_alloc() and chain_free() for each buffer it hands out or
+  // takes back.
+  bool _sample_chains;
+
 private:
   size_t _page_size;
 
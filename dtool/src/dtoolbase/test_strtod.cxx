@@ -14,16 +14,63 @@
 
 #include "pstrtod.h"
 
+#include <math.h>
+
 #ifndef _WIN32
 #include <locale.h>
 #endif
 
+// These are checked when the program is run with no arguments.  The
+// exponent cases guard against pstrtod() computing pow(evalue, 10)
+// instead of pow(10, evalue).
+static const char *const test_strings[] = {
+  "0", "1", "-1", "0.5", "3.14159", "-2.75",
+  "1e1", "1e3", "1E3", "2.5e-2", "-2.5e-2", "6.02e23", "1.5e+2", "4e0",
+  NULL
+};
+
+////////////////////////////////////////////////////////////////////
+//     Function: run_tests
+//  Description: Compares pstrtod() against the C library's strtod()
+//               for each of test_strings, and returns the number of
+//               mismatches.
+////////////////////////////////////////////////////////////////////
+static int
+run_tests() {
+  int num_failed = 0;
+  for (int i = 0; test_strings[i] != NULL; ++i) {
+    const char *str = test_strings[i];
+    char *pendptr = NULL;
+    char *endptr = NULL;
+    double presult = pstrtod(str, &pendptr);
+    double result = strtod(str, &endptr);
+
+    // pstrtod() accumulates the mantissa digit by digit, so allow a
+    // little rounding error.
+    double tolerance = fabs(result) * 1.0e-12;
+    if (fabs(presult - result) > tolerance || pendptr != endptr) {
+      cerr << "FAILED: " << str << " : pstrtod " << presult
+           << ", strtod " << result << "\n";
+      ++num_failed;
+    }
+  }
+
+  if (num_failed == 0) {
+    cerr << "All tests passed.\n";
+  }
+  return num_failed;
+}
+
 int
 main(int argc, char *argv[]) {
 #ifndef _WIN32
   setlocale(LC_ALL, "");
 #endif
 
+  if (argc < 2) {
+    return (run_tests() == 0) ? 0 : 1;
+  }
+
   for (int i = 1; i < argc; ++i) {
     char *endptr = NULL;
     double result = pstrtod(argv[i], &endptr);
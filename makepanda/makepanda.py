@@ -2751,6 +2751,7 @@ if (PkgSkip("PANDATOOL")==0):
     CopyAllHeaders('pandatool/src/pstatserver')
     CopyAllHeaders('pandatool/src/softprogs')
     CopyAllHeaders('pandatool/src/text-stats')
+    CopyAllHeaders('pandatool/src/pstats-report')
     CopyAllHeaders('pandatool/src/vrmlprogs')
     CopyAllHeaders('pandatool/src/win-stats')
     CopyAllHeaders('pandatool/src/xfileprogs')
@@ -5602,6 +5603,24 @@ if (PkgSkip("PANDATOOL")==0):
     TargetAdd('text-stats.exe', input='libp3pystub.lib')
     TargetAdd('text-stats.exe', opts=['ADVAPI'])
 
+#
+# DIRECTORY: pandatool/src/pstats-report/
+#
+
+if (PkgSkip("PANDATOOL")==0):
+    OPTS=['DIR:pandatool/src/pstats-report']
+    TargetAdd('pstats-report_pStatCapture.obj', opts=OPTS, input='pStatCapture.cxx')
+    TargetAdd('pstats-report_pStatsReport.obj', opts=OPTS, input='pStatsReport.cxx')
+    TargetAdd('pstats-report.exe', input='pstats-report_pStatCapture.obj')
+    TargetAdd('pstats-report.exe', input='pstats-report_pStatsReport.obj')
+    TargetAdd('pstats-report.exe', input='libp3progbase.lib')
+    TargetAdd('pstats-report.exe', input='libp3pstatserver.lib')
+    TargetAdd('pstats-report.exe', input='libp3pandatoolbase.lib')
+    TargetAdd('pstats-report.exe', input='libpandaegg.dll')
+    TargetAdd('pstats-report.exe', input=COMMON_PANDA_LIBS)
+    TargetAdd('pstats-report.exe', input='libp3pystub.lib')
+    TargetAdd('pstats-report.exe', opts=['ADVAPI'])
+
 #
 # DIRECTORY: pandatool/src/vrmlprogs/
 #
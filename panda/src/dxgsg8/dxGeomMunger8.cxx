@@ -60,6 +60,14 @@ wp_callback(void *) {
 CPT(GeomVertexFormat) DXGeomMunger8::
 munge_format_impl(const GeomVertexFormat *orig,
                   const GeomVertexAnimationSpec &animation) {
+  // A flexible vertex format holds only floating-point positions,
+  // normals and texcoords; it has no normalized integer types, as
+  // GL's generic attributes do, so unlike the GL munger we can't
+  // keep even the vertex column quantized.  They are all expanded
+  // here.
+  CPT(GeomVertexFormat) unquantized = orig->get_unquantized_format();
+  orig = unquantized;
+
   if (dxgsg8_cat.is_debug()) {
     if (animation.get_animation_type() != AT_none) {
       dxgsg8_cat.debug()
@@ -189,6 +197,14 @@ munge_format_impl(const GeomVertexFormat *orig,
 ////////////////////////////////////////////////////////////////////
 CPT(GeomVertexFormat) DXGeomMunger8::
 premunge_format_impl(const GeomVertexFormat *orig) {
+  // A flexible vertex format holds only floating-point positions,
+  // normals and texcoords; it has no normalized integer types, as
+  // GL's generic attributes do, so unlike the GL munger we can't
+  // keep even the vertex column quantized.  They are all expanded
+  // here.
+  CPT(GeomVertexFormat) unquantized = orig->get_unquantized_format();
+  orig = unquantized;
+
   // We have to build a completely new format that includes only the
   // appropriate components, in the appropriate order, in just one
   // array.
@@ -38,7 +38,7 @@
      eggNamedObject.I eggNamedObject.h eggNameUniquifier.h  \
      eggNode.I eggNode.h eggNurbsCurve.I eggNurbsCurve.h  \
      eggNurbsSurface.I eggNurbsSurface.h eggObject.I eggObject.h  \
-     eggParameters.h \
+     eggParameters.h eggParser.I eggParser.h eggParserListener.h \
      eggPatch.I eggPatch.h \
      eggPoint.I eggPoint.h eggPolygon.I  \
      eggPolygon.h eggPolysetMaker.h eggPoolUniquifier.h \
@@ -81,7 +81,7 @@
      eggMiscFuncs.cxx eggMorphList.cxx  \
      eggNamedObject.cxx eggNameUniquifier.cxx eggNode.cxx  \
      eggNurbsCurve.cxx eggNurbsSurface.cxx eggObject.cxx  \
-     eggParameters.cxx \
+     eggParameters.cxx eggParser.cxx eggParserListener.cxx \
      eggPatch.cxx \
      eggPoint.cxx eggPolygon.cxx eggPolysetMaker.cxx  \
      eggPoolUniquifier.cxx eggPrimitive.cxx eggRenderMode.cxx  \
@@ -118,6 +118,7 @@
     eggNamedObject.I eggNamedObject.h eggNameUniquifier.h eggNode.I eggNode.h \
     eggNurbsCurve.I eggNurbsCurve.h eggNurbsSurface.I eggNurbsSurface.h \
     eggObject.I eggObject.h eggParameters.h \
+    eggParser.I eggParser.h eggParserListener.h \
     eggPatch.I eggPatch.h \
     eggPoint.I eggPoint.h \
     eggPolygon.I eggPolygon.h eggPolysetMaker.h eggPoolUniquifier.h \
@@ -71,6 +71,13 @@ ConfigVariableBool egg_support_old_anims
  PRC_DESC("Set this true to support loading of old character animation files, which "
           "had the convention that the order \"phr\" implied a reversed roll."));
 
+ConfigVariableBool egg_fast_parser
+("egg-fast-parser", true,
+ PRC_DESC("Set this true to read egg files with the hand-written EggParser, "
+          "which is much faster than the yacc grammar it replaces on large "
+          "files.  Set it false to fall back to the yacc parser, in case the "
+          "two disagree on some file."));
+
 ConfigVariableBool egg_mesh
 ("egg-mesh", true,
  PRC_DESC("Set this true to convert triangles and higher-order polygons "
@@ -18,6 +18,7 @@
 #include "eggMaterialCollection.h"
 #include "eggComment.h"
 #include "eggPoolUniquifier.h"
+#include "eggParser.h"
 #include "config_egg.h"
 #include "config_util.h"
 #include "config_express.h"
@@ -116,6 +117,22 @@ read(Filename filename, string display_name) {
 ////////////////////////////////////////////////////////////////////
 bool EggData::
 read(istream &in) {
+  return read(in, (EggParserListener *)NULL);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggData::read
+//       Access: Public
+//  Description: Parses the egg syntax contained in the indicated
+//               input stream, as above, but hands the vertices and
+//               primitives to the indicated listener, if it is not
+//               NULL, instead of storing them.  See
+//               EggParserListener.  A listener is only supported by
+//               the fast parser, so this always uses it when there
+//               is one.
+////////////////////////////////////////////////////////////////////
+bool EggData::
+read(istream &in, EggParserListener *listener) {
   // First, dispense with any children we had previously.  We will
   // replace them with the new data.
   clear();
@@ -126,7 +143,15 @@ read(istream &in) {
   PT(EggData) data = new EggData(*this);
 
   int error_count;
-  {
+  if (egg_fast_parser || listener != (EggParserListener *)NULL) {
+    // The EggParser keeps all of its state to itself, so it doesn't
+    // need to hold egg_lock.
+    EggParser parser(in, get_egg_filename());
+    parser.set_listener(listener);
+    parser.parse_egg(data, data);
+    error_count = parser.get_error_count();
+
+  } else {
     LightMutexHolder holder(egg_lock);
     egg_init_parser(in, get_egg_filename(), data, data);
     eggyyparse();
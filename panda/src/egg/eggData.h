@@ -24,6 +24,7 @@
 #include "dSearchPath.h"
 
 class BamCacheRecord;
+class EggParserListener;
 
 ////////////////////////////////////////////////////////////////////
 //       Class : EggData
@@ -79,6 +80,9 @@ PUBLISHED:
 protected:
   virtual void write(ostream &out, int indent_level = 0) const;
 
+public:
+  bool read(istream &in, EggParserListener *listener);
+
 private:
   void post_read();
   void pre_write();
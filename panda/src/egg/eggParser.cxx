@@ -0,0 +1,3789 @@
+// Filename: eggParser.cxx
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "eggParser.h"
+#include "eggParserListener.h"
+#include "config_egg.h"
+#include "eggData.h"
+#include "eggGroup.h"
+#include "eggTexture.h"
+#include "eggMaterial.h"
+#include "eggVertexPool.h"
+#include "eggVertex.h"
+#include "eggVertexUV.h"
+#include "eggVertexAux.h"
+#include "eggPolygon.h"
+#include "eggTriangleFan.h"
+#include "eggTriangleStrip.h"
+#include "eggPatch.h"
+#include "eggPoint.h"
+#include "eggLine.h"
+#include "eggNurbsSurface.h"
+#include "eggNurbsCurve.h"
+#include "eggTable.h"
+#include "eggSAnimData.h"
+#include "eggXfmAnimData.h"
+#include "eggXfmSAnim.h"
+#include "eggAnimPreload.h"
+#include "eggComment.h"
+#include "eggCoordinateSystem.h"
+#include "eggExternalReference.h"
+#include "eggSwitchCondition.h"
+#include "eggCompositePrimitive.h"
+#include "dcast.h"
+#include "indent.h"
+#include "pnotify.h"
+#include "thread.h"
+
+#include <math.h>
+#include <algorithm>
+
+// The input is read in blocks of this size.  The buffer grows beyond
+// this only if a single token (a long quoted string, say) doesn't fit.
+static const size_t egg_parser_block_size = 65536;
+
+// As in the yacc parser, this much of the current line is kept for
+// printing out with an error message.
+static const size_t max_error_width = 1024;
+
+// The keywords, sorted in strcmp() order of their uppercase names for
+// the binary search in lookup_keyword().  Several keywords have more
+// than one spelling.
+struct EggKeyword {
+  const char *_name;
+  int _token;
+};
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::Constructor
+//       Access: Public
+//  Description: Prepares to read egg syntax from the indicated
+//               stream.  The filename is used only for reporting
+//               errors.
+////////////////////////////////////////////////////////////////////
+EggParser::
+EggParser(istream &in, const string &filename) :
+  _in(in),
+  _filename(filename)
+{
+  _buffer_size = egg_parser_block_size;
+  _buffer = (char *)PANDA_MALLOC_ARRAY(_buffer_size + 1);
+  _pos = _buffer;
+  _end = _buffer;
+  *_end = '\0';
+  _eof = false;
+
+  _token = T_eof;
+  _need_token = false;
+  _text = _buffer;
+  _text_length = 0;
+  _number = 0.0;
+  _ulong = 0;
+
+  _line_number = 1;
+  _line_start = _buffer;
+  _line_prefix_length = 0;
+  _col_number = 0;
+  _error_count = 0;
+  _warning_count = 0;
+  _failed = false;
+
+  _top_node = NULL;
+  _last_pool = NULL;
+  _last_vertices = NULL;
+
+  _listener = NULL;
+  _prim_pool = NULL;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::Destructor
+//       Access: Public
+//  Description:
+////////////////////////////////////////////////////////////////////
+EggParser::
+~EggParser() {
+  PANDA_FREE_ARRAY(_buffer);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::parse_egg
+//       Access: Public
+//  Description: Reads the entire stream, adding each node defined at
+//               the top level to the indicated EggData.  Textures
+//               that are defined on-the-fly within a primitive are
+//               added to top_node, which may be NULL.
+//
+//               Returns true if the file was read without errors,
+//               false otherwise.  As with the yacc parser, a syntax
+//               error stops the read, but the nodes that were
+//               completely read before the error are still added.
+//               If a listener stops the read, this returns true
+//               unless there were also errors; the listener must
+//               remember that it did so.
+////////////////////////////////////////////////////////////////////
+bool EggParser::
+parse_egg(EggData *data, EggGroupNode *top_node) {
+  _top_node = top_node;
+
+  next_token();
+  while (!_failed && get_token() != T_eof) {
+    PT(EggNode) node;
+    if (!parse_node(node) || !add_node(data, node)) {
+      break;
+    }
+  }
+
+  check_vertex_pools();
+  return (_error_count == 0);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::NameTable::Constructor
+//       Access: Public
+//  Description:
+////////////////////////////////////////////////////////////////////
+EggParser::NameTable::
+NameTable() : _num_entries(0) {
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::NameTable::find
+//       Access: Public
+//  Description: Returns the object defined with the indicated name,
+//               or NULL if there is no such object.
+////////////////////////////////////////////////////////////////////
+EggObject *EggParser::NameTable::
+find(const char *name, size_t length) const {
+  if (_num_entries == 0) {
+    return NULL;
+  }
+  size_t slot = find_slot(name, length, hash_name(name, length));
+  return _entries[slot]._object;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::NameTable::insert
+//       Access: Public
+//  Description: Records the object with the indicated name,
+//               replacing any object previously recorded with the
+//               same name.
+////////////////////////////////////////////////////////////////////
+void EggParser::NameTable::
+insert(const string &name, EggObject *object) {
+  nassertv(object != (EggObject *)NULL);
+  if ((_num_entries + 1) * 2 > _entries.size()) {
+    grow();
+  }
+
+  size_t hash = hash_name(name.data(), name.length());
+  Entry &entry = _entries[find_slot(name.data(), name.length(), hash)];
+  if (entry._object == (EggObject *)NULL) {
+    entry._name = name;
+    entry._hash = hash;
+    ++_num_entries;
+  }
+  entry._object = object;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::NameTable::get_names
+//       Access: Public
+//  Description: Fills the vector with the names in the table, in no
+//               particular order.
+////////////////////////////////////////////////////////////////////
+void EggParser::NameTable::
+get_names(pvector<string> &names) const {
+  Entries::const_iterator ei;
+  for (ei = _entries.begin(); ei != _entries.end(); ++ei) {
+    if ((*ei)._object != (EggObject *)NULL) {
+      names.push_back((*ei)._name);
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::NameTable::hash_name
+//       Access: Private, Static
+//  Description: Computes the FNV-1a hash of the name.
+////////////////////////////////////////////////////////////////////
+size_t EggParser::NameTable::
+hash_name(const char *name, size_t length) {
+  size_t hash = (size_t)2166136261U;
+  for (size_t i = 0; i < length; ++i) {
+    hash = (hash ^ (unsigned char)name[i]) * (size_t)16777619U;
+  }
+  return hash;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::NameTable::find_slot
+//       Access: Private
+//  Description: Returns the index of the entry with the indicated
+//               name, or of the empty entry at which it should be
+//               added if it is not in the table.  The table must not
+//               be empty.
+////////////////////////////////////////////////////////////////////
+size_t EggParser::NameTable::
+find_slot(const char *name, size_t length, size_t hash) const {
+  size_t mask = _entries.size() - 1;
+  size_t slot = hash & mask;
+  for (;;) {
+    const Entry &entry = _entries[slot];
+    if (entry._object == (EggObject *)NULL) {
+      return slot;
+    }
+    if (entry._hash == hash && entry._name.length() == length &&
+        memcmp(entry._name.data(), name, length) == 0) {
+      return slot;
+    }
+    slot = (slot + 1) & mask;
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::NameTable::grow
+//       Access: Private
+//  Description: Doubles the size of the table and rehashes all of
+//               the entries.
+////////////////////////////////////////////////////////////////////
+void EggParser::NameTable::
+grow() {
+  Entries old_entries;
+  old_entries.swap(_entries);
+  _entries.resize(max(old_entries.size() * 2, (size_t)16));
+
+  size_t mask = _entries.size() - 1;
+  Entries::iterator ei;
+  for (ei = old_entries.begin(); ei != old_entries.end(); ++ei) {
+    Entry &old_entry = (*ei);
+    if (old_entry._object != (EggObject *)NULL) {
+      size_t slot = old_entry._hash & mask;
+      while (_entries[slot]._object != (EggObject *)NULL) {
+        slot = (slot + 1) & mask;
+      }
+      Entry &entry = _entries[slot];
+      entry._name.swap(old_entry._name);
+      entry._hash = old_entry._hash;
+      entry._object = old_entry._object;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::fill_buffer
+//       Access: Private
+//  Description: Reads the next block of the stream into the buffer.
+//               Everything from _pos onward is kept, and moved to
+//               the beginning of the buffer; any pointers past _pos
+//               that the caller is holding must be recomputed
+//               relative to the new value of _pos.  Returns true if
+//               any more characters were read, false at the end of
+//               the file.
+////////////////////////////////////////////////////////////////////
+bool EggParser::
+fill_buffer() {
+  if (_eof) {
+    return false;
+  }
+
+  // If the current line began before _pos, save whatever part of it
+  // we are about to lose, so it can still be reported with an error.
+  if (_line_start < _pos) {
+    size_t length = _pos - _line_start;
+    if (_line_prefix.length() < max_error_width) {
+      _line_prefix.append(_line_start,
+                          min(length, max_error_width - _line_prefix.length()));
+    }
+    _line_prefix_length += length;
+    _line_start = _buffer;
+  } else {
+    _line_start = _buffer + (_line_start - _pos);
+  }
+
+  size_t remaining = _end - _pos;
+  if (remaining == _buffer_size) {
+    // The current token fills the whole buffer.  Make it bigger.
+    size_t new_size = _buffer_size * 2;
+    char *new_buffer = (char *)PANDA_MALLOC_ARRAY(new_size + 1);
+    memcpy(new_buffer, _pos, remaining);
+    _line_start = new_buffer + (_line_start - _buffer);
+    PANDA_FREE_ARRAY(_buffer);
+    _buffer = new_buffer;
+    _buffer_size = new_size;
+
+  } else if (_pos != _buffer) {
+    memmove(_buffer, _pos, remaining);
+  }
+  _pos = _buffer;
+  _end = _buffer + remaining;
+
+  size_t count = 0;
+  if (_in) {
+    _in.read(_end, _buffer_size - remaining);
+    count = _in.gcount();
+  }
+  _end += count;
+  *_end = '\0';
+
+  if (count == 0) {
+    _eof = true;
+    return false;
+  }
+
+  Thread::consider_yield();
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::scan_token
+//       Access: Private
+//  Description: Scans the next token from the input, skipping
+//               whitespace and comments.  Sets _token to T_eof at
+//               the end of the file.
+////////////////////////////////////////////////////////////////////
+void EggParser::
+scan_token() {
+  for (;;) {
+    // The buffer is always terminated with a '\0', so we only have to
+    // check for the end of the buffer when we see one.
+    char c = *_pos;
+    while (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+      if (c == '\n') {
+        ++_line_number;
+        _line_start = _pos + 1;
+        _line_prefix.clear();
+        _line_prefix_length = 0;
+      }
+      c = *(++_pos);
+    }
+
+    if (c == '\0' && _pos == _end) {
+      if (!fill_buffer()) {
+        _token = T_eof;
+        _text = _pos;
+        _text_length = 0;
+        _col_number = (int)(_line_prefix_length + (_pos - _line_start));
+        return;
+      }
+      continue;
+    }
+
+    if (c == '{' || c == '}') {
+      _token = (c == '{') ? T_open : T_close;
+      _text = _pos;
+      _text_length = 1;
+      ++_pos;
+      _col_number = (int)(_line_prefix_length + (_pos - _line_start));
+      return;
+    }
+
+    if (c == '"') {
+      scan_quoted_string();
+      return;
+    }
+
+    if (c == '/' && (_pos[1] == '/' || _pos[1] == '*' || _pos + 1 == _end)) {
+      // This might be a comment; we won't know until we have scanned
+      // the whole run of characters.
+      scan_run();
+      if (_token != T_eof) {
+        return;
+      }
+      continue;
+    }
+
+    scan_run();
+    return;
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::scan_run
+//       Access: Private
+//  Description: Scans a run of characters up to the next whitespace,
+//               curly brace or quotation mark, and classifies it as a
+//               keyword, a number or a string.  If the run turns out
+//               to begin a comment, the comment is skipped and _token
+//               is set to T_eof, so the caller knows to keep looking.
+////////////////////////////////////////////////////////////////////
+void EggParser::
+scan_run() {
+  const char *p = _pos;
+  for (;;) {
+    char c = *p;
+    while (c != ' ' && c != '\t' && c != '\n' && c != '\r' &&
+           c != '{' && c != '}' && c != '"' && c != '\0') {
+      c = *(++p);
+    }
+    if (c != '\0') {
+      break;
+    }
+    if (p != _end) {
+      // A '\0' character within the file is just part of the run.
+      ++p;
+      continue;
+    }
+    size_t offset = p - _pos;
+    bool more = fill_buffer();
+    p = _pos + offset;
+    if (!more) {
+      break;
+    }
+  }
+
+  size_t length = p - _pos;
+  if (length >= 2 && _pos[0] == '/') {
+    if (_pos[1] == '/') {
+      eat_line_comment();
+      _token = T_eof;
+      return;
+    }
+    if (_pos[1] == '*' && length == 2) {
+      _pos += 2;
+      _col_number = (int)(_line_prefix_length + (_pos - _line_start));
+      eat_c_comment();
+      _token = T_eof;
+      return;
+    }
+  }
+
+  _token = classify_run(_pos, p);
+  _text = _pos;
+  _text_length = length;
+  _pos = (char *)p;
+  _col_number = (int)(_line_prefix_length + (_pos - _line_start));
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::scan_quoted_string
+//       Access: Private
+//  Description: Scans a string in quotation marks, which may include
+//               any characters up to the closing quotation mark,
+//               including newlines.  _pos is on the opening quotation
+//               mark.
+////////////////////////////////////////////////////////////////////
+void EggParser::
+scan_quoted_string() {
+  // This is where the error is reported if the string is
+  // unterminated.
+  ++_pos;
+  int line_number = _line_number;
+  int col_number = (int)(_line_prefix_length + (_pos - _line_start));
+
+  const char *p = _pos;
+  bool terminated = false;
+  for (;;) {
+    char c = *p;
+    while (c != '"' && c != '\n' && c != '\0') {
+      c = *(++p);
+    }
+    if (c == '"') {
+      terminated = true;
+      break;
+    }
+    if (c == '\n') {
+      ++_line_number;
+      _line_start = p + 1;
+      _line_prefix.clear();
+      _line_prefix_length = 0;
+      ++p;
+      continue;
+    }
+    if (p != _end) {
+      ++p;
+      continue;
+    }
+    size_t offset = p - _pos;
+    bool more = fill_buffer();
+    p = _pos + offset;
+    if (!more) {
+      break;
+    }
+  }
+
+  _token = T_string;
+  _text = _pos;
+  _text_length = p - _pos;
+  _pos = (char *)(terminated ? p + 1 : p);
+  _col_number = (int)(_line_prefix_length + (_pos - _line_start));
+
+  if (!terminated) {
+    int save_line_number = _line_number;
+    int save_col_number = _col_number;
+    _line_number = line_number;
+    _col_number = col_number;
+    error("This quotation mark is unterminated.");
+    _line_number = save_line_number;
+    _col_number = save_col_number;
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::eat_line_comment
+//       Access: Private
+//  Description: Skips a C++-style comment up to (but not including)
+//               the end of the line.
+////////////////////////////////////////////////////////////////////
+void EggParser::
+eat_line_comment() {
+  for (;;) {
+    char *newline = (char *)memchr(_pos, '\n', _end - _pos);
+    if (newline != (char *)NULL) {
+      _pos = newline;
+      return;
+    }
+    _pos = _end;
+    if (!fill_buffer()) {
+      return;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::eat_c_comment
+//       Access: Private
+//  Description: Skips a C-style comment, up to the closing */.  _pos
+//               is just past the opening /*.
+////////////////////////////////////////////////////////////////////
+void EggParser::
+eat_c_comment() {
+  int line_number = _line_number;
+  int col_number = _col_number;
+
+  char last = '\0';
+  for (;;) {
+    if (_pos == _end) {
+      if (!fill_buffer()) {
+        break;
+      }
+      continue;
+    }
+
+    char c = *_pos++;
+    if (c == '\n') {
+      ++_line_number;
+      _line_start = _pos;
+      _line_prefix.clear();
+      _line_prefix_length = 0;
+
+    } else if (last == '*' && c == '/') {
+      return;
+
+    } else if (last == '/' && c == '*') {
+      // Report the column of the nested slash.
+      int save_col_number = _col_number;
+      _col_number = (int)(_line_prefix_length + (_pos - _line_start)) - 1;
+      ostringstream errmsg;
+      errmsg << "This comment contains a nested /* symbol at line "
+             << _line_number << ", column " << _col_number
+             << "--possibly unclosed?";
+      warning(errmsg.str());
+      _col_number = save_col_number;
+      // Don't let the '*' also close a comment, as in "/*/".
+      c = '\0';
+    }
+    last = c;
+  }
+
+  int save_line_number = _line_number;
+  _line_number = line_number;
+  _col_number = col_number;
+  error("This comment marker is unclosed.");
+  _line_number = save_line_number;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::classify_run
+//       Access: Private
+//  Description: Decides what kind of token the indicated run of
+//               characters is, following the same rules as the lex
+//               scanner: the whole run must match the pattern for a
+//               keyword or number, or else it is a string.  Fills in
+//               _number or _ulong for a number.
+////////////////////////////////////////////////////////////////////
+int EggParser::
+classify_run(const char *p, const char *end) {
+  char c = *p;
+  size_t length = end - p;
+
+  if (c == '<') {
+    if (end[-1] == '>') {
+      int keyword = lookup_keyword(p, end);
+      if (keyword != T_eof) {
+        return keyword;
+      }
+    }
+    return T_string;
+  }
+
+  if ((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.') {
+    if (scan_decimal(p, end, _number)) {
+      return T_number;
+    }
+
+    if (c == '0' && length >= 2 && (p[1] == 'x' || p[1] == 'X' ||
+                                    p[1] == 'b' || p[1] == 'B')) {
+      bool hex = (p[1] == 'x' || p[1] == 'X');
+      const char *q = p + 2;
+      while (q < end && (hex ? isxdigit(*q) : (*q == '0' || *q == '1'))) {
+        ++q;
+      }
+      if (q == end) {
+        string digits(p + 2, end);
+        _ulong = strtoul(digits.c_str(), (char **)NULL, hex ? 16 : 2);
+        return T_ulong;
+      }
+      return T_string;
+    }
+
+    if (length == 4 && cmp_nocase(string(p, end), "-inf") == 0) {
+      _number = -HUGE_VAL;
+      return T_number;
+    }
+    if (length == 6 && cmp_nocase(string(p, end), "1.#inf") == 0) {
+      _number = HUGE_VAL;
+      return T_number;
+    }
+    if (length == 7 && cmp_nocase(string(p, end), "-1.#inf") == 0) {
+      _number = -HUGE_VAL;
+      return T_number;
+    }
+    return T_string;
+  }
+
+  if (c == 'i' || c == 'I') {
+    if (length == 3 && cmp_nocase(string(p, end), "inf") == 0) {
+      _number = HUGE_VAL;
+      return T_number;
+    }
+    return T_string;
+  }
+
+  if (c == 'n' || c == 'N') {
+    // A not-a-number, written as "nan0x" followed by the bits.
+    if (length >= 5 && cmp_nocase(string(p, p + 5), "nan0x") == 0) {
+      const char *q = p + 5;
+      while (q < end && isxdigit(*q)) {
+        ++q;
+      }
+      if (q == end) {
+        string digits(p + 3, end);
+        unsigned long bits = strtoul(digits.c_str(), (char **)NULL, 0);
+        memset(&_number, 0, sizeof(_number));
+        memcpy(&_number, &bits, min(sizeof(bits), sizeof(_number)));
+        return T_number;
+      }
+    }
+    return T_string;
+  }
+
+  return T_string;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::lookup_keyword
+//       Access: Private, Static
+//  Description: Returns the token for the indicated run of
+//               characters if it is one of the <Keywords>, compared
+//               without regard to case, or T_eof if it is not.
+////////////////////////////////////////////////////////////////////
+int EggParser::
+lookup_keyword(const char *p, const char *end) {
+  static const EggKeyword keywords[] = {
+    { "<ANIMPRELOAD>", K_animpreload },
+    { "<AUX>", K_aux },
+    { "<BEZIERCURVE>", K_beziercurve },
+    { "<BFACE>", K_bface },
+    { "<BILLBOARD>", K_billboard },
+    { "<BILLBOARDCENTER>", K_billboardcenter },
+    { "<BINORMAL>", K_binormal },
+    { "<BUNDLE>", K_bundle },
+    { "<CHAR*>", K_scalar },
+    { "<CLOSED>", K_closed },
+    { "<COLLIDE>", K_collide },
+    { "<COMMENT>", K_comment },
+    { "<COMPONENT>", K_component },
+    { "<COORDINATESYSTEM>", K_coordsystem },
+    { "<CV>", K_cv },
+    { "<DART>", K_dart },
+    { "<DCS>", K_dcs },
+    { "<DEFAULTPOSE>", K_defaultpose },
+    { "<DISTANCE>", K_distance },
+    { "<DNORMAL>", K_dnormal },
+    { "<DRGBA>", K_drgba },
+    { "<DTREF>", K_dtref },
+    { "<DUV>", K_duv },
+    { "<DXYZ>", K_dxyz },
+    { "<DYNAMICVERTEXPOOL>", K_dynamicvertexpool },
+    { "<FILE>", K_external_file },
+    { "<GROUP>", K_group },
+    { "<INCLUDE>", K_include },
+    { "<INSTANCE>", K_instance },
+    { "<JOINT>", K_joint },
+    { "<KNOTS>", K_knots },
+    { "<LINE>", K_line },
+    { "<LOOP>", K_loop },
+    { "<MATERIAL>", K_material },
+    { "<MATRIX3>", K_matrix3 },
+    { "<MATRIX4>", K_matrix4 },
+    { "<MODEL>", K_model },
+    { "<MREF>", K_mref },
+    { "<NORMAL>", K_normal },
+    { "<NURBSCURVE>", K_nurbscurve },
+    { "<NURBSSURFACE>", K_nurbssurface },
+    { "<OBJECTTYPE>", K_objecttype },
+    { "<ORDER>", K_order },
+    { "<OUTTANGENT>", K_outtangent },
+    { "<PATCH>", K_patch },
+    { "<POINTLIGHT>", K_pointlight },
+    { "<POLYGON>", K_polygon },
+    { "<REF>", K_ref },
+    { "<RGBA>", K_rgba },
+    { "<ROTATE>", K_rotate },
+    { "<ROTX>", K_rotx },
+    { "<ROTY>", K_roty },
+    { "<ROTZ>", K_rotz },
+    { "<S$ANIM>", K_sanim },
+    { "<SCALAR>", K_scalar },
+    { "<SCALE>", K_scale },
+    { "<SEQUENCE>", K_sequence },
+    { "<SHADING>", K_shading },
+    { "<SWITCH>", K_switch },
+    { "<SWITCHCONDITION>", K_switchcondition },
+    { "<TABLE>", K_table },
+    { "<TAG>", K_tag },
+    { "<TANGENT>", K_tangent },
+    { "<TEXLIST>", K_texlist },
+    { "<TEXTURE>", K_texture },
+    { "<TLENGTHS>", K_tlengths },
+    { "<TRANSFORM>", K_transform },
+    { "<TRANSLATE>", K_translate },
+    { "<TREF>", K_tref },
+    { "<TRIANGLEFAN>", K_trianglefan },
+    { "<TRIANGLESTRIP>", K_trianglestrip },
+    { "<TRIM>", K_trim },
+    { "<TXT>", K_txt },
+    { "<U-KNOTS>", K_uknots },
+    { "<UV>", K_uv },
+    { "<U_KNOTS>", K_uknots },
+    { "<V-KNOTS>", K_vknots },
+    { "<V>", K_table_v },
+    { "<VERTEX>", K_vertex },
+    { "<VERTEXANIM>", K_vertexanim },
+    { "<VERTEXPOOL>", K_vertexpool },
+    { "<VERTEXREF>", K_vertexref },
+    { "<V_KNOTS>", K_vknots },
+    { "<XFM$ANIM>", K_xfmanim },
+    { "<XFM$ANIM_S$>", K_xfmsanim },
+  };
+  static const int num_keywords = sizeof(keywords) / sizeof(keywords[0]);
+
+  // The longest keyword is "<DYNAMICVERTEXPOOL>".
+  char upper[24];
+  size_t length = end - p;
+  if (length >= sizeof(upper)) {
+    return T_eof;
+  }
+  for (size_t i = 0; i < length; ++i) {
+    upper[i] = toupper((unsigned char)p[i]);
+  }
+  upper[length] = '\0';
+
+  int lo = 0;
+  int hi = num_keywords;
+  while (lo < hi) {
+    int mid = (lo + hi) / 2;
+    int cmp = strcmp(upper, keywords[mid]._name);
+    if (cmp == 0) {
+      return keywords[mid]._token;
+    } else if (cmp < 0) {
+      hi = mid;
+    } else {
+      lo = mid + 1;
+    }
+  }
+  return T_eof;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::scan_decimal
+//       Access: Private, Static
+//  Description: If the indicated run of characters is entirely a
+//               decimal number, with an optional fraction and
+//               exponent, stores its value and returns true.
+//               Otherwise, returns false.
+//
+//               The value is computed with exactly the same
+//               arithmetic as pstrtod(), which the yacc lexer uses,
+//               rather than correctly rounded, so that both parsers
+//               read the same egg data from the same file.
+////////////////////////////////////////////////////////////////////
+bool EggParser::
+scan_decimal(const char *p, const char *end, double &value) {
+  const char *s = p;
+  bool negative = false;
+  if (*s == '+' || *s == '-') {
+    negative = (*s == '-');
+    ++s;
+  }
+
+  bool any_digits = false;
+  value = 0.0;
+  while (s < end && *s >= '0' && *s <= '9') {
+    value = (value * 10.0) + (*s - '0');
+    any_digits = true;
+    ++s;
+  }
+
+  if (s < end && *s == '.') {
+    ++s;
+    double multiplicand = 0.1;
+    while (s < end && *s >= '0' && *s <= '9') {
+      value += (*s - '0') * multiplicand;
+      multiplicand *= 0.1;
+      any_digits = true;
+      ++s;
+    }
+  }
+
+  if (!any_digits) {
+    return false;
+  }
+
+  if (s < end && (*s == 'e' || *s == 'E')) {
+    ++s;
+    bool exp_negative = false;
+    if (s < end && (*s == '+' || *s == '-')) {
+      exp_negative = (*s == '-');
+      ++s;
+    }
+    if (s == end || *s < '0' || *s > '9') {
+      return false;
+    }
+    double exp_value = 0.0;
+    while (s < end && *s >= '0' && *s <= '9') {
+      exp_value = (exp_value * 10.0) + (*s - '0');
+      ++s;
+    }
+    if (exp_negative) {
+      value /= pow(10.0, exp_value);
+    } else {
+      value *= pow(10.0, exp_value);
+    }
+  }
+
+  if (s != end) {
+    return false;
+  }
+
+  if (negative) {
+    value = -value;
+  }
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::error
+//       Access: Private
+//  Description: Reports an error at the current position in the
+//               file.
+////////////////////////////////////////////////////////////////////
+void EggParser::
+error(const string &msg) {
+  if (egg_cat.is_error()) {
+    report(egg_cat.error(false), "Error", msg);
+  }
+  ++_error_count;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::warning
+//       Access: Private
+//  Description: Reports a warning at the current position in the
+//               file.
+////////////////////////////////////////////////////////////////////
+void EggParser::
+warning(const string &msg) {
+  if (egg_cat.is_warning()) {
+    report(egg_cat.warning(false), "Warning", msg);
+  }
+  ++_warning_count;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::syntax_error
+//       Access: Private
+//  Description: Reports that the current token was not expected, and
+//               stops the parse.
+////////////////////////////////////////////////////////////////////
+void EggParser::
+syntax_error() {
+  if (!_failed) {
+    error("syntax error");
+    _failed = true;
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::stop_read_unsupported
+//       Access: Private
+//  Description: Stops the parse without reporting an error, because
+//               the file uses something that can't be handed to the
+//               listener, and tells the listener so.
+////////////////////////////////////////////////////////////////////
+void EggParser::
+stop_read_unsupported() {
+  _listener->read_stopped();
+  stop_read();
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::report
+//       Access: Private
+//  Description: Writes an error or warning message, along with the
+//               current line and a caret under the current column,
+//               in the same format used by the yacc parser.
+////////////////////////////////////////////////////////////////////
+void EggParser::
+report(ostream &out, const char *kind, const string &msg) {
+  out << "\n" << kind;
+  if (!_filename.empty()) {
+    out << " in " << _filename;
+  }
+  out
+    << " at line " << _line_number << ", column " << _col_number << ":\n"
+    << setiosflags(Notify::get_literal_flag())
+    << get_current_line() << "\n";
+  indent(out, _col_number - 1)
+    << "^\n" << msg << "\n\n"
+    << resetiosflags(Notify::get_literal_flag()) << flush;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::get_current_line
+//       Access: Private
+//  Description: Returns as much of the current line as is still
+//               available, for reporting an error.
+////////////////////////////////////////////////////////////////////
+string EggParser::
+get_current_line() const {
+  string line = _line_prefix;
+  const char *p = _line_start;
+  while (p < _end && *p != '\n' && line.length() < max_error_width) {
+    line += *p;
+    ++p;
+  }
+  return line;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::expect
+//       Access: Private
+//  Description: If the current token is the indicated token, skips
+//               it and returns true.  Otherwise, reports a syntax
+//               error and returns false.
+////////////////////////////////////////////////////////////////////
+bool EggParser::
+expect(int token) {
+  if (get_token() != token) {
+    syntax_error();
+    return false;
+  }
+  next_token();
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::read_real
+//       Access: Private
+//  Description: Reads a floating-point or hexadecimal number.
+////////////////////////////////////////////////////////////////////
+bool EggParser::
+read_real(double &value) {
+  if (get_token() == T_number) {
+    value = _number;
+  } else if (get_token() == T_ulong) {
+    value = (double)_ulong;
+  } else {
+    syntax_error();
+    return false;
+  }
+  next_token();
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::read_integer
+//       Access: Private
+//  Description: Reads an integer number.  A number with a fractional
+//               part is accepted with a warning, and truncated.
+////////////////////////////////////////////////////////////////////
+bool EggParser::
+read_integer(double &value) {
+  if (get_token() == T_number) {
+    int i = (int)_number;
+    value = _number;
+    if ((double)i != _number) {
+      warning("Integer expected.");
+      value = (double)i;
+    }
+  } else if (get_token() == T_ulong) {
+    value = (double)_ulong;
+  } else {
+    syntax_error();
+    return false;
+  }
+  next_token();
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::read_string
+//       Access: Private
+//  Description: Reads a string.  A number is also accepted as a
+//               string, in the form in which it was written.
+////////////////////////////////////////////////////////////////////
+bool EggParser::
+read_string(string &str) {
+  if (!is_string_token()) {
+    syntax_error();
+    return false;
+  }
+  str.assign(_text, _text_length);
+  next_token();
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::read_optional_name
+//       Access: Private
+//  Description: Reads a string if there is one, or sets name to the
+//               empty string if there is not.
+////////////////////////////////////////////////////////////////////
+void EggParser::
+read_optional_name(string &name) {
+  if (is_string_token()) {
+    name.assign(_text, _text_length);
+    next_token();
+  } else {
+    name = string();
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::read_required_name
+//       Access: Private
+//  Description: Reads a string, or reports an error and sets name to
+//               the empty string if there is not one.
+////////////////////////////////////////////////////////////////////
+void EggParser::
+read_required_name(string &name) {
+  if (is_string_token()) {
+    name.assign(_text, _text_length);
+    next_token();
+  } else {
+    error("Name required.");
+    name = string();
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::read_required_string
+//       Access: Private
+//  Description: As read_required_name(), with a different error
+//               message.
+////////////////////////////////////////////////////////////////////
+void EggParser::
+read_required_string(string &str) {
+  if (is_string_token()) {
+    str.assign(_text, _text_length);
+    next_token();
+  } else {
+    error("String required.");
+    str = string();
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::read_repeated_string
+//       Access: Private
+//  Description: Reads any number of strings in a row, joined with
+//               newlines.
+////////////////////////////////////////////////////////////////////
+void EggParser::
+read_repeated_string(string &str) {
+  str = string();
+  bool first = true;
+  while (is_string_token()) {
+    if (!first) {
+      str += '\n';
+    }
+    str.append(_text, _text_length);
+    first = false;
+    next_token();
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::read_real_or_string
+//       Access: Private
+//  Description: Reads the value of a <Scalar>, which may be a number
+//               or a string.
+////////////////////////////////////////////////////////////////////
+bool EggParser::
+read_real_or_string(ScalarValue &value) {
+  switch (get_token()) {
+  case T_number:
+    value._number = _number;
+    value._ulong = (unsigned long)_number;
+    break;
+
+  case T_ulong:
+    value._number = (double)_ulong;
+    value._ulong = _ulong;
+    break;
+
+  case T_string:
+    value._number = 0.0;
+    value._ulong = 0;
+    break;
+
+  default:
+    syntax_error();
+    return false;
+  }
+  value._string.assign(_text, _text_length);
+  next_token();
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::read_scalar
+//       Access: Private
+//  Description: Reads a <Scalar> name { value } entry.  The current
+//               token is the <Scalar> keyword.
+////////////////////////////////////////////////////////////////////
+bool EggParser::
+read_scalar(string &name, ScalarValue &value) {
+  next_token();
+  read_required_name(name);
+  return expect(T_open) && read_real_or_string(value) && expect(T_close);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::read_reals
+//       Access: Private
+//  Description: Reads as many numbers as appear in a row, up to
+//               max_values, and returns the number read.
+////////////////////////////////////////////////////////////////////
+int EggParser::
+read_reals(double *values, int max_values) {
+  int num_values = 0;
+  while (num_values < max_values) {
+    if (get_token() == T_number) {
+      values[num_values] = _number;
+    } else if (get_token() == T_ulong) {
+      values[num_values] = (double)_ulong;
+    } else {
+      break;
+    }
+    ++num_values;
+    next_token();
+  }
+  return num_values;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::read_real_list
+//       Access: Private
+//  Description: Reads any number of numbers in a row.
+////////////////////////////////////////////////////////////////////
+bool EggParser::
+read_real_list(PTA_double &values) {
+  values = PTA_double::empty_array(0);
+  double value;
+  while (read_reals(&value, 1) == 1) {
+    values.push_back(value);
+  }
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::read_morph
+//       Access: Private
+//  Description: Reads a morph offset, such as a <DXYZ>, in either of
+//               the two forms "name { values }" or "{ name values }".
+//               The current token is the keyword.
+////////////////////////////////////////////////////////////////////
+bool EggParser::
+read_morph(string &name, double *values, int min_values, int max_values,
+           int &num_values) {
+  next_token();
+  if (get_token() == T_open) {
+    next_token();
+    if (!read_string(name)) {
+      return false;
+    }
+  } else {
+    if (!read_string(name) || !expect(T_open)) {
+      return false;
+    }
+  }
+
+  num_values = read_reals(values, max_values);
+  if (num_values < min_values) {
+    syntax_error();
+    return false;
+  }
+  return expect(T_close);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::read_vertex_ref
+//       Access: Private
+//  Description: Reads a <VertexRef> entry, filling indices with the
+//               vertex numbers and returning the vertex pool they
+//               refer to.  If membership is not NULL, a <Scalar>
+//               membership entry is also allowed.  The current token
+//               is the <VertexRef> keyword.
+////////////////////////////////////////////////////////////////////
+bool EggParser::
+read_vertex_ref(pvector<int> &indices, double *membership,
+                EggVertexPool *&pool) {
+  next_token();
+  if (!expect(T_open)) {
+    return false;
+  }
+
+  indices.clear();
+  while (is_number_token()) {
+    double value;
+    read_integer(value);
+    indices.push_back((int)value);
+  }
+
+  if (membership != (double *)NULL) {
+    *membership = 1.0;
+    while (get_token() == K_scalar) {
+      string name;
+      ScalarValue value;
+      if (!read_scalar(name, value)) {
+        return false;
+      }
+      if (cmp_nocase_uh(name, "membership") == 0) {
+        *membership = value._number;
+      } else {
+        warning("Unknown group vertex scalar " + name);
+      }
+    }
+  }
+
+  if (!expect(K_ref) || !expect(T_open)) {
+    return false;
+  }
+  if (is_string_token()) {
+    pool = get_vertex_pool(_text, _text_length);
+    next_token();
+  } else {
+    error("Name required.");
+    pool = get_vertex_pool("", 0);
+  }
+  return expect(T_close) && expect(T_close);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::add_node
+//       Access: Private
+//  Description: Adds a node that has just been read to its parent,
+//               or hands it to the listener instead if it is a
+//               primitive and there is a listener.  Returns false if
+//               the listener stops the read.
+////////////////////////////////////////////////////////////////////
+bool EggParser::
+add_node(EggGroupNode *parent, EggNode *node) {
+  if (_listener != (EggParserListener *)NULL &&
+      node->is_of_type(EggPrimitive::get_class_type())) {
+    if (!_listener->primitive_read(parent, DCAST(EggPrimitive, node),
+                                   _prim_pool, _prim_indices)) {
+      stop_read();
+      return false;
+    }
+    return true;
+  }
+
+  parent->add_child(node);
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::parse_node
+//       Access: Private
+//  Description: Reads any of the entries that may appear at the top
+//               level of the file or within a group.
+////////////////////////////////////////////////////////////////////
+bool EggParser::
+parse_node(PT(EggNode) &node) {
+  switch (get_token()) {
+  case K_coordsystem:
+    return parse_coordsystem(node);
+
+  case K_comment:
+    return parse_comment(node);
+
+  case K_texture:
+    return parse_texture(node);
+
+  case K_material:
+    return parse_material(node);
+
+  case K_external_file:
+    return parse_external_reference(node, true);
+
+  case T_string:
+  case T_number:
+  case T_ulong:
+    return parse_external_reference(node, false);
+
+  case K_vertexpool:
+    return parse_vertex_pool(node);
+
+  case K_group:
+  case K_joint:
+  case K_instance:
+    return parse_group(node, get_token());
+
+  case K_polygon:
+  case K_trianglefan:
+  case K_trianglestrip:
+  case K_patch:
+  case K_pointlight:
+  case K_line:
+    return parse_primitive(node, get_token());
+
+  case K_nurbssurface:
+    return parse_nurbs_surface(node);
+
+  case K_nurbscurve:
+    {
+      PT(EggNurbsCurve) curve;
+      if (!parse_nurbs_curve(curve)) {
+        return false;
+      }
+      node = curve.p();
+      return true;
+    }
+
+  case K_table:
+    return parse_table(node, false);
+
+  case K_animpreload:
+    return parse_anim_preload(node);
+
+  default:
+    syntax_error();
+    return false;
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::parse_coordsystem
+//       Access: Private
+//  Description: Reads a <CoordinateSystem> entry.
+////////////////////////////////////////////////////////////////////
+bool EggParser::
+parse_coordsystem(PT(EggNode) &node) {
+  next_token();
+  string strval;
+  if (!expect(T_open)) {
+    return false;
+  }
+  read_required_string(strval);
+  if (!expect(T_close)) {
+    return false;
+  }
+
+  PT(EggCoordinateSystem) cs = new EggCoordinateSystem;
+  CoordinateSystem f = parse_coordinate_system_string(strval);
+  if (f == CS_invalid) {
+    warning("Unknown coordinate system " + strval);
+  } else {
+    cs->set_value(f);
+  }
+  node = cs.p();
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::parse_comment
+//       Access: Private
+//  Description: Reads a <Comment> entry.
+////////////////////////////////////////////////////////////////////
+bool EggParser::
+parse_comment(PT(EggNode) &node) {
+  next_token();
+  string name, comment;
+  read_optional_name(name);
+  if (!expect(T_open)) {
+    return false;
+  }
+  read_repeated_string(comment);
+  if (!expect(T_close)) {
+    return false;
+  }
+  node = new EggComment(name, comment);
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::parse_texture
+//       Access: Private
+//  Description: Reads a <Texture> entry.
+////////////////////////////////////////////////////////////////////
+bool EggParser::
+parse_texture(PT(EggNode) &node) {
+  next_token();
+  string tref_name, filename;
+  read_required_name(tref_name);
+  if (!expect(T_open)) {
+    return false;
+  }
+  read_required_string(filename);
+
+  PT(EggTexture) texture = new EggTexture(tref_name, Filename(filename));
+  if (_textures.find(tref_name.data(), tref_name.length()) != (EggObject *)NULL) {
+    warning("Duplicate texture name " + tref_name);
+  }
+  _textures.insert(tref_name, texture);
+
+  for (;;) {
+    if (get_token() == K_scalar) {
+      string name;
+      ScalarValue value;
+      if (!read_scalar(name, value)) {
+        return false;
+      }
+      set_texture_scalar(texture, name, value);
+
+    } else if (get_token() == K_transform) {
+      if (!parse_transform(texture)) {
+        return false;
+      }
+
+    } else {
+      break;
+    }
+  }
+
+  if (!expect(T_close)) {
+    return false;
+  }
+  node = texture.p();
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::parse_material
+//       Access: Private
+//  Description: Reads a <Material> entry.
+////////////////////////////////////////////////////////////////////
+bool EggParser::
+parse_material(PT(EggNode) &node) {
+  next_token();
+  string mref_name;
+  read_required_name(mref_name);
+  if (!expect(T_open)) {
+    return false;
+  }
+
+  PT(EggMaterial) material = new EggMaterial(mref_name);
+  if (_materials.find(mref_name.data(), mref_name.length()) != (EggObject *)NULL) {
+    warning("Duplicate material name " + mref_name);
+  }
+  _materials.insert(mref_name, material);
+
+  while (get_token() == K_scalar) {
+    string name;
+    ScalarValue value;
+    if (!read_scalar(name, value)) {
+      return false;
+    }
+    set_material_scalar(material, name, value);
+  }
+
+  if (!expect(T_close)) {
+    return false;
+  }
+  node = material.p();
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::parse_external_reference
+//       Access: Private
+//  Description: Reads a <File> entry, which may also be written with
+//               the word "group" in front of the keyword.
+////////////////////////////////////////////////////////////////////
+bool EggParser::
+parse_external_reference(PT(EggNode) &node, bool keyword_first) {
+  string keyword;
+  if (!keyword_first) {
+    keyword.assign(_text, _text_length);
+    next_token();
+  }
+  if (!expect(K_external_file)) {
+    return false;
+  }
+
+  string node_name, filename;
+  read_optional_name(node_name);
+  if (!expect(T_open)) {
+    return false;
+  }
+  read_required_string(filename);
+  if (!expect(T_close)) {
+    return false;
+  }
+
+  if (!keyword_first && cmp_nocase_uh(keyword, "group") != 0) {
+    error("keyword 'group' expected");
+  }
+  node = new EggExternalReference(node_name, Filename(filename));
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::parse_vertex_pool
+//       Access: Private
+//  Description: Reads a <VertexPool> entry.  If the pool has already
+//               been referenced by a primitive, the vertices are
+//               added to the pool that was created at that time.
+////////////////////////////////////////////////////////////////////
+bool EggParser::
+parse_vertex_pool(PT(EggNode) &node) {
+  next_token();
+  string name;
+  read_required_name(name);
+
+  PT(EggVertexPool) pool =
+    (EggVertexPool *)_vertex_pools.find(name.data(), name.length());
+  if (pool != (EggVertexPool *)NULL && pool->has_defined_vertices()) {
+    warning("Duplicate vertex pool name " + name);
+    pool = NULL;
+  }
+  if (pool == (EggVertexPool *)NULL) {
+    pool = new EggVertexPool(name);
+    // The egg syntax starts counting at 1 by convention.
+    pool->set_highest_index(0);
+    _vertex_pools.insert(name, pool);
+  }
+
+  if (!expect(T_open)) {
+    return false;
+  }
+  while (get_token() == K_vertex) {
+    if (!parse_vertex(pool)) {
+      return false;
+    }
+  }
+  if (!expect(T_close)) {
+    return false;
+  }
+  node = pool.p();
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::parse_vertex
+//       Access: Private
+//  Description: Reads a <Vertex> entry and adds it to the pool.
+////////////////////////////////////////////////////////////////////
+bool EggParser::
+parse_vertex(EggVertexPool *pool) {
+  next_token();
+
+  bool has_index = false;
+  int vertex_index = -1;
+  if (is_number_token()) {
+    double value;
+    read_integer(value);
+    vertex_index = (int)value;
+    has_index = true;
+
+    if (vertex_index < 0) {
+      ostringstream errmsg;
+      errmsg << "Ignoring invalid vertex index " << vertex_index
+             << " in vertex pool " << pool->get_name();
+      warning(errmsg.str());
+      vertex_index = -1;
+
+    } else if (has_defined_vertex(pool, vertex_index)) {
+      ostringstream errmsg;
+      errmsg << "Ignoring duplicate vertex index " << vertex_index
+             << " in vertex pool " << pool->get_name();
+      warning(errmsg.str());
+      vertex_index = -1;
+    }
+  }
+
+  if (!expect(T_open)) {
+    return false;
+  }
+
+  // Even if we didn't like the vertex index number, we still need to
+  // go ahead and parse the vertex.  We just won't save it.
+  PT(EggVertex) vertex = new EggVertex;
+
+  double v[4];
+  switch (read_reals(v, 4)) {
+  case 1:
+    vertex->set_pos(v[0]);
+    break;
+
+  case 2:
+    vertex->set_pos(LPoint2d(v[0], v[1]));
+    break;
+
+  case 3:
+    vertex->set_pos(LPoint3d(v[0], v[1], v[2]));
+    break;
+
+  case 4:
+    vertex->set_pos(LPoint4d(v[0], v[1], v[2], v[3]));
+    break;
+
+  default:
+    syntax_error();
+    return false;
+  }
+
+  for (;;) {
+    switch (get_token()) {
+    case K_uv:
+      if (!parse_vertex_uv(vertex)) {
+        return false;
+      }
+      break;
+
+    case K_aux:
+      if (!parse_vertex_aux(vertex)) {
+        return false;
+      }
+      break;
+
+    case K_normal:
+      next_token();
+      if (!expect(T_open) || !parse_normal(vertex) || !expect(T_close)) {
+        return false;
+      }
+      break;
+
+    case K_rgba:
+      next_token();
+      if (!expect(T_open) || !parse_color(vertex) || !expect(T_close)) {
+        return false;
+      }
+      break;
+
+    case K_dxyz:
+      {
+        string name;
+        int num_values;
+        if (!read_morph(name, v, 3, 3, num_values)) {
+          return false;
+        }
+        bool inserted = vertex->_dxyzs.
+          insert(EggMorphVertex(name, LVector3d(v[0], v[1], v[2]))).second;
+        if (!inserted) {
+          warning("Ignoring repeated morph name " + name);
+        }
+      }
+      break;
+
+    case T_close:
+      next_token();
+      if (_listener != (EggParserListener *)NULL) {
+        if (!has_index || vertex_index != -1) {
+          // Number the vertex just as add_vertex() would, but give it
+          // to the listener instead.
+          if (vertex_index == -1) {
+            vertex_index = pool->get_highest_index() + 1;
+          }
+          pool->set_highest_index(max(pool->get_highest_index(), vertex_index));
+          if (!_listener->vertex_read(pool, vertex_index, vertex)) {
+            stop_read();
+            return false;
+          }
+        }
+        return true;
+      }
+      if (!has_index || vertex_index != -1) {
+        EggVertex *added = pool->add_vertex(vertex, vertex_index);
+        if (added != (EggVertex *)NULL) {
+          record_vertex(pool, added->get_index(), added);
+        }
+      }
+      return true;
+
+    default:
+      syntax_error();
+      return false;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::parse_vertex_uv
+//       Access: Private
+//  Description: Reads a <UV> entry within a vertex.
+////////////////////////////////////////////////////////////////////
+bool EggParser::
+parse_vertex_uv(EggVertex *vertex) {
+  next_token();
+  string name;
+  read_optional_name(name);
+  if (!expect(T_open)) {
+    return false;
+  }
+
+  PT(EggVertexUV) uv = new EggVertexUV(name, LTexCoordd::zero());
+  if (vertex->has_uv(name)) {
+    warning("Ignoring repeated UV name " + name);
+  } else {
+    vertex->set_uv_obj(uv);
+  }
+
+  double v[3];
+  switch (read_reals(v, 3)) {
+  case 2:
+    uv->set_uv(LTexCoordd(v[0], v[1]));
+    break;
+
+  case 3:
+    uv->set_uvw(LVecBase3d(v[0], v[1], v[2]));
+    break;
+
+  default:
+    syntax_error();
+    return false;
+  }
+
+  for (;;) {
+    switch (get_token()) {
+    case K_tangent:
+    case K_binormal:
+      {
+        bool tangent = (get_token() == K_tangent);
+        next_token();
+        if (!expect(T_open) || read_reals(v, 3) != 3) {
+          syntax_error();
+          return false;
+        }
+        if (!expect(T_close)) {
+          return false;
+        }
+        if (tangent) {
+          if (uv->has_tangent()) {
+            warning("Ignoring repeated tangent");
+          } else {
+            uv->set_tangent(LNormald(v[0], v[1], v[2]));
+          }
+        } else {
+          if (uv->has_binormal()) {
+            warning("Ignoring repeated binormal");
+          } else {
+            uv->set_binormal(LNormald(v[0], v[1], v[2]));
+          }
+        }
+      }
+      break;
+
+    case K_duv:
+      {
+        string morph_name;
+        int num_values;
+        if (!read_morph(morph_name, v, 2, 3, num_values)) {
+          return false;
+        }
+        if (num_values == 2) {
+          v[2] = 0.0;
+        }
+        bool inserted = uv->_duvs.
+          insert(EggMorphTexCoord(morph_name, LVector3d(v[0], v[1], v[2]))).second;
+        if (!inserted) {
+          warning("Ignoring repeated morph name " + morph_name);
+        }
+      }
+      break;
+
+    default:
+      return expect(T_close);
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::parse_vertex_aux
+//       Access: Private
+//  Description: Reads an <Aux> entry within a vertex.
+////////////////////////////////////////////////////////////////////
+bool EggParser::
+parse_vertex_aux(EggVertex *vertex) {
+  next_token();
+  string name;
+  read_required_name(name);
+  if (!expect(T_open)) {
+    return false;
+  }
+
+  PT(EggVertexAux) aux = new EggVertexAux(name, LVecBase4d::zero());
+  if (vertex->has_aux(name)) {
+    warning("Ignoring repeated Aux name " + name);
+  } else {
+    vertex->set_aux_obj(aux);
+  }
+
+  double v[4];
+  int num_values = read_reals(v, 4);
+  if (num_values == 4) {
+    aux->set_aux(LVecBase4d(v[0], v[1], v[2], v[3]));
+  } else if (num_values != 0) {
+    syntax_error();
+    return false;
+  }
+  return expect(T_close);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::parse_normal
+//       Access: Private
+//  Description: Reads the body of a <Normal> entry, between the
+//               curly braces, for a vertex or a primitive.
+////////////////////////////////////////////////////////////////////
+bool EggParser::
+parse_normal(EggAttributes *attrib) {
+  double v[3];
+  if (read_reals(v, 3) != 3) {
+    syntax_error();
+    return false;
+  }
+  attrib->set_normal(LNormald(v[0], v[1], v[2]));
+
+  while (get_token() == K_dnormal) {
+    string name;
+    int num_values;
+    if (!read_morph(name, v, 3, 3, num_values)) {
+      return false;
+    }
+    bool inserted = attrib->_dnormals.
+      insert(EggMorphNormal(name, LVector3d(v[0], v[1], v[2]))).second;
+    if (!inserted) {
+      warning("Ignoring repeated morph name " + name);
+    }
+  }
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::parse_color
+//       Access: Private
+//  Description: Reads the body of an <RGBA> entry, between the
+//               curly braces, for a vertex or a primitive.
+////////////////////////////////////////////////////////////////////
+bool EggParser::
+parse_color(EggAttributes *attrib) {
+  double v[4];
+  if (read_reals(v, 4) != 4) {
+    syntax_error();
+    return false;
+  }
+  attrib->set_color(LColor(v[0], v[1], v[2], v[3]));
+
+  while (get_token() == K_drgba) {
+    string name;
+    int num_values;
+    if (!read_morph(name, v, 4, 4, num_values)) {
+      return false;
+    }
+    bool inserted = attrib->_drgbas.
+      insert(EggMorphColor(name, LVector4(v[0], v[1], v[2], v[3]))).second;
+    if (!inserted) {
+      warning("Ignoring repeated morph name " + name);
+    }
+  }
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::parse_group
+//       Access: Private
+//  Description: Reads a <Group>, <Joint> or <Instance> entry; the
+//               group_type is the keyword.
+////////////////////////////////////////////////////////////////////
+bool EggParser::
+parse_group(PT(EggNode) &node, int group_type) {
+  next_token();
+  string name;
+  read_optional_name(name);
+
+  PT(EggGroup) group = new EggGroup(name);
+  if (group_type == K_joint) {
+    group->set_group_type(EggGroup::GT_joint);
+  } else if (group_type == K_instance) {
+    group->set_group_type(EggGroup::GT_instance);
+  }
+
+  if (!expect(T_open) || !parse_group_body(group) || !expect(T_close)) {
+    return false;
+  }
+
+  if (group_type != K_joint && group->has_name()) {
+    _groups.insert(group->get_name(), group);
+  }
+  if (group_type == K_group) {
+    Thread::consider_yield();
+  }
+  node = group.p();
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::parse_group_body
+//       Access: Private
+//  Description: Reads the entries within a group, up to (but not
+//               including) the closing curly brace.
+////////////////////////////////////////////////////////////////////
+bool EggParser::
+parse_group_body(EggGroup *group) {
+  for (;;) {
+    switch (get_token()) {
+    case T_close:
+      return true;
+
+    case K_scalar:
+      {
+        string name;
+        ScalarValue value;
+        if (!read_scalar(name, value)) {
+          return false;
+        }
+        set_group_scalar(group, name, value);
+      }
+      break;
+
+    case K_billboard:
+      {
+        next_token();
+        string strval;
+        if (!expect(T_open) || !read_string(strval) || !expect(T_close)) {
+          return false;
+        }
+        EggGroup::BillboardType f = EggGroup::string_billboard_type(strval);
+        if (f == EggGroup::BT_none) {
+          warning("Unknown billboard type " + strval);
+        } else {
+          group->set_billboard_type(f);
+        }
+      }
+      break;
+
+    case K_billboardcenter:
+      {
+        next_token();
+        double v[3];
+        if (!expect(T_open)) {
+          return false;
+        }
+        if (read_reals(v, 3) != 3) {
+          syntax_error();
+          return false;
+        }
+        if (!expect(T_close)) {
+          return false;
+        }
+        group->set_billboard_center(LPoint3d(v[0], v[1], v[2]));
+      }
+      break;
+
+    case K_collide:
+      if (!parse_collide(group)) {
+        return false;
+      }
+      break;
+
+    case K_dcs:
+    case K_dart:
+      {
+        bool dcs = (get_token() == K_dcs);
+        next_token();
+        if (!expect(T_open)) {
+          return false;
+        }
+        if (get_token() == T_string) {
+          // The special flavor, with { sync } or { nosync }.
+          string strval;
+          read_string(strval);
+          if (!expect(T_close)) {
+            return false;
+          }
+          if (dcs) {
+            EggGroup::DCSType f = EggGroup::string_dcs_type(strval);
+            if (f == EggGroup::DC_unspecified) {
+              warning("Unknown DCS type " + strval);
+            } else {
+              group->set_dcs_type(f);
+            }
+          } else {
+            EggGroup::DartType f = EggGroup::string_dart_type(strval);
+            if (f == EggGroup::DT_none) {
+              warning("Unknown dart type " + strval);
+            } else {
+              group->set_dart_type(f);
+            }
+          }
+
+        } else {
+          // The traditional flavor, with { 0 } or { 1 }.
+          double value;
+          if (!read_integer(value)) {
+            return false;
+          }
+          if (dcs) {
+            group->set_dcs_type((int)value != 0 ? EggGroup::DC_default : EggGroup::DC_none);
+          } else {
+            group->set_dart_type((int)value != 0 ? EggGroup::DT_default : EggGroup::DT_none);
+          }
+          if (!expect(T_close)) {
+            return false;
+          }
+        }
+      }
+      break;
+
+    case K_switch:
+    case K_model:
+    case K_texlist:
+      {
+        int token = get_token();
+        next_token();
+        double value;
+        if (!expect(T_open) || !read_integer(value) || !expect(T_close)) {
+          return false;
+        }
+        bool flag = ((int)value != 0);
+        if (token == K_switch) {
+          group->set_switch_flag(flag);
+        } else if (token == K_model) {
+          group->set_model_flag(flag);
+        } else {
+          group->set_texlist_flag(flag);
+        }
+      }
+      break;
+
+    case K_objecttype:
+      {
+        next_token();
+        string type;
+        if (!expect(T_open)) {
+          return false;
+        }
+        read_required_string(type);
+        if (!expect(T_close)) {
+          return false;
+        }
+        group->add_object_type(type);
+      }
+      break;
+
+    case K_tag:
+      {
+        next_token();
+        string key, value;
+        read_optional_name(key);
+        if (!expect(T_open)) {
+          return false;
+        }
+        read_repeated_string(value);
+        if (!expect(T_close)) {
+          return false;
+        }
+        group->set_tag(key, value);
+      }
+      break;
+
+    case K_transform:
+      if (!parse_transform(group)) {
+        return false;
+      }
+      break;
+
+    case K_defaultpose:
+      if (group->get_group_type() != EggGroup::GT_joint) {
+        warning("Unexpected <DefaultPose> outside of <Joint>");
+      }
+      if (!parse_transform(&group->modify_default_pose())) {
+        return false;
+      }
+      break;
+
+    case K_vertexref:
+      {
+        if (_listener != (EggParserListener *)NULL) {
+          // The vertices have gone to the listener; there is nothing
+          // here to reference.
+          stop_read_unsupported();
+          return false;
+        }
+        double membership;
+        EggVertexPool *pool;
+        if (!read_vertex_ref(_indices, &membership, pool)) {
+          return false;
+        }
+        pvector<int>::const_iterator ii;
+        for (ii = _indices.begin(); ii != _indices.end(); ++ii) {
+          EggVertex *vertex = get_vertex(pool, *ii);
+          if (vertex == (EggVertex *)NULL) {
+            ostringstream errmsg;
+            errmsg << "No vertex " << (*ii) << " in pool " << pool->get_name();
+            error(errmsg.str());
+          } else {
+            group->ref_vertex(vertex, membership);
+          }
+        }
+      }
+      break;
+
+    case K_switchcondition:
+      if (!parse_switchcondition(group)) {
+        return false;
+      }
+      break;
+
+    case K_ref:
+      {
+        next_token();
+        if (!expect(T_open)) {
+          return false;
+        }
+        string name;
+        read_required_name(name);
+        EggGroup *ref =
+          (EggGroup *)_groups.find(name.data(), name.length());
+        if (ref == (EggGroup *)NULL) {
+          error("Unknown group " + name);
+        }
+        if (!expect(T_close)) {
+          return false;
+        }
+        if (group->get_group_type() != EggGroup::GT_instance) {
+          error("<Ref> valid only within <Instance>");
+        } else if (ref != (EggGroup *)NULL) {
+          group->add_group_ref(ref);
+        }
+      }
+      break;
+
+    default:
+      {
+        PT(EggNode) child;
+        if (!parse_node(child) || !add_node(group, child)) {
+          return false;
+        }
+      }
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::parse_collide
+//       Access: Private
+//  Description: Reads a <Collide> entry within a group.
+////////////////////////////////////////////////////////////////////
+bool EggParser::
+parse_collide(EggGroup *group) {
+  next_token();
+  string name, strval;
+  read_optional_name(name);
+  if (!expect(T_open) || !read_string(strval)) {
+    return false;
+  }
+
+  EggGroup::CollisionSolidType f = EggGroup::string_cs_type(strval);
+  if (f == EggGroup::CST_none) {
+    warning("Unknown collision solid type " + strval);
+  } else if (f == EggGroup::CST_polyset &&
+             group->get_cs_type() != EggGroup::CST_none) {
+    // By convention, a CST_polyset doesn't replace any existing
+    // contradictory type, so ignore it if this happens.  This allows
+    // the artist to place, for instance, <ObjectType> { sphere } and
+    // <ObjectType> { trigger } together.
+  } else {
+    group->set_cs_type(f);
+  }
+
+  while (is_string_token()) {
+    read_string(strval);
+    EggGroup::CollideFlags f = EggGroup::string_collide_flags(strval);
+    if (f == EggGroup::CF_none) {
+      warning("Unknown collision flag " + strval);
+    } else {
+      group->set_collide_flags(group->get_collide_flags() | f);
+    }
+  }
+
+  if (!expect(T_close)) {
+    return false;
+  }
+  group->set_collision_name(name);
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::parse_switchcondition
+//       Access: Private
+//  Description: Reads a <SwitchCondition> entry within a group.
+////////////////////////////////////////////////////////////////////
+bool EggParser::
+parse_switchcondition(EggGroup *group) {
+  next_token();
+  if (!expect(T_open) || !expect(K_distance) || !expect(T_open)) {
+    return false;
+  }
+
+  double v[3], center[3];
+  int num_values = read_reals(v, 3);
+  if (num_values < 2) {
+    syntax_error();
+    return false;
+  }
+  if (!expect(K_vertex) || !expect(T_open)) {
+    return false;
+  }
+  if (read_reals(center, 3) != 3) {
+    syntax_error();
+    return false;
+  }
+  if (!expect(T_close) || !expect(T_close) || !expect(T_close)) {
+    return false;
+  }
+
+  LPoint3d point(center[0], center[1], center[2]);
+  if (num_values == 3) {
+    group->set_lod(EggSwitchConditionDistance(v[0], v[1], point, v[2]));
+  } else {
+    group->set_lod(EggSwitchConditionDistance(v[0], v[1], point));
+  }
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::parse_transform
+//       Access: Private
+//  Description: Reads a <Transform> or <DefaultPose> entry, which
+//               replaces whatever transform was stored before.  The
+//               current token is the keyword.
+////////////////////////////////////////////////////////////////////
+bool EggParser::
+parse_transform(EggTransform *transform) {
+  next_token();
+  transform->clear_transform();
+  if (!expect(T_open)) {
+    return false;
+  }
+
+  while (get_token() != T_close) {
+    int token = get_token();
+    next_token();
+    if (!expect(T_open)) {
+      return false;
+    }
+
+    double v[16];
+    int num_values = read_reals(v, 16);
+    bool ok = false;
+    switch (token) {
+    case K_translate:
+      if (num_values == 2) {
+        transform->add_translate2d(LVector2d(v[0], v[1]));
+        ok = true;
+      } else if (num_values == 3) {
+        transform->add_translate3d(LVector3d(v[0], v[1], v[2]));
+        ok = true;
+      }
+      break;
+
+    case K_rotate:
+      if (num_values == 1) {
+        transform->add_rotate2d(v[0]);
+        ok = true;
+      } else if (num_values == 4) {
+        transform->add_rotate3d(v[0], LVector3d(v[1], v[2], v[3]));
+        ok = true;
+      }
+      break;
+
+    case K_rotx:
+    case K_roty:
+    case K_rotz:
+      if (num_values == 1) {
+        if (token == K_rotx) {
+          transform->add_rotx(v[0]);
+        } else if (token == K_roty) {
+          transform->add_roty(v[0]);
+        } else {
+          transform->add_rotz(v[0]);
+        }
+        ok = true;
+      }
+      break;
+
+    case K_scale:
+      if (num_values == 1) {
+        transform->add_uniform_scale(v[0]);
+        ok = true;
+      } else if (num_values == 2) {
+        transform->add_scale2d(LVecBase2d(v[0], v[1]));
+        ok = true;
+      } else if (num_values == 3) {
+        transform->add_scale3d(LVecBase3d(v[0], v[1], v[2]));
+        ok = true;
+      }
+      break;
+
+    case K_matrix3:
+      if (num_values == 9) {
+        transform->add_matrix3
+          (LMatrix3d(v[0], v[1], v[2],
+                     v[3], v[4], v[5],
+                     v[6], v[7], v[8]));
+        ok = true;
+      } else {
+        ok = (num_values == 0);
+      }
+      break;
+
+    case K_matrix4:
+      if (num_values == 16) {
+        transform->add_matrix4
+          (LMatrix4d(v[0], v[1], v[2], v[3],
+                     v[4], v[5], v[6], v[7],
+                     v[8], v[9], v[10], v[11],
+                     v[12], v[13], v[14], v[15]));
+        ok = true;
+      } else {
+        ok = (num_values == 0);
+      }
+      break;
+    }
+
+    if (!ok) {
+      syntax_error();
+      return false;
+    }
+    if (!expect(T_close)) {
+      return false;
+    }
+  }
+
+  next_token();
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::parse_primitive
+//       Access: Private
+//  Description: Reads a <Polygon>, <TriangleFan>, <TriangleStrip>,
+//               <Patch>, <PointLight> or <Line> entry; the token is
+//               the keyword.
+////////////////////////////////////////////////////////////////////
+bool EggParser::
+parse_primitive(PT(EggNode) &node, int token) {
+  next_token();
+  string name;
+  read_optional_name(name);
+
+  PT(EggPrimitive) prim;
+  switch (token) {
+  case K_polygon:
+    prim = new EggPolygon(name);
+    break;
+
+  case K_trianglefan:
+    prim = new EggTriangleFan(name);
+    break;
+
+  case K_trianglestrip:
+    prim = new EggTriangleStrip(name);
+    break;
+
+  case K_patch:
+    prim = new EggPatch(name);
+    break;
+
+  case K_pointlight:
+    prim = new EggPoint(name);
+    break;
+
+  default:
+    prim = new EggLine(name);
+    break;
+  }
+  _prim_pool = NULL;
+  _prim_indices.clear();
+
+  if (!expect(T_open)) {
+    return false;
+  }
+
+  while (get_token() != T_close) {
+    bool handled;
+    if (!parse_primitive_item(prim, handled)) {
+      return false;
+    }
+    if (handled) {
+      continue;
+    }
+
+    if (get_token() == K_component) {
+      if (!parse_component(prim)) {
+        return false;
+      }
+
+    } else if (get_token() == K_scalar) {
+      string name;
+      ScalarValue value;
+      if (!read_scalar(name, value)) {
+        return false;
+      }
+      set_primitive_scalar(prim, name, value);
+
+    } else {
+      syntax_error();
+      return false;
+    }
+  }
+
+  next_token();
+  node = prim.p();
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::parse_primitive_item
+//       Access: Private
+//  Description: Reads any of the entries that are common to all
+//               kinds of primitives, including NURBS.  Sets handled
+//               to false, without reading anything, if the current
+//               token does not begin such an entry.  Returns false
+//               on a syntax error.
+////////////////////////////////////////////////////////////////////
+bool EggParser::
+parse_primitive_item(EggPrimitive *prim, bool &handled) {
+  handled = true;
+  switch (get_token()) {
+  case K_tref:
+    next_token();
+    if (!expect(T_open)) {
+      return false;
+    }
+    if (is_string_token()) {
+      EggTexture *texture =
+        (EggTexture *)_textures.find(_text, _text_length);
+      if (texture == (EggTexture *)NULL) {
+        error("Unknown texture " + get_token_string());
+      } else {
+        prim->add_texture(texture);
+      }
+      next_token();
+    } else {
+      error("Name required.");
+      error("Unknown texture ");
+    }
+    return expect(T_close);
+
+  case K_texture:
+    {
+      // Defining a texture on-the-fly.
+      next_token();
+      if (!expect(T_open)) {
+        return false;
+      }
+      string name;
+      read_required_name(name);
+      Filename filename = name;
+      string tref_name = filename.get_basename();
+      PT(EggTexture) texture =
+        (EggTexture *)_textures.find(tref_name.data(), tref_name.length());
+      if (texture == (EggTexture *)NULL) {
+        // The texture was not yet defined.  Define it.
+        texture = new EggTexture(tref_name, filename);
+        _textures.insert(tref_name, texture);
+        if (_top_node != (EggGroupNode *)NULL) {
+          _top_node->add_child(texture);
+        }
+      } else if (filename != texture->get_filename()) {
+        // The texture already existed.  Use it.
+        warning(string("Using previous path: ") +
+                texture->get_filename().get_fullpath());
+      }
+      prim->add_texture(texture);
+      return expect(T_close);
+    }
+
+  case K_mref:
+    {
+      next_token();
+      if (!expect(T_open)) {
+        return false;
+      }
+      string name;
+      read_required_name(name);
+      EggMaterial *material =
+        (EggMaterial *)_materials.find(name.data(), name.length());
+      if (material == (EggMaterial *)NULL) {
+        error("Unknown material " + name);
+      } else {
+        prim->set_material(material);
+      }
+      return expect(T_close);
+    }
+
+  case K_vertexref:
+    {
+      EggVertexPool *pool;
+      if (!read_vertex_ref(_indices, NULL, pool)) {
+        return false;
+      }
+      if (_listener != (EggParserListener *)NULL) {
+        // Save the index numbers for the listener instead of looking
+        // up the vertices.  A listener can't be told about a
+        // primitive that spans several pools.
+        if (_prim_pool != (EggVertexPool *)NULL && _prim_pool != pool) {
+          stop_read_unsupported();
+          return false;
+        }
+        _prim_pool = pool;
+        _prim_indices.insert(_prim_indices.end(), _indices.begin(), _indices.end());
+        return true;
+      }
+      pvector<int>::const_iterator ii;
+      for (ii = _indices.begin(); ii != _indices.end(); ++ii) {
+        EggVertex *vertex = get_vertex(pool, *ii);
+        if (vertex == (EggVertex *)NULL) {
+          ostringstream errmsg;
+          errmsg << "No vertex " << (*ii) << " in pool " << pool->get_name();
+          error(errmsg.str());
+        } else {
+          prim->add_vertex(vertex);
+        }
+      }
+      return true;
+    }
+
+  case K_normal:
+    next_token();
+    return expect(T_open) && parse_normal(prim) && expect(T_close);
+
+  case K_rgba:
+    next_token();
+    return expect(T_open) && parse_color(prim) && expect(T_close);
+
+  case K_bface:
+    {
+      next_token();
+      double value;
+      if (!expect(T_open) || !read_integer(value) || !expect(T_close)) {
+        return false;
+      }
+      prim->set_bface_flag((int)value != 0);
+      return true;
+    }
+
+  default:
+    handled = false;
+    return true;
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::parse_component
+//       Access: Private
+//  Description: Reads a <Component> entry, which sets the normal or
+//               color of one component (triangle or quad) of a
+//               composite primitive.
+////////////////////////////////////////////////////////////////////
+bool EggParser::
+parse_component(EggPrimitive *prim) {
+  next_token();
+  double index;
+  if (!read_integer(index) || !expect(T_open)) {
+    return false;
+  }
+
+  EggCompositePrimitive *comp = NULL;
+  if (!prim->is_of_type(EggCompositePrimitive::get_class_type())) {
+    error("Not a composite primitive; components are not allowed here.");
+  } else {
+    comp = DCAST(EggCompositePrimitive, prim);
+    if (index < 0 || index >= comp->get_num_components()) {
+      error("Invalid component number");
+      comp = NULL;
+    }
+  }
+
+  // We read the component attributes into a temporary EggPolygon.
+  PT(EggPolygon) component = new EggPolygon;
+  while (get_token() != T_close) {
+    if (get_token() == K_normal) {
+      next_token();
+      if (!expect(T_open) || !parse_normal(component) || !expect(T_close)) {
+        return false;
+      }
+    } else if (get_token() == K_rgba) {
+      next_token();
+      if (!expect(T_open) || !parse_color(component) || !expect(T_close)) {
+        return false;
+      }
+    } else {
+      syntax_error();
+      return false;
+    }
+  }
+  next_token();
+
+  if (comp != (EggCompositePrimitive *)NULL) {
+    comp->set_component((int)index, component);
+  }
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::parse_nurbs_surface
+//       Access: Private
+//  Description: Reads a <NurbsSurface> entry.
+////////////////////////////////////////////////////////////////////
+bool EggParser::
+parse_nurbs_surface(PT(EggNode) &node) {
+  if (_listener != (EggParserListener *)NULL) {
+    // A listener can't be given a NURBS, since its vertices are
+    // needed in the pool.
+    stop_read_unsupported();
+    return false;
+  }
+  next_token();
+  string name;
+  read_optional_name(name);
+  PT(EggNurbsSurface) nurbs = new EggNurbsSurface(name);
+
+  if (!expect(T_open)) {
+    return false;
+  }
+
+  while (get_token() != T_close) {
+    bool handled;
+    if (!parse_primitive_item(nurbs, handled)) {
+      return false;
+    }
+    if (handled) {
+      continue;
+    }
+
+    switch (get_token()) {
+    case K_order:
+      {
+        next_token();
+        double u_order, v_order;
+        if (!expect(T_open) || !read_integer(u_order) ||
+            !read_integer(v_order) || !expect(T_close)) {
+          return false;
+        }
+        nurbs->set_u_order((int)u_order);
+        nurbs->set_v_order((int)v_order);
+      }
+      break;
+
+    case K_uknots:
+    case K_vknots:
+      {
+        bool u = (get_token() == K_uknots);
+        next_token();
+        PTA_double nums;
+        if (!expect(T_open) || !read_real_list(nums) || !expect(T_close)) {
+          return false;
+        }
+        if (u) {
+          nurbs->set_num_u_knots(nums.size());
+          for (int i = 0; i < (int)nums.size(); i++) {
+            nurbs->set_u_knot(i, nums[i]);
+          }
+        } else {
+          nurbs->set_num_v_knots(nums.size());
+          for (int i = 0; i < (int)nums.size(); i++) {
+            nurbs->set_v_knot(i, nums[i]);
+          }
+        }
+      }
+      break;
+
+    case K_nurbscurve:
+      {
+        PT(EggNurbsCurve) curve;
+        if (!parse_nurbs_curve(curve)) {
+          return false;
+        }
+        nurbs->_curves_on_surface.push_back(curve);
+      }
+      break;
+
+    case K_trim:
+      if (!parse_trim(nurbs)) {
+        return false;
+      }
+      break;
+
+    case K_scalar:
+      {
+        string name;
+        ScalarValue value;
+        if (!read_scalar(name, value)) {
+          return false;
+        }
+        set_nurbs_surface_scalar(nurbs, name, value);
+      }
+      break;
+
+    default:
+      syntax_error();
+      return false;
+    }
+  }
+
+  next_token();
+  node = nurbs.p();
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::parse_nurbs_curve
+//       Access: Private
+//  Description: Reads a <NurbsCurve> entry, either as a node by
+//               itself or within a <NurbsSurface>.
+////////////////////////////////////////////////////////////////////
+bool EggParser::
+parse_nurbs_curve(PT(EggNurbsCurve) &curve) {
+  if (_listener != (EggParserListener *)NULL) {
+    stop_read_unsupported();
+    return false;
+  }
+  next_token();
+  string name;
+  read_optional_name(name);
+  PT(EggNurbsCurve) nurbs = new EggNurbsCurve(name);
+
+  if (!expect(T_open)) {
+    return false;
+  }
+
+  while (get_token() != T_close) {
+    bool handled;
+    if (!parse_primitive_item(nurbs, handled)) {
+      return false;
+    }
+    if (handled) {
+      continue;
+    }
+
+    switch (get_token()) {
+    case K_order:
+      {
+        next_token();
+        double order;
+        if (!expect(T_open) || !read_integer(order) || !expect(T_close)) {
+          return false;
+        }
+        nurbs->set_order((int)order);
+      }
+      break;
+
+    case K_knots:
+      {
+        next_token();
+        PTA_double nums;
+        if (!expect(T_open) || !read_real_list(nums) || !expect(T_close)) {
+          return false;
+        }
+        nurbs->set_num_knots(nums.size());
+        for (int i = 0; i < (int)nums.size(); i++) {
+          nurbs->set_knot(i, nums[i]);
+        }
+      }
+      break;
+
+    case K_scalar:
+      {
+        string name;
+        ScalarValue value;
+        if (!read_scalar(name, value)) {
+          return false;
+        }
+        set_nurbs_curve_scalar(nurbs, name, value);
+      }
+      break;
+
+    default:
+      syntax_error();
+      return false;
+    }
+  }
+
+  next_token();
+  curve = nurbs;
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::parse_trim
+//       Access: Private
+//  Description: Reads a <Trim> entry within a <NurbsSurface>, which
+//               contains any number of <Loop>s of curves.
+////////////////////////////////////////////////////////////////////
+bool EggParser::
+parse_trim(EggNurbsSurface *nurbs) {
+  next_token();
+  if (!expect(T_open)) {
+    return false;
+  }
+  nurbs->_trims.push_back(EggNurbsSurface::Trim());
+
+  while (get_token() == K_loop) {
+    next_token();
+    if (!expect(T_open)) {
+      return false;
+    }
+    nurbs->_trims.back().push_back(EggNurbsSurface::Loop());
+
+    while (get_token() == K_nurbscurve) {
+      PT(EggNurbsCurve) curve;
+      if (!parse_nurbs_curve(curve)) {
+        return false;
+      }
+      nurbs->_trims.back().back().push_back(curve);
+    }
+    if (!expect(T_close)) {
+      return false;
+    }
+  }
+
+  return expect(T_close);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::parse_table
+//       Access: Private
+//  Description: Reads a <Table> or <Bundle> entry.
+////////////////////////////////////////////////////////////////////
+bool EggParser::
+parse_table(PT(EggNode) &node, bool is_bundle) {
+  next_token();
+  string name;
+  read_optional_name(name);
+  PT(EggTable) table = new EggTable(name);
+  table->set_table_type(is_bundle ? EggTable::TT_bundle : EggTable::TT_table);
+
+  if (!expect(T_open)) {
+    return false;
+  }
+
+  while (get_token() != T_close) {
+    PT(EggNode) child;
+    bool ok;
+    switch (get_token()) {
+    case K_table:
+      ok = parse_table(child, false);
+      break;
+
+    case K_bundle:
+      ok = parse_table(child, true);
+      break;
+
+    case K_sanim:
+      ok = parse_sanim(child);
+      break;
+
+    case K_xfmanim:
+      ok = parse_xfmanim(child);
+      break;
+
+    case K_xfmsanim:
+      ok = parse_xfm_s_anim(child);
+      break;
+
+    default:
+      syntax_error();
+      ok = false;
+    }
+    if (!ok) {
+      return false;
+    }
+    table->add_child(child);
+  }
+
+  next_token();
+  if (!is_bundle) {
+    Thread::consider_yield();
+  }
+  node = table.p();
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::parse_sanim
+//       Access: Private
+//  Description: Reads an <S$Anim> entry.
+////////////////////////////////////////////////////////////////////
+bool EggParser::
+parse_sanim(PT(EggNode) &node) {
+  next_token();
+  string name;
+  read_optional_name(name);
+  PT(EggSAnimData) anim_data = new EggSAnimData(name);
+
+  if (!expect(T_open)) {
+    return false;
+  }
+
+  while (get_token() != T_close) {
+    if (get_token() == K_scalar) {
+      string name;
+      ScalarValue value;
+      if (!read_scalar(name, value)) {
+        return false;
+      }
+      if (cmp_nocase_uh(name, "fps") == 0) {
+        anim_data->set_fps(value._number);
+      } else {
+        warning("Unsupported S$Anim scalar: " + name);
+      }
+
+    } else if (get_token() == K_table_v) {
+      next_token();
+      PTA_double data;
+      if (!expect(T_open) || !read_real_list(data) || !expect(T_close)) {
+        return false;
+      }
+      anim_data->set_data(data);
+
+    } else {
+      syntax_error();
+      return false;
+    }
+  }
+
+  next_token();
+  node = anim_data.p();
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::parse_xfmanim
+//       Access: Private
+//  Description: Reads an <Xfm$Anim> entry.
+////////////////////////////////////////////////////////////////////
+bool EggParser::
+parse_xfmanim(PT(EggNode) &node) {
+  next_token();
+  string name;
+  read_optional_name(name);
+  PT(EggXfmAnimData) anim_data = new EggXfmAnimData(name);
+
+  if (!expect(T_open)) {
+    return false;
+  }
+
+  while (get_token() != T_close) {
+    if (get_token() == K_scalar) {
+      string name;
+      ScalarValue value;
+      if (!read_scalar(name, value)) {
+        return false;
+      }
+      if (cmp_nocase_uh(name, "fps") == 0) {
+        anim_data->set_fps(value._number);
+      } else if (cmp_nocase_uh(name, "order") == 0) {
+        anim_data->set_order(value._string);
+      } else if (cmp_nocase_uh(name, "contents") == 0) {
+        anim_data->set_contents(value._string);
+      } else {
+        warning("Unsupported Xfm$Anim scalar: " + name);
+      }
+
+    } else if (get_token() == K_table_v) {
+      next_token();
+      PTA_double data;
+      if (!expect(T_open) || !read_real_list(data) || !expect(T_close)) {
+        return false;
+      }
+      anim_data->set_data(data);
+
+    } else {
+      syntax_error();
+      return false;
+    }
+  }
+
+  next_token();
+  node = anim_data.p();
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::parse_xfm_s_anim
+//       Access: Private
+//  Description: Reads an <Xfm$Anim_S$> entry.
+////////////////////////////////////////////////////////////////////
+bool EggParser::
+parse_xfm_s_anim(PT(EggNode) &node) {
+  next_token();
+  string name;
+  read_optional_name(name);
+  PT(EggXfmSAnim) anim_group = new EggXfmSAnim(name);
+
+  if (!expect(T_open)) {
+    return false;
+  }
+
+  while (get_token() != T_close) {
+    if (get_token() == K_scalar) {
+      string name;
+      ScalarValue value;
+      if (!read_scalar(name, value)) {
+        return false;
+      }
+      if (cmp_nocase_uh(name, "fps") == 0) {
+        anim_group->set_fps(value._number);
+      } else if (cmp_nocase_uh(name, "order") == 0) {
+        anim_group->set_order(value._string);
+      } else {
+        warning("Unsupported Xfm$Anim_S$ scalar: " + name);
+      }
+
+    } else if (get_token() == K_sanim) {
+      PT(EggNode) child;
+      if (!parse_sanim(child)) {
+        return false;
+      }
+      anim_group->add_child(child);
+
+    } else {
+      syntax_error();
+      return false;
+    }
+  }
+
+  next_token();
+  node = anim_group.p();
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::parse_anim_preload
+//       Access: Private
+//  Description: Reads an <AnimPreload> entry.
+////////////////////////////////////////////////////////////////////
+bool EggParser::
+parse_anim_preload(PT(EggNode) &node) {
+  next_token();
+  string name;
+  read_optional_name(name);
+  PT(EggAnimPreload) anim_preload = new EggAnimPreload(name);
+
+  if (!expect(T_open)) {
+    return false;
+  }
+
+  while (get_token() != T_close) {
+    if (get_token() != K_scalar) {
+      syntax_error();
+      return false;
+    }
+    string name;
+    ScalarValue value;
+    if (!read_scalar(name, value)) {
+      return false;
+    }
+    if (cmp_nocase_uh(name, "fps") == 0) {
+      anim_preload->set_fps(value._number);
+    } else if (cmp_nocase_uh(name, "frames") == 0) {
+      anim_preload->set_num_frames((int)value._number);
+    } else {
+      warning("Unsupported AnimPreload scalar: " + name);
+    }
+  }
+
+  next_token();
+  node = anim_preload.p();
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::set_render_mode_scalar
+//       Access: Private
+//  Description: Handles the <Scalar> entries that are shared by all
+//               objects that have an EggRenderMode.  Returns true if
+//               the name was one of these, false otherwise.  The
+//               depth_offset and draw_order entries are left to the
+//               caller, since groups read these differently.
+////////////////////////////////////////////////////////////////////
+bool EggParser::
+set_render_mode_scalar(EggRenderMode *mode, const string &name,
+                       const ScalarValue &value) {
+  const string &strval = value._string;
+
+  if (cmp_nocase_uh(name, "alpha") == 0) {
+    EggRenderMode::AlphaMode a = EggRenderMode::string_alpha_mode(strval);
+    if (a == EggRenderMode::AM_unspecified) {
+      warning("Unknown alpha mode " + strval);
+    } else {
+      mode->set_alpha_mode(a);
+    }
+
+  } else if (cmp_nocase_uh(name, "depth_write") == 0) {
+    EggRenderMode::DepthWriteMode m =
+      EggRenderMode::string_depth_write_mode(strval);
+    if (m == EggRenderMode::DWM_unspecified) {
+      warning("Unknown depth-write mode " + strval);
+    } else {
+      mode->set_depth_write_mode(m);
+    }
+
+  } else if (cmp_nocase_uh(name, "depth_test") == 0) {
+    EggRenderMode::DepthTestMode m =
+      EggRenderMode::string_depth_test_mode(strval);
+    if (m == EggRenderMode::DTM_unspecified) {
+      warning("Unknown depth-test mode " + strval);
+    } else {
+      mode->set_depth_test_mode(m);
+    }
+
+  } else if (cmp_nocase_uh(name, "visibility") == 0) {
+    EggRenderMode::VisibilityMode m =
+      EggRenderMode::string_visibility_mode(strval);
+    if (m == EggRenderMode::VM_unspecified) {
+      warning("Unknown visibility mode " + strval);
+    } else {
+      mode->set_visibility_mode(m);
+    }
+
+  } else if (cmp_nocase_uh(name, "bin") == 0) {
+    mode->set_bin(strval);
+
+  } else {
+    return false;
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::set_texture_scalar
+//       Access: Private
+//  Description: Handles a <Scalar> entry within a <Texture>.
+////////////////////////////////////////////////////////////////////
+void EggParser::
+set_texture_scalar(EggTexture *texture, const string &name,
+                   const ScalarValue &value) {
+  const string &strval = value._string;
+  double number = value._number;
+
+  if (set_render_mode_scalar(texture, name, value)) {
+    return;
+  }
+
+  if (cmp_nocase_uh(name, "type") == 0) {
+    EggTexture::TextureType tt = EggTexture::string_texture_type(strval);
+    if (tt == EggTexture::TT_unspecified) {
+      warning("Unknown texture texture_type " + strval);
+    } else {
+      texture->set_texture_type(tt);
+    }
+
+  } else if (cmp_nocase_uh(name, "format") == 0) {
+    EggTexture::Format f = EggTexture::string_format(strval);
+    if (f == EggTexture::F_unspecified) {
+      warning("Unknown texture format " + strval);
+    } else {
+      texture->set_format(f);
+    }
+
+  } else if (cmp_nocase_uh(name, "compression") == 0) {
+    EggTexture::CompressionMode w = EggTexture::string_compression_mode(strval);
+    if (w == EggTexture::CM_default) {
+      warning("Unknown texture compression mode " + strval);
+    } else {
+      texture->set_compression_mode(w);
+    }
+
+  } else if (cmp_nocase_uh(name, "wrap") == 0 ||
+             cmp_nocase_uh(name, "wrapu") == 0 ||
+             cmp_nocase_uh(name, "wrapv") == 0) {
+    EggTexture::WrapMode w = EggTexture::string_wrap_mode(strval);
+    if (w == EggTexture::WM_unspecified) {
+      warning("Unknown texture wrap mode " + strval);
+    } else if (cmp_nocase_uh(name, "wrap") == 0) {
+      texture->set_wrap_mode(w);
+    } else if (cmp_nocase_uh(name, "wrapu") == 0) {
+      texture->set_wrap_u(w);
+    } else {
+      texture->set_wrap_v(w);
+    }
+
+  } else if (cmp_nocase_uh(name, "minfilter") == 0 ||
+             cmp_nocase_uh(name, "magfilter") == 0) {
+    EggTexture::FilterType f = EggTexture::string_filter_type(strval);
+    if (f == EggTexture::FT_unspecified) {
+      warning("Unknown texture filter type " + strval);
+    } else if (cmp_nocase_uh(name, "minfilter") == 0) {
+      texture->set_minfilter(f);
+    } else {
+      texture->set_magfilter(f);
+    }
+
+  } else if (cmp_nocase_uh(name, "anisotropic_degree") == 0) {
+    texture->set_anisotropic_degree((int)number);
+
+  } else if (cmp_nocase_uh(name, "envtype") == 0) {
+    EggTexture::EnvType e = EggTexture::string_env_type(strval);
+    if (e == EggTexture::ET_unspecified) {
+      warning("Unknown texture env type " + strval);
+    } else {
+      texture->set_env_type(e);
+    }
+
+  } else if (cmp_nocase_uh(name, "combine-rgb") == 0 ||
+             cmp_nocase_uh(name, "combine-alpha") == 0) {
+    EggTexture::CombineChannel channel =
+      (cmp_nocase_uh(name, "combine-rgb") == 0) ? EggTexture::CC_rgb : EggTexture::CC_alpha;
+    EggTexture::CombineMode cm = EggTexture::string_combine_mode(strval);
+    if (cm == EggTexture::CM_unspecified) {
+      warning("Unknown combine mode " + strval);
+    } else {
+      texture->set_combine_mode(channel, cm);
+    }
+
+  } else if (cmp_nocase_uh(name.substr(0, 12), "combine-rgb-") == 0 ||
+             cmp_nocase_uh(name.substr(0, 14), "combine-alpha-") == 0) {
+    // combine-rgb-source0, combine-alpha-operand2, and so on.
+    EggTexture::CombineChannel channel;
+    string suffix;
+    if (cmp_nocase_uh(name.substr(0, 12), "combine-rgb-") == 0) {
+      channel = EggTexture::CC_rgb;
+      suffix = name.substr(12);
+    } else {
+      channel = EggTexture::CC_alpha;
+      suffix = name.substr(14);
+    }
+
+    int n = -1;
+    bool source = false;
+    if (suffix.length() == 7 && cmp_nocase_uh(suffix.substr(0, 6), "source") == 0) {
+      n = suffix[6] - '0';
+      source = true;
+    } else if (suffix.length() == 8 && cmp_nocase_uh(suffix.substr(0, 7), "operand") == 0) {
+      n = suffix[7] - '0';
+    }
+
+    if (n < 0 || n > 2) {
+      warning("Unsupported texture scalar: " + name);
+
+    } else if (source) {
+      EggTexture::CombineSource cs = EggTexture::string_combine_source(strval);
+      if (cs == EggTexture::CS_unspecified) {
+        warning("Unknown combine source " + strval);
+      } else {
+        texture->set_combine_source(channel, n, cs);
+      }
+
+    } else {
+      EggTexture::CombineOperand co = EggTexture::string_combine_operand(strval);
+      if (co == EggTexture::CO_unspecified) {
+        warning("Unknown combine operand " + strval);
+      } else {
+        texture->set_combine_operand(channel, n, co);
+      }
+    }
+
+  } else if (cmp_nocase_uh(name, "saved_result") == 0) {
+    texture->set_saved_result(((int)number) != 0);
+
+  } else if (cmp_nocase_uh(name, "tex_gen") == 0) {
+    EggTexture::TexGen tex_gen = EggTexture::string_tex_gen(strval);
+    if (tex_gen == EggTexture::TG_unspecified) {
+      warning("Unknown tex-gen " + strval);
+    } else {
+      texture->set_tex_gen(tex_gen);
+    }
+
+  } else if (cmp_nocase_uh(name, "quality_level") == 0) {
+    EggTexture::QualityLevel quality_level = EggTexture::string_quality_level(strval);
+    if (quality_level == EggTexture::QL_unspecified) {
+      warning("Unknown quality-level " + strval);
+    } else {
+      texture->set_quality_level(quality_level);
+    }
+
+  } else if (cmp_nocase_uh(name, "stage_name") == 0) {
+    texture->set_stage_name(strval);
+
+  } else if (cmp_nocase_uh(name, "priority") == 0) {
+    texture->set_priority((int)number);
+
+  } else if (cmp_nocase_uh(name, "multiview") == 0) {
+    texture->set_multiview(((int)number) != 0);
+
+  } else if (cmp_nocase_uh(name, "num_views") == 0) {
+    int int_value = (int)number;
+    if (int_value < 1) {
+      error("Invalid num-views value " + strval);
+    } else {
+      texture->set_num_views(int_value);
+    }
+
+  } else if (cmp_nocase_uh(name, "blendr") == 0 ||
+             cmp_nocase_uh(name, "blendg") == 0 ||
+             cmp_nocase_uh(name, "blendb") == 0 ||
+             cmp_nocase_uh(name, "blenda") == 0) {
+    LColor color = texture->get_color();
+    color[string("rgba").find(tolower(name[5]))] = number;
+    texture->set_color(color);
+
+  } else if (cmp_nocase_uh(name, "borderr") == 0 ||
+             cmp_nocase_uh(name, "borderg") == 0 ||
+             cmp_nocase_uh(name, "borderb") == 0 ||
+             cmp_nocase_uh(name, "bordera") == 0) {
+    LColor border_color = texture->get_border_color();
+    border_color[string("rgba").find(tolower(name[6]))] = number;
+    texture->set_border_color(border_color);
+
+  } else if (cmp_nocase_uh(name, "uv_name") == 0) {
+    texture->set_uv_name(strval);
+
+  } else if (cmp_nocase_uh(name, "rgb_scale") == 0) {
+    int int_value = (int)number;
+    if (int_value != 1 && int_value != 2 && int_value != 4) {
+      error("Invalid rgb-scale value " + strval);
+    } else {
+      texture->set_rgb_scale(int_value);
+    }
+
+  } else if (cmp_nocase_uh(name, "alpha_scale") == 0) {
+    int int_value = (int)number;
+    if (int_value != 1 && int_value != 2 && int_value != 4) {
+      error("Invalid alpha-scale value " + strval);
+    } else {
+      texture->set_alpha_scale(int_value);
+    }
+
+  } else if (cmp_nocase_uh(name, "depth_offset") == 0) {
+    texture->set_depth_offset((int)number);
+
+  } else if (cmp_nocase_uh(name, "draw_order") == 0) {
+    texture->set_draw_order((int)number);
+
+  } else if (cmp_nocase_uh(name, "alpha_file") == 0) {
+    texture->set_alpha_filename(strval);
+
+  } else if (cmp_nocase_uh(name, "alpha_file_channel") == 0) {
+    texture->set_alpha_file_channel((int)number);
+
+  } else if (cmp_nocase_uh(name, "read_mipmaps") == 0) {
+    texture->set_read_mipmaps(((int)number) != 0);
+
+  } else {
+    warning("Unsupported texture scalar: " + name);
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::set_material_scalar
+//       Access: Private
+//  Description: Handles a <Scalar> entry within a <Material>.
+////////////////////////////////////////////////////////////////////
+void EggParser::
+set_material_scalar(EggMaterial *material, const string &name,
+                    const ScalarValue &value) {
+  double number = value._number;
+
+  // The color components are named diffr, ambg, emitb, speca, and so
+  // on.
+  if (name.length() >= 4) {
+    string prefix = name.substr(0, name.length() - 1);
+    int component = (int)string("rgba").find(tolower(name[name.length() - 1]));
+    if (component >= 0) {
+      if (cmp_nocase_uh(prefix, "diff") == 0) {
+        LColor diff = material->get_diff();
+        diff[component] = number;
+        material->set_diff(diff);
+        return;
+      } else if (cmp_nocase_uh(prefix, "amb") == 0) {
+        LColor amb = material->get_amb();
+        amb[component] = number;
+        material->set_amb(amb);
+        return;
+      } else if (cmp_nocase_uh(prefix, "emit") == 0) {
+        LColor emit = material->get_emit();
+        emit[component] = number;
+        material->set_emit(emit);
+        return;
+      } else if (cmp_nocase_uh(prefix, "spec") == 0) {
+        LColor spec = material->get_spec();
+        spec[component] = number;
+        material->set_spec(spec);
+        return;
+      }
+    }
+  }
+
+  if (cmp_nocase_uh(name, "shininess") == 0) {
+    material->set_shininess(number);
+
+  } else if (cmp_nocase_uh(name, "local") == 0) {
+    material->set_local(number != 0.0);
+
+  } else {
+    warning("Unsupported material scalar: " + name);
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::set_group_scalar
+//       Access: Private
+//  Description: Handles a <Scalar> entry within a group.
+////////////////////////////////////////////////////////////////////
+void EggParser::
+set_group_scalar(EggGroup *group, const string &name,
+                 const ScalarValue &value) {
+  const string &strval = value._string;
+  double number = value._number;
+  unsigned long ulong_value = value._ulong;
+
+  if (set_render_mode_scalar(group, name, value)) {
+    return;
+  }
+
+  if (cmp_nocase_uh(name, "fps") == 0) {
+    group->set_switch_fps(number);
+  } else if (cmp_nocase_uh(name, "no_fog") == 0) {
+    group->set_nofog_flag(number != 0);
+  } else if (cmp_nocase_uh(name, "decal") == 0) {
+    group->set_decal_flag(number != 0);
+  } else if (cmp_nocase_uh(name, "direct") == 0) {
+    group->set_direct_flag(number != 0);
+  } else if (cmp_nocase_uh(name, "depth_offset") == 0) {
+    group->set_depth_offset(ulong_value);
+  } else if (cmp_nocase_uh(name, "draw_order") == 0) {
+    group->set_draw_order(ulong_value);
+  } else if (cmp_nocase_uh(name, "collide_mask") == 0) {
+    group->set_collide_mask(group->get_collide_mask() | ulong_value);
+  } else if (cmp_nocase_uh(name, "from_collide_mask") == 0) {
+    group->set_from_collide_mask(group->get_from_collide_mask() | ulong_value);
+  } else if (cmp_nocase_uh(name, "into_collide_mask") == 0) {
+    group->set_into_collide_mask(group->get_into_collide_mask() | ulong_value);
+  } else if (cmp_nocase_uh(name, "portal") == 0) {
+    group->set_portal_flag(number != 0);
+  } else if (cmp_nocase_uh(name, "occluder") == 0) {
+    group->set_occluder_flag(number != 0);
+  } else if (cmp_nocase_uh(name, "polylight") == 0) {
+    group->set_polylight_flag(number != 0);
+  } else if (cmp_nocase_uh(name, "indexed") == 0) {
+    group->set_indexed_flag(number != 0);
+  } else if (cmp_nocase_uh(name, "scroll_u") == 0) {
+    group->set_scroll_u(number);
+  } else if (cmp_nocase_uh(name, "scroll_v") == 0) {
+    group->set_scroll_v(number);
+  } else if (cmp_nocase_uh(name, "scroll_w") == 0) {
+    group->set_scroll_w(number);
+  } else if (cmp_nocase_uh(name, "scroll_r") == 0) {
+    group->set_scroll_r(number);
+
+  } else if (cmp_nocase_uh(name, "blend") == 0) {
+    EggGroup::BlendMode blend_mode = EggGroup::string_blend_mode(strval);
+    if (blend_mode == EggGroup::BM_unspecified) {
+      warning("Unknown blend mode " + strval);
+    } else {
+      group->set_blend_mode(blend_mode);
+    }
+
+  } else if (cmp_nocase_uh(name, "blendop_a") == 0 ||
+             cmp_nocase_uh(name, "blendop_b") == 0) {
+    EggGroup::BlendOperand blend_operand =
+      EggGroup::string_blend_operand(strval);
+    if (blend_operand == EggGroup::BO_unspecified) {
+      warning("Unknown blend operand " + strval);
+    } else if (cmp_nocase_uh(name, "blendop_a") == 0) {
+      group->set_blend_operand_a(blend_operand);
+    } else {
+      group->set_blend_operand_b(blend_operand);
+    }
+
+  } else if (cmp_nocase_uh(name, "blendr") == 0 ||
+             cmp_nocase_uh(name, "blendg") == 0 ||
+             cmp_nocase_uh(name, "blendb") == 0 ||
+             cmp_nocase_uh(name, "blenda") == 0) {
+    LColor color = group->get_blend_color();
+    color[string("rgba").find(tolower(name[5]))] = number;
+    group->set_blend_color(color);
+
+  } else {
+    warning("Unknown group scalar " + name);
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::set_primitive_scalar
+//       Access: Private
+//  Description: Handles a <Scalar> entry within a polygon or other
+//               simple primitive.
+////////////////////////////////////////////////////////////////////
+void EggParser::
+set_primitive_scalar(EggPrimitive *prim, const string &name,
+                     const ScalarValue &value) {
+  double number = value._number;
+
+  if (set_render_mode_scalar(prim, name, value)) {
+    return;
+  }
+
+  if (cmp_nocase_uh(name, "depth_offset") == 0) {
+    prim->set_depth_offset((int)number);
+
+  } else if (cmp_nocase_uh(name, "draw_order") == 0) {
+    prim->set_draw_order((int)number);
+
+  } else if (cmp_nocase_uh(name, "thick") == 0) {
+    if (prim->is_of_type(EggLine::get_class_type())) {
+      DCAST(EggLine, prim)->set_thick(number);
+    } else if (prim->is_of_type(EggPoint::get_class_type())) {
+      DCAST(EggPoint, prim)->set_thick(number);
+    } else {
+      warning("scalar thick is only meaningful for points and lines.");
+    }
+
+  } else if (cmp_nocase_uh(name, "perspective") == 0) {
+    if (prim->is_of_type(EggPoint::get_class_type())) {
+      DCAST(EggPoint, prim)->set_perspective(number != 0);
+    } else {
+      warning("scalar perspective is only meaningful for points.");
+    }
+
+  } else {
+    warning("Unknown scalar " + name);
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::set_nurbs_surface_scalar
+//       Access: Private
+//  Description: Handles a <Scalar> entry within a <NurbsSurface>.
+////////////////////////////////////////////////////////////////////
+void EggParser::
+set_nurbs_surface_scalar(EggNurbsSurface *nurbs, const string &name,
+                         const ScalarValue &value) {
+  double number = value._number;
+
+  if (set_render_mode_scalar(nurbs, name, value)) {
+    return;
+  }
+
+  if (cmp_nocase_uh(name, "depth_offset") == 0) {
+    nurbs->set_depth_offset((int)number);
+  } else if (cmp_nocase_uh(name, "draw_order") == 0) {
+    nurbs->set_draw_order((int)number);
+  } else if (cmp_nocase_uh(name, "u_subdiv") == 0) {
+    nurbs->set_u_subdiv((int)number);
+  } else if (cmp_nocase_uh(name, "v_subdiv") == 0) {
+    nurbs->set_v_subdiv((int)number);
+  } else {
+    warning("Unknown scalar " + name);
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::set_nurbs_curve_scalar
+//       Access: Private
+//  Description: Handles a <Scalar> entry within a <NurbsCurve>.
+////////////////////////////////////////////////////////////////////
+void EggParser::
+set_nurbs_curve_scalar(EggNurbsCurve *curve, const string &name,
+                       const ScalarValue &value) {
+  double number = value._number;
+
+  if (set_render_mode_scalar(curve, name, value)) {
+    return;
+  }
+
+  if (cmp_nocase_uh(name, "depth_offset") == 0) {
+    curve->set_depth_offset((int)number);
+  } else if (cmp_nocase_uh(name, "draw_order") == 0) {
+    curve->set_draw_order((int)number);
+  } else if (cmp_nocase_uh(name, "subdiv") == 0) {
+    curve->set_subdiv((int)number);
+  } else if (cmp_nocase_uh(name, "type") == 0) {
+    EggCurve::CurveType a = EggCurve::string_curve_type(value._string);
+    if (a == EggCurve::CT_none) {
+      warning("Unknown curve type " + value._string);
+    } else {
+      curve->set_curve_type(a);
+    }
+  } else {
+    warning("Unknown scalar " + name);
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::get_vertex_pool
+//       Access: Private
+//  Description: Returns the vertex pool with the indicated name.  If
+//               there is no such pool yet, creates one as a forward
+//               reference, to be filled in when its <VertexPool>
+//               entry is read.
+////////////////////////////////////////////////////////////////////
+EggVertexPool *EggParser::
+get_vertex_pool(const char *name, size_t length) {
+  EggVertexPool *pool = (EggVertexPool *)_vertex_pools.find(name, length);
+  if (pool == (EggVertexPool *)NULL) {
+    string pool_name(name, length);
+    pool = new EggVertexPool(pool_name);
+    // The egg syntax starts counting at 1 by convention.
+    pool->set_highest_index(0);
+    _vertex_pools.insert(pool_name, pool);
+  }
+  return pool;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::has_defined_vertex
+//       Access: Private
+//  Description: Returns true if the pool already has a vertex (other
+//               than a forward reference) with the indicated index
+//               number.
+////////////////////////////////////////////////////////////////////
+bool EggParser::
+has_defined_vertex(EggVertexPool *pool, int index) {
+  PoolVertices &pv = get_pool_vertices(pool);
+  if (index >= 0 && index < (int)pv._vertices.size()) {
+    EggVertex *vertex = pv._vertices[index];
+    if (vertex != (EggVertex *)NULL) {
+      return !vertex->is_forward_reference();
+    }
+  }
+  if (pv._complete) {
+    return false;
+  }
+  return pool->has_vertex(index);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::get_vertex
+//       Access: Private
+//  Description: Returns the vertex with the indicated index number in
+//               the pool, creating a forward reference if it has not
+//               yet been defined.  Returns NULL if the index number
+//               is invalid.
+////////////////////////////////////////////////////////////////////
+EggVertex *EggParser::
+get_vertex(EggVertexPool *pool, int index) {
+  PoolVertices &pv = get_pool_vertices(pool);
+  if (index >= 0 && index < (int)pv._vertices.size()) {
+    EggVertex *vertex = pv._vertices[index];
+    if (vertex != (EggVertex *)NULL) {
+      return vertex;
+    }
+  }
+
+  if (index < 0) {
+    return NULL;
+  }
+  EggVertex *vertex = pool->get_forward_vertex(index);
+  if (vertex != (EggVertex *)NULL) {
+    record_vertex(pool, index, vertex);
+  }
+  return vertex;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::record_vertex
+//       Access: Private
+//  Description: Stores a vertex that has just been added to the pool
+//               in the direct index used by get_vertex().
+////////////////////////////////////////////////////////////////////
+void EggParser::
+record_vertex(EggVertexPool *pool, int index, EggVertex *vertex) {
+  PoolVertices &pv = get_pool_vertices(pool);
+  if (index < 0) {
+    return;
+  }
+  if (index >= (int)pv._vertices.size()) {
+    size_t size = pv._vertices.size();
+    if ((size_t)index > size * 2 + 1024) {
+      // The index numbers are too sparse to store directly; leave
+      // this one to the pool.
+      pv._complete = false;
+      return;
+    }
+    pv._vertices.resize(max((size_t)index + 1, size * 2), (EggVertex *)NULL);
+  }
+  pv._vertices[index] = vertex;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParser::check_vertex_pools
+//       Access: Private
+//  Description: Reports an error for each vertex pool that was
+//               referenced but never defined, or in which vertices
+//               were referenced that were never defined.
+////////////////////////////////////////////////////////////////////
+void EggParser::
+check_vertex_pools() {
+  pvector<string> names;
+  _vertex_pools.get_names(names);
+  sort(names.begin(), names.end());
+
+  pvector<string>::const_iterator ni;
+  for (ni = names.begin(); ni != names.end(); ++ni) {
+    const string &name = (*ni);
+    EggVertexPool *pool =
+      (EggVertexPool *)_vertex_pools.find(name.data(), name.length());
+    if (pool->has_forward_vertices()) {
+      if (!pool->has_defined_vertices()) {
+        error("Undefined vertex pool " + pool->get_name());
+      } else {
+        error("Undefined vertices in pool " + pool->get_name());
+
+        egg_cat.error(false)
+          << "Undefined vertex index numbers:";
+        EggVertexPool::const_iterator vi;
+        for (vi = pool->begin(); vi != pool->end(); ++vi) {
+          EggVertex *vertex = (*vi);
+          if (vertex->is_forward_reference()) {
+            egg_cat.error(false)
+              << " " << vertex->get_index();
+          }
+        }
+        egg_cat.error(false)
+          << "\n";
+      }
+    }
+  }
+}
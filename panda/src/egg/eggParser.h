@@ -0,0 +1,380 @@
+// Filename: eggParser.h
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#ifndef EGGPARSER_H
+#define EGGPARSER_H
+
+#include "pandabase.h"
+
+#include "eggObject.h"
+#include "eggNode.h"
+#include "pointerTo.h"
+#include "pvector.h"
+#include "pmap.h"
+#include "pta_double.h"
+#include "luse.h"
+#include "string_utils.h"
+
+class EggData;
+class EggGroupNode;
+class EggGroup;
+class EggTexture;
+class EggMaterial;
+class EggVertexPool;
+class EggVertex;
+class EggVertexUV;
+class EggVertexAux;
+class EggAttributes;
+class EggPrimitive;
+class EggNurbsSurface;
+class EggNurbsCurve;
+class EggTransform;
+class EggRenderMode;
+class EggTable;
+class EggSAnimData;
+class EggXfmAnimData;
+class EggXfmSAnim;
+class EggAnimPreload;
+class EggParserListener;
+
+////////////////////////////////////////////////////////////////////
+//       Class : EggParser
+// Description : A hand-written reader for the egg syntax.  This
+//               accepts the same language as the yacc grammar in
+//               parser.yxx and builds the same egg structures, but it
+//               reads the stream in large blocks, scans numbers
+//               directly out of the block, and looks up the names of
+//               vertex pools, textures and the like without building
+//               a string for each reference, so it is many times
+//               faster on large files.
+//
+//               Unlike the yacc parser, an EggParser keeps all of its
+//               state within the object, so several may be used at
+//               once in different threads.
+//
+//               This is used by EggData::read() unless
+//               egg-fast-parser is false.  It is also the only parser
+//               that can hand the vertices and primitives to an
+//               EggParserListener.
+////////////////////////////////////////////////////////////////////
+class EXPCL_PANDAEGG EggParser {
+public:
+  EggParser(istream &in, const string &filename);
+  ~EggParser();
+
+  INLINE void set_listener(EggParserListener *listener);
+  bool parse_egg(EggData *data, EggGroupNode *top_node);
+
+  INLINE int get_error_count() const;
+  INLINE int get_warning_count() const;
+
+private:
+  enum TokenType {
+    T_eof = 0,
+    T_open,
+    T_close,
+    T_number,
+    T_ulong,
+    T_string,
+
+    // The keywords, in <angle brackets>.
+    K_animpreload,
+    K_aux,
+    K_beziercurve,
+    K_bface,
+    K_billboard,
+    K_billboardcenter,
+    K_binormal,
+    K_bundle,
+    K_closed,
+    K_collide,
+    K_comment,
+    K_component,
+    K_coordsystem,
+    K_cv,
+    K_dart,
+    K_dnormal,
+    K_drgba,
+    K_duv,
+    K_dxyz,
+    K_dcs,
+    K_distance,
+    K_dtref,
+    K_dynamicvertexpool,
+    K_external_file,
+    K_group,
+    K_defaultpose,
+    K_joint,
+    K_knots,
+    K_include,
+    K_instance,
+    K_line,
+    K_loop,
+    K_material,
+    K_matrix3,
+    K_matrix4,
+    K_model,
+    K_mref,
+    K_normal,
+    K_nurbscurve,
+    K_nurbssurface,
+    K_objecttype,
+    K_order,
+    K_outtangent,
+    K_patch,
+    K_pointlight,
+    K_polygon,
+    K_ref,
+    K_rgba,
+    K_rotate,
+    K_rotx,
+    K_roty,
+    K_rotz,
+    K_sanim,
+    K_scalar,
+    K_scale,
+    K_sequence,
+    K_shading,
+    K_switch,
+    K_switchcondition,
+    K_table,
+    K_table_v,
+    K_tag,
+    K_tangent,
+    K_texlist,
+    K_texture,
+    K_tlengths,
+    K_transform,
+    K_translate,
+    K_tref,
+    K_trianglefan,
+    K_trianglestrip,
+    K_trim,
+    K_txt,
+    K_uknots,
+    K_uv,
+    K_vknots,
+    K_vertex,
+    K_vertexanim,
+    K_vertexpool,
+    K_vertexref,
+    K_xfmanim,
+    K_xfmsanim
+  };
+
+  // The value of a <Scalar> entry, which may be read as a number, an
+  // unsigned integer or a string, depending on the scalar.
+  class ScalarValue {
+  public:
+    double _number;
+    unsigned long _ulong;
+    string _string;
+  };
+
+  // A hash table of names to the objects defined with those names.
+  // The lookup is made directly from the text of a token, so that
+  // referring to a name that has been seen before does not have to
+  // build a new string.
+  class NameTable {
+  public:
+    NameTable();
+
+    EggObject *find(const char *name, size_t length) const;
+    void insert(const string &name, EggObject *object);
+    void get_names(pvector<string> &names) const;
+
+  private:
+    class Entry {
+    public:
+      string _name;
+      size_t _hash;
+      PT(EggObject) _object;
+    };
+    typedef pvector<Entry> Entries;
+
+    static size_t hash_name(const char *name, size_t length);
+    size_t find_slot(const char *name, size_t length, size_t hash) const;
+    void grow();
+
+    Entries _entries;
+    size_t _num_entries;
+  };
+
+  // A direct index into the vertices of each vertex pool, so that the
+  // vertex numbers in a <VertexRef> can be looked up without searching
+  // the pool's own map.  Index numbers that are too sparse to store
+  // this way are looked up in the pool instead.
+  class PoolVertices {
+  public:
+    INLINE PoolVertices();
+    pvector<EggVertex *> _vertices;
+
+    // True as long as every vertex in the pool is in _vertices.
+    bool _complete;
+  };
+  typedef pmap<EggVertexPool *, PoolVertices> PoolIndex;
+
+  // Lexer.
+  bool fill_buffer();
+  INLINE void next_token();
+  INLINE int get_token();
+  void scan_token();
+  void scan_run();
+  void scan_quoted_string();
+  void eat_line_comment();
+  void eat_c_comment();
+  int classify_run(const char *p, const char *end);
+  static int lookup_keyword(const char *p, const char *end);
+  static bool scan_decimal(const char *p, const char *end, double &value);
+
+  INLINE bool is_string_token();
+  INLINE bool is_number_token();
+  INLINE string get_token_string() const;
+
+  // Errors.
+  INLINE void stop_read();
+  void stop_read_unsupported();
+  void error(const string &msg);
+  void warning(const string &msg);
+  void syntax_error();
+  void report(ostream &out, const char *kind, const string &msg);
+  string get_current_line() const;
+
+  // Low-level grammar pieces.
+  bool expect(int token);
+  bool read_real(double &value);
+  bool read_integer(double &value);
+  bool read_string(string &str);
+  void read_optional_name(string &name);
+  void read_required_name(string &name);
+  void read_required_string(string &str);
+  void read_repeated_string(string &str);
+  bool read_real_or_string(ScalarValue &value);
+  bool read_scalar(string &name, ScalarValue &value);
+  int read_reals(double *values, int max_values);
+  bool read_real_list(PTA_double &values);
+  bool read_morph(string &name, double *values, int min_values,
+                  int max_values, int &num_values);
+  bool read_vertex_ref(pvector<int> &indices, double *membership,
+                       EggVertexPool *&pool);
+
+  // The grammar itself.
+  bool add_node(EggGroupNode *parent, EggNode *node);
+  bool parse_node(PT(EggNode) &node);
+  bool parse_coordsystem(PT(EggNode) &node);
+  bool parse_comment(PT(EggNode) &node);
+  bool parse_texture(PT(EggNode) &node);
+  bool parse_material(PT(EggNode) &node);
+  bool parse_external_reference(PT(EggNode) &node, bool keyword_first);
+  bool parse_vertex_pool(PT(EggNode) &node);
+  bool parse_vertex(EggVertexPool *pool);
+  bool parse_vertex_uv(EggVertex *vertex);
+  bool parse_vertex_aux(EggVertex *vertex);
+  bool parse_group(PT(EggNode) &node, int group_type);
+  bool parse_group_body(EggGroup *group);
+  bool parse_collide(EggGroup *group);
+  bool parse_switchcondition(EggGroup *group);
+  bool parse_transform(EggTransform *transform);
+  bool parse_primitive(PT(EggNode) &node, int token);
+  bool parse_primitive_item(EggPrimitive *prim, bool &handled);
+  bool parse_normal(EggAttributes *attrib);
+  bool parse_color(EggAttributes *attrib);
+  bool parse_component(EggPrimitive *prim);
+  bool parse_nurbs_surface(PT(EggNode) &node);
+  bool parse_nurbs_curve(PT(EggNurbsCurve) &curve);
+  bool parse_trim(EggNurbsSurface *nurbs);
+  bool parse_table(PT(EggNode) &node, bool is_bundle);
+  bool parse_sanim(PT(EggNode) &node);
+  bool parse_xfmanim(PT(EggNode) &node);
+  bool parse_xfm_s_anim(PT(EggNode) &node);
+  bool parse_anim_preload(PT(EggNode) &node);
+
+  // The <Scalar> entries of the various objects.
+  bool set_render_mode_scalar(EggRenderMode *mode, const string &name,
+                              const ScalarValue &value);
+  void set_texture_scalar(EggTexture *texture, const string &name,
+                          const ScalarValue &value);
+  void set_material_scalar(EggMaterial *material, const string &name,
+                           const ScalarValue &value);
+  void set_group_scalar(EggGroup *group, const string &name,
+                        const ScalarValue &value);
+  void set_primitive_scalar(EggPrimitive *prim, const string &name,
+                            const ScalarValue &value);
+  void set_nurbs_surface_scalar(EggNurbsSurface *nurbs, const string &name,
+                                const ScalarValue &value);
+  void set_nurbs_curve_scalar(EggNurbsCurve *curve, const string &name,
+                              const ScalarValue &value);
+
+  EggVertexPool *get_vertex_pool(const char *name, size_t length);
+  INLINE PoolVertices &get_pool_vertices(EggVertexPool *pool);
+  bool has_defined_vertex(EggVertexPool *pool, int index);
+  EggVertex *get_vertex(EggVertexPool *pool, int index);
+  void record_vertex(EggVertexPool *pool, int index, EggVertex *vertex);
+  void check_vertex_pools();
+
+private:
+  istream &_in;
+  string _filename;
+
+  // The input buffer.  Only the part from _pos to _end has not yet
+  // been scanned.
+  char *_buffer;
+  size_t _buffer_size;
+  char *_pos;
+  char *_end;
+  bool _eof;
+
+  // The current token.  The text points into the buffer, and is only
+  // valid until the next token is scanned.
+  int _token;
+  bool _need_token;
+  const char *_text;
+  size_t _text_length;
+  double _number;
+  unsigned long _ulong;
+
+  // For reporting errors.  _line_start is the beginning of the
+  // current line within the buffer; if the line began before the
+  // part of the input that is still in the buffer, the text that has
+  // been lost is saved in _line_prefix.
+  int _line_number;
+  const char *_line_start;
+  string _line_prefix;
+  size_t _line_prefix_length;
+  int _col_number;
+  int _error_count;
+  int _warning_count;
+  bool _failed;
+
+  EggGroupNode *_top_node;
+  NameTable _vertex_pools;
+  NameTable _textures;
+  NameTable _materials;
+  NameTable _groups;
+  pvector<int> _indices;
+
+  PoolIndex _pool_index;
+  EggVertexPool *_last_pool;
+  PoolVertices *_last_vertices;
+
+  // The vertex references of the primitive being read, when they are
+  // to be handed to a listener rather than looked up.
+  EggParserListener *_listener;
+  EggVertexPool *_prim_pool;
+  pvector<int> _prim_indices;
+};
+
+#include "eggParser.I"
+
+#endif
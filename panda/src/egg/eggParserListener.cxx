@@ -0,0 +1,37 @@
+// Filename: eggParserListener.cxx
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "eggParserListener.h"
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParserListener::Destructor
+//       Access: Public, Virtual
+//  Description:
+////////////////////////////////////////////////////////////////////
+EggParserListener::
+~EggParserListener() {
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggParserListener::read_stopped
+//       Access: Public, Virtual
+//  Description: Called by the parser when it stops the read because
+//               the file uses something that can't be handed to a
+//               listener, such as a <VertexRef> within a group.  The
+//               EggData will be incomplete.  The default
+//               implementation does nothing.
+////////////////////////////////////////////////////////////////////
+void EggParserListener::
+read_stopped() {
+}
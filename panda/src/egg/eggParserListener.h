@@ -0,0 +1,74 @@
+// Filename: eggParserListener.h
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#ifndef EGGPARSERLISTENER_H
+#define EGGPARSERLISTENER_H
+
+#include "pandabase.h"
+#include "pvector.h"
+
+class EggVertexPool;
+class EggVertex;
+class EggGroupNode;
+class EggPrimitive;
+
+////////////////////////////////////////////////////////////////////
+//       Class : EggParserListener
+// Description : An object that may be given to EggData::read() to
+//               receive the vertices and primitives of an egg file as
+//               they are read, instead of having them stored in the
+//               egg structures.  The rest of the file--groups,
+//               textures, materials and so on--is still read into the
+//               EggData as usual, but each vertex pool is left empty
+//               and no primitives are added to the groups.
+//
+//               This allows a client that only wants to convert the
+//               geometry to some other form to do so without ever
+//               holding the whole file in memory as EggVertex and
+//               EggPrimitive objects.
+//
+//               Since the vertices are not stored, a file that
+//               references them from anywhere else--a <VertexRef>
+//               within a group, or a NURBS curve or surface--cannot
+//               be read this way; the read is stopped when one is
+//               encountered, and read_stopped() is called to tell
+//               the listener so.
+////////////////////////////////////////////////////////////////////
+class EXPCL_PANDAEGG EggParserListener {
+public:
+  virtual ~EggParserListener();
+
+  // Each vertex is passed to vertex_read() as soon as it has been
+  // read, along with its index number within the pool.  The vertex
+  // is not added to the pool, so duplicate index numbers are not
+  // detected by the parser.  Return false to stop the read.
+  virtual bool vertex_read(EggVertexPool *pool, int index,
+                           EggVertex *vertex)=0;
+
+  // Each primitive is passed to primitive_read() instead of being
+  // added to its parent.  The primitive has all of its attributes,
+  // but no vertices; the index numbers of its vertices are given
+  // instead.  The parent is still being read, and is not yet
+  // attached to its own parent.  Return false to stop the read.
+  virtual bool primitive_read(EggGroupNode *parent, EggPrimitive *prim,
+                              EggVertexPool *pool,
+                              const pvector<int> &indices)=0;
+
+  // This is called if the parser has to stop the read itself,
+  // because the file uses something that can't be handed to a
+  // listener.  It is not called when a listener method returns false.
+  virtual void read_stopped();
+};
+
+#endif
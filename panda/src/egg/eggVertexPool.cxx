@@ -30,6 +30,7 @@ TypeHandle EggVertexPool::_type_handle;
 ////////////////////////////////////////////////////////////////////
 EggVertexPool::
 EggVertexPool(const string &name) : EggNode(name) {
+  _unique_built = false;
   _highest_index = -1;
 }
 
@@ -43,6 +44,9 @@ EggVertexPool(const string &name) : EggNode(name) {
 ////////////////////////////////////////////////////////////////////
 EggVertexPool::
 EggVertexPool(const EggVertexPool &copy) : EggNode(copy) {
+  _unique_built = false;
+  _highest_index = -1;
+
   iterator i;
   for (i = copy.begin(); i != copy.end(); ++i) {
     add_vertex(new EggVertex(*(*i)), (*i)->get_index());
@@ -60,7 +64,7 @@ EggVertexPool::
   // Remove all vertices from the pool when it destructs.
 
   // Sanity check.
-  nassertv(_index_vertices.size() == _unique_vertices.size());
+  nassertv(!_unique_built || _index_vertices.size() == _unique_vertices.size());
 
   IndexVertices::iterator ivi;
   for (ivi = _index_vertices.begin(); ivi != _index_vertices.end(); ++ivi) {
@@ -422,7 +426,7 @@ get_aux_names(vector_string &aux_names) const {
 ////////////////////////////////////////////////////////////////////
 EggVertexPool::iterator EggVertexPool::
 begin() const {
-  nassertr(_index_vertices.size() == _unique_vertices.size(),
+  nassertr(!_unique_built || _index_vertices.size() == _unique_vertices.size(),
            iterator(_index_vertices.begin()));
   return iterator(_index_vertices.begin());
 }
@@ -455,7 +459,7 @@ empty() const {
 ////////////////////////////////////////////////////////////////////
 EggVertexPool::size_type EggVertexPool::
 size() const {
-  nassertr(_index_vertices.size() == _unique_vertices.size(), 0);
+  nassertr(!_unique_built || _index_vertices.size() == _unique_vertices.size(), 0);
   return _index_vertices.size();
 }
 
@@ -494,15 +498,24 @@ add_vertex(EggVertex *vertex, int index) {
   // Always supply an index number >= 0.
   nassertr(index >= 0, NULL);
 
-  // Check for a forward reference.
-  IndexVertices::const_iterator ivi = _index_vertices.find(index);
+  // Check for a forward reference.  The vertices are usually added
+  // in order, so the search also gives a good hint for the insert.
+  IndexVertices::iterator ivi = _index_vertices.lower_bound(index);
 
-  if (ivi != _index_vertices.end()) {
+  if (ivi != _index_vertices.end() && (*ivi).first == index) {
     EggVertex *orig_vertex = (*ivi).second;
     if (orig_vertex->is_forward_reference() &&
         !vertex->is_forward_reference()) {
+      // The forward reference is about to change its properties, so
+      // it must be re-sorted within the unique list.
+      if (_unique_built) {
+        erase_unique_vertex(orig_vertex);
+      }
       (*orig_vertex) = (*vertex);
       orig_vertex->_forward_reference = false;
+      if (_unique_built) {
+        _unique_vertices.insert(orig_vertex);
+      }
       _highest_index = max(_highest_index, index);
       return orig_vertex;
     }
@@ -511,8 +524,10 @@ add_vertex(EggVertex *vertex, int index) {
     nassertr(false, NULL);
   }
   
-  _unique_vertices.insert(vertex);
-  _index_vertices[index] = vertex;
+  if (_unique_built) {
+    _unique_vertices.insert(vertex);
+  }
+  _index_vertices.insert(ivi, IndexVertices::value_type(index, vertex));
 
   if (!vertex->is_forward_reference()) {
     _highest_index = max(_highest_index, index);
@@ -535,6 +550,8 @@ add_vertex(EggVertex *vertex, int index) {
 ////////////////////////////////////////////////////////////////////
 EggVertex *EggVertexPool::
 create_unique_vertex(const EggVertex &copy) {
+  build_unique_vertices();
+
   UniqueVertices::iterator uvi;
   uvi = _unique_vertices.find((EggVertex *)&copy);
 
@@ -557,6 +574,8 @@ create_unique_vertex(const EggVertex &copy) {
 ////////////////////////////////////////////////////////////////////
 EggVertex *EggVertexPool::
 find_matching_vertex(const EggVertex &copy) {
+  build_unique_vertices();
+
   UniqueVertices::iterator uvi;
   uvi = _unique_vertices.find((EggVertex *)&copy);
 
@@ -605,24 +624,10 @@ remove_vertex(EggVertex *vertex) {
     }
   }
 
-  // Removing the vertex from the unique list is a bit trickier--there
-  // might be several other vertices that are considered identical to
-  // this one, and so we have to walk through all the identical
-  // vertices until we find the right one.
-  UniqueVertices::iterator uvi;
-  uvi = _unique_vertices.find(vertex);
-
-  // Sanity check.  Is the vertex actually in the pool?
-  nassertv(uvi != _unique_vertices.end());
-
-  while ((*uvi) != vertex) {
-    ++uvi;
-    // Sanity check.  Is the vertex actually in the pool?
-    nassertv(uvi != _unique_vertices.end());
+  if (_unique_built) {
+    erase_unique_vertex(vertex);
   }
 
-  _unique_vertices.erase(uvi);
-
   vertex->_pool = NULL;
 }
 
@@ -690,6 +695,7 @@ remove_unused_vertices() {
 
   // All done.  Lose the old lists.
   _unique_vertices.swap(new_unique_vertices);
+  _unique_built = true;
   _index_vertices.swap(new_index_vertices);
   _highest_index = (int)_index_vertices.size() - 1;
 
@@ -897,3 +903,50 @@ void EggVertexPool::
 r_transform_vertices(const LMatrix4d &mat) {
   transform(mat);
 }
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggVertexPool::build_unique_vertices
+//       Access: Private
+//  Description: Fills up _unique_vertices from _index_vertices, if it
+//               has not already been built.  Once built, it is kept
+//               up-to-date by add_vertex() and remove_vertex().
+////////////////////////////////////////////////////////////////////
+void EggVertexPool::
+build_unique_vertices() {
+  if (_unique_built) {
+    return;
+  }
+
+  _unique_vertices.clear();
+  IndexVertices::const_iterator ivi;
+  for (ivi = _index_vertices.begin(); ivi != _index_vertices.end(); ++ivi) {
+    _unique_vertices.insert((*ivi).second);
+  }
+  _unique_built = true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggVertexPool::erase_unique_vertex
+//       Access: Private
+//  Description: Removes the indicated vertex from _unique_vertices.
+////////////////////////////////////////////////////////////////////
+void EggVertexPool::
+erase_unique_vertex(EggVertex *vertex) {
+  // Removing the vertex from the unique list is a bit tricky--there
+  // might be several other vertices that are considered identical to
+  // this one, and so we have to walk through all the identical
+  // vertices until we find the right one.
+  UniqueVertices::iterator uvi;
+  uvi = _unique_vertices.find(vertex);
+
+  // Sanity check.  Is the vertex actually in the pool?
+  nassertv(uvi != _unique_vertices.end());
+
+  while ((*uvi) != vertex) {
+    ++uvi;
+    // Sanity check.  Is the vertex actually in the pool?
+    nassertv(uvi != _unique_vertices.end());
+  }
+
+  _unique_vertices.erase(uvi);
+}
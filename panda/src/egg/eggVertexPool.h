@@ -60,6 +60,9 @@ private:
   // are not reference-counted), this time ordered by vertex
   // properties.  This makes it easy to determine when one or more
   // vertices already exist in the pool with identical properties.
+  // Since most pools (for instance, those just read from an egg file)
+  // are never asked for this, it is not built until it is first
+  // needed.
   typedef pmultiset<EggVertex *, UniqueEggVertices> UniqueVertices;
 
 public:
@@ -143,7 +146,11 @@ protected:
   virtual void r_transform_vertices(const LMatrix4d &mat);
 
 private:
+  void build_unique_vertices();
+  void erase_unique_vertex(EggVertex *vertex);
+
   UniqueVertices _unique_vertices;
+  bool _unique_built;
   IndexVertices _index_vertices;
   int _highest_index;
 
@@ -1,5 +1,7 @@
 #include "eggObject.cxx"
 #include "eggParameters.cxx"
+#include "eggParser.cxx"
+#include "eggParserListener.cxx"
 #include "eggPatch.cxx"
 #include "eggPoint.cxx"
 #include "eggPolygon.cxx"
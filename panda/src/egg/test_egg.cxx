@@ -13,11 +13,119 @@
 ////////////////////////////////////////////////////////////////////
 
 #include "eggData.h"
+#include "config_egg.h"
 #include "pnotify.h"
+#include "pvector.h"
 
+#include <algorithm>
+
+////////////////////////////////////////////////////////////////////
+//     Function: read_and_write
+//  Description: Reads the indicated egg file with either the fast
+//               parser or the yacc parser, and writes the result to
+//               the indicated string.  Returns true on success.
+////////////////////////////////////////////////////////////////////
+static bool
+read_and_write(const Filename &egg_filename, bool fast, string &result) {
+  egg_fast_parser.set_value(fast);
+
+  EggData data;
+  data.set_coordinate_system(CS_default);
+  if (!data.read(egg_filename)) {
+    return false;
+  }
+
+  ostringstream strm;
+  data.write_egg(strm);
+  result = strm.str();
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: same_lines
+//  Description: Returns true if the two strings contain the same
+//               lines, in any order.
+////////////////////////////////////////////////////////////////////
+static bool
+same_lines(const string &a, const string &b) {
+  pvector<string> a_lines, b_lines;
+  istringstream a_strm(a), b_strm(b);
+  string line;
+  while (getline(a_strm, line)) {
+    a_lines.push_back(line);
+  }
+  while (getline(b_strm, line)) {
+    b_lines.push_back(line);
+  }
+  sort(a_lines.begin(), a_lines.end());
+  sort(b_lines.begin(), b_lines.end());
+  return a_lines == b_lines;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: compare_parsers
+//  Description: Reads each of the indicated egg files with both the
+//               fast parser and the yacc parser, and checks that
+//               they produce the same egg data.
+//
+//               A joint writes its vertex references in the order of
+//               the vertices' addresses, which differ from one read
+//               to the next, so if the two outputs don't match
+//               exactly, they are accepted if they have the same
+//               lines in some order.  Run as "test_egg -c
+//               file.egg [file.egg ...]".  Returns the number of
+//               files that differ or fail to load.
+////////////////////////////////////////////////////////////////////
+static int
+compare_parsers(int argc, char *argv[]) {
+  int num_failed = 0;
+  for (int i = 0; i < argc; ++i) {
+    Filename egg_filename = Filename::from_os_specific(argv[i]);
+    string fast_result, yacc_result;
+    bool fast_ok = read_and_write(egg_filename, true, fast_result);
+    bool yacc_ok = read_and_write(egg_filename, false, yacc_result);
+
+    if (!fast_ok || !yacc_ok) {
+      nout << egg_filename << ": failed to read with the "
+           << (fast_ok ? "yacc" : "fast") << " parser.\n";
+      ++num_failed;
+
+    } else if (fast_result != yacc_result &&
+               !same_lines(fast_result, yacc_result)) {
+      // Report the first line that differs.
+      size_t p = 0;
+      while (p < fast_result.size() && p < yacc_result.size() &&
+             fast_result[p] == yacc_result[p]) {
+        ++p;
+      }
+      size_t line_start = fast_result.rfind('\n', p);
+      line_start = (line_start == string::npos) ? 0 : line_start + 1;
+      int line = 1;
+      for (size_t q = 0; q < line_start; ++q) {
+        if (fast_result[q] == '\n') {
+          ++line;
+        }
+      }
+      nout << egg_filename << ": parsers differ at line " << line << ":\n"
+           << "  fast: " << fast_result.substr(line_start, fast_result.find('\n', p) - line_start) << "\n"
+           << "  yacc: " << yacc_result.substr(line_start, yacc_result.find('\n', p) - line_start) << "\n";
+      ++num_failed;
+
+    } else {
+      nout << egg_filename << ": ok\n";
+    }
+  }
+
+  nout << argc - num_failed << " of " << argc << " files match.\n";
+  return num_failed;
+}
 
 int
 main(int argc, char *argv[]) {
+  if (argc > 1 && strcmp(argv[1], "-c") == 0) {
+    return (compare_parsers(argc - 2, argv + 2) == 0) ? 0 : 1;
+  }
+
   if (argc != 2) {
     nout << "Specify an egg file to load.\n";
     exit(1);
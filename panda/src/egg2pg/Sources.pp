@@ -21,6 +21,7 @@
     eggLoader.h eggLoader.I \
     eggRenderState.h eggRenderState.I \
     eggSaver.h eggSaver.I \
+    eggStreamLoader.h eggStreamLoader.I \
     egg_parametrics.h \
     load_egg_file.h \
     save_egg_file.h \
@@ -35,6 +36,7 @@
     eggLoader.cxx \
     eggRenderState.cxx \
     eggSaver.cxx \
+    eggStreamLoader.cxx \
     egg_parametrics.cxx \
     load_egg_file.cxx \
     save_egg_file.cxx \
@@ -52,3 +54,13 @@
   #define IGATESCAN load_egg_file.h save_egg_file.h
 
 #end lib_target
+
+#begin test_bin_target
+  #define TARGET test_egg2pg
+  #define LOCAL_LIBS \
+    p3egg2pg p3egg p3pgraph p3gobj p3putil p3mathutil
+
+  #define SOURCES \
+    test_egg2pg.cxx
+
+#end test_bin_target
@@ -65,6 +65,36 @@ ConfigVariableBool egg_unify
           "benefits, especially on higher-end graphics cards, but it also "
           "slightly slows down egg loading."));
 
+ConfigVariableBool egg_optimize_vertex_cache
+("egg-optimize-vertex-cache", false,
+ PRC_DESC("Set this true to reorder the triangles and vertices of the "
+          "loaded geometry for the graphics card's vertex cache, as the "
+          "last step of loading an egg file; see "
+          "SceneGraphReducer::optimize_vertex_cache().  The result is "
+          "indexed triangle lists rather than triangle strips: the egg "
+          "mesher still runs if egg-mesh is true, but any strips and fans "
+          "it makes are decomposed into triangles again before they are "
+          "reordered."));
+
+ConfigVariableInt egg_generate_lods
+("egg-generate-lods", 0,
+ PRC_DESC("Set this to a number of triangles to automatically generate "
+          "simplified levels of detail for each GeomNode of a loaded egg "
+          "file that has at least that many triangles; see LODGenerator.  "
+          "This is done after flattening, and before "
+          "egg-optimize-vertex-cache.  Set it to 0 to leave the geometry "
+          "alone."));
+
+ConfigVariableInt egg_quantize_vertices
+("egg-quantize-vertices", 0,
+ PRC_DESC("Set this to 16 or 8 to store the vertices of a loaded egg file "
+          "in compact form, as the very last step of loading: positions "
+          "and texture coordinates become integers of that many bits, "
+          "scaled to the bounding box of each GeomVertexData, and normals "
+          "are stored in two such integers each.  See "
+          "SceneGraphReducer::quantize_vertices().  Set it to 0 to keep "
+          "floating-point vertices."));
+
 ConfigVariableBool egg_combine_geoms
 ("egg-combine-geoms", false,
  PRC_DESC("Set this true to combine sibling GeomNodes into a single GeomNode, "
@@ -191,6 +221,18 @@ ConfigVariableBool egg_implicit_alpha_binary
           "will automatically be downgraded to alpha type \"binary\" instead of "
           "whatever appears in the egg file."));
 
+ConfigVariableBool egg_stream_load
+("egg-stream-load", false,
+ PRC_DESC("When this is true, an egg file that contains only static "
+          "polygons in ordinary groups is converted to geometry as it is "
+          "read, without first building the complete egg structure in "
+          "memory.  This is much faster and smaller for large files.  The "
+          "polygons are triangulated rather than made into strips.  Egg "
+          "files that use anything else, such as animation, collision "
+          "geometry, billboards or tags, are loaded in the usual way.  "
+          "This is still experimental; test_egg2pg compares its results "
+          "with the usual loader's."));
+
 ConfigureFn(config_egg2pg) {
   init_libegg2pg();
 }
@@ -39,6 +39,9 @@ extern EXPCL_PANDAEGG ConfigVariableBool egg_ignore_decals;
 extern EXPCL_PANDAEGG ConfigVariableBool egg_flatten;
 extern EXPCL_PANDAEGG ConfigVariableDouble egg_flatten_radius;
 extern EXPCL_PANDAEGG ConfigVariableBool egg_unify;
+extern EXPCL_PANDAEGG ConfigVariableBool egg_optimize_vertex_cache;
+extern EXPCL_PANDAEGG ConfigVariableInt egg_generate_lods;
+extern EXPCL_PANDAEGG ConfigVariableInt egg_quantize_vertices;
 extern EXPCL_PANDAEGG ConfigVariableBool egg_combine_geoms;
 extern EXPCL_PANDAEGG ConfigVariableBool egg_rigid_geometry;
 extern EXPCL_PANDAEGG ConfigVariableBool egg_flat_shading;
@@ -55,6 +58,7 @@ extern EXPCL_PANDAEGG ConfigVariableBool egg_preload_simple_textures;
 extern EXPCL_PANDAEGG ConfigVariableDouble egg_vertex_membership_quantize;
 extern EXPCL_PANDAEGG ConfigVariableInt egg_vertex_max_num_joints;
 extern EXPCL_PANDAEGG ConfigVariableBool egg_implicit_alpha_binary;
+extern EXPCL_PANDAEGG ConfigVariableBool egg_stream_load;
 
 extern EXPCL_PANDAEGG void init_libegg2pg();
 
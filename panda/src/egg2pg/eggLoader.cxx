@@ -349,7 +349,9 @@ make_polyset(EggBin *egg_bin, PandaNode *parent, const LMatrix4d *transform,
                                 false);
 
   if (egg_mesh) {
-    // If we're using the mesher, mesh now.
+    // If we're using the mesher, mesh now.  (If
+    // egg-optimize-vertex-cache is also on, the strips will be
+    // decomposed into triangles again when they are reordered.)
     egg_bin->mesh_triangles(render_state->_flat_shaded ? EggGroupNode::T_flat_shaded : 0);
 
   } else {
@@ -1952,25 +1954,7 @@ make_node(EggGroup *egg_group, PandaNode *parent) {
     
   } else if (egg_group->get_model_flag() || egg_group->has_dcs_type()) {
     // A model or DCS flag; create a model node.
-    node = new ModelNode(egg_group->get_name());
-    switch (egg_group->get_dcs_type()) {
-    case EggGroup::DC_net:
-      DCAST(ModelNode, node)->set_preserve_transform(ModelNode::PT_net);
-      break;
-
-    case EggGroup::DC_no_touch:
-      DCAST(ModelNode, node)->set_preserve_transform(ModelNode::PT_no_touch);
-      break;
-
-    case EggGroup::DC_local:
-    case EggGroup::DC_default:
-      DCAST(ModelNode, node)->set_preserve_transform(ModelNode::PT_local);
-      break;
-
-    case EggGroup::DC_none:
-    case EggGroup::DC_unspecified:
-      break;
-    }
+    node = make_model_node(egg_group);
 
     EggGroup::const_iterator ci;
     for (ci = egg_group->begin(); ci != egg_group->end(); ++ci) {
@@ -2022,6 +2006,37 @@ make_node(EggGroup *egg_group, PandaNode *parent) {
   return create_group_arc(egg_group, parent, node);
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: EggLoader::make_model_node
+//       Access: Private
+//  Description: Creates the ModelNode for a group with the model
+//               flag or a DCS type.
+////////////////////////////////////////////////////////////////////
+PT(ModelNode) EggLoader::
+make_model_node(EggGroup *egg_group) {
+  PT(ModelNode) node = new ModelNode(egg_group->get_name());
+  switch (egg_group->get_dcs_type()) {
+  case EggGroup::DC_net:
+    node->set_preserve_transform(ModelNode::PT_net);
+    break;
+
+  case EggGroup::DC_no_touch:
+    node->set_preserve_transform(ModelNode::PT_no_touch);
+    break;
+
+  case EggGroup::DC_local:
+  case EggGroup::DC_default:
+    node->set_preserve_transform(ModelNode::PT_local);
+    break;
+
+  case EggGroup::DC_none:
+  case EggGroup::DC_unspecified:
+    break;
+  }
+
+  return node;
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: EggLoader::create_group_arc
 //       Access: Private
@@ -56,6 +56,7 @@ class PortalNode;
 class OccluderNode;
 class PolylightNode;
 class EggRenderState;
+class ModelNode;
 class CharacterMaker;
 
 
@@ -134,6 +135,7 @@ private:
   PandaNode *make_polyset(EggBin *egg_bin, PandaNode *parent);
   PandaNode *make_lod(EggBin *egg_bin, PandaNode *parent);
   PandaNode *make_node(EggGroup *egg_group, PandaNode *parent);
+  PT(ModelNode) make_model_node(EggGroup *egg_group);
   PandaNode *create_group_arc(EggGroup *egg_group, PandaNode *parent,
                                    PandaNode *node);
   PandaNode *make_node(EggTable *egg_table, PandaNode *parent);
@@ -267,6 +269,7 @@ public:
 
 
   friend class EggRenderState;
+  friend class EggStreamLoader;
   friend class PandaNode;
 };
 
@@ -0,0 +1,1075 @@
+// Filename: eggStreamLoader.cxx
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "eggStreamLoader.h"
+#include "config_egg2pg.h"
+#include "eggData.h"
+#include "eggGroup.h"
+#include "eggVertex.h"
+#include "eggVertexUV.h"
+#include "eggVertexPool.h"
+#include "eggTexture.h"
+#include "eggMaterial.h"
+#include "eggComment.h"
+#include "eggCoordinateSystem.h"
+#include "modelRoot.h"
+#include "modelNode.h"
+#include "geomNode.h"
+#include "geom.h"
+#include "geomTriangles.h"
+#include "geomVertexData.h"
+#include "geomVertexFormat.h"
+#include "geomVertexArrayFormat.h"
+#include "geomVertexWriter.h"
+#include "colorAttrib.h"
+#include "internalName.h"
+#include "dcast.h"
+#include "thread.h"
+
+#include <algorithm>
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggStreamLoader::Constructor
+//       Access: Public
+//  Description: The loader's EggData should already have its
+//               filename and coordinate system set up, but should not
+//               yet have been read.
+////////////////////////////////////////////////////////////////////
+EggStreamLoader::
+EggStreamLoader(EggLoader &loader) :
+  _loader(loader)
+{
+  _last_pool = NULL;
+  _last_stream_pool = NULL;
+  _last_parent = NULL;
+  _last_key = NULL;
+  _last_bin = NULL;
+  _cs_mat = LMatrix4d::ident_mat();
+  _convert_cs = false;
+  _unsupported = false;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggStreamLoader::Destructor
+//       Access: Public, Virtual
+//  Description:
+////////////////////////////////////////////////////////////////////
+EggStreamLoader::
+~EggStreamLoader() {
+  Bins::iterator bi;
+  for (bi = _bins.begin(); bi != _bins.end(); ++bi) {
+    delete (*bi);
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggStreamLoader::is_enabled
+//       Access: Public, Static
+//  Description: Returns true if egg files should be loaded with an
+//               EggStreamLoader first, or false if the current
+//               configuration asks for something only the full
+//               EggLoader can do.
+////////////////////////////////////////////////////////////////////
+bool EggStreamLoader::
+is_enabled() {
+  return egg_stream_load && !egg_flat_shading && !egg_show_normals;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggStreamLoader::load
+//       Access: Public
+//  Description: Reads the egg file from the indicated stream and
+//               builds the scene graph into the loader's _root.
+//
+//               Returns R_loaded if this succeeded, or R_error if the
+//               file could not be read.  Returns R_unsupported if
+//               the file turned out to need the full EggLoader; in
+//               this case the loader has not been modified, and the
+//               file should be read again into its EggData and
+//               loaded with build_graph().
+////////////////////////////////////////////////////////////////////
+EggStreamLoader::Result EggStreamLoader::
+load(istream &in) {
+  // We read into a new EggData, rather than the loader's, so that the
+  // coordinate system of the file is not converted automatically:
+  // we need to know it to convert the vertices ourselves.
+  PT(EggData) orig_data = _loader._data;
+  PT(EggData) data = new EggData;
+  data->set_egg_filename(orig_data->get_egg_filename());
+  data->set_egg_timestamp(orig_data->get_egg_timestamp());
+  data->set_auto_resolve_externals(orig_data->get_auto_resolve_externals());
+
+  bool okflag = data->read(in, this);
+  if (_unsupported) {
+    return R_unsupported;
+  }
+  if (!okflag) {
+    return R_error;
+  }
+  if (!check_groups(data)) {
+    return R_unsupported;
+  }
+
+  CoordinateSystem file_cs = data->get_coordinate_system();
+  data->set_coordinate_system(orig_data->get_coordinate_system());
+  if (data->get_coordinate_system() != file_cs) {
+    _cs_mat = LMatrix4d::convert_mat(file_cs, data->get_coordinate_system());
+    _convert_cs = true;
+  }
+  _loader._data = data;
+
+  // The textures referenced by the stand-in polygons are all of the
+  // textures referenced by the file.
+  _loader.load_textures();
+
+  Bins::iterator bi;
+  for (bi = _bins.begin(); bi != _bins.end(); ++bi) {
+    Bin *bin = (*bi);
+    bin->_render_state = new EggRenderState(_loader);
+    bin->_render_state->fill_state(bin->_prototype);
+  }
+
+  _loader._root = new ModelRoot(data->get_egg_filename(),
+                                data->get_egg_timestamp());
+
+  EggGroupNode::const_iterator ci;
+  for (ci = data->begin(); ci != data->end(); ++ci) {
+    if ((*ci)->is_of_type(EggGroup::get_class_type())) {
+      make_node(DCAST(EggGroup, *ci), _loader._root);
+    }
+  }
+  make_bins(data, _loader._root);
+
+  _loader.apply_deferred_nodes(_loader._root, DeferredNodeProperty());
+  return R_loaded;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggStreamLoader::vertex_read
+//       Access: Public, Virtual
+//  Description: Stores a vertex from the file, if it is one we can
+//               handle.
+////////////////////////////////////////////////////////////////////
+bool EggStreamLoader::
+vertex_read(EggVertexPool *pool, int index, EggVertex *vertex) {
+  if (vertex->get_num_dimensions() != 3 || !vertex->_dxyzs.empty() ||
+      !vertex->_dnormals.empty() || !vertex->_drgbas.empty() ||
+      vertex->aux_begin() != vertex->aux_end()) {
+    // Only static, three-dimensional vertices.
+    _unsupported = true;
+    return false;
+  }
+
+  if (pool != _last_pool) {
+    _last_pool = pool;
+    _last_stream_pool = &_pools[pool];
+  }
+  StreamPool &sp = *_last_stream_pool;
+
+  size_t size = sp._vertices.size();
+  if ((size_t)index >= size) {
+    if ((size_t)index > size * 2 + 1024) {
+      // The index numbers are too sparse to store directly.
+      _unsupported = true;
+      return false;
+    }
+    sp._vertices.resize(index + 1);
+  }
+
+  StreamVertex &sv = sp._vertices[index];
+  if ((sv._flags & VF_defined) != 0) {
+    // A duplicate vertex number.  The full loader will report it.
+    _unsupported = true;
+    return false;
+  }
+
+  sv._flags = VF_defined;
+  sv._pos = vertex->get_pos3();
+  if (vertex->has_normal()) {
+    sv._flags |= VF_normal;
+    sv._normal = vertex->get_normal();
+  }
+  if (vertex->has_color()) {
+    sv._flags |= VF_color;
+    sv._color = LCAST(float, vertex->get_color());
+  }
+
+  EggVertex::const_uv_iterator uvi;
+  for (uvi = vertex->uv_begin(); uvi != vertex->uv_end(); ++uvi) {
+    EggVertexUV *egg_uv = (*uvi);
+    if (egg_uv->has_w() || egg_uv->has_tangent() ||
+        egg_uv->has_binormal() || !egg_uv->_duvs.empty()) {
+      _unsupported = true;
+      return false;
+    }
+
+    int slot;
+    pmap<string, int>::const_iterator si = _uv_slots.find(egg_uv->get_name());
+    if (si != _uv_slots.end()) {
+      slot = (*si).second;
+    } else {
+      slot = (int)_uv_names.size();
+      if (slot >= (int)sizeof(sv._uv_bits) * 8) {
+        _unsupported = true;
+        return false;
+      }
+      _uv_names.push_back(egg_uv->get_name());
+      _uv_slots[egg_uv->get_name()] = slot;
+    }
+
+    if (slot >= (int)sp._uvs.size()) {
+      sp._uvs.resize(slot + 1);
+    }
+    pvector<LTexCoordf> &uvs = sp._uvs[slot];
+    if (index >= (int)uvs.size()) {
+      uvs.resize(index + 1);
+    }
+    uvs[index] = LCAST(float, egg_uv->get_uv());
+    sv._uv_bits |= (1 << slot);
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggStreamLoader::primitive_read
+//       Access: Public, Virtual
+//  Description: Sorts a polygon from the file into its bin, if it is
+//               one we can handle.
+////////////////////////////////////////////////////////////////////
+bool EggStreamLoader::
+primitive_read(EggGroupNode *parent, EggPrimitive *prim,
+               EggVertexPool *pool, const pvector<int> &indices) {
+  if (!prim->is_exact_type(EggPolygon::get_class_type())) {
+    _unsupported = true;
+    return false;
+  }
+
+  if (parent != _last_parent) {
+    // The group's own attributes have usually been read by now, so we
+    // can stop early on a character or the like, rather than reading
+    // the whole file first.  check_groups() checks again at the end.
+    EggGroupNode *node = parent;
+    while (node != (EggGroupNode *)NULL &&
+           node->is_of_type(EggGroup::get_class_type())) {
+      if (!check_group(DCAST(EggGroup, node))) {
+        _unsupported = true;
+        return false;
+      }
+      node = node->get_parent();
+    }
+    _last_parent = parent;
+  }
+
+  if (pool == (EggVertexPool *)NULL) {
+    // A polygon without vertices is simply removed, as by
+    // remove_invalid_primitives().
+    return true;
+  }
+
+  StreamPools::iterator pi = _pools.find(pool);
+  if (pi == _pools.end()) {
+    // The polygon came before its vertices.
+    _unsupported = true;
+    return false;
+  }
+  StreamPool *sp = &(*pi).second;
+
+  // Remove repeated vertices, as EggPolygon::cleanup() does: by
+  // position only, and also at the end of the loop.
+  _clean_indices.clear();
+  pvector<int>::const_iterator ii;
+  for (ii = indices.begin(); ii != indices.end(); ++ii) {
+    int index = (*ii);
+    if (index < 0 || index >= (int)sp->_vertices.size() ||
+        (sp->_vertices[index]._flags & VF_defined) == 0) {
+      _unsupported = true;
+      return false;
+    }
+    if (_clean_indices.empty() ||
+        sp->_vertices[_clean_indices.back()]._pos != sp->_vertices[index]._pos) {
+      _clean_indices.push_back(index);
+    }
+  }
+  while (_clean_indices.size() > 1 &&
+         sp->_vertices[_clean_indices.back()]._pos ==
+         sp->_vertices[_clean_indices.front()]._pos) {
+    _clean_indices.pop_back();
+  }
+
+  int num_vertices = (int)_clean_indices.size();
+  if (num_vertices < 3) {
+    return true;
+  }
+  int convex = check_convex(*sp, &_clean_indices[0], num_vertices);
+  if (convex < 0) {
+    // Degenerate.
+    return true;
+  }
+  if (convex == 0) {
+    // We only know how to triangulate convex polygons.
+    _unsupported = true;
+    return false;
+  }
+
+  // Once the polygon color has been folded into the vertices, the
+  // render state will want to know whether any of them are
+  // transparent.
+  bool implicit_alpha = false;
+  unsigned int uv_bits = 0;
+  bool any_normal = prim->has_normal();
+  for (int i = 0; i < num_vertices; ++i) {
+    const StreamVertex &sv = sp->_vertices[_clean_indices[i]];
+    if ((sv._flags & VF_color) != 0) {
+      implicit_alpha = implicit_alpha || (sv._color[3] != 1.0f);
+    } else if (prim->has_color()) {
+      implicit_alpha = implicit_alpha || (prim->get_color()[3] != 1.0f);
+    }
+    uv_bits |= sv._uv_bits;
+    any_normal = any_normal || ((sv._flags & VF_normal) != 0);
+  }
+
+  // Emulate bface the same way EggLoader::emulate_bface() does, by
+  // adding the polygon again with the vertices in reverse order.
+  bool emulate_bface = prim->get_bface_flag() && egg_emulate_bface;
+  Bin *bin = get_bin(parent, prim, prim->get_bface_flag() && !emulate_bface,
+                     implicit_alpha);
+  bin->_uv_bits |= uv_bits;
+  bin->_any_normal = bin->_any_normal || any_normal;
+
+  StreamPrim sprim;
+  sprim._pool = sp;
+  sprim._first_index = (int)bin->_indices.size();
+  sprim._num_vertices = num_vertices;
+  sprim._attrib = -1;
+  sprim._flags = 0;
+  if (prim->has_normal()) {
+    sprim._flags |= PF_normal;
+  }
+  if (prim->has_color()) {
+    sprim._flags |= PF_color;
+  }
+  if (sprim._flags != 0) {
+    sprim._attrib = get_prim_attrib(prim);
+  }
+
+  bin->_indices.insert(bin->_indices.end(), _clean_indices.begin(),
+                       _clean_indices.end());
+  bin->_prims.push_back(sprim);
+  if (emulate_bface) {
+    sprim._flags |= PF_reversed;
+    bin->_prims.push_back(sprim);
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggStreamLoader::read_stopped
+//       Access: Public, Virtual
+//  Description: Called when the parser stops the read because the
+//               file references its vertices from somewhere other
+//               than a primitive, as a character's joints do.  The
+//               full EggLoader is needed for such a file.
+////////////////////////////////////////////////////////////////////
+void EggStreamLoader::
+read_stopped() {
+  _unsupported = true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggStreamLoader::BinKey::operator <
+//       Access: Public
+//  Description:
+////////////////////////////////////////////////////////////////////
+bool EggStreamLoader::BinKey::
+operator < (const BinKey &other) const {
+  if (_parent != other._parent) {
+    return _parent < other._parent;
+  }
+  if (_material != other._material) {
+    return _material < other._material;
+  }
+  if (_bface != other._bface) {
+    return (int)_bface < (int)other._bface;
+  }
+  if (_implicit_alpha != other._implicit_alpha) {
+    return (int)_implicit_alpha < (int)other._implicit_alpha;
+  }
+  if (_textures != other._textures) {
+    return _textures < other._textures;
+  }
+  if (_sort_name != other._sort_name) {
+    return _sort_name < other._sort_name;
+  }
+  return _render_mode < other._render_mode;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggStreamLoader::RowTable::Constructor
+//       Access: Public
+//  Description:
+////////////////////////////////////////////////////////////////////
+EggStreamLoader::RowTable::
+RowTable(int row_width) :
+  _row_width(row_width),
+  _num_rows(0)
+{
+  _table.assign(1024, -1);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggStreamLoader::RowTable::add_row
+//       Access: Public
+//  Description: Returns the index of the row with the indicated
+//               values, adding it if there is no such row yet.
+////////////////////////////////////////////////////////////////////
+int EggStreamLoader::RowTable::
+add_row(const PN_stdfloat *row) {
+  if ((size_t)_num_rows * 2 >= _table.size()) {
+    grow();
+  }
+
+  size_t mask = _table.size() - 1;
+  size_t slot = hash_row(row) & mask;
+  size_t row_size = _row_width * sizeof(PN_stdfloat);
+  while (_table[slot] != -1) {
+    int n = _table[slot];
+    if (memcmp(&_values[n * _row_width], row, row_size) == 0) {
+      return n;
+    }
+    slot = (slot + 1) & mask;
+  }
+
+  int n = _num_rows++;
+  _values.insert(_values.end(), row, row + _row_width);
+  _table[slot] = n;
+  return n;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggStreamLoader::RowTable::clear
+//       Access: Public
+//  Description: Removes all of the rows.
+////////////////////////////////////////////////////////////////////
+void EggStreamLoader::RowTable::
+clear() {
+  _values.clear();
+  _table.assign(1024, -1);
+  _num_rows = 0;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggStreamLoader::RowTable::hash_row
+//       Access: Private
+//  Description: Returns a hash of the bytes of the row.
+////////////////////////////////////////////////////////////////////
+size_t EggStreamLoader::RowTable::
+hash_row(const PN_stdfloat *row) const {
+  // FNV-1a.
+  const unsigned char *p = (const unsigned char *)row;
+  const unsigned char *end = p + _row_width * sizeof(PN_stdfloat);
+  size_t hash = (size_t)2166136261U;
+  while (p < end) {
+    hash = (hash ^ (*p++)) * (size_t)16777619U;
+  }
+  return hash ^ (hash >> 16);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggStreamLoader::RowTable::grow
+//       Access: Private
+//  Description: Doubles the size of the hash table.
+////////////////////////////////////////////////////////////////////
+void EggStreamLoader::RowTable::
+grow() {
+  _table.assign(_table.size() * 2, -1);
+  size_t mask = _table.size() - 1;
+  for (int n = 0; n < _num_rows; ++n) {
+    size_t slot = hash_row(&_values[n * _row_width]) & mask;
+    while (_table[slot] != -1) {
+      slot = (slot + 1) & mask;
+    }
+    _table[slot] = n;
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggStreamLoader::get_bin
+//       Access: Private
+//  Description: Returns the bin for polygons like the indicated one
+//               within the indicated parent, creating it if
+//               necessary.
+////////////////////////////////////////////////////////////////////
+EggStreamLoader::Bin *EggStreamLoader::
+get_bin(EggGroupNode *parent, EggPrimitive *prim, bool bface,
+        bool implicit_alpha) {
+  _key._parent = parent;
+  _key._sort_name = prim->get_sort_name();
+  _key._textures.clear();
+  int num_textures = prim->get_num_textures();
+  for (int i = 0; i < num_textures; ++i) {
+    _key._textures.push_back(prim->get_texture(i));
+  }
+  _key._material = prim->get_material();
+  _key._bface = bface;
+  _key._implicit_alpha = implicit_alpha;
+  _key._render_mode = *prim;
+
+  // Consecutive polygons are usually in the same bin.
+  if (_last_key != (const BinKey *)NULL &&
+      !(_key < *_last_key) && !(*_last_key < _key)) {
+    return _last_bin;
+  }
+
+  BinsByKey::iterator bi = _bins_by_key.find(_key);
+  if (bi == _bins_by_key.end()) {
+    Bin *bin = new Bin;
+    bin->_parent = parent;
+    bin->_uv_bits = 0;
+    bin->_any_normal = false;
+
+    // The stand-in polygon has the polygon's attributes, except for
+    // the color and normal, which belong to the vertices now.  (The
+    // EggPrimitive copy constructor doesn't copy the render mode.)  If any
+    // of those colors are transparent, a transparent color here will
+    // have the same effect on the render state.
+    bin->_prototype = new EggPolygon(*DCAST(EggPolygon, prim));
+    EggRenderMode &render_mode = *bin->_prototype;
+    render_mode = _key._render_mode;
+    bin->_prototype->clear_color();
+    bin->_prototype->clear_normal();
+    if (implicit_alpha) {
+      bin->_prototype->set_color(LColor(1.0f, 1.0f, 1.0f, 0.0f));
+    }
+    bin->_prototype->set_bface_flag(bface);
+    parent->add_child(bin->_prototype);
+
+    _bins.push_back(bin);
+    _bins_by_parent[parent].push_back(bin);
+    bi = _bins_by_key.insert(BinsByKey::value_type(_key, bin)).first;
+  }
+
+  _last_key = &(*bi).first;
+  _last_bin = (*bi).second;
+  return _last_bin;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggStreamLoader::get_prim_attrib
+//       Access: Private
+//  Description: Records the polygon's own normal and color, and
+//               returns the index of the record.
+////////////////////////////////////////////////////////////////////
+int EggStreamLoader::
+get_prim_attrib(EggPrimitive *prim) {
+  PrimAttrib attrib;
+  if (prim->has_normal()) {
+    attrib._normal = prim->get_normal();
+  } else {
+    attrib._normal = LNormald::zero();
+  }
+  if (prim->has_color()) {
+    attrib._color = LCAST(float, prim->get_color());
+  } else {
+    attrib._color = LColorf(1.0f, 1.0f, 1.0f, 1.0f);
+  }
+
+  // Neighboring polygons often have the same color.
+  if (!_prim_attribs.empty() &&
+      _prim_attribs.back()._normal == attrib._normal &&
+      _prim_attribs.back()._color == attrib._color) {
+    return (int)_prim_attribs.size() - 1;
+  }
+  _prim_attribs.push_back(attrib);
+  return (int)_prim_attribs.size() - 1;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggStreamLoader::check_convex
+//       Access: Private
+//  Description: Returns 1 if the polygon is convex, 0 if it is
+//               concave, or -1 if it is degenerate.
+////////////////////////////////////////////////////////////////////
+int EggStreamLoader::
+check_convex(const StreamPool &pool, const int *indices,
+             int num_vertices) const {
+  // The polygon normal, as in EggPolygon::calculate_normal().
+  LVector3d normal = LVector3d::zero();
+  int i;
+  for (i = 0; i < num_vertices; ++i) {
+    const LPoint3d &p0 = pool._vertices[indices[i]]._pos;
+    const LPoint3d &p1 = pool._vertices[indices[(i + 1) % num_vertices]]._pos;
+    normal[0] += p0[1] * p1[2] - p0[2] * p1[1];
+    normal[1] += p0[2] * p1[0] - p0[0] * p1[2];
+    normal[2] += p0[0] * p1[1] - p0[1] * p1[0];
+  }
+  if (!normal.normalize()) {
+    return -1;
+  }
+  if (num_vertices == 3) {
+    return 1;
+  }
+
+  // Every corner must turn the same way as the polygon as a whole.
+  for (i = 0; i < num_vertices; ++i) {
+    const LPoint3d &p0 = pool._vertices[indices[i]]._pos;
+    const LPoint3d &p1 = pool._vertices[indices[(i + 1) % num_vertices]]._pos;
+    const LPoint3d &p2 = pool._vertices[indices[(i + 2) % num_vertices]]._pos;
+    if (cross(p1 - p0, p2 - p1).dot(normal) < 0.0) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggStreamLoader::check_group
+//       Access: Private
+//  Description: Returns true if the indicated group is a plain group
+//               that we know how to convert, or false if the full
+//               EggLoader is needed.
+//
+//               Besides the special kinds of groups, this rejects
+//               any group with billboards, tags, a blend mode or a
+//               collide mask, even though create_group_arc() would
+//               apply some of these, so that everything the stream
+//               loader builds is covered by the comparison in
+//               test_egg2pg.
+////////////////////////////////////////////////////////////////////
+bool EggStreamLoader::
+check_group(EggGroup *group) const {
+  return (group->get_group_type() == EggGroup::GT_group &&
+          group->get_dart_type() == EggGroup::DT_none &&
+          group->get_cs_type() == EggGroup::CST_none &&
+          !group->get_portal_flag() && !group->get_occluder_flag() &&
+          !group->get_polylight_flag() && !group->get_switch_flag() &&
+          !group->get_decal_flag() && !group->has_scrolling_uvs() &&
+          !group->has_lod() && group->get_num_object_types() == 0 &&
+          group->get_num_group_refs() == 0 &&
+          group->get_billboard_type() == EggGroup::BT_none &&
+          !group->has_billboard_center() &&
+          group->tag_begin() == group->tag_end() &&
+          (group->get_blend_mode() == EggGroup::BM_unspecified ||
+           group->get_blend_mode() == EggGroup::BM_none) &&
+          !group->has_collide_mask() && !group->has_from_collide_mask() &&
+          !group->has_into_collide_mask());
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggStreamLoader::check_groups
+//       Access: Private
+//  Description: Returns true if all of the groups at and below the
+//               indicated node are plain groups that we know how to
+//               convert, or false if the full EggLoader is needed.
+////////////////////////////////////////////////////////////////////
+bool EggStreamLoader::
+check_groups(EggGroupNode *egg_group) const {
+  EggGroupNode::const_iterator ci;
+  for (ci = egg_group->begin(); ci != egg_group->end(); ++ci) {
+    EggNode *child = (*ci);
+    if (child->is_of_type(EggGroup::get_class_type())) {
+      EggGroup *group = DCAST(EggGroup, child);
+      if (!check_group(group) || !check_groups(group)) {
+        return false;
+      }
+
+    } else if (!child->is_of_type(EggPolygon::get_class_type()) &&
+               !child->is_of_type(EggVertexPool::get_class_type()) &&
+               !child->is_of_type(EggTexture::get_class_type()) &&
+               !child->is_of_type(EggMaterial::get_class_type()) &&
+               !child->is_of_type(EggComment::get_class_type()) &&
+               !child->is_of_type(EggCoordinateSystem::get_class_type())) {
+      // Tables, external references and the like.
+      return false;
+    }
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggStreamLoader::make_node
+//       Access: Private
+//  Description: Creates the node for a group, as
+//               EggLoader::make_node() does for the kinds of groups
+//               that check_groups() allows.
+////////////////////////////////////////////////////////////////////
+void EggStreamLoader::
+make_node(EggGroup *egg_group, PandaNode *parent) {
+  PT(PandaNode) node;
+
+  if (egg_group->get_model_flag() || egg_group->has_dcs_type()) {
+    node = _loader.make_model_node(egg_group);
+
+  } else {
+    // If all of the children of this group are polysets, create a
+    // single GeomNode for all of them.
+    bool all_polysets = false;
+    bool any_hidden = false;
+    BinsByParent::const_iterator bpi = _bins_by_parent.find(egg_group);
+    if (bpi != _bins_by_parent.end()) {
+      all_polysets = true;
+      EggGroup::const_iterator ci;
+      for (ci = egg_group->begin(); ci != egg_group->end(); ++ci) {
+        if ((*ci)->is_of_type(EggGroup::get_class_type())) {
+          all_polysets = false;
+          break;
+        }
+      }
+      Bins::const_iterator bi;
+      for (bi = (*bpi).second.begin(); bi != (*bpi).second.end(); ++bi) {
+        any_hidden = any_hidden || (*bi)->_render_state->_hidden;
+      }
+    }
+
+    if (all_polysets && !any_hidden) {
+      node = new GeomNode(egg_group->get_name());
+    } else {
+      node = new PandaNode(egg_group->get_name());
+    }
+  }
+
+  EggGroup::const_iterator ci;
+  for (ci = egg_group->begin(); ci != egg_group->end(); ++ci) {
+    if ((*ci)->is_of_type(EggGroup::get_class_type())) {
+      make_node(DCAST(EggGroup, *ci), node);
+    }
+  }
+  make_bins(egg_group, node);
+
+  _loader._groups[egg_group] = node;
+  _loader.create_group_arc(egg_group, parent, node);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggStreamLoader::make_bins
+//       Access: Private
+//  Description: Creates the geometry for all of the bins of polygons
+//               directly within the indicated group.
+////////////////////////////////////////////////////////////////////
+void EggStreamLoader::
+make_bins(EggGroupNode *egg_group, PandaNode *parent) {
+  BinsByParent::iterator bpi = _bins_by_parent.find(egg_group);
+  if (bpi != _bins_by_parent.end()) {
+    Bins::iterator bi;
+    for (bi = (*bpi).second.begin(); bi != (*bpi).second.end(); ++bi) {
+      make_polyset(*bi, parent);
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggStreamLoader::make_polyset
+//       Access: Private
+//  Description: Triangulates the polygons of the bin and writes them
+//               into one or more Geoms, which are added to a
+//               GeomNode under the indicated parent.
+////////////////////////////////////////////////////////////////////
+void EggStreamLoader::
+make_polyset(Bin *bin, PandaNode *parent) {
+  const EggRenderState *render_state = bin->_render_state;
+  if (render_state->_hidden && egg_suppress_hidden) {
+    return;
+  }
+
+  // The uv columns are in order by name, as in
+  // EggVertexPool::get_uv_names().
+  pvector<string> uv_names;
+  for (int slot = 0; slot < (int)_uv_names.size(); ++slot) {
+    if ((bin->_uv_bits & (1 << slot)) != 0) {
+      uv_names.push_back(_uv_names[slot]);
+    }
+  }
+  sort(uv_names.begin(), uv_names.end());
+
+  pvector<int> uv_slots;
+  pvector<const LMatrix4d *> uv_mats;
+  pvector<string>::const_iterator ni;
+  for (ni = uv_names.begin(); ni != uv_names.end(); ++ni) {
+    uv_slots.push_back((*_uv_slots.find(*ni)).second);
+
+    CPT(InternalName) iname = InternalName::get_texcoord_name(*ni);
+    EggRenderState::BakeInUVs::const_iterator buv =
+      render_state->_bake_in_uvs.find(iname);
+    if (buv != render_state->_bake_in_uvs.end()) {
+      uv_mats.push_back(&(*buv).second->get_transform3d());
+    } else {
+      uv_mats.push_back((const LMatrix4d *)NULL);
+    }
+  }
+
+  // The vertices are converted from the file's coordinate system,
+  // then into the space of the node.
+  LMatrix4d mat = _cs_mat * bin->_parent->get_vertex_to_node();
+
+  bool has_normal = bin->_any_normal;
+  int row_width = 3 + (has_normal ? 3 : 0) + 4 + 2 * (int)uv_names.size();
+  RowTable rows(row_width);
+  pvector<PN_stdfloat> row(row_width);
+  pvector<int> indices;
+  pvector<int> prim_rows;
+  GeomNode *geom_node = NULL;
+
+  pvector<StreamPrim>::const_iterator pi;
+  for (pi = bin->_prims.begin(); pi != bin->_prims.end(); ++pi) {
+    const StreamPrim &prim = (*pi);
+    if (rows.get_num_rows() + prim._num_vertices > egg_max_vertices &&
+        !indices.empty()) {
+      // Keep each GeomVertexData within egg_max_vertices.
+      make_geom(bin, uv_names, rows, indices, geom_node, parent);
+      rows.clear();
+      indices.clear();
+    }
+
+    prim_rows.clear();
+    for (int i = 0; i < prim._num_vertices; ++i) {
+      int vi = ((prim._flags & PF_reversed) != 0) ?
+        prim._num_vertices - 1 - i : i;
+      int index = bin->_indices[prim._first_index + vi];
+      fill_row(&row[0], prim, prim._pool->_vertices[index], index, mat,
+               uv_slots, uv_mats, has_normal);
+      prim_rows.push_back(rows.add_row(&row[0]));
+    }
+
+    // The polygon is known to be convex, so we can make a fan of it.
+    for (int i = 1; i + 1 < prim._num_vertices; ++i) {
+      indices.push_back(prim_rows[0]);
+      indices.push_back(prim_rows[i]);
+      indices.push_back(prim_rows[i + 1]);
+    }
+  }
+
+  if (!indices.empty()) {
+    make_geom(bin, uv_names, rows, indices, geom_node, parent);
+  }
+  Thread::consider_yield();
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggStreamLoader::make_geom
+//       Access: Private
+//  Description: Creates a Geom from the rows and triangles collected
+//               for a bin, and adds it to geom_node, creating that
+//               first if it is NULL.
+////////////////////////////////////////////////////////////////////
+void EggStreamLoader::
+make_geom(Bin *bin, const pvector<string> &uv_names, const RowTable &rows,
+          const pvector<int> &indices, GeomNode *&geom_node,
+          PandaNode *parent) {
+  const EggRenderState *render_state = bin->_render_state;
+  bool has_normal = bin->_any_normal;
+  int color_column = has_normal ? 6 : 3;
+  int uv_column = color_column + 4;
+  int num_rows = rows.get_num_rows();
+
+  // If all of the rows are the same color, we can leave out the color
+  // column, as EggVertexPool::check_overall_color() allows.
+  bool has_overall_color = egg_flat_colors;
+  const PN_stdfloat *first_color = rows.get_row(0) + color_column;
+  LColor overall_color(first_color[0], first_color[1], first_color[2],
+                       first_color[3]);
+  for (int n = 1; n < num_rows && has_overall_color; ++n) {
+    const PN_stdfloat *color = rows.get_row(n) + color_column;
+    has_overall_color =
+      LColor(color[0], color[1], color[2], color[3]).almost_equal(overall_color);
+  }
+
+  PT(GeomVertexArrayFormat) array_format = new GeomVertexArrayFormat;
+  array_format->add_column
+    (InternalName::get_vertex(), 3, Geom::NT_stdfloat, Geom::C_point);
+  if (has_normal) {
+    array_format->add_column
+      (InternalName::get_normal(), 3, Geom::NT_stdfloat, Geom::C_vector);
+  }
+  if (!has_overall_color) {
+    array_format->add_column
+      (InternalName::get_color(), 1, Geom::NT_packed_dabc, Geom::C_color);
+  }
+  pvector<string>::const_iterator ni;
+  for (ni = uv_names.begin(); ni != uv_names.end(); ++ni) {
+    array_format->add_column
+      (InternalName::get_texcoord_name(*ni), 2, Geom::NT_stdfloat,
+       Geom::C_texcoord);
+  }
+
+  CPT(GeomVertexFormat) format =
+    GeomVertexFormat::register_format(new GeomVertexFormat(array_format));
+
+  string name = _loader._data->get_egg_filename().get_basename_wo_extension();
+  PT(GeomVertexData) vertex_data =
+    new GeomVertexData(name, format, Geom::UH_static);
+  vertex_data->unclean_set_num_rows(num_rows);
+
+  {
+    GeomVertexWriter vertex(vertex_data, InternalName::get_vertex());
+    for (int n = 0; n < num_rows; ++n) {
+      const PN_stdfloat *row = rows.get_row(n);
+      vertex.set_data3(row[0], row[1], row[2]);
+    }
+  }
+  if (has_normal) {
+    GeomVertexWriter normal(vertex_data, InternalName::get_normal());
+    for (int n = 0; n < num_rows; ++n) {
+      const PN_stdfloat *row = rows.get_row(n);
+      normal.set_data3(row[3], row[4], row[5]);
+    }
+  }
+  if (!has_overall_color) {
+    GeomVertexWriter color(vertex_data, InternalName::get_color());
+    for (int n = 0; n < num_rows; ++n) {
+      const PN_stdfloat *row = rows.get_row(n) + color_column;
+      color.set_data4(row[0], row[1], row[2], row[3]);
+    }
+  }
+  for (size_t i = 0; i < uv_names.size(); ++i) {
+    GeomVertexWriter texcoord(vertex_data,
+                              InternalName::get_texcoord_name(uv_names[i]));
+    for (int n = 0; n < num_rows; ++n) {
+      const PN_stdfloat *row = rows.get_row(n) + uv_column + i * 2;
+      texcoord.set_data2(row[0], row[1]);
+    }
+  }
+
+  // Write the triangles directly into the index arrays, keeping each
+  // within egg_max_indices.
+  PT(Geom) geom = new Geom(vertex_data);
+  Geom::NumericType index_type =
+    (num_rows <= 0xffff) ? Geom::NT_uint16 : Geom::NT_uint32;
+  int max_indices = max((int)egg_max_indices / 3 * 3, 3);
+
+  for (size_t first = 0; first < indices.size(); first += max_indices) {
+    int num_indices = min((int)(indices.size() - first), max_indices);
+
+    PT(GeomTriangles) triangles = new GeomTriangles(Geom::UH_static);
+    triangles->set_shade_model(GeomPrimitive::SM_smooth);
+    triangles->set_index_type(index_type);
+
+    PT(GeomVertexArrayData) index_data = triangles->make_index_data();
+    index_data->unclean_set_num_rows(num_indices);
+    {
+      PT(GeomVertexArrayDataHandle) handle = index_data->modify_handle();
+      unsigned char *pointer = handle->get_write_pointer();
+      if (index_type == Geom::NT_uint16) {
+        PN_uint16 *dest = (PN_uint16 *)pointer;
+        for (int i = 0; i < num_indices; ++i) {
+          dest[i] = (PN_uint16)indices[first + i];
+        }
+      } else {
+        PN_uint32 *dest = (PN_uint32 *)pointer;
+        for (int i = 0; i < num_indices; ++i) {
+          dest[i] = (PN_uint32)indices[first + i];
+        }
+      }
+    }
+    triangles->set_vertices(index_data, num_indices);
+    geom->add_primitive(triangles);
+  }
+
+  if (geom_node == (GeomNode *)NULL) {
+    if (parent->is_geom_node() && !render_state->_hidden) {
+      geom_node = DCAST(GeomNode, parent);
+
+    } else {
+      geom_node = new GeomNode(bin->_prototype->get_sort_name());
+      if (render_state->_hidden) {
+        parent->add_stashed(geom_node);
+      } else {
+        parent->add_child(geom_node);
+      }
+    }
+  }
+
+  CPT(RenderState) geom_state = render_state->_state;
+  if (has_overall_color) {
+    if (!overall_color.almost_equal(LColor(1.0f, 1.0f, 1.0f, 1.0f))) {
+      geom_state = geom_state->add_attrib(ColorAttrib::make_flat(overall_color), -1);
+    }
+  } else {
+    geom_state = geom_state->add_attrib(ColorAttrib::make_vertex(), -1);
+  }
+
+  geom_node->add_geom(geom, geom_state);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: EggStreamLoader::fill_row
+//       Access: Private
+//  Description: Computes the vertex row for the indicated vertex of
+//               a polygon: the transformed position, then the normal
+//               if the bin has normals, the color, and the uv's.
+////////////////////////////////////////////////////////////////////
+void EggStreamLoader::
+fill_row(PN_stdfloat *row, const StreamPrim &prim, const StreamVertex &vertex,
+         int index, const LMatrix4d &mat, const pvector<int> &uv_slots,
+         const pvector<const LMatrix4d *> &uv_mats, bool has_normal) const {
+  const PrimAttrib *attrib = NULL;
+  if (prim._attrib >= 0) {
+    attrib = &_prim_attribs[prim._attrib];
+  }
+
+  LPoint3d pos = vertex._pos * mat;
+  row[0] = (PN_stdfloat)pos[0];
+  row[1] = (PN_stdfloat)pos[1];
+  row[2] = (PN_stdfloat)pos[2];
+  row += 3;
+
+  if (has_normal) {
+    LNormald normal = LNormald::zero();
+    if ((vertex._flags & VF_normal) != 0) {
+      normal = vertex._normal;
+    } else if ((prim._flags & PF_normal) != 0) {
+      normal = attrib->_normal;
+    }
+    if ((prim._flags & PF_reversed) != 0) {
+      normal = -normal;
+    }
+    if (normal != LNormald::zero()) {
+      normal = normalize(normal * mat);
+    }
+    row[0] = (PN_stdfloat)normal[0];
+    row[1] = (PN_stdfloat)normal[1];
+    row[2] = (PN_stdfloat)normal[2];
+    row += 3;
+  }
+
+  // The color is the vertex color, or the polygon color, or white, as
+  // after EggPrimitive::unify_attributes().
+  LColorf color(1.0f, 1.0f, 1.0f, 1.0f);
+  if ((vertex._flags & VF_color) != 0) {
+    color = vertex._color;
+  } else if ((prim._flags & PF_color) != 0) {
+    color = attrib->_color;
+  }
+  row[0] = (PN_stdfloat)color[0];
+  row[1] = (PN_stdfloat)color[1];
+  row[2] = (PN_stdfloat)color[2];
+  row[3] = (PN_stdfloat)color[3];
+  row += 4;
+
+  for (size_t i = 0; i < uv_slots.size(); ++i) {
+    int slot = uv_slots[i];
+    LTexCoordd uv = LTexCoordd::zero();
+    if ((vertex._uv_bits & (1 << slot)) != 0) {
+      uv = LCAST(double, prim._pool->_uvs[slot][index]);
+      if (uv_mats[i] != (const LMatrix4d *)NULL) {
+        LTexCoord3d uvw = LTexCoord3d(uv[0], uv[1], 0.0) * (*uv_mats[i]);
+        uv.set(uvw[0], uvw[1]);
+      }
+    }
+    row[0] = (PN_stdfloat)uv[0];
+    row[1] = (PN_stdfloat)uv[1];
+    row += 2;
+  }
+}
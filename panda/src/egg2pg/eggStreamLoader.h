@@ -0,0 +1,235 @@
+// Filename: eggStreamLoader.h
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#ifndef EGGSTREAMLOADER_H
+#define EGGSTREAMLOADER_H
+
+#include "pandabase.h"
+
+#include "eggParserListener.h"
+#include "eggLoader.h"
+#include "eggRenderState.h"
+#include "eggPolygon.h"
+#include "eggRenderMode.h"
+#include "geomNode.h"
+#include "luse.h"
+#include "pointerTo.h"
+#include "pvector.h"
+#include "pmap.h"
+
+////////////////////////////////////////////////////////////////////
+//       Class : EggStreamLoader
+// Description : Loads the common case of an egg file--static polygons
+//               in plain groups--directly into GeomVertexData
+//               tables, without ever building the EggVertex and
+//               EggPolygon objects for the whole file.
+//
+//               The file is read with an EggParser that hands each
+//               vertex and polygon to this object as it is read.  The
+//               vertices are kept in a compact array per vertex pool,
+//               and the polygons are sorted by render state into bins
+//               as they arrive, one bin per state within each group.
+//               Afterwards, each bin's polygons are triangulated and
+//               their vertex rows written straight into a new
+//               GeomVertexData, with identical rows shared through a
+//               hash table.
+//
+//               The groups, textures and materials are still read
+//               into the EggLoader's EggData as usual, and the
+//               EggLoader is used to load the textures and compute
+//               the render states.  One EggPolygon without vertices
+//               is kept in each bin to stand in for all of the bin's
+//               polygons when the render state is computed.
+//
+//               If the file uses anything this class does not handle
+//               (animation, collision geometry, LOD's, switches,
+//               instances, decals, NURBS, concave polygons, and so
+//               on), load() returns R_unsupported and the file must
+//               be loaded again with EggLoader::build_graph().
+//
+//               This class isn't exported from this package.
+////////////////////////////////////////////////////////////////////
+class EggStreamLoader : public EggParserListener {
+public:
+  EggStreamLoader(EggLoader &loader);
+  virtual ~EggStreamLoader();
+
+  enum Result {
+    R_loaded,
+    R_error,
+    R_unsupported
+  };
+
+  static bool is_enabled();
+  Result load(istream &in);
+
+  virtual bool vertex_read(EggVertexPool *pool, int index,
+                           EggVertex *vertex);
+  virtual bool primitive_read(EggGroupNode *parent, EggPrimitive *prim,
+                              EggVertexPool *pool,
+                              const pvector<int> &indices);
+  virtual void read_stopped();
+
+private:
+  enum VertexFlags {
+    VF_defined = 0x01,
+    VF_normal  = 0x02,
+    VF_color   = 0x04
+  };
+
+  // A vertex as read from a vertex pool.  The bits of _uv_bits
+  // indicate which of the named uv sets the vertex has.
+  class StreamVertex {
+  public:
+    INLINE StreamVertex();
+
+    LPoint3d _pos;
+    LNormald _normal;
+    LColorf _color;
+    unsigned short _flags;
+    unsigned short _uv_bits;
+  };
+
+  // The vertices of one vertex pool, indexed by vertex number.  The
+  // uv's are kept in a separate array for each uv name, since few
+  // vertices have more than one.
+  class StreamPool {
+  public:
+    pvector<StreamVertex> _vertices;
+    pvector< pvector<LTexCoordf> > _uvs;
+  };
+  typedef pmap<EggVertexPool *, StreamPool> StreamPools;
+
+  enum PrimFlags {
+    PF_normal   = 0x01,
+    PF_color    = 0x02,
+    PF_reversed = 0x04
+  };
+
+  // One polygon, whose vertex numbers are stored in its bin's
+  // _indices.  The polygon's own normal and color are kept here
+  // only when it has them, since they are folded into the vertices
+  // that don't.
+  class StreamPrim {
+  public:
+    StreamPool *_pool;
+    int _first_index;
+    int _num_vertices;
+    int _attrib;
+    int _flags;
+  };
+
+  class PrimAttrib {
+  public:
+    LNormald _normal;
+    LColorf _color;
+  };
+
+  // The polygons within one group that share a render state.
+  class Bin {
+  public:
+    EggGroupNode *_parent;
+    PT(EggPolygon) _prototype;
+    PT(EggRenderState) _render_state;
+    pvector<StreamPrim> _prims;
+    pvector<int> _indices;
+    unsigned int _uv_bits;
+    bool _any_normal;
+  };
+  typedef pvector<Bin *> Bins;
+
+  // The properties of a polygon that determine its bin.
+  class BinKey {
+  public:
+    bool operator < (const BinKey &other) const;
+
+    EggGroupNode *_parent;
+    string _sort_name;
+    pvector<EggTexture *> _textures;
+    EggMaterial *_material;
+    bool _bface;
+    bool _implicit_alpha;
+    EggRenderMode _render_mode;
+  };
+  typedef pmap<BinKey, Bin *> BinsByKey;
+  typedef pmap<EggGroupNode *, Bins> BinsByParent;
+
+  // The rows of the GeomVertexData being built for a bin, with a
+  // hash table to find a row with the same values.
+  class RowTable {
+  public:
+    RowTable(int row_width);
+
+    int add_row(const PN_stdfloat *row);
+    INLINE int get_num_rows() const;
+    INLINE const PN_stdfloat *get_row(int n) const;
+    void clear();
+
+  private:
+    size_t hash_row(const PN_stdfloat *row) const;
+    void grow();
+
+    int _row_width;
+    pvector<PN_stdfloat> _values;
+    pvector<int> _table;
+    int _num_rows;
+  };
+
+  Bin *get_bin(EggGroupNode *parent, EggPrimitive *prim,
+               bool bface, bool implicit_alpha);
+  int get_prim_attrib(EggPrimitive *prim);
+  int check_convex(const StreamPool &pool, const int *indices,
+                   int num_vertices) const;
+
+  bool check_group(EggGroup *group) const;
+  bool check_groups(EggGroupNode *egg_group) const;
+  void make_node(EggGroup *egg_group, PandaNode *parent);
+  void make_bins(EggGroupNode *egg_group, PandaNode *parent);
+  void make_polyset(Bin *bin, PandaNode *parent);
+  void make_geom(Bin *bin, const pvector<string> &uv_names,
+                 const RowTable &rows, const pvector<int> &indices,
+                 GeomNode *&geom_node, PandaNode *parent);
+  void fill_row(PN_stdfloat *row, const StreamPrim &prim,
+                const StreamVertex &vertex, int index,
+                const LMatrix4d &mat, const pvector<int> &uv_slots,
+                const pvector<const LMatrix4d *> &uv_mats,
+                bool has_normal) const;
+
+private:
+  EggLoader &_loader;
+  StreamPools _pools;
+  EggVertexPool *_last_pool;
+  StreamPool *_last_stream_pool;
+
+  pvector<string> _uv_names;
+  pmap<string, int> _uv_slots;
+
+  Bins _bins;
+  BinsByKey _bins_by_key;
+  BinsByParent _bins_by_parent;
+  EggGroupNode *_last_parent;
+  BinKey _key;
+  const BinKey *_last_key;
+  Bin *_last_bin;
+  pvector<int> _clean_indices;
+
+  pvector<PrimAttrib> _prim_attribs;
+  LMatrix4d _cs_mat;
+  bool _convert_cs;
+  bool _unsupported;
+};
+
+#include "eggStreamLoader.I"
+
+#endif
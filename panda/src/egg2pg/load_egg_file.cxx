@@ -14,18 +14,16 @@
 
 #include "load_egg_file.h"
 #include "eggLoader.h"
+#include "eggStreamLoader.h"
 #include "config_egg2pg.h"
 #include "sceneGraphReducer.h"
+#include "lodGenerator.h"
 #include "virtualFileSystem.h"
 #include "config_util.h"
 #include "bamCacheRecord.h"
 
 static PT(PandaNode)
-load_from_loader(EggLoader &loader) {
-  loader._data->load_externals(DSearchPath(), loader._record);
-
-  loader.build_graph();
-
+finish_loader(EggLoader &loader) {
   if (loader._error && !egg_accept_errors) {
     egg2pg_cat.error()
       << "Errors in egg file.\n";
@@ -61,9 +59,54 @@ load_from_loader(EggLoader &loader) {
     }
   }
 
+  if (loader._root != (PandaNode *)NULL && egg_generate_lods > 0) {
+    LODGenerator generator;
+    generator.set_min_triangles(egg_generate_lods);
+    int num_generated = generator.generate(loader._root);
+    if (egg2pg_cat.is_debug()) {
+      egg2pg_cat.debug()
+        << "Generated levels of detail for " << num_generated
+        << " GeomNodes.\n";
+    }
+  }
+
+  if (loader._root != (PandaNode *)NULL && egg_optimize_vertex_cache) {
+    SceneGraphReducer gr;
+    gr.optimize_vertex_cache(loader._root);
+    if (egg2pg_cat.is_debug()) {
+      egg2pg_cat.debug() << "Optimized for the vertex cache.\n";
+    }
+  }
+
+  if (loader._root != (PandaNode *)NULL && egg_quantize_vertices != 0) {
+    SceneGraphReducer gr;
+    Geom::NumericType numeric_type = Geom::NT_uint16;
+    if (egg_quantize_vertices == 8) {
+      numeric_type = Geom::NT_uint8;
+    } else if (egg_quantize_vertices != 16) {
+      egg2pg_cat.warning()
+        << "Ignoring invalid egg-quantize-vertices " << egg_quantize_vertices
+        << "; using 16.\n";
+    }
+    int num_quantized = gr.quantize_vertices(loader._root, numeric_type);
+    if (egg2pg_cat.is_debug()) {
+      egg2pg_cat.debug()
+        << "Quantized vertices of " << num_quantized << " GeomNodes.\n";
+    }
+  }
+
   return loader._root;
 }
 
+static PT(PandaNode)
+load_from_loader(EggLoader &loader) {
+  loader._data->load_externals(DSearchPath(), loader._record);
+
+  loader.build_graph();
+
+  return finish_loader(loader);
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: load_egg_file
 //  Description: A convenience function.  Loads up the indicated egg
@@ -108,6 +151,35 @@ load_egg_file(const Filename &filename, CoordinateSystem cs,
   egg2pg_cat.info()
     << "Reading " << egg_filename << "\n";
 
+  if (EggStreamLoader::is_enabled()) {
+    // Try to convert the geometry as it is read.  If the file turns
+    // out to need more than the stream loader can do, we have to go
+    // back and read it again the usual way.
+    EggStreamLoader stream_loader(loader);
+    EggStreamLoader::Result result = stream_loader.load(*istr);
+    vfile->close_read_file(istr);
+
+    if (result == EggStreamLoader::R_loaded) {
+      return finish_loader(loader);
+
+    } else if (result == EggStreamLoader::R_error) {
+      egg2pg_cat.error()
+        << "Error reading " << egg_filename << "\n";
+      return NULL;
+    }
+
+    if (egg2pg_cat.is_debug()) {
+      egg2pg_cat.debug()
+        << "Reading " << egg_filename << " again to load it fully.\n";
+    }
+    istr = vfile->open_read_file(true);
+    if (istr == (istream *)NULL) {
+      egg2pg_cat.error()
+        << "Couldn't read " << egg_filename << "\n";
+      return NULL;
+    }
+  }
+
   okflag = loader._data->read(*istr);
   vfile->close_read_file(istr);
 
@@ -1,6 +1,7 @@
 #include "eggBinner.cxx"
 #include "eggLoader.cxx"
 #include "eggSaver.cxx"
+#include "eggStreamLoader.cxx"
 #include "load_egg_file.cxx"
 #include "save_egg_file.cxx"
 #include "loaderFileTypeEgg.cxx"
@@ -0,0 +1,222 @@
+// Filename: test_egg2pg.cxx
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "pandabase.h"
+#include "load_egg_file.h"
+#include "config_egg2pg.h"
+#include "pandaNode.h"
+#include "geomNode.h"
+#include "geom.h"
+#include "geomPrimitive.h"
+#include "geomVertexData.h"
+#include "geomVertexFormat.h"
+#include "geomVertexReader.h"
+#include "internalName.h"
+#include "indent.h"
+#include "pvector.h"
+#include "pnotify.h"
+
+#include <algorithm>
+
+////////////////////////////////////////////////////////////////////
+//     Function: name_less
+//  Description: Orders column names alphabetically.
+////////////////////////////////////////////////////////////////////
+static bool
+name_less(const InternalName *a, const InternalName *b) {
+  return a->get_name() < b->get_name();
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: write_vertex
+//  Description: Writes all of the columns of the indicated vertex,
+//               in order by name, so that the result does not depend
+//               on how the columns are packed.
+////////////////////////////////////////////////////////////////////
+static void
+write_vertex(ostream &out, const GeomVertexData *data, int vertex,
+             const pvector<const InternalName *> &names) {
+  pvector<const InternalName *>::const_iterator ni;
+  for (ni = names.begin(); ni != names.end(); ++ni) {
+    GeomVertexReader reader(data, *ni);
+    reader.set_row_unsafe(vertex);
+    LVecBase4 value = reader.get_data4();
+    out << " " << (*ni)->get_name() << " " << value;
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: write_geom
+//  Description: Writes a summary of the triangles of the indicated
+//               Geom: their total area, and the distinct vertices
+//               they use, in sorted order.  This does not depend on
+//               how the polygons were triangulated, stripped or
+//               ordered, which the two loaders do differently; the
+//               number of triangles may differ too, when a polygon
+//               has collinear vertices, so triangles with no area
+//               are skipped.  The values are written to four digits,
+//               since the two loaders may round differently in the
+//               last place.
+////////////////////////////////////////////////////////////////////
+static void
+write_geom(ostream &out, const Geom *geom, int indent_level) {
+  CPT(GeomVertexData) data = geom->get_vertex_data();
+  const GeomVertexFormat *format = data->get_format();
+
+  pvector<const InternalName *> names;
+  for (int ai = 0; ai < format->get_num_arrays(); ++ai) {
+    const GeomVertexArrayFormat *array = format->get_array(ai);
+    for (int ci = 0; ci < array->get_num_columns(); ++ci) {
+      names.push_back(array->get_column(ci)->get_name());
+    }
+  }
+  sort(names.begin(), names.end(), &name_less);
+
+  GeomVertexReader vertex(data, InternalName::get_vertex());
+  double area = 0.0;
+  pvector<string> vertices;
+  for (int pi = 0; pi < geom->get_num_primitives(); ++pi) {
+    CPT(GeomPrimitive) prim = geom->get_primitive(pi)->decompose();
+    for (int i = 0; i < prim->get_num_primitives(); ++i) {
+      int start = prim->get_primitive_start(i);
+      int num_vertices = prim->get_primitive_num_vertices(i);
+      if (num_vertices != 3) {
+        continue;
+      }
+
+      LPoint3 points[3];
+      for (int vi = 0; vi < 3; ++vi) {
+        vertex.set_row_unsafe(prim->get_vertex(start + vi));
+        points[vi] = vertex.get_data3();
+      }
+      double tri_area = cross(points[1] - points[0], points[2] - points[0]).length() * 0.5;
+      if (tri_area < 1.0e-6) {
+        continue;
+      }
+      area += tri_area;
+
+      for (int vi = 0; vi < 3; ++vi) {
+        ostringstream strm;
+        strm.precision(4);
+        write_vertex(strm, data, prim->get_vertex(start + vi), names);
+        vertices.push_back(strm.str());
+      }
+    }
+  }
+  sort(vertices.begin(), vertices.end());
+  vertices.erase(unique(vertices.begin(), vertices.end()), vertices.end());
+
+  out.precision(4);
+  indent(out, indent_level)
+    << "area " << area << "\n";
+  pvector<string>::const_iterator vi;
+  for (vi = vertices.begin(); vi != vertices.end(); ++vi) {
+    indent(out, indent_level) << "vertex" << (*vi) << "\n";
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: write_graph
+//  Description: Writes the scene graph below the indicated node: the
+//               nodes with their transforms, states, effects and
+//               tags, and the triangles of each Geom.
+////////////////////////////////////////////////////////////////////
+static void
+write_graph(ostream &out, PandaNode *node, int indent_level) {
+  node->PandaNode::write(out, indent_level);
+
+  if (node->is_geom_node()) {
+    GeomNode *geom_node = DCAST(GeomNode, node);
+    for (int gi = 0; gi < geom_node->get_num_geoms(); ++gi) {
+      indent(out, indent_level + 2)
+        << "geom " << *geom_node->get_geom_state(gi) << "\n";
+      write_geom(out, geom_node->get_geom(gi), indent_level + 4);
+    }
+  }
+
+  for (int ci = 0; ci < node->get_num_children(); ++ci) {
+    write_graph(out, node->get_child(ci), indent_level + 2);
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: load_and_write
+//  Description: Loads the indicated egg file with or without the
+//               stream loader, and writes the resulting scene graph
+//               to the indicated string.  Returns true on success.
+////////////////////////////////////////////////////////////////////
+static bool
+load_and_write(const Filename &egg_filename, bool stream, string &result) {
+  egg_stream_load.set_value(stream);
+
+  PT(PandaNode) root = load_egg_file(egg_filename);
+  if (root == (PandaNode *)NULL) {
+    return false;
+  }
+
+  ostringstream strm;
+  write_graph(strm, root, 0);
+  result = strm.str();
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: main
+//  Description: Loads each of the egg files named on the command
+//               line both with the stream loader and with the full
+//               EggLoader, and checks that they produce the same
+//               scene graph: the same nodes, with the same
+//               attributes, and the same geometry.
+////////////////////////////////////////////////////////////////////
+int
+main(int argc, char *argv[]) {
+  if (argc < 2) {
+    nout << "Specify one or more egg files to load.\n";
+    return 1;
+  }
+
+  int num_failed = 0;
+  for (int i = 1; i < argc; ++i) {
+    Filename egg_filename = Filename::from_os_specific(argv[i]);
+    string stream_result, full_result;
+    bool stream_ok = load_and_write(egg_filename, true, stream_result);
+    bool full_ok = load_and_write(egg_filename, false, full_result);
+
+    if (!stream_ok || !full_ok) {
+      nout << egg_filename << ": failed to load "
+           << (stream_ok ? "without" : "with") << " the stream loader.\n";
+      ++num_failed;
+
+    } else if (stream_result != full_result) {
+      // Report the first line that differs.
+      size_t p = 0;
+      while (p < stream_result.size() && p < full_result.size() &&
+             stream_result[p] == full_result[p]) {
+        ++p;
+      }
+      size_t line_start = stream_result.rfind('\n', p);
+      line_start = (line_start == string::npos) ? 0 : line_start + 1;
+      nout << egg_filename << ": scene graphs differ:\n"
+           << "  stream: " << stream_result.substr(line_start, stream_result.find('\n', p) - line_start) << "\n"
+           << "  full:   " << full_result.substr(line_start, full_result.find('\n', p) - line_start) << "\n";
+      ++num_failed;
+
+    } else {
+      nout << egg_filename << ": ok\n";
+    }
+  }
+
+  nout << argc - 1 - num_failed << " of " << argc - 1 << " files match.\n";
+  return (num_failed == 0) ? 0 : 1;
+}
@@ -21,6 +21,7 @@
     pointerEvent.I pointerEvent.h \
     pointerEventList.I pointerEventList.h \
     pythonTask.h pythonTask.I \
+    rangeAsyncTask.h rangeAsyncTask.I \
     event.I event.h eventHandler.h eventHandler.I \
     eventParameter.I eventParameter.h \
     eventQueue.I eventQueue.h eventReceiver.h \
@@ -39,6 +40,7 @@
     pointerEvent.cxx \
     pointerEventList.cxx \
     pythonTask.cxx \
+    rangeAsyncTask.cxx \
     config_event.cxx event.cxx eventHandler.cxx \ 
     eventParameter.cxx eventQueue.cxx eventReceiver.cxx \
     pt_Event.cxx
@@ -56,6 +58,7 @@
     pointerEvent.I pointerEvent.h \
     pointerEventList.I pointerEventList.h \
     pythonTask.h pythonTask.I \
+    rangeAsyncTask.h rangeAsyncTask.I \
     event.I event.h eventHandler.h eventHandler.I \
     eventParameter.I eventParameter.h \
     eventQueue.I eventQueue.h eventReceiver.h \
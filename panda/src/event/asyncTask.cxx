@@ -18,6 +18,7 @@
 #include "pt_Event.h"
 #include "throw_event.h"
 #include "eventParameter.h"
+#include "pset.h"
 
 AtomicAdjust::Integer AsyncTask::_next_task_id;
 PStatCollector AsyncTask::_show_code_pcollector("App:Show code");
@@ -34,8 +35,12 @@ AsyncTask(const string &name) :
   _delay(0.0),
   _has_delay(false),
   _wake_time(0.0),
+  _sleep_index(-1),
   _sort(0),
   _priority(0),
+  _num_dependencies(0),
+  _waiting_index(-1),
+  _finished(false),
   _state(S_inactive),
   _servicing_thread(NULL),
   _manager(NULL),
@@ -140,8 +145,7 @@ recalc_wake_time() {
       _wake_time = now + _delay;
       _start_time = _wake_time;
 
-      make_heap(_chain->_sleeping.begin(), _chain->_sleeping.end(), 
-                AsyncTaskChain::AsyncTaskSortWakeTime());
+      _chain->update_sleeping(this);
     }
   }
 }
@@ -278,7 +282,7 @@ set_task_chain(const string &chain_name) {
   if (chain_name != _chain_name) {
     if (_manager != (AsyncTaskManager *)NULL) {
       MutexHolder holder(_manager->_lock);
-      if (_state == S_active) {
+      if (_state == S_active || _state == S_waiting) {
         // Changing chains on an "active" (i.e. enqueued) task means
         // removing it and re-inserting it into the queue.
         PT(AsyncTask) hold_task = this;
@@ -400,6 +404,55 @@ set_priority(int priority) {
   }
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: AsyncTask::add_dependency
+//       Access: Published
+//  Description: Specifies that this task may not begin to run until
+//               the indicated prerequisite task has finished.  If
+//               this task is added to the AsyncTaskManager before all
+//               of its prerequisites have finished, it is held in the
+//               S_waiting state, and becomes active (or begins its
+//               delay, if it has one) as soon as the last of them is
+//               removed from the manager, whether it exits normally
+//               or is removed explicitly.
+//
+//               This must be called before this task is added to the
+//               manager.  The prerequisite may be a task that has not
+//               yet been added, or one that is currently active; if
+//               it has already been added and removed again, the
+//               dependency is already satisfied and this call has no
+//               effect.  Both tasks should belong to the same
+//               AsyncTaskManager, though they may be on different
+//               task chains.
+//
+//               Dependencies are one-shot: once satisfied, they are
+//               forgotten, and will not affect the task if it is
+//               added again later.
+//
+//               It is an error to make a cycle of dependencies, such
+//               as A depending on B while B depends on A; the tasks
+//               would wait for each other forever.
+////////////////////////////////////////////////////////////////////
+void AsyncTask::
+add_dependency(AsyncTask *prerequisite) {
+  nassertv(prerequisite != this);
+  nassertv(_state == S_inactive);
+
+  AsyncTaskManager *manager = prerequisite->_manager;
+  if (manager != (AsyncTaskManager *)NULL) {
+    MutexHolder holder(manager->_lock);
+    if (!prerequisite->_finished) {
+      nassertv(!has_dependent(prerequisite));
+      prerequisite->_dependents.push_back(this);
+      ++_num_dependencies;
+    }
+  } else if (!prerequisite->_finished) {
+    nassertv(!has_dependent(prerequisite));
+    prerequisite->_dependents.push_back(this);
+    ++_num_dependencies;
+  }
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: AsyncTask::output
 //       Access: Published, Virtual
@@ -443,12 +496,36 @@ unlock_and_do_task() {
   nassertr(_manager != (AsyncTaskManager *)NULL, DS_done);
   PT(ClockObject) clock = _manager->get_clock();
 
-  Thread *current_thread = Thread::get_current_thread();
-  record_task(current_thread);
-
   // It's important to release the lock while the task is being
   // serviced.
   _manager->_lock.release();
+  DoneStatus status = do_task_unlocked(clock);
+
+  // Now reacquire the lock (so we can return with the lock held).
+  _manager->_lock.acquire();
+
+  _chain->_time_in_frame += _dt;
+
+  return status;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: AsyncTask::do_task_unlocked
+//       Access: Protected
+//  Description: Runs the task and records its timing statistics.
+//               This is called with the lock *not* held, either by
+//               unlock_and_do_task(), or directly by an
+//               AsyncTaskChain in work stealing mode.
+//
+//               Unlike unlock_and_do_task(), this does not charge the
+//               elapsed time against the chain's frame budget; the
+//               caller is responsible for that once it holds the
+//               lock again.
+////////////////////////////////////////////////////////////////////
+AsyncTask::DoneStatus AsyncTask::
+do_task_unlocked(ClockObject *clock) {
+  Thread *current_thread = Thread::get_current_thread();
+  record_task(current_thread);
 
   double start = clock->get_real_time();
   _task_pcollector.start();
@@ -456,20 +533,81 @@ unlock_and_do_task() {
   _task_pcollector.stop();
   double end = clock->get_real_time();
 
-  // Now reacquire the lock (so we can return with the lock held).
-  _manager->_lock.acquire();
-
   _dt = end - start;
   _max_dt = max(_dt, _max_dt);
   _total_dt += _dt;
 
-  _chain->_time_in_frame += _dt;
-
   clear_task(current_thread);
 
   return status;
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: AsyncTask::has_dependent
+//       Access: Protected
+//  Description: Returns true if the indicated task is waiting on
+//               this one, directly or through any chain of other
+//               dependencies.  Used by add_dependency() to refuse a
+//               dependency that would make a cycle.  Assumes the
+//               manager's lock is held, if there is a manager.
+////////////////////////////////////////////////////////////////////
+bool AsyncTask::
+has_dependent(AsyncTask *task) const {
+  // Walk the graph of dependents, visiting each task only once,
+  // since several paths may lead to the same task.
+  pset<const AsyncTask *> visited;
+  pvector<const AsyncTask *> pending;
+  pending.push_back(this);
+  visited.insert(this);
+
+  while (!pending.empty()) {
+    const AsyncTask *next = pending.back();
+    pending.pop_back();
+
+    Dependents::const_iterator di;
+    for (di = next->_dependents.begin(); di != next->_dependents.end(); ++di) {
+      const AsyncTask *dependent = (*di);
+      if (dependent == task) {
+        return true;
+      }
+      if (visited.insert(dependent).second) {
+        pending.push_back(dependent);
+      }
+    }
+  }
+
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: AsyncTask::release_dependents
+//       Access: Protected
+//  Description: Called when this task is removed from its manager,
+//               to inform each of the tasks that named it in
+//               add_dependency() that it has finished.  Any of those
+//               tasks that are no longer waiting for anything are
+//               moved to the active (or sleeping) queue of their
+//               chain.  Assumes the lock is held.
+////////////////////////////////////////////////////////////////////
+void AsyncTask::
+release_dependents() {
+  _finished = true;
+
+  Dependents dependents;
+  dependents.swap(_dependents);
+
+  Dependents::iterator di;
+  for (di = dependents.begin(); di != dependents.end(); ++di) {
+    AsyncTask *task = (*di);
+    if (task->_num_dependencies > 0) {
+      --(task->_num_dependencies);
+      if (task->_num_dependencies == 0 && task->_state == S_waiting) {
+        task->_chain->do_release_waiting(task);
+      }
+    }
+  }
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: AsyncTask::is_runnable
 //       Access: Protected, Virtual
@@ -32,6 +32,7 @@
 
 class AsyncTaskManager;
 class AsyncTaskChain;
+class ClockObject;
 
 ////////////////////////////////////////////////////////////////////
 //       Class : AsyncTask
@@ -65,6 +66,7 @@ PUBLISHED:
     S_servicing_removed,  // Still servicing, but wants removal from manager.
     S_sleeping,
     S_active_nested,      // active within a sequence.
+    S_waiting,            // waiting for its dependencies to finish.
   };
 
   INLINE State get_state() const;
@@ -100,6 +102,9 @@ PUBLISHED:
   void set_priority(int priority);
   INLINE int get_priority() const;
 
+  void add_dependency(AsyncTask *prerequisite);
+  INLINE int get_num_dependencies() const;
+
   INLINE void set_done_event(const string &done_event);
   INLINE const string &get_done_event() const;
 
@@ -117,6 +122,9 @@ PUBLISHED:
 protected:
   void jump_to_task_chain(AsyncTaskManager *manager);
   DoneStatus unlock_and_do_task();
+  DoneStatus do_task_unlocked(ClockObject *clock);
+  void release_dependents();
+  bool has_dependent(AsyncTask *task) const;
 
   virtual bool is_runnable();
   virtual DoneStatus do_task();
@@ -129,10 +137,22 @@ protected:
   double _delay;
   bool _has_delay;
   double _wake_time;
+  int _sleep_index;
   int _sort;
   int _priority;
   string _done_event;
 
+  // The tasks that are waiting for this one to finish, and the number
+  // of unfinished tasks that this one is waiting for.  _finished is
+  // set when the task is removed from its manager, and cleared again
+  // when it is next added.  _waiting_index is this task's index
+  // within its chain's _waiting list, while it is S_waiting.
+  typedef pvector< PT(AsyncTask) > Dependents;
+  Dependents _dependents;
+  int _num_dependencies;
+  int _waiting_index;
+  bool _finished;
+
   State _state;
   Thread *_servicing_thread;
   AsyncTaskManager *_manager;
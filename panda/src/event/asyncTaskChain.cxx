@@ -29,6 +29,13 @@ TypeHandle AsyncTaskChain::_type_handle;
 PStatCollector AsyncTaskChain::_task_pcollector("Task");
 PStatCollector AsyncTaskChain::_wait_pcollector("Wait");
 
+// The maximum number of tasks a thread in work stealing mode will
+// service before it returns to the chain to retire them.  Larger
+// batches mean less contention on the manager's lock, but a task's
+// completion (and its done event) may be delayed by up to this many
+// other tasks.
+static const int steal_batch_size = 16;
+
 ////////////////////////////////////////////////////////////////////
 //     Function: AsyncTaskChain::Constructor
 //       Access: Published
@@ -41,8 +48,10 @@ AsyncTaskChain(AsyncTaskManager *manager, const string &name) :
   _cvar(manager->_lock),
   _tick_clock(false),
   _timeslice_priority(false),
+  _work_stealing(false),
   _num_threads(0),
   _thread_priority(TP_normal),
+  _num_queued(0),
   _frame_budget(-1.0),
   _frame_sync(false),
   _num_busy_threads(0),
@@ -300,6 +309,54 @@ get_timeslice_priority() const {
   return _timeslice_priority;
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: AsyncTaskChain::set_work_stealing
+//       Access: Published
+//  Description: Sets the work_stealing flag.  This changes the way
+//               the chain's threads find their tasks; it has no
+//               effect on a chain with no threads.
+//
+//               When this flag is false (the default), all of the
+//               threads take their tasks one at a time from the
+//               chain's single active queue, which is protected by
+//               the AsyncTaskManager's lock.  With many threads and
+//               many short tasks, this lock becomes a bottleneck.
+//
+//               When this flag is true, all of the tasks of the
+//               current sort value are dealt out, in priority order,
+//               to a queue owned by each thread.  Each thread takes
+//               tasks from the front of its own queue, and when that
+//               is empty, from the front of another thread's queue,
+//               without holding the manager's lock; it only returns
+//               to the lock to retire a batch of finished tasks.
+//
+//               In either mode, tasks of different sort values never
+//               run at the same time, and the frame_budget and
+//               frame_sync settings are still honored.  Within a
+//               sort value, the priority order is necessarily only
+//               approximate when there is more than one thread.
+////////////////////////////////////////////////////////////////////
+void AsyncTaskChain::
+set_work_stealing(bool work_stealing) {
+  MutexHolder holder(_manager->_lock);
+  if (_work_stealing != work_stealing) {
+    reclaim_queued_tasks();
+    _work_stealing = work_stealing;
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: AsyncTaskChain::get_work_stealing
+//       Access: Published
+//  Description: Returns the work_stealing flag.  See
+//               set_work_stealing().
+////////////////////////////////////////////////////////////////////
+bool AsyncTaskChain::
+get_work_stealing() const {
+  MutexHolder holder(_manager->_lock);
+  return _work_stealing;
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: AsyncTaskChain::stop_threads
 //       Access: Published
@@ -409,9 +466,9 @@ get_active_tasks() const {
 ////////////////////////////////////////////////////////////////////
 //     Function: AsyncTaskChain::get_sleeping_tasks
 //       Access: Published
-//  Description: Returns the set of tasks that are sleeping (and not
-//               active) on the task chain, at the time of the
-//               call.
+//  Description: Returns the set of tasks that are sleeping, or
+//               waiting for their dependencies (and not active) on
+//               the task chain, at the time of the call.
 ////////////////////////////////////////////////////////////////////
 AsyncTaskCollection AsyncTaskChain::
 get_sleeping_tasks() const {
@@ -451,6 +508,110 @@ get_next_wake_time() const {
   return do_get_next_wake_time();
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: AsyncTaskChain::parallel_for
+//       Access: Public
+//  Description: Splits the half-open range [begin, end) into pieces
+//               of grain_size values each, and adds a RangeAsyncTask
+//               to this chain for each piece, which will call the
+//               indicated function with its piece of the range.  If
+//               the chain has more than one thread, the pieces may
+//               run in parallel.  The function must therefore be
+//               safe to call from several threads at once, for
+//               non-overlapping ranges.
+//
+//               If grain_size is 0 or less, a grain size is chosen
+//               to make about four pieces per thread on the chain.
+//
+//               Each of the new tasks will wait for all of the tasks
+//               in prerequisites to finish before it runs (see
+//               AsyncTask::add_dependency()).  The return value is
+//               the list of new tasks; a task that should run only
+//               after the whole range is finished may be made to
+//               depend on each of these in turn.
+////////////////////////////////////////////////////////////////////
+AsyncTaskCollection AsyncTaskChain::
+parallel_for(const string &name, int begin, int end, int grain_size,
+             RangeAsyncTask::RangeFunc *function, void *user_data,
+             const AsyncTaskCollection &prerequisites) {
+  nassertr(function != NULL && begin <= end, AsyncTaskCollection());
+  return make_range_tasks(name, begin, end, grain_size, function, user_data,
+                          prerequisites, NULL);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: AsyncTaskChain::parallel_for_join
+//       Access: Public
+//  Description: The blocking form of parallel_for().  Splits the
+//               range into pieces and adds them to this chain in the
+//               same way, and then waits for all of them to finish
+//               before returning.
+//
+//               A piece that is removed before it starts, because
+//               the tasks were removed from the manager or the chain
+//               was cleaned up, does not hold up the wait; instead,
+//               its range is run in the calling thread after the
+//               others have finished.  The same is done with all of
+//               the pieces that have not yet started if the chain
+//               has no threads to run them, because it was created
+//               without any or they have been stopped.  Thus, every
+//               value in the range is passed to the function exactly
+//               once.  The return value is the number of pieces that
+//               were run in the calling thread.
+//
+//               If this is called from one of the chain's own
+//               threads, the whole range is run directly, since
+//               waiting on the chain from within it could deadlock.
+////////////////////////////////////////////////////////////////////
+int AsyncTaskChain::
+parallel_for_join(const string &name, int begin, int end, int grain_size,
+                  RangeAsyncTask::RangeFunc *function, void *user_data) {
+  nassertr(function != NULL && begin <= end, 0);
+  if (begin == end) {
+    return 0;
+  }
+
+  if (is_chain_thread(Thread::get_current_thread())) {
+    (*function)(begin, end, user_data);
+    return 1;
+  }
+
+  PT(RangeAsyncTask::Join) join = new RangeAsyncTask::Join;
+  AsyncTaskCollection tasks =
+    make_range_tasks(name, begin, end, grain_size, function, user_data,
+                     AsyncTaskCollection(), join);
+
+  // The last piece to finish wakes us up.  If there is no thread to
+  // run the pieces, now or after the threads are stopped while we
+  // wait, we cancel them instead, and run them ourselves below.
+  bool no_threads;
+  {
+    MutexHolder holder(_manager->_lock);
+    _joins.push_back(join);
+    no_threads = _threads.empty();
+  }
+  if (no_threads) {
+    _manager->remove(tasks);
+  }
+  while (!join->wait()) {
+    _manager->remove(tasks);
+  }
+  {
+    MutexHolder holder(_manager->_lock);
+    Joins::iterator ji = find(_joins.begin(), _joins.end(), join);
+    nassertr(ji != _joins.end(), 0);
+    _joins.erase(ji);
+  }
+
+  RangeAsyncTask::Join::Ranges cancelled;
+  join->take_cancelled(cancelled);
+  RangeAsyncTask::Join::Ranges::const_iterator ri;
+  for (ri = cancelled.begin(); ri != cancelled.end(); ++ri) {
+    (*function)((*ri).first, (*ri).second, user_data);
+  }
+  return (int)cancelled.size();
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: AsyncTaskChain::output
 //       Access: Published, Virtual
@@ -473,6 +634,64 @@ write(ostream &out, int indent_level) const {
   do_write(out, indent_level);
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: AsyncTaskChain::make_range_tasks
+//       Access: Protected
+//  Description: The implementation of parallel_for() and
+//               parallel_for_join().  Each new task reports to the
+//               indicated Join, if it is not NULL.  The lock is not
+//               held.
+////////////////////////////////////////////////////////////////////
+AsyncTaskCollection AsyncTaskChain::
+make_range_tasks(const string &name, int begin, int end, int grain_size,
+                 RangeAsyncTask::RangeFunc *function, void *user_data,
+                 const AsyncTaskCollection &prerequisites,
+                 RangeAsyncTask::Join *join) {
+  AsyncTaskCollection result;
+
+  if (grain_size <= 0) {
+    int num_pieces = max(get_num_threads(), 1) * 4;
+    grain_size = max((end - begin + num_pieces - 1) / num_pieces, 1);
+  }
+
+  int num_prerequisites = prerequisites.get_num_tasks();
+  while (begin < end) {
+    int piece_end = (end - begin > grain_size) ? begin + grain_size : end;
+    PT(RangeAsyncTask) task = new RangeAsyncTask(name, function, user_data, begin, piece_end, join);
+    task->set_task_chain(get_name());
+    for (int i = 0; i < num_prerequisites; ++i) {
+      task->add_dependency(prerequisites.get_task(i));
+    }
+    result.add_task(task);
+    begin = piece_end;
+  }
+
+  int num_tasks = result.get_num_tasks();
+  for (int i = 0; i < num_tasks; ++i) {
+    _manager->add(result.get_task(i));
+  }
+
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: AsyncTaskChain::is_chain_thread
+//       Access: Protected
+//  Description: Returns true if the indicated thread is one of the
+//               threads servicing this chain.  The lock is not held.
+////////////////////////////////////////////////////////////////////
+bool AsyncTaskChain::
+is_chain_thread(Thread *thread) const {
+  MutexHolder holder(_manager->_lock);
+  Threads::const_iterator ti;
+  for (ti = _threads.begin(); ti != _threads.end(); ++ti) {
+    if ((Thread *)(*ti) == thread) {
+      return true;
+    }
+  }
+  return false;
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: AsyncTaskChain::do_add
 //       Access: Protected
@@ -495,20 +714,47 @@ do_add(AsyncTask *task) {
 
   task->_chain = this;
   task->_manager = _manager;
+  task->_finished = false;
+
+  _manager->add_task_by_name(task);
+
+  if (task->_num_dependencies != 0) {
+    // This task can't start until its prerequisites have finished.
+    // Park it on the waiting list until then.
+    task->_state = AsyncTask::S_waiting;
+    add_waiting(task);
+
+  } else {
+    enqueue_task(task);
+  }
+  ++_num_tasks;
+  ++(_manager->_num_tasks);
+  _needs_cleanup = true;
+
+  _cvar.notify_all();
+}
 
+////////////////////////////////////////////////////////////////////
+//     Function: AsyncTaskChain::enqueue_task
+//       Access: Protected
+//  Description: Puts a task that is ready to start onto the sleeping
+//               queue, if it has a delay, or onto the active queue
+//               otherwise.  This is called when the task is added to
+//               the chain, or when its last dependency has finished.
+//               Assumes the lock is already held.
+////////////////////////////////////////////////////////////////////
+void AsyncTaskChain::
+enqueue_task(AsyncTask *task) {
   double now = _manager->_clock->get_frame_time();
   task->_start_time = now;
   task->_start_frame = _manager->_clock->get_frame_count();
 
-  _manager->add_task_by_name(task);
-
   if (task->has_delay()) {
     // This is a deferred task.  Add it to the sleeping queue.
     task->_wake_time = now + task->get_delay();
     task->_start_time = task->_wake_time;
     task->_state = AsyncTask::S_sleeping;
-    _sleeping.push_back(task);
-    push_heap(_sleeping.begin(), _sleeping.end(), AsyncTaskSortWakeTime());
+    add_sleeping(task);
 
   } else {
     // This is an active task.  Add it to the active set.
@@ -528,10 +774,28 @@ do_add(AsyncTask *task) {
       _next_active.push_back(task);
     }
   }
-  ++_num_tasks;
-  ++(_manager->_num_tasks);
-  _needs_cleanup = true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: AsyncTaskChain::do_release_waiting
+//       Access: Protected
+//  Description: Called when the last dependency of a task on the
+//               waiting list has finished.  Moves the task to the
+//               active or sleeping queue.  Assumes the lock is
+//               already held.
+////////////////////////////////////////////////////////////////////
+void AsyncTaskChain::
+do_release_waiting(AsyncTask *task) {
+  nassertv(task->_chain == this && task->_state == AsyncTask::S_waiting);
 
+  PT(AsyncTask) hold_task = task;
+  remove_waiting(task);
+
+  if (task_cat.is_spam()) {
+    task_cat.spam()
+      << "Releasing " << *task << " on chain " << get_name() << "\n";
+  }
+  enqueue_task(task);
   _cvar.notify_all();
 }
 
@@ -549,6 +813,16 @@ do_remove(AsyncTask *task) {
 
   nassertr(task->_chain == this, false);
 
+  if (task->_state == AsyncTask::S_active && _work_stealing && !_steal_threads.empty()) {
+    // The task might be waiting on one of the per-thread queues.
+    if (do_remove_queued(task)) {
+      cleanup_task(task, false, false);
+      return true;
+    }
+    // If it wasn't there, a thread may have taken it just now, in
+    // which case its state is now S_servicing.
+  }
+
   switch (task->_state) {
   case AsyncTask::S_servicing:
     // This task is being serviced.
@@ -560,16 +834,18 @@ do_remove(AsyncTask *task) {
     // Being serviced, though it will be removed later.
     break;
     
+  case AsyncTask::S_waiting:
+    // Waiting for its dependencies, also easy.
+    remove_waiting(task);
+    removed = true;
+    cleanup_task(task, false, false);
+    break;
+
   case AsyncTask::S_sleeping:
     // Sleeping, easy.
-    {
-      int index = find_task_on_heap(_sleeping, task);
-      nassertr(index != -1, false);
-      _sleeping.erase(_sleeping.begin() + index);
-      make_heap(_sleeping.begin(), _sleeping.end(), AsyncTaskSortWakeTime());
-      removed = true;
-      cleanup_task(task, false, false);
-    }
+    remove_sleeping(task);
+    removed = true;
+    cleanup_task(task, false, false);
     break;
     
   case AsyncTask::S_active:
@@ -677,10 +953,24 @@ do_cleanup() {
   }
   for (ti = _sleeping.begin(); ti != _sleeping.end(); ++ti) {
     AsyncTask *task = (*ti);
+    task->_sleep_index = -1;
+    dead.push_back(task);
+    cleanup_task(task, false, false);
+  }
+  for (ti = _waiting.begin(); ti != _waiting.end(); ++ti) {
+    AsyncTask *task = (*ti);
+    task->_waiting_index = -1;
     dead.push_back(task);
     cleanup_task(task, false, false);
   }
 
+  // Release anything on another chain that was waiting on the tasks
+  // we just removed.  (Any dependents on this chain have already been
+  // cleaned up above, so they will be ignored.)
+  for (ti = dead.begin(); ti != dead.end(); ++ti) {
+    (*ti)->release_dependents();
+  }
+
   // There might still be one task remaining: the currently-executing
   // task.
   nassertv(_num_tasks == 0 || _num_tasks == 1);
@@ -709,9 +999,21 @@ do_cleanup() {
 ////////////////////////////////////////////////////////////////////
 bool AsyncTaskChain::
 do_has_task(AsyncTask *task) const {
+  // Sleeping and waiting tasks know where they are on their lists,
+  // so we don't need to search those.
+  int sleep_index = task->_sleep_index;
+  if (sleep_index >= 0 && sleep_index < (int)_sleeping.size() &&
+      _sleeping[sleep_index] == task) {
+    return true;
+  }
+  int waiting_index = task->_waiting_index;
+  if (waiting_index >= 0 && waiting_index < (int)_waiting.size() &&
+      _waiting[waiting_index] == task) {
+    return true;
+  }
+
   return (find_task_on_heap(_active, task) != -1 ||
           find_task_on_heap(_next_active, task) != -1 ||
-          find_task_on_heap(_sleeping, task) != -1 ||
           find_task_on_heap(_this_active, task) != -1);
 }
 
@@ -735,6 +1037,175 @@ find_task_on_heap(const TaskHeap &heap, AsyncTask *task) const {
   return -1;
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: AsyncTaskChain::add_waiting
+//       Access: Protected
+//  Description: Adds the indicated task to the _waiting list.  Like
+//               a sleeping task, each waiting task records its own
+//               index within the list, so that it may be removed when
+//               its dependencies finish without searching for it.
+//               Assumes that the lock is currently held.
+////////////////////////////////////////////////////////////////////
+void AsyncTaskChain::
+add_waiting(AsyncTask *task) {
+  task->_waiting_index = (int)_waiting.size();
+  _waiting.push_back(task);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: AsyncTaskChain::remove_waiting
+//       Access: Protected
+//  Description: Removes the indicated task from the _waiting list.
+//               The list is not ordered, so the last task simply
+//               takes its place.  Assumes that the lock is currently
+//               held.
+////////////////////////////////////////////////////////////////////
+void AsyncTaskChain::
+remove_waiting(AsyncTask *task) {
+  int index = task->_waiting_index;
+  int last = (int)_waiting.size() - 1;
+  nassertv(index >= 0 && index <= last && _waiting[index] == task);
+
+  // Hold a reference so the task doesn't get deleted out from under
+  // us when its slot is overwritten.
+  PT(AsyncTask) hold_task = task;
+  task->_waiting_index = -1;
+
+  if (index != last) {
+    AsyncTask *moved = _waiting[last];
+    _waiting[index] = moved;
+    moved->_waiting_index = index;
+  }
+  _waiting.pop_back();
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: AsyncTaskChain::add_sleeping
+//       Access: Protected
+//  Description: Adds the indicated task to the _sleeping heap, which
+//               is ordered by wake time.  Each task on the heap
+//               records its own index within it, so that it may later
+//               be removed or reordered without searching for it.
+//               Assumes that the lock is currently held.
+////////////////////////////////////////////////////////////////////
+void AsyncTaskChain::
+add_sleeping(AsyncTask *task) {
+  int index = (int)_sleeping.size();
+  _sleeping.push_back(task);
+  task->_sleep_index = index;
+  sift_sleeping_up(index);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: AsyncTaskChain::remove_sleeping
+//       Access: Protected
+//  Description: Removes the indicated task from the _sleeping heap,
+//               wherever it is within the heap.  Assumes that the
+//               lock is currently held.
+////////////////////////////////////////////////////////////////////
+void AsyncTaskChain::
+remove_sleeping(AsyncTask *task) {
+  int index = task->_sleep_index;
+  int last = (int)_sleeping.size() - 1;
+  nassertv(index >= 0 && index <= last && _sleeping[index] == task);
+
+  // Hold a reference so the task doesn't get deleted out from under
+  // us when its slot is overwritten.
+  PT(AsyncTask) hold_task = task;
+  task->_sleep_index = -1;
+
+  if (index != last) {
+    // Move the last task on the heap into the vacated slot, and then
+    // let it find its proper place.
+    AsyncTask *moved = _sleeping[last];
+    _sleeping[index] = moved;
+    _sleeping.pop_back();
+    moved->_sleep_index = index;
+    update_sleeping(moved);
+  } else {
+    _sleeping.pop_back();
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: AsyncTaskChain::update_sleeping
+//       Access: Protected
+//  Description: Restores the heap ordering after the wake time of the
+//               indicated task, which is already on the _sleeping
+//               heap, has changed.  Assumes that the lock is
+//               currently held.
+////////////////////////////////////////////////////////////////////
+void AsyncTaskChain::
+update_sleeping(AsyncTask *task) {
+  int index = task->_sleep_index;
+  nassertv(index >= 0 && index < (int)_sleeping.size() && _sleeping[index] == task);
+
+  sift_sleeping_up(index);
+  sift_sleeping_down(task->_sleep_index);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: AsyncTaskChain::sift_sleeping_up
+//       Access: Protected
+//  Description: Moves the task at the indicated index of the
+//               _sleeping heap towards the top of the heap until its
+//               parent wakes no later than it does, updating the
+//               index of each task that is moved.
+////////////////////////////////////////////////////////////////////
+void AsyncTaskChain::
+sift_sleeping_up(int index) {
+  PT(AsyncTask) task = _sleeping[index];
+  double wake_time = task->_wake_time;
+
+  while (index > 0) {
+    int parent = (index - 1) / 2;
+    if (_sleeping[parent]->_wake_time <= wake_time) {
+      break;
+    }
+    _sleeping[index] = _sleeping[parent];
+    _sleeping[index]->_sleep_index = index;
+    index = parent;
+  }
+
+  _sleeping[index] = task;
+  task->_sleep_index = index;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: AsyncTaskChain::sift_sleeping_down
+//       Access: Protected
+//  Description: Moves the task at the indicated index of the
+//               _sleeping heap towards the bottom of the heap until
+//               neither of its children wakes before it does,
+//               updating the index of each task that is moved.
+////////////////////////////////////////////////////////////////////
+void AsyncTaskChain::
+sift_sleeping_down(int index) {
+  int size = (int)_sleeping.size();
+  PT(AsyncTask) task = _sleeping[index];
+  double wake_time = task->_wake_time;
+
+  while (true) {
+    int child = index * 2 + 1;
+    if (child >= size) {
+      break;
+    }
+    if (child + 1 < size &&
+        _sleeping[child + 1]->_wake_time < _sleeping[child]->_wake_time) {
+      ++child;
+    }
+    if (wake_time <= _sleeping[child]->_wake_time) {
+      break;
+    }
+    _sleeping[index] = _sleeping[child];
+    _sleeping[index]->_sleep_index = index;
+    index = child;
+  }
+
+  _sleeping[index] = task;
+  task->_sleep_index = index;
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: AsyncTaskChain::service_one_task
 //       Access: Protected
@@ -775,73 +1246,87 @@ service_one_task(AsyncTaskChain::AsyncTaskChainThread *thread) {
     }
     task->_servicing_thread = NULL;
 
-    if (task->_chain == this) {
-      if (task->_state == AsyncTask::S_servicing_removed) {
-        // This task wants to kill itself.
-        cleanup_task(task, true, false);
+    finish_task(task, ds);
 
-      } else if (task->_chain_name != get_name()) {
-        // The task wants to jump to a different chain.
-        PT(AsyncTask) hold_task = task;
-        cleanup_task(task, false, false);
-        task->jump_to_task_chain(_manager);
+    if (task_cat.is_spam()) {
+      task_cat.spam()
+        << "Done servicing " << *task << " in "
+        << *Thread::get_current_thread() << "\n";
+    }
+  }
+  thread_consider_yield();
+}
 
-      } else {
-        switch (ds) {
-        case AsyncTask::DS_cont:
-          // The task is still alive; put it on the next frame's active
-          // queue.
-          task->_state = AsyncTask::S_active;
-          _next_active.push_back(task);
-          _cvar.notify_all();
-          break;
-          
-        case AsyncTask::DS_again:
-          // The task wants to sleep again.
-          {
-            double now = _manager->_clock->get_frame_time();
-            task->_wake_time = now + task->get_delay();
-            task->_start_time = task->_wake_time;
-            task->_state = AsyncTask::S_sleeping;
-            _sleeping.push_back(task);
-            push_heap(_sleeping.begin(), _sleeping.end(), AsyncTaskSortWakeTime());
-            if (task_cat.is_spam()) {
-              task_cat.spam()
-                << "Sleeping " << *task << ", wake time at " 
-                << task->_wake_time - now << "\n";
-            }
-            _cvar.notify_all();
-          }
-          break;
+////////////////////////////////////////////////////////////////////
+//     Function: AsyncTaskChain::service_queued_tasks
+//       Access: Protected
+//  Description: The work stealing equivalent of service_one_task().
+//               Deals any tasks of the current sort value on the
+//               active queue out to the threads' queues, then
+//               releases the lock and services a batch of tasks from
+//               those queues, and finally reacquires the lock and
+//               puts each serviced task back where it belongs.  This
+//               is called internally only within one of the task
+//               threads.  Assumes the lock is already held.
+//
+//               Note that the lock is temporarily released by this
+//               method.
+////////////////////////////////////////////////////////////////////
+void AsyncTaskChain::
+service_queued_tasks(AsyncTaskChain::AsyncTaskChainThread *thread) {
+  distribute_tasks();
 
-        case AsyncTask::DS_pickup:
-          // The task wants to run again this frame if possible.
-          task->_state = AsyncTask::S_active;
-          _this_active.push_back(task);
-          _cvar.notify_all();
-          break;
-
-        case AsyncTask::DS_interrupt:
-          // The task had an exception and wants to raise a big flag.
-          task->_state = AsyncTask::S_active;
-          _next_active.push_back(task);
-          if (_state == S_started) {
-            _state = S_interrupted;
-            _cvar.notify_all();
-          }
-          break;
-          
-        default:
-          // The task has finished.
-          cleanup_task(task, true, true);
-        }
-      }
-    } else {
-      task_cat.error()
-        << "Task is no longer on chain " << get_name() 
-        << ": " << *task << "\n";
+  // We can't look at _time_in_frame without the lock, so we work out
+  // in advance how much of the frame budget is left, and stop taking
+  // new tasks once this thread has used up its share of it.
+  double budget_left = -1.0;
+  if (_frame_budget >= 0.0) {
+    budget_left = (_frame_budget - _time_in_frame) / (double)_steal_threads.size();
+  }
+  PT(ClockObject) clock = _manager->_clock;
+
+  AsyncTask::DoneStatus status[steal_batch_size];
+  int num_serviced = 0;
+  double time_used = 0.0;
+
+  _manager->_lock.release();
+  while (num_serviced < steal_batch_size &&
+         (budget_left < 0.0 || time_used < budget_left)) {
+    PT(AsyncTask) task = pop_queued_task(thread);
+    if (task == (AsyncTask *)NULL) {
+      break;
+    }
+
+    if (task_cat.is_spam()) {
+      task_cat.spam()
+        << "Servicing " << *task << " in "
+        << *Thread::get_current_thread() << "\n";
     }
 
+    status[num_serviced] = task->do_task_unlocked(clock);
+    time_used += task->_dt;
+    ++num_serviced;
+
+    MutexHolder holder(thread->_queue_lock);
+    thread->_servicing = NULL;
+  }
+  _manager->_lock.acquire();
+
+  // Now retire the batch.  We swap it out of the thread first, since
+  // finish_task() may release the lock again.
+  TaskHeap batch;
+  {
+    MutexHolder holder(thread->_queue_lock);
+    batch.swap(thread->_batch);
+  }
+  nassertv((int)batch.size() == num_serviced);
+
+  for (int i = 0; i < num_serviced; ++i) {
+    AsyncTask *task = batch[i];
+    task->_servicing_thread = NULL;
+    _time_in_frame += task->_dt;
+    finish_task(task, status[i]);
+
     if (task_cat.is_spam()) {
       task_cat.spam()
         << "Done servicing " << *task << " in "
@@ -851,6 +1336,237 @@ service_one_task(AsyncTaskChain::AsyncTaskChainThread *thread) {
   thread_consider_yield();
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: AsyncTaskChain::distribute_tasks
+//       Access: Protected
+//  Description: In work stealing mode, moves all of the tasks of the
+//               current sort value from the active queue to the
+//               threads' queues.  The tasks are dealt out
+//               round-robin in priority order, so that each thread's
+//               queue is itself in priority order, and the threads
+//               between them start with the highest-priority tasks.
+//               Assumes the lock is already held.
+////////////////////////////////////////////////////////////////////
+void AsyncTaskChain::
+distribute_tasks() {
+  int num_threads = (int)_steal_threads.size();
+  nassertv(num_threads != 0);
+
+  TaskHeap band;
+  band.reserve(_active.size());
+  while (!_active.empty() && _active.front()->get_sort() == _current_sort) {
+    band.push_back(_active.front());
+    pop_heap(_active.begin(), _active.end(), AsyncTaskSortPriority());
+    _active.pop_back();
+  }
+  if (band.empty()) {
+    return;
+  }
+
+  // Count the tasks before we queue them, so that _num_queued can
+  // never be seen to be less than the number of tasks available.
+  AtomicAdjust::add(_num_queued, (AtomicAdjust::Integer)band.size());
+
+  for (int ti = 0; ti < num_threads && ti < (int)band.size(); ++ti) {
+    AsyncTaskChainThread *thread = _steal_threads[ti];
+    MutexHolder holder(thread->_queue_lock);
+    for (size_t i = ti; i < band.size(); i += num_threads) {
+      thread->_queue.push_back(band[i]);
+    }
+  }
+
+  // Wake up any threads that are idle, so they can help.
+  _cvar.notify_all();
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: AsyncTaskChain::pop_queued_task
+//       Access: Protected
+//  Description: In work stealing mode, takes the next task for the
+//               indicated thread: the front of its own queue if it
+//               has one, or else the front of the first other
+//               thread's queue that isn't empty.  The task is marked
+//               as being serviced and recorded in the thread's
+//               _batch.  Returns NULL if there are no queued tasks.
+//
+//               This is called *without* the manager's lock held.
+////////////////////////////////////////////////////////////////////
+PT(AsyncTask) AsyncTaskChain::
+pop_queued_task(AsyncTaskChain::AsyncTaskChainThread *thread) {
+  PT(AsyncTask) task;
+  if (AtomicAdjust::get(_num_queued) == 0) {
+    return task;
+  }
+
+  int num_threads = (int)_steal_threads.size();
+  for (int i = 0; i < num_threads && task == (AsyncTask *)NULL; ++i) {
+    AsyncTaskChainThread *victim = _steal_threads[(thread->_steal_index + i) % num_threads];
+    MutexHolder holder(victim->_queue_lock);
+    if (!victim->_queue.empty()) {
+      task = victim->_queue.front();
+      victim->_queue.pop_front();
+
+      // The state change happens while the queue is locked, so that
+      // do_remove() always sees the task either on a queue, or
+      // already being serviced.
+      nassertr(task->_state == AsyncTask::S_active, NULL);
+      task->_state = AsyncTask::S_servicing;
+      task->_servicing_thread = thread;
+      AtomicAdjust::dec(_num_queued);
+
+      if (victim == thread) {
+        thread->_batch.push_back(task);
+        thread->_servicing = task;
+        return task;
+      }
+    }
+  }
+
+  if (task != (AsyncTask *)NULL) {
+    MutexHolder holder(thread->_queue_lock);
+    thread->_batch.push_back(task);
+    thread->_servicing = task;
+  }
+  return task;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: AsyncTaskChain::reclaim_queued_tasks
+//       Access: Protected
+//  Description: Moves any tasks that are still waiting on the
+//               threads' queues back onto the active queue.  This is
+//               done when the threads are stopped, when the frame
+//               budget runs out, and when work stealing is turned
+//               off.  Tasks that a thread has already taken are not
+//               affected.  Assumes the lock is already held.
+////////////////////////////////////////////////////////////////////
+void AsyncTaskChain::
+reclaim_queued_tasks() {
+  if (AtomicAdjust::get(_num_queued) == 0) {
+    return;
+  }
+
+  StealThreads::const_iterator ti;
+  for (ti = _steal_threads.begin(); ti != _steal_threads.end(); ++ti) {
+    AsyncTaskChainThread *thread = (*ti);
+    MutexHolder holder(thread->_queue_lock);
+    TaskDeque::const_iterator qi;
+    for (qi = thread->_queue.begin(); qi != thread->_queue.end(); ++qi) {
+      _active.push_back(*qi);
+      AtomicAdjust::dec(_num_queued);
+    }
+    thread->_queue.clear();
+  }
+  make_heap(_active.begin(), _active.end(), AsyncTaskSortPriority());
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: AsyncTaskChain::do_remove_queued
+//       Access: Protected
+//  Description: Removes the indicated task from whichever thread's
+//               queue it is waiting on.  Returns true if it was
+//               found, false otherwise.  Assumes the lock is already
+//               held.
+////////////////////////////////////////////////////////////////////
+bool AsyncTaskChain::
+do_remove_queued(AsyncTask *task) {
+  StealThreads::const_iterator ti;
+  for (ti = _steal_threads.begin(); ti != _steal_threads.end(); ++ti) {
+    AsyncTaskChainThread *thread = (*ti);
+    MutexHolder holder(thread->_queue_lock);
+    TaskDeque::iterator qi;
+    for (qi = thread->_queue.begin(); qi != thread->_queue.end(); ++qi) {
+      if ((*qi) == task) {
+        thread->_queue.erase(qi);
+        AtomicAdjust::dec(_num_queued);
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: AsyncTaskChain::finish_task
+//       Access: Protected
+//  Description: Called after a task has been serviced, to put it
+//               back on the appropriate queue (or remove it from the
+//               chain) according to the indicated DoneStatus.
+//               Assumes the lock is already held.
+//
+//               Note that the lock may be temporarily released by
+//               this method.
+////////////////////////////////////////////////////////////////////
+void AsyncTaskChain::
+finish_task(AsyncTask *task, AsyncTask::DoneStatus ds) {
+  if (task->_chain == this) {
+    if (task->_state == AsyncTask::S_servicing_removed) {
+      // This task wants to kill itself.
+      cleanup_task(task, true, false);
+
+    } else if (task->_chain_name != get_name()) {
+      // The task wants to jump to a different chain.
+      PT(AsyncTask) hold_task = task;
+      cleanup_task(task, false, false);
+      task->jump_to_task_chain(_manager);
+
+    } else {
+      switch (ds) {
+      case AsyncTask::DS_cont:
+        // The task is still alive; put it on the next frame's active
+        // queue.
+        task->_state = AsyncTask::S_active;
+        _next_active.push_back(task);
+        _cvar.notify_all();
+        break;
+        
+      case AsyncTask::DS_again:
+        // The task wants to sleep again.
+        {
+          double now = _manager->_clock->get_frame_time();
+          task->_wake_time = now + task->get_delay();
+          task->_start_time = task->_wake_time;
+          task->_state = AsyncTask::S_sleeping;
+          add_sleeping(task);
+          if (task_cat.is_spam()) {
+            task_cat.spam()
+              << "Sleeping " << *task << ", wake time at " 
+              << task->_wake_time - now << "\n";
+          }
+          _cvar.notify_all();
+        }
+        break;
+
+      case AsyncTask::DS_pickup:
+        // The task wants to run again this frame if possible.
+        task->_state = AsyncTask::S_active;
+        _this_active.push_back(task);
+        _cvar.notify_all();
+        break;
+
+      case AsyncTask::DS_interrupt:
+        // The task had an exception and wants to raise a big flag.
+        task->_state = AsyncTask::S_active;
+        _next_active.push_back(task);
+        if (_state == S_started) {
+          _state = S_interrupted;
+          _cvar.notify_all();
+        }
+        break;
+        
+      default:
+        // The task has finished.
+        cleanup_task(task, true, true);
+      }
+    }
+  } else {
+    task_cat.error()
+      << "Task is no longer on chain " << get_name() 
+      << ": " << *task << "\n";
+  }
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: AsyncTaskChain::cleanup_task
 //       Access: Protected
@@ -886,6 +1602,8 @@ cleanup_task(AsyncTask *task, bool upon_death, bool clean_exit) {
   _manager->remove_task_by_name(task);
 
   if (upon_death) {
+    task->release_dependents();
+
     _manager->_lock.release();
     task->upon_death(_manager, clean_exit);
     _manager->_lock.acquire();
@@ -983,8 +1701,7 @@ finish_sort_group() {
           << "Waking " << *task << ", wake time at " 
           << task->_wake_time - now << "\n";
       }
-      pop_heap(_sleeping.begin(), _sleeping.end(), AsyncTaskSortWakeTime());
-      _sleeping.pop_back();
+      remove_sleeping(task);
       task->_state = AsyncTask::S_active;
       task->_start_frame = _manager->_clock->get_frame_count();
       _active.push_back(task);
@@ -1014,7 +1731,7 @@ finish_sort_group() {
     filter_timeslice_priority();
   }
 
-  nassertr((size_t)_num_tasks == _active.size() + _this_active.size() + _next_active.size() + _sleeping.size(), true);
+  nassertr((size_t)_num_tasks == _active.size() + _this_active.size() + _next_active.size() + _sleeping.size() + _waiting.size(), true);
   make_heap(_active.begin(), _active.end(), AsyncTaskSortPriority());
 
   _current_sort = -INT_MAX;
@@ -1128,6 +1845,7 @@ do_stop_threads() {
     }
 
     _state = S_shutdown;
+    reclaim_queued_tasks();
     _cvar.notify_all();
     _manager->_frame_cvar.notify_all();
     
@@ -1152,9 +1870,20 @@ do_stop_threads() {
       }
     }
     _manager->_lock.acquire();
+
+    // Now that the threads are gone, no one can be looking at their
+    // queues.
+    _steal_threads.clear();
     
     _state = S_initial;
 
+    // Any parallel_for_join() waiting on this chain must now run the
+    // rest of its pieces itself.
+    Joins::iterator ji;
+    for (ji = _joins.begin(); ji != _joins.end(); ++ji) {
+      (*ji)->interrupt();
+    }
+
     // There might be one busy "thread" still: the main thread.
     nassertv(_num_busy_threads == 0 || _num_busy_threads == 1);
     cleanup_pickup_mode();
@@ -1187,8 +1916,10 @@ do_start_threads() {
         ostringstream strm;
         strm << _manager->get_name() << "_" << get_name() << "_" << i;
         PT(AsyncTaskChainThread) thread = new AsyncTaskChainThread(strm.str(), this);
+        thread->_steal_index = (int)_steal_threads.size();
         if (thread->start(_thread_priority, true)) {
           _threads.push_back(thread);
+          _steal_threads.push_back(thread);
         }
       }
     }
@@ -1208,11 +1939,29 @@ do_get_active_tasks() const {
 
   Threads::const_iterator thi;
   for (thi = _threads.begin(); thi != _threads.end(); ++thi) {
+    // In work stealing mode, _servicing is changed while holding only
+    // the thread's _queue_lock.
+    MutexHolder holder((*thi)->_queue_lock);
     AsyncTask *task = (*thi)->_servicing;
     if (task != (AsyncTask *)NULL) {
       result.add_task(task);
     }
   }
+  StealThreads::const_iterator sti;
+  for (sti = _steal_threads.begin(); sti != _steal_threads.end(); ++sti) {
+    AsyncTaskChainThread *thread = (*sti);
+    MutexHolder holder(thread->_queue_lock);
+    TaskHeap::const_iterator bi;
+    for (bi = thread->_batch.begin(); bi != thread->_batch.end(); ++bi) {
+      if ((*bi) != thread->_servicing) {
+        result.add_task(*bi);
+      }
+    }
+    TaskDeque::const_iterator qi;
+    for (qi = thread->_queue.begin(); qi != thread->_queue.end(); ++qi) {
+      result.add_task(*qi);
+    }
+  }
   TaskHeap::const_iterator ti;
   for (ti = _active.begin(); ti != _active.end(); ++ti) {
     AsyncTask *task = (*ti);
@@ -1233,9 +1982,10 @@ do_get_active_tasks() const {
 ////////////////////////////////////////////////////////////////////
 //     Function: AsyncTaskChain::do_get_sleeping_tasks
 //       Access: Published
-//  Description: Returns the set of tasks that are sleeping (and not
-//               active) on the task chain, at the time of the
-//               call.  Assumes the lock is held.
+//  Description: Returns the set of tasks that are sleeping, or
+//               waiting for their dependencies (and not active) on
+//               the task chain, at the time of the call.  Assumes
+//               the lock is held.
 ////////////////////////////////////////////////////////////////////
 AsyncTaskCollection AsyncTaskChain::
 do_get_sleeping_tasks() const {
@@ -1246,6 +1996,10 @@ do_get_sleeping_tasks() const {
     AsyncTask *task = (*ti);
     result.add_task(task);
   }
+  for (ti = _waiting.begin(); ti != _waiting.end(); ++ti) {
+    AsyncTask *task = (*ti);
+    result.add_task(task);
+  }
 
   return result;
 }
@@ -1379,6 +2133,10 @@ do_write(ostream &out, int indent_level) const {
     indent(out, indent_level + 2) 
       << "timeslice priority\n";
   }
+  if (_work_stealing) {
+    indent(out, indent_level + 2) 
+      << "work stealing\n";
+  }
   if (_tick_clock) {
     indent(out, indent_level + 2) 
       << "tick clock\n";
@@ -1410,11 +2168,24 @@ do_write(ostream &out, int indent_level) const {
 
   Threads::const_iterator thi;
   for (thi = _threads.begin(); thi != _threads.end(); ++thi) {
+    MutexHolder holder((*thi)->_queue_lock);
     AsyncTask *task = (*thi)->_servicing;
     if (task != (AsyncTask *)NULL) {
       tasks.push_back(task);
     }
   }
+  StealThreads::const_iterator sti;
+  for (sti = _steal_threads.begin(); sti != _steal_threads.end(); ++sti) {
+    AsyncTaskChainThread *thread = (*sti);
+    MutexHolder holder(thread->_queue_lock);
+    TaskHeap::const_iterator bi;
+    for (bi = thread->_batch.begin(); bi != thread->_batch.end(); ++bi) {
+      if ((*bi) != thread->_servicing) {
+        tasks.push_back(*bi);
+      }
+    }
+    tasks.insert(tasks.end(), thread->_queue.begin(), thread->_queue.end());
+  }
 
   double now = _manager->_clock->get_frame_time();
 
@@ -1442,6 +2213,11 @@ do_write(ostream &out, int indent_level) const {
     
     write_task_line(out, indent_level, task, now);
   }
+
+  TaskHeap::const_iterator ti;
+  for (ti = _waiting.begin(); ti != _waiting.end(); ++ti) {
+    write_task_line(out, indent_level, *ti, now);
+  }
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -1507,7 +2283,8 @@ AsyncTaskChain::AsyncTaskChainThread::
 AsyncTaskChainThread(const string &name, AsyncTaskChain *chain) :
   Thread(name, chain->get_name()),
   _chain(chain),
-  _servicing(NULL)
+  _servicing(NULL),
+  _steal_index(-1)
 {
 }
 
@@ -1521,8 +2298,7 @@ thread_main() {
   MutexHolder holder(_chain->_manager->_lock);
   while (_chain->_state != S_shutdown && _chain->_state != S_interrupted) {
     thread_consider_yield();
-    if (!_chain->_active.empty() &&
-        _chain->_active.front()->get_sort() == _chain->_current_sort) {
+    if (_chain->has_current_task()) {
 
       int frame = _chain->_manager->_clock->get_frame_count();
       if (_chain->_current_frame != frame) {
@@ -1538,6 +2314,7 @@ thread_main() {
         while ((_chain->_block_till_next_frame ||
                 (_chain->_frame_budget >= 0.0 && _chain->_time_in_frame >= _chain->_frame_budget)) &&
                _chain->_state != S_shutdown && _chain->_state != S_interrupted) {
+          _chain->reclaim_queued_tasks();
           _chain->cleanup_pickup_mode();
           _chain->_manager->_frame_cvar.wait();
           frame = _chain->_manager->_clock->get_frame_count();
@@ -1553,7 +2330,11 @@ thread_main() {
 
       PStatTimer timer(_task_pcollector);
       _chain->_num_busy_threads++;
-      _chain->service_one_task(this);
+      if (_chain->_work_stealing) {
+        _chain->service_queued_tasks(this);
+      } else {
+        _chain->service_one_task(this);
+      }
       _chain->_num_busy_threads--;
       _chain->_cvar.notify_all();
 
@@ -19,9 +19,12 @@
 
 #include "asyncTask.h"
 #include "asyncTaskCollection.h"
+#include "rangeAsyncTask.h"
 #include "typedReferenceCount.h"
 #include "thread.h"
 #include "conditionVarFull.h"
+#include "pmutex.h"
+#include "atomicAdjust.h"
 #include "pvector.h"
 #include "pdeque.h"
 #include "pStatCollector.h"
@@ -53,6 +56,13 @@ class AsyncTaskManager;
 //               never run in parallel together, but tasks with
 //               different priority values might be (if there is more
 //               than one thread).
+//
+//               Optionally, a threaded chain may be put into work
+//               stealing mode (see set_work_stealing()), in which
+//               the tasks of each sort value are dealt out to
+//               per-thread queues, and idle threads steal from their
+//               neighbors, rather than every thread contending for
+//               the one shared queue.
 ////////////////////////////////////////////////////////////////////
 class EXPCL_PANDA_EVENT AsyncTaskChain : public TypedReferenceCount, public Namable {
 public:
@@ -79,6 +89,9 @@ PUBLISHED:
   void set_timeslice_priority(bool timeslice_priority);
   bool get_timeslice_priority() const;
 
+  void set_work_stealing(bool work_stealing);
+  bool get_work_stealing() const;
+
   BLOCKING void stop_threads();
   void start_threads();
   INLINE bool is_started() const;
@@ -95,14 +108,36 @@ PUBLISHED:
   void poll();
   double get_next_wake_time() const;
 
+public:
+  AsyncTaskCollection parallel_for(const string &name, int begin, int end,
+                                   int grain_size,
+                                   RangeAsyncTask::RangeFunc *function,
+                                   void *user_data,
+                                   const AsyncTaskCollection &prerequisites = AsyncTaskCollection());
+  BLOCKING int parallel_for_join(const string &name, int begin, int end,
+                                 int grain_size,
+                                 RangeAsyncTask::RangeFunc *function,
+                                 void *user_data);
+
+PUBLISHED:
   virtual void output(ostream &out) const;
   virtual void write(ostream &out, int indent_level = 0) const;
 
 protected:
   class AsyncTaskChainThread;
   typedef pvector< PT(AsyncTask) > TaskHeap;
+  typedef pdeque< PT(AsyncTask) > TaskDeque;
 
   void do_add(AsyncTask *task);
+  AsyncTaskCollection make_range_tasks(const string &name, int begin, int end,
+                                       int grain_size,
+                                       RangeAsyncTask::RangeFunc *function,
+                                       void *user_data,
+                                       const AsyncTaskCollection &prerequisites,
+                                       RangeAsyncTask::Join *join);
+  bool is_chain_thread(Thread *thread) const;
+  void enqueue_task(AsyncTask *task);
+  void do_release_waiting(AsyncTask *task);
   bool do_remove(AsyncTask *task);
   void do_wait_for_tasks();
   void do_cleanup();
@@ -110,7 +145,22 @@ protected:
   bool do_has_task(AsyncTask *task) const;
   int find_task_on_heap(const TaskHeap &heap, AsyncTask *task) const;
 
+  void add_waiting(AsyncTask *task);
+  void remove_waiting(AsyncTask *task);
+  void add_sleeping(AsyncTask *task);
+  void remove_sleeping(AsyncTask *task);
+  void update_sleeping(AsyncTask *task);
+  void sift_sleeping_up(int index);
+  void sift_sleeping_down(int index);
+
   void service_one_task(AsyncTaskChainThread *thread);
+  void service_queued_tasks(AsyncTaskChainThread *thread);
+  void finish_task(AsyncTask *task, AsyncTask::DoneStatus ds);
+  INLINE bool has_current_task() const;
+  void distribute_tasks();
+  PT(AsyncTask) pop_queued_task(AsyncTaskChainThread *thread);
+  void reclaim_queued_tasks();
+  bool do_remove_queued(AsyncTask *task);
   void cleanup_task(AsyncTask *task, bool upon_death, bool clean_exit);
   bool finish_sort_group();
   void filter_timeslice_priority();
@@ -134,7 +184,21 @@ protected:
     virtual void thread_main();
 
     AsyncTaskChain *_chain;
+
+    // The task this thread is running right now, if any.  This is
+    // read with both the manager's lock and _queue_lock held, and
+    // written with either one, according to the mode.
     AsyncTask *_servicing;
+
+    // These are used only in work stealing mode.  _queue holds the
+    // tasks dealt to this thread, highest priority first; _batch
+    // holds the tasks it has taken (from its own queue or another
+    // thread's) but not yet returned to the chain.  Both are
+    // protected by _queue_lock, not by the manager's lock.
+    int _steal_index;
+    Mutex _queue_lock;
+    TaskDeque _queue;
+    TaskHeap _batch;
   };
 
   class AsyncTaskSortWakeTime {
@@ -158,6 +222,8 @@ protected:
   };
 
   typedef pvector< PT(AsyncTaskChainThread) > Threads;
+  typedef pvector<AsyncTaskChainThread *> StealThreads;
+  typedef pvector< PT(RangeAsyncTask::Join) > Joins;
 
   AsyncTaskManager *_manager;
 
@@ -172,9 +238,12 @@ protected:
 
   bool _tick_clock;
   bool _timeslice_priority;
+  bool _work_stealing;
   int _num_threads;
   ThreadPriority _thread_priority;
   Threads _threads;
+  StealThreads _steal_threads;
+  AtomicAdjust::Integer _num_queued;
   double _frame_budget;
   bool _frame_sync;
   int _num_busy_threads;
@@ -183,6 +252,11 @@ protected:
   TaskHeap _this_active;
   TaskHeap _next_active;
   TaskHeap _sleeping;
+  TaskHeap _waiting;
+
+  // The Joins of the parallel_for_join() calls now waiting on this
+  // chain; they are interrupted when the threads are stopped.
+  Joins _joins;
   State _state;
   int _current_sort;
   bool _pickup_mode;
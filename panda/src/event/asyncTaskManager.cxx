@@ -377,6 +377,11 @@ remove(const AsyncTaskCollection &tasks) {
           << "Removing " << *task << "\n";
       }
       if (task->_chain->do_remove(task)) {
+        if (task->_state == AsyncTask::S_inactive) {
+          // If it's still being serviced, this will happen instead
+          // when it finishes.
+          task->release_dependents();
+        }
         _lock.release();
         task->upon_death(this, false);
         _lock.acquire();
@@ -505,9 +510,9 @@ get_active_tasks() const {
 ////////////////////////////////////////////////////////////////////
 //     Function: AsyncTaskManager::get_sleeping_tasks
 //       Access: Published
-//  Description: Returns the set of tasks that are sleeping (and not
-//               active) on the task manager, at the time of the
-//               call.
+//  Description: Returns the set of tasks that are sleeping, or
+//               waiting for their dependencies (and not active) on
+//               the task manager, at the time of the call.
 ////////////////////////////////////////////////////////////////////
 AsyncTaskCollection AsyncTaskManager::
 get_sleeping_tasks() const {
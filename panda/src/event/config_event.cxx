@@ -25,6 +25,7 @@
 #include "genericAsyncTask.h"
 #include "pointerEventList.h"
 #include "pythonTask.h"
+#include "rangeAsyncTask.h"
 
 #include "dconfig.h"
 
@@ -48,6 +49,7 @@ ConfigureFn(config_event) {
 #ifdef HAVE_PYTHON
   PythonTask::init_type();
 #endif
+  RangeAsyncTask::init_type();
 
   ButtonEventList::register_with_read_factory();
   EventStoreInt::register_with_read_factory();
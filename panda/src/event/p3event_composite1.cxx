@@ -10,3 +10,4 @@
 #include "pointerEvent.cxx"
 #include "pointerEventList.cxx"
 #include "pythonTask.cxx"
+#include "rangeAsyncTask.cxx"
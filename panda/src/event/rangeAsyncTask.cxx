@@ -0,0 +1,227 @@
+// Filename: rangeAsyncTask.cxx
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "rangeAsyncTask.h"
+#include "mutexHolder.h"
+#include "pnotify.h"
+
+TypeHandle RangeAsyncTask::_type_handle;
+
+////////////////////////////////////////////////////////////////////
+//     Function: RangeAsyncTask::Constructor
+//       Access: Public
+//  Description: If join is not NULL, the task is counted by it until
+//               it has either run or been removed.
+////////////////////////////////////////////////////////////////////
+RangeAsyncTask::
+RangeAsyncTask(const string &name, RangeAsyncTask::RangeFunc *function,
+               void *user_data, int begin, int end,
+               RangeAsyncTask::Join *join) :
+  AsyncTask(name),
+  _function(function),
+  _user_data(user_data),
+  _begin(begin),
+  _end(end),
+  _join(join),
+  _join_state(JS_pending)
+{
+  if (join != (Join *)NULL) {
+    join->add_range(this);
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: RangeAsyncTask::is_runnable
+//       Access: Protected, Virtual
+//  Description: Override this function to return true if the task can
+//               be successfully executed, false if it cannot.  Mainly
+//               intended as a sanity check when attempting to add the
+//               task to a task manager.
+//
+//               This function is called with the lock held.
+////////////////////////////////////////////////////////////////////
+bool RangeAsyncTask::
+is_runnable() {
+  return _function != NULL;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: RangeAsyncTask::do_task
+//       Access: Protected, Virtual
+//  Description: Calls the function with the task's range.  A range
+//               task always runs exactly once.
+//
+//               This function is called with the lock *not* held.
+////////////////////////////////////////////////////////////////////
+AsyncTask::DoneStatus RangeAsyncTask::
+do_task() {
+  nassertr(_function != NULL, DS_interrupt);
+  if (_join != (Join *)NULL && !_join->start_range(this)) {
+    // This range was cancelled just before it started; the Join has
+    // already counted it.
+    return DS_done;
+  }
+
+  (*_function)(_begin, _end, _user_data);
+
+  if (_join != (Join *)NULL) {
+    _join->finish_range(this);
+  }
+  return DS_done;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: RangeAsyncTask::upon_death
+//       Access: Protected, Virtual
+//  Description: Reports the range to the Join as cancelled, if it was
+//               removed before it started.  This may be called twice
+//               for a task that is removed while it is running, once
+//               from remove() and once when it finishes; neither
+//               call has any effect on the Join in that case.
+//
+//               This function is called with the lock *not* held.
+////////////////////////////////////////////////////////////////////
+void RangeAsyncTask::
+upon_death(AsyncTaskManager *manager, bool clean_exit) {
+  AsyncTask::upon_death(manager, clean_exit);
+  if (_join != (Join *)NULL) {
+    _join->cancel_range(this);
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: RangeAsyncTask::Join::Constructor
+//       Access: Public
+//  Description:
+////////////////////////////////////////////////////////////////////
+RangeAsyncTask::Join::
+Join() :
+  _lock("RangeAsyncTask::Join"),
+  _cvar(_lock),
+  _num_pending(0),
+  _interrupted(false)
+{
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: RangeAsyncTask::Join::add_range
+//       Access: Public
+//  Description: Counts a new task as outstanding.  This is called by
+//               the RangeAsyncTask constructor.
+////////////////////////////////////////////////////////////////////
+void RangeAsyncTask::Join::
+add_range(RangeAsyncTask *task) {
+  MutexHolder holder(_lock);
+  nassertv(task->_join_state == JS_pending);
+  ++_num_pending;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: RangeAsyncTask::Join::wait
+//       Access: Public
+//  Description: Blocks until every range has either run or been
+//               cancelled, or until interrupt() is called.  Returns
+//               true if there are no ranges left outstanding, false
+//               if it was interrupted first.  The last range to
+//               finish or be cancelled wakes the waiting thread.
+////////////////////////////////////////////////////////////////////
+bool RangeAsyncTask::Join::
+wait() {
+  MutexHolder holder(_lock);
+  while (_num_pending != 0 && !_interrupted) {
+    _cvar.wait();
+  }
+  _interrupted = false;
+  return (_num_pending == 0);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: RangeAsyncTask::Join::interrupt
+//       Access: Public
+//  Description: Wakes up the thread in wait(), or makes the next call
+//               to wait() return immediately, even though some ranges
+//               may still be outstanding.  This is called by the task
+//               chain when its threads are stopped, since the ranges
+//               may then never run.
+////////////////////////////////////////////////////////////////////
+void RangeAsyncTask::Join::
+interrupt() {
+  MutexHolder holder(_lock);
+  _interrupted = true;
+  _cvar.notify();
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: RangeAsyncTask::Join::take_cancelled
+//       Access: Public
+//  Description: Moves the list of ranges that were cancelled before
+//               they could run into the indicated vector.
+////////////////////////////////////////////////////////////////////
+void RangeAsyncTask::Join::
+take_cancelled(Ranges &ranges) {
+  MutexHolder holder(_lock);
+  ranges.swap(_cancelled);
+  _cancelled.clear();
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: RangeAsyncTask::Join::start_range
+//       Access: Private
+//  Description: Called by the task when it is about to call its
+//               function.  Returns true if it should go ahead, or
+//               false if it has already been counted as cancelled.
+////////////////////////////////////////////////////////////////////
+bool RangeAsyncTask::Join::
+start_range(RangeAsyncTask *task) {
+  MutexHolder holder(_lock);
+  if (task->_join_state != JS_pending) {
+    return false;
+  }
+  task->_join_state = JS_started;
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: RangeAsyncTask::Join::finish_range
+//       Access: Private
+//  Description: Called by the task when its function has returned.
+////////////////////////////////////////////////////////////////////
+void RangeAsyncTask::Join::
+finish_range(RangeAsyncTask *task) {
+  MutexHolder holder(_lock);
+  nassertv(task->_join_state == JS_started);
+  task->_join_state = JS_counted;
+  if (--_num_pending == 0) {
+    _cvar.notify();
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: RangeAsyncTask::Join::cancel_range
+//       Access: Private
+//  Description: Called when the task leaves the manager.  If it never
+//               started, it is counted now, and its range is recorded
+//               as cancelled.
+////////////////////////////////////////////////////////////////////
+void RangeAsyncTask::Join::
+cancel_range(RangeAsyncTask *task) {
+  MutexHolder holder(_lock);
+  if (task->_join_state == JS_pending) {
+    task->_join_state = JS_counted;
+    _cancelled.push_back(pair<int, int>(task->_begin, task->_end));
+    if (--_num_pending == 0) {
+      _cvar.notify();
+    }
+  }
+}
@@ -0,0 +1,128 @@
+// Filename: rangeAsyncTask.h
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#ifndef RANGEASYNCTASK_H
+#define RANGEASYNCTASK_H
+
+#include "pandabase.h"
+
+#include "asyncTask.h"
+#include "referenceCount.h"
+#include "pmutex.h"
+#include "conditionVar.h"
+#include "pvector.h"
+
+////////////////////////////////////////////////////////////////////
+//       Class : RangeAsyncTask
+// Description : Associates a C-style function pointer with a
+//               half-open range of integers [begin, end).  When the
+//               task runs, it calls the function once with the whole
+//               range, and then it is done.
+//
+//               These are normally created in bulk by
+//               AsyncTaskChain::parallel_for(), which splits a large
+//               range into many of these, so that the pieces may be
+//               run in parallel by the chain's threads.
+//
+//               A task may also report to a Join, which counts the
+//               pieces still outstanding, so that
+//               AsyncTaskChain::parallel_for_join() can wait for
+//               them.  A piece that is removed from the manager
+//               before it starts counts as finished, and is recorded
+//               as cancelled.
+////////////////////////////////////////////////////////////////////
+class EXPCL_PANDA_EVENT RangeAsyncTask : public AsyncTask {
+public:
+  typedef void RangeFunc(int begin, int end, void *user_data);
+
+  class Join;
+
+  RangeAsyncTask(const string &name, RangeFunc *function, void *user_data,
+                 int begin, int end, Join *join = NULL);
+  ALLOC_DELETED_CHAIN(RangeAsyncTask);
+
+  INLINE RangeFunc *get_function() const;
+  INLINE void *get_user_data() const;
+  INLINE int get_begin() const;
+  INLINE int get_end() const;
+
+  // Counts the outstanding pieces of one parallel_for_join() call.
+  class EXPCL_PANDA_EVENT Join : public ReferenceCount {
+  public:
+    typedef pvector< pair<int, int> > Ranges;
+
+    Join();
+
+    void add_range(RangeAsyncTask *task);
+    bool wait();
+    void interrupt();
+    void take_cancelled(Ranges &ranges);
+
+  private:
+    bool start_range(RangeAsyncTask *task);
+    void finish_range(RangeAsyncTask *task);
+    void cancel_range(RangeAsyncTask *task);
+
+    // Protects all of the following, as well as the _join_state of
+    // each of the tasks.
+    Mutex _lock;
+    ConditionVar _cvar;
+    int _num_pending;
+    bool _interrupted;
+    Ranges _cancelled;
+
+    friend class RangeAsyncTask;
+  };
+
+protected:
+  virtual bool is_runnable();
+  virtual DoneStatus do_task();
+  virtual void upon_death(AsyncTaskManager *manager, bool clean_exit);
+
+private:
+  RangeFunc *_function;
+  void *_user_data;
+  int _begin;
+  int _end;
+
+  enum JoinState {
+    JS_pending,
+    JS_started,
+    JS_counted
+  };
+  PT(Join) _join;
+  JoinState _join_state;
+
+public:
+  static TypeHandle get_class_type() {
+    return _type_handle;
+  }
+  static void init_type() {
+    AsyncTask::init_type();
+    register_type(_type_handle, "RangeAsyncTask",
+                  AsyncTask::get_class_type());
+  }
+  virtual TypeHandle get_type() const {
+    return get_class_type();
+  }
+  virtual TypeHandle force_init_type() {init_type(); return get_class_type();}
+
+private:
+  static TypeHandle _type_handle;
+};
+
+#include "rangeAsyncTask.I"
+
+#endif
+
@@ -15,7 +15,13 @@
 #include "pandabase.h"
 #include "asyncTask.h"
 #include "asyncTaskManager.h"
+#include "asyncTaskChain.h"
+#include "asyncTaskCollection.h"
+#include "atomicAdjust.h"
+#include "eventQueue.h"
+#include "clockObject.h"
 #include "perlinNoise2.h"
+#include "randomizer.h"
 
 class MyTask : public AsyncTask {
 public:
@@ -44,11 +50,384 @@ public:
   int _repeat_count;
 };
 
+// A trivial task for the timer benchmark, below.
+class TimerTask : public AsyncTask {
+public:
+  TimerTask(const string &name) : AsyncTask(name) { }
+  ALLOC_DELETED_CHAIN(TimerTask);
+
+  virtual DoneStatus do_task() {
+    ++_num_fired;
+    return DS_done;
+  }
+
+  static int _num_fired;
+};
+
+int TimerTask::_num_fired = 0;
+
+////////////////////////////////////////////////////////////////////
+//     Function: timer_benchmark
+//  Description: Measures the cost of managing a large number of
+//               sleeping tasks, as a server with many doLater-style
+//               timers would: adding them, removing an arbitrary half
+//               of them before they fire, and waking the rest as the
+//               clock advances.  Run as "test_task timers [count]".
+////////////////////////////////////////////////////////////////////
+static int
+timer_benchmark(int num_timers) {
+  PT(AsyncTaskManager) task_mgr = new AsyncTaskManager("timer_mgr");
+  PT(ClockObject) clock = new ClockObject;
+  clock->set_mode(ClockObject::M_slave);
+  task_mgr->set_clock(clock);
+
+  // Use a separate clock for timing, since the task manager's clock
+  // is under our control.
+  ClockObject *real_clock = ClockObject::get_global_clock();
+  EventQueue *queue = EventQueue::get_global_event_queue();
+
+  Randomizer random(1);
+  static const double max_delay = 100.0;
+
+  pvector< PT(AsyncTask) > timers;
+  timers.reserve(num_timers);
+  for (int i = 0; i < num_timers; ++i) {
+    ostringstream namestrm;
+    namestrm << "timer_" << i;
+    PT(TimerTask) task = new TimerTask(namestrm.str());
+    task->set_delay(1.0 + random.random_real(max_delay - 1.0));
+    timers.push_back(task.p());
+  }
+
+  double start = real_clock->get_real_time();
+  for (int i = 0; i < num_timers; ++i) {
+    task_mgr->add(timers[i]);
+  }
+  double add_time = real_clock->get_real_time() - start;
+
+  // Cancel every other timer, in random order.
+  pvector< PT(AsyncTask) > cancel;
+  for (int i = 0; i < num_timers; i += 2) {
+    cancel.push_back(timers[i]);
+  }
+  for (int i = (int)cancel.size() - 1; i > 0; --i) {
+    swap(cancel[i], cancel[random.random_int(i + 1)]);
+  }
+
+  start = real_clock->get_real_time();
+  for (size_t i = 0; i < cancel.size(); ++i) {
+    task_mgr->remove(cancel[i]);
+  }
+  double remove_time = real_clock->get_real_time() - start;
+  queue->clear();
+
+  // Now let the clock run until every remaining timer has fired.
+  start = real_clock->get_real_time();
+  int num_frames = 0;
+  for (double now = 0.5; now <= max_delay + 1.0; now += 0.5) {
+    clock->set_frame_time(now);
+    task_mgr->poll();
+    ++num_frames;
+  }
+  double wake_time = real_clock->get_real_time() - start;
+  queue->clear();
+
+  cerr << num_timers << " timers, " << cancel.size() << " cancelled, "
+       << TimerTask::_num_fired << " fired:\n"
+       << "  add:    " << add_time * 1000.0 << " ms ("
+       << add_time * 1000000.0 / num_timers << " us each)\n"
+       << "  remove: " << remove_time * 1000.0 << " ms ("
+       << remove_time * 1000000.0 / cancel.size() << " us each)\n"
+       << "  wake:   " << wake_time * 1000.0 << " ms over "
+       << num_frames << " frames\n";
+
+  return (TimerTask::_num_fired == num_timers - (int)cancel.size()) ? 0 : 1;
+}
+
+// A task for the work stealing test, below.  While it runs, it checks
+// that the chain reports it among the active tasks exactly once.
+class StealTask : public AsyncTask {
+public:
+  StealTask(const string &name, AsyncTaskChain *chain) :
+    AsyncTask(name),
+    _chain(chain)
+  {
+  }
+  ALLOC_DELETED_CHAIN(StealTask);
+
+  virtual DoneStatus do_task() {
+    AsyncTaskCollection active = _chain->get_active_tasks();
+    int count = 0;
+    for (int i = 0; i < active.get_num_tasks(); ++i) {
+      if (active.get_task(i) == this) {
+        ++count;
+      }
+    }
+    if (count != 1) {
+      cerr << *this << " listed " << count << " times among "
+           << active.get_num_tasks() << " active tasks.\n";
+      AtomicAdjust::inc(_num_errors);
+    }
+    AtomicAdjust::inc(_num_run);
+    Thread::sleep(0.001);
+    return DS_done;
+  }
+
+  AsyncTaskChain *_chain;
+  static AtomicAdjust::Integer _num_run;
+  static AtomicAdjust::Integer _num_errors;
+};
+
+AtomicAdjust::Integer StealTask::_num_run = 0;
+AtomicAdjust::Integer StealTask::_num_errors = 0;
+
+////////////////////////////////////////////////////////////////////
+//     Function: steal_test
+//  Description: Runs a batch of tasks on a work stealing chain, and
+//               checks that each task, while it is being serviced
+//               from a thread's queue, is reported as active exactly
+//               once.  Run as "test_task steal".
+////////////////////////////////////////////////////////////////////
+static int
+steal_test() {
+  static const int num_tasks = 200;
+
+  PT(AsyncTaskManager) task_mgr = new AsyncTaskManager("steal_mgr");
+  PT(AsyncTaskChain) chain = task_mgr->make_task_chain("steal");
+  chain->set_work_stealing(true);
+  chain->set_num_threads(4);
+
+  for (int i = 0; i < num_tasks; ++i) {
+    ostringstream namestrm;
+    namestrm << "steal_" << i;
+    PT(StealTask) task = new StealTask(namestrm.str(), chain);
+    task->set_task_chain("steal");
+    task_mgr->add(task);
+  }
+
+  task_mgr->wait_for_tasks();
+  chain->stop_threads();
+
+  cerr << AtomicAdjust::get(StealTask::_num_run) << " of " << num_tasks
+       << " tasks run, " << AtomicAdjust::get(StealTask::_num_errors)
+       << " errors.\n";
+  return (AtomicAdjust::get(StealTask::_num_run) == num_tasks &&
+          AtomicAdjust::get(StealTask::_num_errors) == 0) ? 0 : 1;
+}
+
+// The following are used for the parallel_for test, below.
+static const int range_size = 1000;
+static const int range_grain = 10;
+static AtomicAdjust::Integer range_hits[range_size];
+static AtomicAdjust::Integer range_started = 0;
+static AtomicAdjust::Integer range_release = 0;
+
+static void
+range_func(int begin, int end, void *) {
+  if (begin == 0) {
+    // The first piece waits until the test lets it go, so that the
+    // test can interfere with the rest while they are still queued.
+    AtomicAdjust::set(range_started, 1);
+    while (AtomicAdjust::get(range_release) == 0) {
+      Thread::sleep(0.001);
+    }
+  }
+  for (int i = begin; i < end; ++i) {
+    AtomicAdjust::inc(range_hits[i]);
+  }
+}
+
+// Interferes with a parallel_for_join() in progress, once its first
+// piece has started: either by removing the tasks, or by stopping the
+// chain's threads.
+class RangeSaboteur : public Thread {
+public:
+  RangeSaboteur(AsyncTaskManager *task_mgr, AsyncTaskChain *chain, bool stop) :
+    Thread("saboteur", "saboteur"),
+    _task_mgr(task_mgr),
+    _chain(chain),
+    _stop(stop)
+  {
+  }
+
+  virtual void thread_main() {
+    while (AtomicAdjust::get(range_started) == 0) {
+      Thread::sleep(0.001);
+    }
+    if (_stop) {
+      AtomicAdjust::set(range_release, 1);
+      _chain->stop_threads();
+    } else {
+      _task_mgr->remove(_task_mgr->find_tasks("range"));
+      AtomicAdjust::set(range_release, 1);
+    }
+  }
+
+  AsyncTaskManager *_task_mgr;
+  AsyncTaskChain *_chain;
+  bool _stop;
+};
+
+////////////////////////////////////////////////////////////////////
+//     Function: check_ranges
+//  Description: Checks that every value in the range was visited
+//               exactly once, and resets the counters for the next
+//               pass.  Returns the number of errors.
+////////////////////////////////////////////////////////////////////
+static int
+check_ranges(const string &pass, int num_local, int expect_local) {
+  int num_errors = 0;
+  for (int i = 0; i < range_size; ++i) {
+    if (AtomicAdjust::get(range_hits[i]) != 1) {
+      ++num_errors;
+    }
+    AtomicAdjust::set(range_hits[i], 0);
+  }
+  if (expect_local >= 0 && num_local != expect_local) {
+    ++num_errors;
+  }
+  cerr << pass << ": " << num_local << " pieces run locally, "
+       << num_errors << " errors.\n";
+  AtomicAdjust::set(range_started, 0);
+  AtomicAdjust::set(range_release, 0);
+  return num_errors;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: parallel_for_test
+//  Description: Runs parallel_for_join() normally, on a chain without
+//               threads, with its tasks removed partway through, and
+//               with its chain stopped partway through, and checks
+//               that each time every value is visited exactly once
+//               and the call returns.  Run as "test_task
+//               parallel_for".
+////////////////////////////////////////////////////////////////////
+static int
+parallel_for_test() {
+  static const int num_pieces = range_size / range_grain;
+  int num_errors = 0;
+
+  PT(AsyncTaskManager) task_mgr = new AsyncTaskManager("range_mgr");
+  PT(AsyncTaskChain) chain = task_mgr->make_task_chain("range");
+  chain->set_num_threads(4);
+  AtomicAdjust::set(range_release, 1);
+  int num_local = chain->parallel_for_join("range", 0, range_size, range_grain,
+                                           &range_func, NULL);
+  num_errors += check_ranges("threaded", num_local, 0);
+
+  // A chain with no threads; everything is run by the caller.
+  PT(AsyncTaskChain) serial = task_mgr->make_task_chain("range_serial");
+  serial->set_num_threads(0);
+  AtomicAdjust::set(range_release, 1);
+  num_local = serial->parallel_for_join("range", 0, range_size, range_grain,
+                                        &range_func, NULL);
+  num_errors += check_ranges("no threads", num_local, num_pieces);
+
+  // With one thread, the first piece holds up all of the others,
+  // which are removed before they can start.
+  chain->set_num_threads(1);
+  PT(RangeSaboteur) saboteur = new RangeSaboteur(task_mgr, chain, false);
+  saboteur->start(TP_normal, true);
+  num_local = chain->parallel_for_join("range", 0, range_size, range_grain,
+                                       &range_func, NULL);
+  saboteur->join();
+  num_errors += check_ranges("removed", num_local, num_pieces - 1);
+
+  // The same, but the chain's threads are stopped instead.  The
+  // thread may or may not get to start another piece before it
+  // notices.
+  saboteur = new RangeSaboteur(task_mgr, chain, true);
+  saboteur->start(TP_normal, true);
+  num_local = chain->parallel_for_join("range", 0, range_size, range_grain,
+                                       &range_func, NULL);
+  saboteur->join();
+  num_errors += check_ranges("stopped", num_local, -1);
+
+  task_mgr->cleanup();
+  return (num_errors == 0) ? 0 : 1;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: dependency_test
+//  Description: Releases a large fan-in of tasks that all wait on one
+//               prerequisite, and checks that they all run, and that
+//               a cycle of dependencies is refused.  Run as
+//               "test_task depend".  The refused cycle reports an
+//               assertion failure, which is expected.
+////////////////////////////////////////////////////////////////////
+static int
+dependency_test() {
+  static const int num_dependents = 20000;
+  int num_errors = 0;
+
+  PT(AsyncTaskManager) task_mgr = new AsyncTaskManager("depend_mgr");
+  ClockObject *real_clock = ClockObject::get_global_clock();
+  TimerTask::_num_fired = 0;
+
+  // The dependents are unnamed, so that the manager's index of task
+  // names doesn't dominate the time.
+  PT(TimerTask) prerequisite = new TimerTask("prerequisite");
+  for (int i = 0; i < num_dependents; ++i) {
+    PT(TimerTask) task = new TimerTask("");
+    task->add_dependency(prerequisite);
+    task_mgr->add(task);
+  }
+  if (task_mgr->get_num_tasks() != num_dependents) {
+    ++num_errors;
+  }
+
+  double start = real_clock->get_real_time();
+  task_mgr->add(prerequisite);
+  for (int i = 0; i < 3 && task_mgr->get_num_tasks() != 0; ++i) {
+    task_mgr->poll();
+  }
+  double release_time = real_clock->get_real_time() - start;
+
+  if (TimerTask::_num_fired != num_dependents + 1) {
+    ++num_errors;
+  }
+  cerr << num_dependents << " dependents: ran " << TimerTask::_num_fired
+       << " tasks in " << release_time * 1000.0 << " ms.\n";
+
+  // a depends on b, so b may not also depend on a.
+  PT(TimerTask) a = new TimerTask("a");
+  PT(TimerTask) b = new TimerTask("b");
+  PT(TimerTask) c = new TimerTask("c");
+  a->add_dependency(b);
+  b->add_dependency(c);
+  c->add_dependency(a);
+  if (a->get_num_dependencies() != 1 || b->get_num_dependencies() != 1 ||
+      c->get_num_dependencies() != 0) {
+    ++num_errors;
+  }
+  cerr << "cycle: " << num_errors << " errors.\n";
+
+  task_mgr->cleanup();
+  return (num_errors == 0) ? 0 : 1;
+}
+
 static const int grid_size = 10;
 static const int num_threads = 10;
 
 int
 main(int argc, char *argv[]) {
+  if (argc > 1 && strcmp(argv[1], "timers") == 0) {
+    int num_timers = 200000;
+    if (argc > 2) {
+      num_timers = atoi(argv[2]);
+    }
+    return timer_benchmark(num_timers);
+  }
+  if (argc > 1 && strcmp(argv[1], "steal") == 0) {
+    return steal_test();
+  }
+  if (argc > 1 && strcmp(argv[1], "parallel_for") == 0) {
+    return parallel_for_test();
+  }
+  if (argc > 1 && strcmp(argv[1], "depend") == 0) {
+    return dependency_test();
+  }
+
   PT(AsyncTaskManager) task_mgr = new AsyncTaskManager("task_mgr");
   PT(AsyncTaskChain) chain = task_mgr->make_task_chain("default");
   chain->set_tick_clock(true);
@@ -120,6 +120,7 @@ init_libexpress() {
   TemporaryFile::init_type();
 
   init_system_type_handles();
+  Datagram::init_array_pool();
 
 #ifdef HAVE_ZLIB
   {
@@ -190,6 +191,39 @@ get_verify_dcast() {
   return *verify_dcast;
 }
 
+int
+get_datagram_pool_size() {
+  static ConfigVariableInt *datagram_pool_size = NULL;
+
+  if (datagram_pool_size == (ConfigVariableInt *)NULL) {
+    datagram_pool_size = new ConfigVariableInt
+      ("datagram-pool-size", 256,
+       PRC_DESC("The maximum number of spare Datagram buffers that are kept "
+                "around for reuse, rather than being freed when the last "
+                "Datagram referencing them is destructed.  With true "
+                "threads, each thread may also hold up to 16 more of its "
+                "own.  Set this to 0 to disable the pool."));
+  }
+
+  return *datagram_pool_size;
+}
+
+int
+get_datagram_pool_max_bytes() {
+  static ConfigVariableInt *datagram_pool_max_bytes = NULL;
+
+  if (datagram_pool_max_bytes == (ConfigVariableInt *)NULL) {
+    datagram_pool_max_bytes = new ConfigVariableInt
+      ("datagram-pool-max-bytes", 16384,
+       PRC_DESC("Datagram buffers whose allocated size exceeds this many "
+                "bytes are freed normally instead of being returned to the "
+                "pool of spare buffers, so that one very large datagram "
+                "does not pin its memory indefinitely."));
+  }
+
+  return *datagram_pool_max_bytes;
+}
+
 // Returns the configure object for accessing config variables from a
 // scripting language.
 DConfig &
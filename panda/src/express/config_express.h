@@ -47,6 +47,8 @@ EXPCL_PANDAEXPRESS bool get_use_high_res_clock();
 EXPCL_PANDAEXPRESS bool get_paranoid_clock();
 EXPCL_PANDAEXPRESS bool get_paranoid_inheritance();
 EXPCL_PANDAEXPRESS bool get_verify_dcast();
+EXPCL_PANDAEXPRESS int get_datagram_pool_size();
+EXPCL_PANDAEXPRESS int get_datagram_pool_max_bytes();
 
 extern ConfigVariableInt patchfile_window_size;
 extern ConfigVariableInt patchfile_increment_size;
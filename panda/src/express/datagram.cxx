@@ -16,12 +16,73 @@
 #include "datagram.h"
 
 #include "pnotify.h"
+#include "config_express.h"
+#include "mutexImpl.h"
+#include "pvector.h"
 
 // for sprintf().
 #include <stdio.h>
 
+#ifdef THREAD_POSIX_IMPL
+#include <pthread.h>
+#endif
+
 TypeHandle Datagram::_type_handle;
 
+// The pool of spare arrays handed out by new_array().  These are
+// allocated on first use and never freed, so that a Datagram
+// destructed during static destruction can still return its array.
+typedef pvector<PTA_uchar> ArrayPool;
+static MutexImpl *_array_pool_lock = NULL;
+static ArrayPool *_array_pool = NULL;
+
+#ifdef THREAD_POSIX_IMPL
+// With true Posix threads, each thread also keeps a few spare arrays
+// of its own, so that the usual release/new pairs need not take
+// _array_pool_lock.  Arrays move between a thread's pool and the
+// shared pool in batches, which keeps a thread that only builds
+// datagrams supplied by one that only destructs them.  A thread's
+// arrays go back to the shared pool when it exits.
+#define USE_DATAGRAM_THREAD_POOL 1
+
+static const size_t thread_pool_limit = 16;
+static pthread_key_t _thread_pool_key;
+
+// Moves arrays from the end of one pool to another, until the first
+// has only keep left or the second has grown to limit.
+static void
+move_arrays(ArrayPool &from, size_t keep, ArrayPool &to, size_t limit) {
+  while (from.size() > keep && to.size() < limit) {
+    to.push_back(from.back());
+    from.pop_back();
+  }
+}
+
+// Called by the thread library when a thread with a pool exits.
+static void
+flush_thread_pool(void *data) {
+  ArrayPool *pool = (ArrayPool *)data;
+  _array_pool_lock->acquire();
+  move_arrays(*pool, 0, *_array_pool, (size_t)max(get_datagram_pool_size(), 0));
+  _array_pool_lock->release();
+
+  // Whatever the shared pool had no room for is freed here.
+  delete pool;
+}
+
+// Returns the current thread's pool, creating it if necessary.
+static ArrayPool *
+get_thread_pool() {
+  ArrayPool *pool = (ArrayPool *)pthread_getspecific(_thread_pool_key);
+  if (pool == (ArrayPool *)NULL) {
+    pool = new ArrayPool;
+    pool->reserve(thread_pool_limit + 1);
+    pthread_setspecific(_thread_pool_key, pool);
+  }
+  return pool;
+}
+#endif  // THREAD_POSIX_IMPL
+
 ////////////////////////////////////////////////////////////////////
 //     Function: Datagram::Destructor
 //       Access: Public, Virtual
@@ -29,6 +90,7 @@ TypeHandle Datagram::_type_handle;
 ////////////////////////////////////////////////////////////////////
 Datagram::
 ~Datagram() {
+  release_array(_data);
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -39,7 +101,7 @@ Datagram::
 ////////////////////////////////////////////////////////////////////
 void Datagram::
 clear() {
-  _data.clear();
+  release_array(_data);
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -113,11 +175,11 @@ pad_bytes(size_t size) {
 
   if (_data == (uchar *)NULL) {
     // Create a new array.
-    _data = PTA_uchar::empty_array(0);
+    _data = new_array();
 
   } else if (_data.get_ref_count() != 1) {
     // Copy on write.
-    PTA_uchar new_data = PTA_uchar::empty_array(0);
+    PTA_uchar new_data = new_array();
     new_data.v() = _data.v();
     _data = new_data;
   }
@@ -146,11 +208,11 @@ append_data(const void *data, size_t size) {
 
   if (_data == (uchar *)NULL) {
     // Create a new array.
-    _data = PTA_uchar::empty_array(0);
+    _data = new_array();
 
   } else if (_data.get_ref_count() != 1) {
     // Copy on write.
-    PTA_uchar new_data = PTA_uchar::empty_array(0);
+    PTA_uchar new_data = new_array();
     new_data.v() = _data.v();
     _data = new_data;
   }
@@ -177,10 +239,127 @@ append_data(const void *data, size_t size) {
 void Datagram::
 assign(const void *data, size_t size) {
   nassertv((int)size >= 0);
-  
-  _data = PTA_uchar::empty_array(0);
-  _data.v().insert(_data.v().end(), (const unsigned char *)data,
-                   (const unsigned char *)data + size);
+
+  // Fill the new array before releasing the old one, in case the
+  // data came from the old one.
+  PTA_uchar new_data = new_array();
+  new_data.v().insert(new_data.v().end(), (const unsigned char *)data,
+                      (const unsigned char *)data + size);
+  release_array(_data);
+  _data = new_data;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: Datagram::init_array_pool
+//       Access: Public, Static
+//  Description: Creates the pool of spare arrays shared by all
+//               Datagrams.  This is normally called by
+//               init_libexpress(); it need not be called explicitly,
+//               but it must be called once before any threads are
+//               spawned if it is to be called at all.
+////////////////////////////////////////////////////////////////////
+void Datagram::
+init_array_pool() {
+  if (_array_pool_lock == (MutexImpl *)NULL) {
+    _array_pool_lock = new MutexImpl;
+    _array_pool = new ArrayPool;
+#ifdef USE_DATAGRAM_THREAD_POOL
+    int result = pthread_key_create(&_thread_pool_key, &flush_thread_pool);
+    nassertv(result == 0);
+#endif  // USE_DATAGRAM_THREAD_POOL
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: Datagram::new_array
+//       Access: Private, Static
+//  Description: Returns a new, empty array for a Datagram to write
+//               into.  If a previously-used array is available in
+//               the pool, it is returned instead of allocating a new
+//               one; its storage is already reserved, so appending
+//               to it will not need to reallocate for a while.
+////////////////////////////////////////////////////////////////////
+PTA_uchar Datagram::
+new_array() {
+  init_array_pool();
+
+#ifdef USE_DATAGRAM_THREAD_POOL
+  ArrayPool *pool = get_thread_pool();
+  if (pool->empty()) {
+    // Take a batch from the shared pool.
+    _array_pool_lock->acquire();
+    move_arrays(*_array_pool, 0, *pool, thread_pool_limit / 2);
+    _array_pool_lock->release();
+  }
+  if (!pool->empty()) {
+    PTA_uchar data = pool->back();
+    pool->pop_back();
+    return data;
+  }
+
+#else  // USE_DATAGRAM_THREAD_POOL
+  _array_pool_lock->acquire();
+  if (!_array_pool->empty()) {
+    PTA_uchar data = _array_pool->back();
+    _array_pool->pop_back();
+    _array_pool_lock->release();
+    return data;
+  }
+  _array_pool_lock->release();
+#endif  // USE_DATAGRAM_THREAD_POOL
+
+  return PTA_uchar::empty_array(0);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: Datagram::release_array
+//       Access: Private, Static
+//  Description: Clears the indicated PTA.  If this was the last
+//               reference to its array, and the array is not too
+//               large, the array is emptied and returned to the pool
+//               for a future call to new_array(), rather than being
+//               freed.
+////////////////////////////////////////////////////////////////////
+void Datagram::
+release_array(PTA_uchar &data) {
+  if (data == (uchar *)NULL) {
+    return;
+  }
+
+  if (data.get_ref_count() == 1 && data.get_node_ref_count() == 0 &&
+      data.v().capacity() <= (size_t)get_datagram_pool_max_bytes()) {
+    init_array_pool();
+
+    // This array is ours alone, so no one else can see us empty it.
+    // clear() keeps the capacity, which is the whole point.
+    data.v().clear();
+
+#ifdef USE_DATAGRAM_THREAD_POOL
+    size_t pool_size = (size_t)max(get_datagram_pool_size(), 0);
+    if (pool_size != 0) {
+      ArrayPool *pool = get_thread_pool();
+      pool->push_back(data);
+      if (pool->size() > min(thread_pool_limit, pool_size)) {
+        // Hand half of them back to the shared pool, and free any it
+        // has no room for.
+        size_t keep = min(thread_pool_limit, pool_size) / 2;
+        _array_pool_lock->acquire();
+        move_arrays(*pool, keep, *_array_pool, pool_size);
+        _array_pool_lock->release();
+        pool->resize(keep);
+      }
+    }
+
+#else  // USE_DATAGRAM_THREAD_POOL
+    _array_pool_lock->acquire();
+    if ((int)_array_pool->size() < get_datagram_pool_size()) {
+      _array_pool->push_back(data);
+    }
+    _array_pool_lock->release();
+#endif  // USE_DATAGRAM_THREAD_POOL
+  }
+
+  data.clear();
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -109,6 +109,13 @@ PUBLISHED:
   void output(ostream &out) const;
   void write(ostream &out, unsigned int indent=0) const;
 
+public:
+  static void init_array_pool();
+
+private:
+  static PTA_uchar new_array();
+  static void release_array(PTA_uchar &data);
+
 private:
   PTA_uchar _data;
   bool _stdfloat_double;
@@ -28,8 +28,17 @@
 
 #include "config_express.h"
 #include "configVariableInt64.h"
+#include "configVariableInt.h"
 #include <algorithm>
 #include <iterator>
+#include <string.h>
+
+#if defined(__GLIBC__) || defined(IS_OSX)
+#include <execinfo.h>
+#define HAVE_HEAP_SAMPLE_BACKTRACE 1
+#elif defined(WIN32_VC) || defined(WIN64_VC)
+#include <windows.h>
+#endif
 
 MemoryUsage *MemoryUsage::_global_ptr;
 
@@ -219,6 +228,10 @@ heap_alloc_single(size_t size) {
     } else {
       ptr = MemoryHook::heap_alloc_single(size);
     }
+
+    if (_sample_interval != 0 && should_sample()) {
+      record_sample(ptr, size, TypeHandle::none(), 2);
+    }
   }
 
   return ptr;
@@ -232,6 +245,10 @@ heap_alloc_single(size_t size) {
 ////////////////////////////////////////////////////////////////////
 void MemoryUsage::
 heap_free_single(void *ptr) {
+  if (_sample_interval != 0 && may_be_sampled(ptr)) {
+    remove_sample(ptr);
+  }
+
   if (_recursion_protect) {
     if (express_cat.is_spam()) {
       express_cat.spam()
@@ -291,6 +308,10 @@ heap_alloc_array(size_t size) {
     } else {
       ptr = MemoryHook::heap_alloc_array(size);
     }
+
+    if (_sample_interval != 0 && should_sample()) {
+      record_sample(ptr, size, TypeHandle::none(), 2);
+    }
   }
 
   return ptr;
@@ -304,6 +325,10 @@ heap_alloc_array(size_t size) {
 ////////////////////////////////////////////////////////////////////
 void *MemoryUsage::
 heap_realloc_array(void *ptr, size_t size) {
+  if (_sample_interval != 0 && may_be_sampled(ptr)) {
+    remove_sample(ptr);
+  }
+
   if (_recursion_protect) {
     ptr = MemoryHook::heap_realloc_array(ptr, size);
     if (express_cat.is_spam()) {
@@ -329,6 +354,10 @@ heap_realloc_array(void *ptr, size_t size) {
     } else {
       ptr = MemoryHook::heap_realloc_array(ptr, size);
     }
+
+    if (_sample_interval != 0 && should_sample()) {
+      record_sample(ptr, size, TypeHandle::none(), 2);
+    }
   }
 
   return ptr;
@@ -342,6 +371,10 @@ heap_realloc_array(void *ptr, size_t size) {
 ////////////////////////////////////////////////////////////////////
 void MemoryUsage::
 heap_free_array(void *ptr) {
+  if (_sample_interval != 0 && may_be_sampled(ptr)) {
+    remove_sample(ptr);
+  }
+
   if (_recursion_protect) {
     if (express_cat.is_spam()) {
       express_cat.spam()
@@ -504,6 +537,37 @@ MemoryUsage(const MemoryHook &copy) : MemoryHook(copy) {
 
   _count_memory_usage = false;
 
+  _sample_interval = ConfigVariableInt
+    ("sample-memory-usage", 0,
+     PRC_DESC("Set this to a nonzero value N to enable the sampling heap "
+              "profiler, which records the call stack of roughly one in "
+              "every N heap allocations, and reports the live samples by "
+              "type and call site via MemoryUsage::show_heap_samples().  "
+              "This is much cheaper than track-memory-usage; a value on "
+              "the order of 1000 or more is suitable for a running game, "
+              "though allocation-heavy code may still run a few percent "
+              "slower.  When this is 0, the cost is a single test per "
+              "allocation."));
+  if (_sample_interval < 0) {
+    _sample_interval = 0;
+  }
+  _sample_chains = (_sample_interval != 0);
+  _sampled_size = 0;
+  _sample_seed = 1;
+  _sample_countdown = _sample_interval;
+  memset(_sample_filter, 0, sizeof(_sample_filter));
+  _last_sample_ptr = NULL;
+  _last_sample_size = 0;
+
+#ifdef HAVE_HEAP_SAMPLE_BACKTRACE
+  if (_sample_interval != 0) {
+    // The first call to backtrace() may need to load the unwinder,
+    // which allocates memory; get that out of the way now.
+    void *frames[1];
+    backtrace(frames, 1);
+  }
+#endif
+
   PN_int64 max_heap_size = ConfigVariableInt64
     ("max-heap-size", 0,
      PRC_DESC("If this is nonzero, it is the maximum number of bytes expected "
@@ -582,6 +646,37 @@ get_global_ptr() {
 }
 
 
+////////////////////////////////////////////////////////////////////
+//     Function: MemoryUsage::chain_alloc
+//       Access: Public, Virtual
+//  Description: Called by DeletedBufferChain when sampling is
+//               enabled, for each buffer it hands out.  Most
+//               scene graph objects are allocated this way, and
+//               would otherwise never be sampled, since the chains
+//               get their memory in large pages.
+////////////////////////////////////////////////////////////////////
+void MemoryUsage::
+chain_alloc(void *ptr, size_t size, TypeHandle type_handle) {
+  if (should_sample()) {
+    // Skip this method, DeletedBufferChain::allocate(), and the
+    // operator new that called it.
+    record_sample(ptr, size, type_handle, 3);
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: MemoryUsage::chain_free
+//       Access: Public, Virtual
+//  Description: Called by DeletedBufferChain when sampling is
+//               enabled, for each buffer that is returned to it.
+////////////////////////////////////////////////////////////////////
+void MemoryUsage::
+chain_free(void *ptr) {
+  if (may_be_sampled(ptr)) {
+    remove_sample(ptr);
+  }
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: MemoryUsage::ns_record_pointer
 //       Access: Private
@@ -647,6 +742,11 @@ ns_record_pointer(ReferenceCount *ptr) {
 ////////////////////////////////////////////////////////////////////
 void MemoryUsage::
 ns_update_type(ReferenceCount *ptr, TypeHandle type) {
+  if (_sample_interval != 0 &&
+      (size_t)((char *)ptr - (char *)_last_sample_ptr) < _last_sample_size) {
+    update_sample_type(ptr, type);
+  }
+
   if (_track_memory_usage) {
     Table::iterator ti;
     ti = _table.find(ptr);
@@ -681,6 +781,14 @@ ns_update_type(ReferenceCount *ptr, TypeHandle type) {
 ////////////////////////////////////////////////////////////////////
 void MemoryUsage::
 ns_update_type(ReferenceCount *ptr, TypedObject *typed_ptr) {
+  if (_sample_interval != 0 &&
+      (size_t)((char *)ptr - (char *)_last_sample_ptr) < _last_sample_size) {
+    // The object may still be under construction, so this is only
+    // the type of the constructor that is running now; but each
+    // derived constructor that calls update_type() will refine it.
+    update_sample_type(ptr, typed_ptr->get_type());
+  }
+
   if (_track_memory_usage) {
     Table::iterator ti;
     ti = _table.find(ptr);
@@ -1146,6 +1254,248 @@ ns_show_trend_ages() {
   _trend_ages.show();
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: MemoryUsage::ns_show_deleted_chains
+//       Access: Private
+//  Description: Shows the per-size statistics of the
+//               DeletedBufferChains.
+////////////////////////////////////////////////////////////////////
+void MemoryUsage::
+ns_show_deleted_chains() {
+  write_deleted_chains(nout);
+}
+
+// This class is a temporary class used only in
+// MemoryUsage::ns_show_heap_samples(), below, to group the samples
+// that share a type and call stack.
+class HeapSampleSite {
+public:
+  HeapSampleSite() : _count(0), _size(0) { }
+  bool operator < (const HeapSampleSite &other) const {
+    return other._size < _size;
+  }
+
+  TypeHandle _type;
+  vector<void *> _frames;
+  int _count;
+  size_t _size;
+};
+
+////////////////////////////////////////////////////////////////////
+//     Function: MemoryUsage::record_sample
+//       Access: Private
+//  Description: Records the indicated newly-allocated pointer as a
+//               heap sample, along with the current call stack, less
+//               the innermost num_skip_frames frames.
+////////////////////////////////////////////////////////////////////
+void MemoryUsage::
+record_sample(void *ptr, size_t size, TypeHandle type, int num_skip_frames) {
+  HeapSample sample;
+  sample._size = size;
+  sample._type = type;
+  sample._num_frames = 0;
+
+  // Skip the frames for this method and the allocation methods that
+  // called it, which are of no interest.
+  nassertv(num_skip_frames <= max_skip_frames);
+  void *frames[max_sample_frames + max_skip_frames];
+#if defined(HAVE_HEAP_SAMPLE_BACKTRACE)
+  int num_frames = backtrace(frames, max_sample_frames + num_skip_frames);
+#elif defined(WIN32_VC) || defined(WIN64_VC)
+  int num_frames = CaptureStackBackTrace(0, max_sample_frames + num_skip_frames, frames, NULL);
+#else
+  int num_frames = 0;
+#endif
+  for (int i = num_skip_frames; i < num_frames; ++i) {
+    sample._frames[sample._num_frames++] = frames[i];
+  }
+
+  _sample_lock.acquire();
+  pair<Samples::iterator, bool> insert_result =
+    _samples.insert(Samples::value_type(ptr, sample));
+  if (!insert_result.second) {
+    // We must have missed the free, e.g. because the pointer was
+    // freed by a different MemoryHook.  Replace the stale record.
+    _sampled_size -= (*insert_result.first).second._size;
+    (*insert_result.first).second = sample;
+  } else {
+    unsigned char &count = _sample_filter[get_sample_filter_index(ptr)];
+    if (count != 0xff) {
+      ++count;
+    }
+  }
+  _sampled_size += size;
+  _last_sample_ptr = ptr;
+  _last_sample_size = size;
+  _sample_lock.release();
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: MemoryUsage::remove_sample
+//       Access: Private
+//  Description: Called when a pointer that passed may_be_sampled() is
+//               freed, to remove it from the samples table if it is
+//               in fact there.
+////////////////////////////////////////////////////////////////////
+void MemoryUsage::
+remove_sample(void *ptr) {
+  _sample_lock.acquire();
+  Samples::iterator si = _samples.find(ptr);
+  if (si != _samples.end()) {
+    _sampled_size -= (*si).second._size;
+    _samples.erase(si);
+
+    // A saturated counter stays put, since we no longer know how
+    // many pointers share it.
+    unsigned char &count = _sample_filter[get_sample_filter_index(ptr)];
+    if (count != 0xff) {
+      --count;
+    }
+    if (ptr == _last_sample_ptr) {
+      _last_sample_ptr = NULL;
+      _last_sample_size = 0;
+    }
+  }
+  _sample_lock.release();
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: MemoryUsage::update_sample_type
+//       Access: Private
+//  Description: Called by update_type() for a pointer that appears to
+//               be within the most recently sampled allocation, to
+//               associate the type with the sample.
+////////////////////////////////////////////////////////////////////
+void MemoryUsage::
+update_sample_type(void *ptr, TypeHandle type) {
+  _sample_lock.acquire();
+  // Check again, now that we hold the lock; the sample may have been
+  // freed or replaced by another thread in the meantime.
+  if ((size_t)((char *)ptr - (char *)_last_sample_ptr) < _last_sample_size) {
+    Samples::iterator si = _samples.find(_last_sample_ptr);
+    if (si != _samples.end()) {
+      (*si).second._type = type;
+    }
+  }
+  _sample_lock.release();
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: MemoryUsage::ns_get_num_heap_samples
+//       Access: Private
+//  Description: Returns the number of live sampled allocations.
+////////////////////////////////////////////////////////////////////
+int MemoryUsage::
+ns_get_num_heap_samples() {
+  _sample_lock.acquire();
+  int num_samples = (int)_samples.size();
+  _sample_lock.release();
+  return num_samples;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: MemoryUsage::ns_get_sampled_heap_size
+//       Access: Private
+//  Description: Returns the estimated number of live heap bytes,
+//               extrapolated from the samples.
+////////////////////////////////////////////////////////////////////
+size_t MemoryUsage::
+ns_get_sampled_heap_size() {
+  _sample_lock.acquire();
+  size_t size = _sampled_size * (size_t)_sample_interval;
+  _sample_lock.release();
+  return size;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: MemoryUsage::ns_show_heap_samples
+//       Access: Private
+//  Description: Shows the live samples to nout, grouped by type and
+//               call stack.
+////////////////////////////////////////////////////////////////////
+void MemoryUsage::
+ns_show_heap_samples() {
+  if (_sample_interval == 0) {
+    nout << "sample-memory-usage is not enabled.\n";
+    return;
+  }
+
+  // Copy out the samples first, so we don't hold the lock while we
+  // write the report.
+  typedef vector<HeapSample> SampleList;
+  SampleList samples;
+  _sample_lock.acquire();
+  samples.reserve(_samples.size());
+  Samples::const_iterator si;
+  for (si = _samples.begin(); si != _samples.end(); ++si) {
+    samples.push_back((*si).second);
+  }
+  _sample_lock.release();
+
+  // Group them by type and call stack.  Don't use a pmap.
+  typedef map<pair<TypeHandle, vector<void *> >, HeapSampleSite> Sites;
+  Sites sites;
+  size_t total_size = 0;
+  SampleList::const_iterator li;
+  for (li = samples.begin(); li != samples.end(); ++li) {
+    const HeapSample &sample = (*li);
+    vector<void *> frames(sample._frames, sample._frames + sample._num_frames);
+    HeapSampleSite &site = sites[Sites::key_type(sample._type, frames)];
+    if (site._count == 0) {
+      site._type = sample._type;
+      site._frames.swap(frames);
+    }
+    ++site._count;
+    site._size += sample._size;
+    total_size += sample._size;
+  }
+
+  typedef vector<HeapSampleSite> SiteSorter;
+  SiteSorter site_sorter;
+  site_sorter.reserve(sites.size());
+  Sites::const_iterator ti;
+  for (ti = sites.begin(); ti != sites.end(); ++ti) {
+    site_sorter.push_back((*ti).second);
+  }
+  sort(site_sorter.begin(), site_sorter.end());
+
+  nout << samples.size() << " live heap samples, 1 in "
+       << _sample_interval << " allocations; estimated "
+       << total_size * (size_t)_sample_interval << " bytes in "
+       << sites.size() << " call sites:\n";
+
+  SiteSorter::const_iterator vi;
+  for (vi = site_sorter.begin(); vi != site_sorter.end(); ++vi) {
+    const HeapSampleSite &site = (*vi);
+    nout << "\n" << site._size * (size_t)_sample_interval
+         << " bytes (" << site._count << " samples), ";
+    if (site._type == TypeHandle::none()) {
+      nout << "unknown";
+    } else {
+      nout << site._type;
+    }
+    nout << ":\n";
+
+    int num_frames = (int)site._frames.size();
+    void *const *frames = num_frames == 0 ? NULL : &site._frames[0];
+#ifdef HAVE_HEAP_SAMPLE_BACKTRACE
+    char **symbols = backtrace_symbols(frames, num_frames);
+    for (int i = 0; i < num_frames; ++i) {
+      if (symbols != (char **)NULL) {
+        nout << "  " << symbols[i] << "\n";
+      } else {
+        nout << "  " << frames[i] << "\n";
+      }
+    }
+    free(symbols);
+#else
+    for (int i = 0; i < num_frames; ++i) {
+      nout << "  " << frames[i] << "\n";
+    }
+#endif
+  }
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: MemoryUsage::consolidate_void_ptr
 //       Access: Private
@@ -24,6 +24,8 @@
 #include "memoryUsagePointerCounts.h"
 #include "pmap.h"
 #include "memoryHook.h"
+#include "mutexImpl.h"
+#include "atomicAdjust.h"
 
 class ReferenceCount;
 class MemoryUsagePointers;
@@ -56,6 +58,8 @@ public:
   virtual void heap_free_array(void *ptr);
 
   virtual void mark_pointer(void *ptr, size_t orig_size, ReferenceCount *ref_ptr);
+  virtual void chain_alloc(void *ptr, size_t size, TypeHandle type_handle);
+  virtual void chain_free(void *ptr);
 
 #if (defined(WIN32_VC) || defined(WIN64_VC)) && defined(_DEBUG)
   static int win32_malloc_hook(int alloc_type, void *ptr, 
@@ -90,6 +94,13 @@ PUBLISHED:
   INLINE static void show_trend_types();
   INLINE static void show_current_ages();
   INLINE static void show_trend_ages();
+  INLINE static void show_deleted_chains();
+
+  INLINE static bool is_sampling();
+  INLINE static int get_sample_interval();
+  INLINE static int get_num_heap_samples();
+  INLINE static size_t get_sampled_heap_size();
+  INLINE static void show_heap_samples();
 
 protected:
   virtual void overflow_heap_size();
@@ -120,6 +131,18 @@ private:
   void ns_show_trend_types();
   void ns_show_current_ages();
   void ns_show_trend_ages();
+  void ns_show_deleted_chains();
+
+  INLINE bool should_sample();
+  INLINE bool may_be_sampled(void *ptr) const;
+  INLINE static size_t get_sample_filter_index(void *ptr);
+  void record_sample(void *ptr, size_t size, TypeHandle type,
+                     int num_skip_frames);
+  void remove_sample(void *ptr);
+  void update_sample_type(void *ptr, TypeHandle type);
+  int ns_get_num_heap_samples();
+  size_t ns_get_sampled_heap_size();
+  void ns_show_heap_samples();
 
   void consolidate_void_ptr(MemoryInfo *info);
   void refresh_info_set();
@@ -184,6 +207,50 @@ private:
   AgeHistogram _trend_ages;
 
 
+  // The following members implement the sampling heap profiler,
+  // enabled by sample-memory-usage.  This is independent of (and
+  // much cheaper than) track-memory-usage: only one in every
+  // _sample_interval heap allocations is recorded, along with the
+  // stack trace of the code that allocated it.
+  enum {
+    max_sample_frames = 12,
+    max_skip_frames = 4,
+    sample_filter_size = 65536,
+  };
+  class HeapSample {
+  public:
+    size_t _size;
+    TypeHandle _type;
+    int _num_frames;
+    void *_frames[max_sample_frames];
+  };
+
+  // This is keyed on the void pointer of each sampled allocation
+  // that is still live.  It is not a pmap, for the same reason given
+  // above; but since the sampling code never holds _recursion_protect,
+  // it also relies on the fact that map uses the system allocator,
+  // not the MemoryHook.
+  typedef map<void *, HeapSample> Samples;
+  Samples _samples;
+  MutexImpl _sample_lock;
+  size_t _sampled_size;
+
+  int _sample_interval;
+  TVOLATILE AtomicAdjust::Integer _sample_countdown;
+  unsigned int _sample_seed;
+
+  // This is a counting filter on the sampled pointers, so that
+  // heap_free_*() can rule out nearly all pointers without taking
+  // _sample_lock.
+  unsigned char _sample_filter[sample_filter_size];
+
+  // The most recently sampled allocation.  update_type() is usually
+  // called by the constructor immediately following the allocation,
+  // so this lets it discard all of the other objects with a simple
+  // range check.
+  void *_last_sample_ptr;
+  size_t _last_sample_size;
+
   bool _track_memory_usage;
   bool _startup_track_memory_usage;
   bool _count_memory_usage;
@@ -49,6 +49,9 @@ protected:
   // NodePointerToBase, because we will have to specialize on const
   // vs. non-const later.
 
+public:
+  INLINE To *exchange_owned(To *ptr);
+
 PUBLISHED:
   INLINE void clear();
 
@@ -41,6 +41,25 @@ CLP(GeomMunger)(GraphicsStateGuardian *gsg, const RenderState *state) :
   } else if (gl_parallel_arrays) {
     _flags |= F_parallel_arrays;
   }
+
+#ifndef OPENGLES
+  // A quantized vertex column can be issued as normalized integers
+  // through generic vertex attribute 0, which stands for the vertex
+  // position, and the GLSL shaders bind it that way too.  The Cg
+  // shaders, including the generated ones, bind the position
+  // themselves, so we expand the column for them, as we do when
+  // vertex arrays are disabled.
+  CLP(GraphicsStateGuardian) *glgsg;
+  DCAST_INTO_V(glgsg, gsg);
+  const ShaderAttrib *shader_attrib = DCAST(ShaderAttrib, state->get_attrib_def(ShaderAttrib::get_class_slot()));
+  const Shader *shader = shader_attrib->get_shader();
+  if (vertex_arrays && glgsg->get_supports_glsl() &&
+      glgsg->_glVertexAttribPointer != NULL && !shader_attrib->auto_shader() &&
+      (shader == (Shader *)NULL || shader->get_language() == Shader::SL_GLSL)) {
+    _flags |= F_quantized_vertex;
+    _keep_quantized_vertex = true;
+  }
+#endif
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -81,6 +100,13 @@ wp_callback(void *) {
 CPT(GeomVertexFormat) CLP(GeomMunger)::
 munge_format_impl(const GeomVertexFormat *orig,
                   const GeomVertexAnimationSpec &animation) {
+  // The fixed-function vertex arrays can't undo the scale and offset
+  // of a quantized column, so those are expanded to floating-point,
+  // except for a vertex column we can issue as normalized integers.
+  CPT(GeomVertexFormat) unquantized =
+    orig->get_unquantized_format((_flags & F_quantized_vertex) != 0);
+  orig = unquantized;
+
   PT(GeomVertexFormat) new_format = new GeomVertexFormat(*orig);
   new_format->set_animation(animation);
 
@@ -145,11 +171,10 @@ munge_format_impl(const GeomVertexFormat *orig,
     // Split out the interleaved array into n parallel arrays.
     new_format = new GeomVertexFormat;
     for (int i = 0; i < format->get_num_columns(); ++i) {
-      const GeomVertexColumn *column = format->get_column(i);
+      GeomVertexColumn new_column(*format->get_column(i));
+      new_column.set_start(0);
       PT(GeomVertexArrayFormat) new_array_format = new GeomVertexArrayFormat;
-      new_array_format->add_column(column->get_name(), column->get_num_components(),
-                                   column->get_numeric_type(), column->get_contents(),
-                                   -1, column->get_column_alignment());
+      new_array_format->add_column(new_column);
       new_format->add_array(new_array_format);
     }
     format = GeomVertexFormat::register_format(new_format);
@@ -161,10 +186,10 @@ munge_format_impl(const GeomVertexFormat *orig,
 
     const GeomVertexColumn *column = format->get_vertex_column();
     if (column != (const GeomVertexColumn *)NULL) {
-      new_array_format->add_column
-        (column->get_name(), column->get_num_components(),
-         column->get_numeric_type(), column->get_contents(),
-         -1, column->get_column_alignment());
+      // Copy the column, in case it is quantized.
+      GeomVertexColumn new_column(*column);
+      new_column.set_start(new_array_format->get_total_bytes());
+      new_array_format->add_column(new_column);
       new_format->remove_column(column->get_name());
     }
 
@@ -232,6 +257,13 @@ munge_format_impl(const GeomVertexFormat *orig,
 ////////////////////////////////////////////////////////////////////
 CPT(GeomVertexFormat) CLP(GeomMunger)::
 premunge_format_impl(const GeomVertexFormat *orig) {
+  // The fixed-function vertex arrays can't undo the scale and offset
+  // of a quantized column, so those are expanded to floating-point,
+  // except for a vertex column we can issue as normalized integers.
+  CPT(GeomVertexFormat) unquantized =
+    orig->get_unquantized_format((_flags & F_quantized_vertex) != 0);
+  orig = unquantized;
+
   PT(GeomVertexFormat) new_format = new GeomVertexFormat(*orig);
 
   CLP(GraphicsStateGuardian) *glgsg;
@@ -259,11 +291,10 @@ premunge_format_impl(const GeomVertexFormat *orig) {
     // Split out the interleaved array into n parallel arrays.
     new_format = new GeomVertexFormat;
     for (int i = 0; i < format->get_num_columns(); ++i) {
-      const GeomVertexColumn *column = format->get_column(i);
+      GeomVertexColumn new_column(*format->get_column(i));
+      new_column.set_start(0);
       PT(GeomVertexArrayFormat) new_array_format = new GeomVertexArrayFormat;
-      new_array_format->add_column(column->get_name(), column->get_num_components(),
-                                   column->get_numeric_type(), column->get_contents(),
-                                   -1, column->get_column_alignment());
+      new_array_format->add_column(new_column);
       new_format->add_array(new_array_format);
     }
     format = GeomVertexFormat::register_format(new_format);
@@ -280,10 +311,10 @@ premunge_format_impl(const GeomVertexFormat *orig) {
 
     const GeomVertexColumn *column = format->get_vertex_column();
     if (column != (const GeomVertexColumn *)NULL) {
-      new_array_format->add_column
-        (column->get_name(), column->get_num_components(),
-         column->get_numeric_type(), column->get_contents(),
-         -1, column->get_column_alignment());
+      // Copy the column, in case it is quantized.
+      GeomVertexColumn new_column(*column);
+      new_column.set_start(new_array_format->get_total_bytes());
+      new_array_format->add_column(new_column);
       new_format->remove_column(column->get_name());
     }
 
@@ -345,10 +376,9 @@ premunge_format_impl(const GeomVertexFormat *orig) {
       if (orig_a->count_unused_space() != 0) {
         PT(GeomVertexArrayFormat) new_a = new GeomVertexArrayFormat;
         for (int j = 0; j < orig_a->get_num_columns(); ++j) {
-          const GeomVertexColumn *column = orig_a->get_column(j);
-          new_a->add_column(column->get_name(), column->get_num_components(),
-                            column->get_numeric_type(), column->get_contents(),
-                            -1, column->get_column_alignment());
+          GeomVertexColumn new_column(*orig_a->get_column(j));
+          new_column.set_start(new_a->get_total_bytes());
+          new_a->add_column(new_column);
         }
         new_format->set_array(i, new_a);
       }
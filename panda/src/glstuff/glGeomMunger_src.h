@@ -55,6 +55,7 @@ private:
   enum Flags {
     F_interleaved_arrays   = 0x0001,
     F_parallel_arrays      = 0x0002,
+    F_quantized_vertex     = 0x0004,
   };
   int _flags;
 
@@ -2046,6 +2046,9 @@ reset() {
   _texture_binding_shader = (Shader *)NULL;
   _texture_binding_shader_context = (ShaderContext *)NULL;
 #endif
+#ifndef OPENGLES
+  _normalized_vertex_array = false;
+#endif
 
 #ifdef OPENGLES_2
   _max_lights = 0;
@@ -3398,9 +3401,31 @@ update_standard_vertex_arrays(bool force) {
       if (!setup_array_data(client_pointer, array_reader, force)) {
         return false;
       }
-      glVertexPointer(num_values, get_numeric_type(numeric_type),
-                         stride, client_pointer + start);
-      glEnableClientState(GL_VERTEX_ARRAY);
+#ifndef OPENGLES
+      if (_data_reader->get_format()->get_vertex_column()->is_quantized()) {
+        // The munger left the vertex column quantized (see
+        // GeomMunger::keeps_quantized_vertex()).  glVertexPointer()
+        // can't normalize it, but generic attribute 0 stands for the
+        // vertex position, and can.  The column's scale and offset
+        // are already in the model transform.
+        glDisableClientState(GL_VERTEX_ARRAY);
+        _glVertexAttribPointer(0, num_values, get_numeric_type(numeric_type),
+                               GL_TRUE, stride, client_pointer + start);
+        _glEnableVertexAttribArray(0);
+        _normalized_vertex_array = true;
+      } else
+#endif
+      {
+#ifndef OPENGLES
+        if (_normalized_vertex_array) {
+          _glDisableVertexAttribArray(0);
+          _normalized_vertex_array = false;
+        }
+#endif
+        glVertexPointer(num_values, get_numeric_type(numeric_type),
+                        stride, client_pointer + start);
+        glEnableClientState(GL_VERTEX_ARRAY);
+      }
     }
   }
 #endif  // OPENGLES_2
@@ -3473,6 +3498,12 @@ disable_standard_vertex_arrays() {
 #endif
 
   glDisableClientState(GL_VERTEX_ARRAY);
+#ifndef OPENGLES
+  if (_normalized_vertex_array) {
+    _glDisableVertexAttribArray(0);
+    _normalized_vertex_array = false;
+  }
+#endif
   report_my_gl_errors();
 #endif
 }
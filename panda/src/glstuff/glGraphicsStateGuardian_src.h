@@ -566,6 +566,12 @@ protected:
   bool _use_sender;
 #endif  // SUPPORT_IMMEDIATE_MODE
 
+#ifndef OPENGLES
+  // True if update_standard_vertex_arrays() issued a quantized vertex
+  // column through generic vertex attribute 0.
+  bool _normalized_vertex_array;
+#endif
+
   // Cache the data necessary to bind each particular light each
   // frame, so if we bind a given light multiple times, we only have
   // to compute its data once.
@@ -47,6 +47,7 @@
     lens.h lens.I \
     material.I material.h materialPool.I materialPool.h  \
     matrixLens.I matrixLens.h \
+    meshSimplifier.I meshSimplifier.h \
     occlusionQueryContext.I occlusionQueryContext.h \
     orthographicLens.I orthographicLens.h perspectiveLens.I  \
     perspectiveLens.h \
@@ -74,6 +75,7 @@
     userVertexSlider.I userVertexSlider.h \
     userVertexTransform.I userVertexTransform.h \
     vertexBufferContext.I vertexBufferContext.h \
+    vertexCacheOptimizer.I vertexCacheOptimizer.h \
     vertexDataBlock.I vertexDataBlock.h \
     vertexDataBook.I vertexDataBook.h \
     vertexDataBuffer.I vertexDataBuffer.h \
@@ -118,6 +120,7 @@
     internalName.cxx \
     lens.cxx  \
     materialPool.cxx matrixLens.cxx \
+    meshSimplifier.cxx \
     occlusionQueryContext.cxx \
     orthographicLens.cxx  \
     perspectiveLens.cxx \
@@ -145,6 +148,7 @@
     userVertexSlider.cxx \
     userVertexTransform.cxx \
     vertexBufferContext.cxx \
+    vertexCacheOptimizer.cxx \
     vertexDataBlock.cxx \
     vertexDataBook.cxx \
     vertexDataBuffer.cxx \
@@ -191,6 +195,7 @@
     lens.h lens.I \
     material.I material.h \
     materialPool.I materialPool.h matrixLens.I matrixLens.h \
+    meshSimplifier.I meshSimplifier.h \
     occlusionQueryContext.I occlusionQueryContext.h \
     orthographicLens.I orthographicLens.h perspectiveLens.I \
     perspectiveLens.h \
@@ -218,6 +223,7 @@
     userVertexSlider.I userVertexSlider.h \
     userVertexTransform.I userVertexTransform.h \
     vertexBufferContext.I vertexBufferContext.h \
+    vertexCacheOptimizer.I vertexCacheOptimizer.h \
     vertexDataBlock.I vertexDataBlock.h \
     vertexDataBook.I vertexDataBook.h \
     vertexDataBuffer.I vertexDataBuffer.h \
@@ -242,3 +248,13 @@
 
 #end test_bin_target
 
+#begin test_bin_target
+  #define TARGET test_texture_process
+  #define LOCAL_LIBS \
+    p3gobj p3putil p3event
+
+  #define SOURCES \
+    test_texture_process.cxx
+
+#end test_bin_target
+
@@ -138,6 +138,16 @@ ConfigVariableBool driver_generate_mipmaps
           "automatically in all cases, if supported.  Set it false "
           "to generate mipmaps in software when possible."));
 
+ConfigVariableInt texture_process_threads
+("texture-process-threads", 0,
+ PRC_DESC("The number of threads that may be used to generate the mipmap "
+          "levels of a texture in software, and to compress its RAM "
+          "images with the squish library.  The rows and pages of each "
+          "mipmap level, and the blocks of each compressed image, are "
+          "divided among the threads of the \"texture_process\" task "
+          "chain.  If this is 0 or 1, all of the work is done in the "
+          "calling thread."));
+
 ConfigVariableBool vertex_buffers
 ("vertex-buffers", true,
  PRC_DESC("Set this true to allow the use of vertex buffers (or buffer "
@@ -307,6 +317,14 @@ ConfigVariableBool vertex_animation_align_16
           "impacts only vertex formats created within Panda subsystems; custom "
           "vertex formats are not affected."));
 
+ConfigVariableInt vertex_cache_size
+("vertex-cache-size", 32,
+ PRC_DESC("The size of the post-transform vertex cache that is assumed when "
+          "triangles are reordered by GeomPrimitive::optimize_vertex_cache() "
+          "and SceneGraphReducer::optimize_vertex_cache().  The default "
+          "suits all current hardware, including cards with smaller "
+          "caches."));
+
 ConfigVariableEnum<AutoTextureScale> textures_power_2
 ("textures-power-2", ATS_down,
  PRC_DESC("Specify whether textures should automatically be constrained to "
@@ -103,6 +103,8 @@ PUBLISHED:
   INLINE PT(Geom) unify(int max_indices, bool preserve_order) const;
   INLINE PT(Geom) make_points() const;
   INLINE PT(Geom) make_patches() const;
+  INLINE PT(Geom) optimize_vertex_cache() const;
+  INLINE PT(Geom) simplify(PN_stdfloat fraction, PN_stdfloat max_error) const;
 
   void decompose_in_place();
   void doubleside_in_place();
@@ -111,6 +113,8 @@ PUBLISHED:
   void unify_in_place(int max_indices, bool preserve_order);
   void make_points_in_place();
   void make_patches_in_place();
+  void optimize_vertex_cache_in_place();
+  void simplify_in_place(PN_stdfloat fraction, PN_stdfloat max_error);
 
   virtual bool copy_primitives_from(const Geom *other);
 
@@ -31,6 +31,7 @@ PStatCollector GeomMunger::_munge_pcollector("*:Munge");
 ////////////////////////////////////////////////////////////////////
 GeomMunger::
 GeomMunger(GraphicsStateGuardianBase *gsg) :
+  _keep_quantized_vertex(false),
   _gsg(gsg),
   _is_registered(false)
 {
@@ -48,6 +49,7 @@ GeomMunger(GraphicsStateGuardianBase *gsg) :
 ////////////////////////////////////////////////////////////////////
 GeomMunger::
 GeomMunger(const GeomMunger &copy) :
+  _keep_quantized_vertex(copy._keep_quantized_vertex),
   _is_registered(false)
 {
 #ifndef NDEBUG
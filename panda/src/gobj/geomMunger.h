@@ -62,6 +62,7 @@ public:
   virtual ~GeomMunger();
 
   INLINE GraphicsStateGuardianBase *get_gsg() const;
+  INLINE bool keeps_quantized_vertex() const;
 
   INLINE bool is_registered() const;
   INLINE static PT(GeomMunger) register_munger(GeomMunger *munger, Thread *current_thread);
@@ -105,6 +106,12 @@ protected:
   virtual int compare_to_impl(const GeomMunger *other) const;
   virtual int geom_compare_to_impl(const GeomMunger *other) const;
 
+protected:
+  // A derived class sets this in its constructor, if it will leave
+  // quantized vertex columns in place.  It must also compare mungers
+  // that differ in this respect as different.
+  bool _keep_quantized_vertex;
+
 private:
   class Registry;
   INLINE static Registry *get_registry();
@@ -22,6 +22,9 @@
 #include "geomVertexWriter.h"
 #include "geomVertexRewriter.h"
 #include "geomPoints.h"
+#include "vertexCacheOptimizer.h"
+#include "meshSimplifier.h"
+#include "config_gobj.h"
 #include "preparedGraphicsObjects.h"
 #include "internalName.h"
 #include "bamReader.h"
@@ -38,6 +41,8 @@ PStatCollector GeomPrimitive::_decompose_pcollector("*:Munge:Decompose");
 PStatCollector GeomPrimitive::_doubleside_pcollector("*:Munge:Doubleside");
 PStatCollector GeomPrimitive::_reverse_pcollector("*:Munge:Reverse");
 PStatCollector GeomPrimitive::_rotate_pcollector("*:Munge:Rotate");
+PStatCollector GeomPrimitive::_optimize_vertex_cache_pcollector("*:Munge:Optimize vertex cache");
+PStatCollector GeomPrimitive::_simplify_pcollector("*:Munge:Simplify");
 
 ////////////////////////////////////////////////////////////////////
 //     Function: GeomPrimitive::Default Constructor
@@ -1073,6 +1078,171 @@ make_patches() const {
   return patches;
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: GeomPrimitive::optimize_vertex_cache
+//       Access: Published
+//  Description: Returns a new primitive with the same triangles as
+//               this one, reordered so that vertices are reused
+//               while they are still in the graphics card's
+//               post-transform vertex cache.  Triangle strips and
+//               fans are first decomposed into triangles, since an
+//               indexed triangle list drawn in this order is
+//               generally as fast as the best strips.
+//
+//               The vertices within each triangle are not rotated,
+//               so the shade model is unaffected.  The vertex table
+//               itself is not reordered; see
+//               SceneGraphReducer::optimize_vertex_cache(), which
+//               does this too.
+//
+//               If the primitive is not made of triangles, or is not
+//               indexed, this returns the original primitive (or its
+//               decomposition).
+////////////////////////////////////////////////////////////////////
+CPT(GeomPrimitive) GeomPrimitive::
+optimize_vertex_cache() const {
+  if (get_primitive_type() != PT_polygons) {
+    return this;
+  }
+
+  CPT(GeomPrimitive) prim = decompose();
+  if (prim->get_num_vertices_per_primitive() != 3 || !prim->is_indexed()) {
+    return prim;
+  }
+
+  int num_vertices = prim->get_num_vertices();
+  if (num_vertices < 6) {
+    // Nothing to reorder.
+    return prim;
+  }
+
+  PStatTimer timer(_optimize_vertex_cache_pcollector);
+
+  pvector<int> indices;
+  indices.reserve(num_vertices);
+  {
+    GeomVertexReader reader(prim->get_vertices(), 0);
+    while (!reader.is_at_end()) {
+      indices.push_back(reader.get_data1i());
+    }
+  }
+  nassertr((int)indices.size() == num_vertices, prim);
+
+  VertexCacheOptimizer optimizer(vertex_cache_size);
+  optimizer.optimize(&indices[0], num_vertices / 3, prim->get_max_vertex() + 1);
+
+  PT(GeomPrimitive) new_prim = prim->make_copy();
+  {
+    PT(GeomVertexArrayData) vertices = new_prim->modify_vertices();
+    GeomVertexWriter writer(vertices, 0);
+    pvector<int>::const_iterator ii;
+    for (ii = indices.begin(); ii != indices.end(); ++ii) {
+      writer.set_data1i(*ii);
+    }
+  }
+
+  if (gobj_cat.is_debug()) {
+    gobj_cat.debug()
+      << "Optimized " << num_vertices / 3 << " triangles of " << get_type()
+      << " " << (void *)this << " for the vertex cache\n";
+  }
+
+  return new_prim;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: GeomPrimitive::simplify
+//       Access: Published
+//  Description: Returns a new primitive with about the indicated
+//               fraction of the triangles of this one, produced by
+//               collapsing the edges that least change the shape of
+//               the surface, as long as no vertex moves farther than
+//               max_error from the surface it replaces.  See
+//               MeshSimplifier.
+//
+//               vertex_data is the table whose vertices this
+//               primitive indexes.  The remaining triangles still
+//               use the original vertices, unmoved, so the vertex
+//               data can be shared with the original primitive;
+//               vertices with different normals, colors or texture
+//               coordinates at the same position are treated as a
+//               seam, which keeps its shape.
+//
+//               Only indexed triangles are simplified; triangle
+//               strips and fans are decomposed first.  Other kinds
+//               of primitives are returned unchanged.
+////////////////////////////////////////////////////////////////////
+CPT(GeomPrimitive) GeomPrimitive::
+simplify(const GeomVertexData *vertex_data, PN_stdfloat fraction,
+         PN_stdfloat max_error) const {
+  if (get_primitive_type() != PT_polygons) {
+    return this;
+  }
+
+  CPT(GeomPrimitive) prim = decompose();
+  if (prim->get_num_vertices_per_primitive() != 3 || !prim->is_indexed() ||
+      !vertex_data->has_column(InternalName::get_vertex())) {
+    return prim;
+  }
+
+  int num_vertices = prim->get_num_vertices();
+  int num_triangles = num_vertices / 3;
+  int target_triangles = (int)(num_triangles * fraction);
+  if (target_triangles >= num_triangles) {
+    return prim;
+  }
+
+  PStatTimer timer(_simplify_pcollector);
+
+  pvector<int> indices;
+  indices.reserve(num_vertices);
+  {
+    GeomVertexReader reader(prim->get_vertices(), 0);
+    while (!reader.is_at_end()) {
+      indices.push_back(reader.get_data1i());
+    }
+  }
+  nassertr((int)indices.size() == num_vertices, prim);
+
+  int num_rows = prim->get_max_vertex() + 1;
+  nassertr(num_rows <= vertex_data->get_num_rows(), prim);
+  pvector<LPoint3> positions;
+  positions.reserve(num_rows);
+  {
+    GeomVertexReader reader(vertex_data, InternalName::get_vertex());
+    while ((int)positions.size() < num_rows) {
+      positions.push_back(reader.get_data3());
+    }
+  }
+
+  MeshSimplifier simplifier;
+  int new_num_triangles =
+    simplifier.simplify(&indices[0], num_triangles, &positions[0], num_rows,
+                        target_triangles, max_error);
+  if (new_num_triangles == num_triangles) {
+    return prim;
+  }
+
+  PT(GeomPrimitive) new_prim = prim->make_copy();
+  {
+    PT(GeomVertexArrayData) vertices = new_prim->modify_vertices();
+    vertices->set_num_rows(new_num_triangles * 3);
+    GeomVertexWriter writer(vertices, 0);
+    for (int i = 0; i < new_num_triangles * 3; ++i) {
+      writer.set_data1i(indices[i]);
+    }
+  }
+
+  if (gobj_cat.is_debug()) {
+    gobj_cat.debug()
+      << "Simplified " << num_triangles << " triangles of " << get_type()
+      << " " << (void *)this << " to " << new_num_triangles
+      << ", error " << simplifier.get_error() << "\n";
+  }
+
+  return new_prim;
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: GeomPrimitive::get_num_bytes
 //       Access: Published
@@ -135,6 +135,10 @@ PUBLISHED:
   CPT(GeomPrimitive) match_shade_model(ShadeModel shade_model) const;
   CPT(GeomPrimitive) make_points() const;
   CPT(GeomPrimitive) make_patches() const;
+  CPT(GeomPrimitive) optimize_vertex_cache() const;
+  CPT(GeomPrimitive) simplify(const GeomVertexData *vertex_data,
+                              PN_stdfloat fraction,
+                              PN_stdfloat max_error) const;
 
   int get_num_bytes() const;
   INLINE int get_data_size_bytes() const;
@@ -295,6 +299,8 @@ private:
   static PStatCollector _doubleside_pcollector;
   static PStatCollector _reverse_pcollector;
   static PStatCollector _rotate_pcollector;
+  static PStatCollector _optimize_vertex_cache_pcollector;
+  static PStatCollector _simplify_pcollector;
 
 public:
   virtual void write_datagram(BamWriter *manager, Datagram &dg);
@@ -416,39 +416,123 @@ clear_prepared(PreparedGraphicsObjects *prepared_objects) {
 ////////////////////////////////////////////////////////////////////
 //     Function: GeomVertexArrayData::reverse_data_endianness
 //       Access: Private
-//  Description: Fills a new data array with all numeric values
-//               expressed in the indicated array reversed,
-//               byte-for-byte, to convert littleendian to bigendian
-//               and vice-versa.
+//  Description: Reverses, in place, all numeric values in the
+//               indicated data array, byte-for-byte, to convert
+//               littleendian to bigendian and vice-versa.
+//
+//               When every byte of a row belongs to a component of
+//               the same size (which is the case for index arrays
+//               and for most all-float vertex formats), the whole
+//               array is swapped as one flat run of words; otherwise
+//               the rows are walked column by column.
 ////////////////////////////////////////////////////////////////////
 void GeomVertexArrayData::
-reverse_data_endianness(unsigned char *dest, const unsigned char *source, 
-                        size_t size) {
+reverse_data_endianness(unsigned char *data, size_t size) {
+  int stride = _array_format->get_stride();
   int num_columns = _array_format->get_num_columns();
+  nassertv(stride > 0);
+
+  // First, see whether the rows are made up entirely of components of
+  // one size.
+  int uniform_bytes = 0;
+  int covered_bytes = 0;
+  for (int ci = 0; ci < num_columns; ++ci) {
+    const GeomVertexColumn *col = _array_format->get_column(ci);
+    int component_bytes = col->get_component_bytes();
+    if (uniform_bytes == 0) {
+      uniform_bytes = component_bytes;
+    } else if (uniform_bytes != component_bytes) {
+      uniform_bytes = -1;
+      break;
+    }
+    covered_bytes += col->get_total_bytes();
+  }
+
+  size_t num_rows = size / stride;
+
+  if (uniform_bytes > 0 && covered_bytes == stride) {
+    if (uniform_bytes > 1) {
+      reverse_words(data, (num_rows * stride) / uniform_bytes, uniform_bytes);
+    }
+    return;
+  }
 
   // Walk through each row of the data.
-  for (size_t pi = 0; pi < size; pi += _array_format->get_stride()) {
-    // For each row, visit all of the columns; and for each column,
-    // visit all of the components of that column.
+  for (size_t ri = 0; ri < num_rows; ++ri) {
+    unsigned char *row = data + ri * stride;
+
+    // For each row, visit all of the columns, and reverse all of the
+    // components of that column.
     for (int ci = 0; ci < num_columns; ++ci) {
       const GeomVertexColumn *col = _array_format->get_column(ci);
       int component_bytes = col->get_component_bytes();
       if (component_bytes > 1) {
-        // Get the index of the beginning of the column.
-        size_t ci = pi + col->get_start();
-
-        int num_components = col->get_num_components();
-        for (int cj = 0; cj < num_components; ++cj) {
-          // Reverse the bytes of each component.
-          ReversedNumericData nd(source + ci, component_bytes);
-          nd.store_value(dest + ci, component_bytes);
-          ci += component_bytes;
-        }
+        reverse_words(row + col->get_start(), col->get_num_components(),
+                      component_bytes);
       }
     }
   }
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: GeomVertexArrayData::reverse_words
+//       Access: Private, Static
+//  Description: Byte-swaps, in place, num_words consecutive numeric
+//               values of word_bytes bytes each.  The common sizes
+//               are spelled out so the compiler can turn them into
+//               native byte-swap instructions, rather than going
+//               through ReversedNumericData one byte at a time.
+////////////////////////////////////////////////////////////////////
+void GeomVertexArrayData::
+reverse_words(unsigned char *data, size_t num_words, int word_bytes) {
+  unsigned char *end = data + num_words * word_bytes;
+
+  switch (word_bytes) {
+  case 2:
+    for (unsigned char *p = data; p < end; p += 2) {
+      unsigned char b0 = p[0];
+      p[0] = p[1];
+      p[1] = b0;
+    }
+    break;
+
+  case 4:
+    for (unsigned char *p = data; p < end; p += 4) {
+      unsigned char b0 = p[0];
+      unsigned char b1 = p[1];
+      p[0] = p[3];
+      p[1] = p[2];
+      p[2] = b1;
+      p[3] = b0;
+    }
+    break;
+
+  case 8:
+    for (unsigned char *p = data; p < end; p += 8) {
+      unsigned char b0 = p[0];
+      unsigned char b1 = p[1];
+      unsigned char b2 = p[2];
+      unsigned char b3 = p[3];
+      p[0] = p[7];
+      p[1] = p[6];
+      p[2] = p[5];
+      p[3] = p[4];
+      p[4] = b3;
+      p[5] = b2;
+      p[6] = b1;
+      p[7] = b0;
+    }
+    break;
+
+  default:
+    for (unsigned char *p = data; p < end; p += word_bytes) {
+      ReversedNumericData nd(p, word_bytes);
+      nd.store_value(p, word_bytes);
+    }
+    break;
+  }
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: GeomVertexArrayData::register_with_read_factory
 //       Access: Public, Static
@@ -532,13 +616,27 @@ finalize(BamReader *manager) {
   manager->change_pointer(_array_format, new_array_format);
   _array_format = new_array_format;
 
+  if (cdata->_buffer.is_shared()) {
+    // The data was read directly out of the datagram.  Each numeric
+    // component must still be naturally aligned, or we copy it into
+    // memory of our own, which is.
+    size_t alignment = 1;
+    for (int i = 0; i < _array_format->get_num_columns(); ++i) {
+      alignment = max(alignment, (size_t)_array_format->get_column(i)->get_component_bytes());
+    }
+    const unsigned char *pointer = cdata->_buffer.get_read_pointer(true);
+    if (((size_t)pointer & (alignment - 1)) != 0) {
+      cdata->_buffer.get_write_pointer();
+    }
+  }
+
   PT(BamAuxData) aux_data = (BamAuxData *)manager->get_aux_data(this, "");
   if (aux_data != (BamAuxData *)NULL) {
     if (aux_data->_endian_reversed) {
-      // Now is the time to endian-reverse the data.
-      VertexDataBuffer new_buffer(cdata->_buffer.get_size());
-      reverse_data_endianness(new_buffer.get_write_pointer(), cdata->_buffer.get_read_pointer(true), cdata->_buffer.get_size());
-      cdata->_buffer.swap(new_buffer);
+      // Now is the time to endian-reverse the data.  We can do this in
+      // place, without allocating a second buffer.
+      reverse_data_endianness(cdata->_buffer.get_write_pointer(),
+                              cdata->_buffer.get_size());
     }
   }
 
@@ -611,17 +709,17 @@ write_datagram(BamWriter *manager, Datagram &dg, void *extra_data) const {
   GeomVertexArrayData *array_data = (GeomVertexArrayData *)extra_data;
   dg.add_uint8(_usage_hint);
 
-  dg.add_uint32(_buffer.get_size());
+  size_t size = _buffer.get_size();
+  dg.add_uint32(size);
 
-  if (manager->get_file_endian() == BamWriter::BE_native) {
-    // For native endianness, we only have to write the data directly.
-    dg.append_data(_buffer.get_read_pointer(true), _buffer.get_size());
+  size_t start = dg.get_length();
+  dg.append_data(_buffer.get_read_pointer(true), size);
 
-  } else {
-    // Otherwise, we have to convert it.
-    unsigned char *new_data = (unsigned char *)alloca(_buffer.get_size());
-    array_data->reverse_data_endianness(new_data, _buffer.get_read_pointer(true), _buffer.get_size());
-    dg.append_data(new_data, _buffer.get_size());
+  if (manager->get_file_endian() != BamWriter::BE_native && size != 0) {
+    // For non-native endianness, we convert the data in place, right
+    // in the datagram, rather than making a temporary copy of it.
+    PTA_uchar dg_data = dg.modify_array();
+    array_data->reverse_data_endianness(&dg_data[start], size);
   }
 }
 
@@ -648,12 +746,23 @@ fillin(DatagramIterator &scan, BamReader *manager, void *extra_data) {
   } else {
     // Now, the array data is just stored directly.
     size_t size = scan.get_uint32();
-    _buffer.unclean_realloc(size);
-    _buffer.set_size(size);
+    CPTA_uchar source = scan.get_datagram().get_array();
+    size_t offset = scan.get_current_index();
+    nassertv(offset + size <= source.size());
+
+    if (manager->get_file_endian() == BamReader::BE_native &&
+        size * 2 >= source.v().capacity()) {
+      // The vertex data makes up most of the datagram, so rather than
+      // copying it out, we keep the datagram's array and read the
+      // vertices directly from it.  finalize() makes a copy after all
+      // if the data turns out to be misaligned for its format.
+      _buffer.share_data(source, offset, size);
 
-    const unsigned char *source_data = 
-      (const unsigned char *)scan.get_datagram().get_data();
-    memcpy(_buffer.get_write_pointer(), source_data + scan.get_current_index(), size);
+    } else {
+      _buffer.unclean_realloc(size);
+      _buffer.set_size(size);
+      memcpy(_buffer.get_write_pointer(), source.p() + offset, size);
+    }
     scan.skip_bytes(size);
   }
 
@@ -670,9 +779,8 @@ fillin(DatagramIterator &scan, BamReader *manager, void *extra_data) {
       // Since we have the _array_format pointer now, we can reverse
       // it immediately (and we should, to support threaded CData
       // updates).
-      VertexDataBuffer new_buffer(_buffer.get_size());
-      array_data->reverse_data_endianness(new_buffer.get_write_pointer(), _buffer.get_read_pointer(true), _buffer.get_size());
-      _buffer.swap(new_buffer);
+      array_data->reverse_data_endianness(_buffer.get_write_pointer(),
+                                          _buffer.get_size());
     }
   }
 
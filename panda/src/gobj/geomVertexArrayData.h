@@ -127,8 +127,9 @@ private:
   INLINE void set_lru_size(size_t lru_size);
 
   void clear_prepared(PreparedGraphicsObjects *prepared_objects);
-  void reverse_data_endianness(unsigned char *dest, 
-                               const unsigned char *source, size_t size);
+  void reverse_data_endianness(unsigned char *data, size_t size);
+  static void reverse_words(unsigned char *data, size_t num_words,
+                            int word_bytes);
 
 
   CPT(GeomVertexArrayFormat) _array_format;
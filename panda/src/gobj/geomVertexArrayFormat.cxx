@@ -359,8 +359,13 @@ pack_columns() {
   Columns::const_iterator ci;
   for (ci = orig_columns.begin(); ci != orig_columns.end(); ++ci) {
     GeomVertexColumn *column = (*ci);
-    add_column(column->get_name(), column->get_num_components(),
-               column->get_numeric_type(), column->get_contents());
+    GeomVertexColumn new_column(column->get_name(), column->get_num_components(),
+                                column->get_numeric_type(), column->get_contents(),
+                                _total_bytes);
+    if (column->is_quantized()) {
+      new_column.set_scale_offset(column->get_scale(), column->get_offset());
+    }
+    add_column(new_column);
   }
 }
 
@@ -392,8 +397,13 @@ align_columns_for_animation() {
         column->get_num_components() >= 3) {
       add_column(column->get_name(), 4, column->get_numeric_type(), column->get_contents(), -1, 16);
     } else {
-      add_column(column->get_name(), column->get_num_components(),
-                 column->get_numeric_type(), column->get_contents());
+      GeomVertexColumn new_column(column->get_name(), column->get_num_components(),
+                                  column->get_numeric_type(), column->get_contents(),
+                                  _total_bytes);
+      if (column->is_quantized()) {
+        new_column.set_scale_offset(column->get_scale(), column->get_offset());
+      }
+      add_column(new_column);
     }
   }
 }
@@ -30,6 +30,9 @@ operator = (const GeomVertexColumn &copy) {
   _contents = copy._contents;
   _start = copy._start;
   _column_alignment = copy._column_alignment;
+  _quantized = copy._quantized;
+  _scale = copy._scale;
+  _offset = copy._offset;
 
   setup();
 }
@@ -112,6 +115,51 @@ set_column_alignment(int column_alignment) {
   setup();
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: GeomVertexColumn::set_scale_offset
+//       Access: Published
+//  Description: Makes this a quantized column: each integer value
+//               stored in the column stands for the floating-point
+//               value (stored * scale + offset), component by
+//               component.  GeomVertexReader and GeomVertexWriter
+//               convert to and from these values automatically.
+//
+//               This is only valid for a column of integer numeric
+//               type, and not for a color or index column.  It is
+//               only legal on an unregistered format (i.e. when
+//               constructing the format initially).
+////////////////////////////////////////////////////////////////////
+void GeomVertexColumn::
+set_scale_offset(const LVecBase4 &scale, const LVecBase4 &offset) {
+  nassertv(_numeric_type == NT_uint8 || _numeric_type == NT_uint16 ||
+           _numeric_type == NT_uint32);
+  nassertv(_contents != C_color && _contents != C_index);
+  for (int i = 0; i < _num_components && i < 4; ++i) {
+    nassertv(scale[i] != 0.0f);
+  }
+
+  _quantized = true;
+  _scale = scale;
+  _offset = offset;
+  setup();
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: GeomVertexColumn::clear_scale_offset
+//       Access: Published
+//  Description: Undoes the effect of a previous call to
+//               set_scale_offset(), so that the integer values in
+//               the column are read as they are.  This is only legal
+//               on an unregistered format.
+////////////////////////////////////////////////////////////////////
+void GeomVertexColumn::
+clear_scale_offset() {
+  _quantized = false;
+  _scale.set(1.0f, 1.0f, 1.0f, 1.0f);
+  _offset.set(0.0f, 0.0f, 0.0f, 0.0f);
+  setup();
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: GeomVertexColumn::output
 //       Access: Published
@@ -154,6 +202,12 @@ output(ostream &out) const {
     break;
   }
 
+  if (is_octahedral()) {
+    out << " oct";
+  } else if (_quantized) {
+    out << " * " << _scale << " + " << _offset;
+  }
+
   out << ")";
 }
 
@@ -221,6 +275,23 @@ setup() {
 
   _total_bytes = _component_bytes * _num_components;
 
+  if (_quantized) {
+    // A scale and offset only make sense on integer values that
+    // aren't already given a meaning of their own.
+    switch (_numeric_type) {
+    case NT_uint8:
+    case NT_uint16:
+    case NT_uint32:
+      if (_contents == C_color || _contents == C_index) {
+        _quantized = false;
+      }
+      break;
+
+    default:
+      _quantized = false;
+    }
+  }
+
   if (_packer != NULL) {
     delete _packer;
   }
@@ -238,6 +309,13 @@ setup() {
 ////////////////////////////////////////////////////////////////////
 GeomVertexColumn::Packer *GeomVertexColumn::
 make_packer() const {
+  if (_quantized) {
+    if (is_octahedral()) {
+      return new Packer_octahedral;
+    }
+    return new Packer_quantized;
+  }
+
   switch (get_contents()) {
   case C_point:
   case C_clip_point:
@@ -389,6 +467,12 @@ write_datagram(BamWriter *manager, Datagram &dg) {
   dg.add_uint8(_contents);
   dg.add_uint16(_start);
   dg.add_uint8(_column_alignment);
+
+  dg.add_bool(_quantized);
+  if (_quantized) {
+    _scale.write_datagram(dg);
+    _offset.write_datagram(dg);
+  }
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -428,6 +512,15 @@ fillin(DatagramIterator &scan, BamReader *manager) {
     _column_alignment = scan.get_uint8();
   }
 
+  _quantized = false;
+  if (manager->get_file_minor_ver() >= 37) {
+    _quantized = scan.get_bool();
+    if (_quantized) {
+      _scale.read_datagram(scan);
+      _offset.read_datagram(scan);
+    }
+  }
+
   setup();
 }
 
@@ -3310,6 +3403,436 @@ get_data4f(const unsigned char *pointer) {
   return *(const LVecBase4f *)pointer;
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: GeomVertexColumn::Packer_quantized::get_data1f
+//       Access: Public, Virtual
+//  Description: 
+////////////////////////////////////////////////////////////////////
+float GeomVertexColumn::Packer_quantized::
+get_data1f(const unsigned char *pointer) {
+  load(pointer);
+  return _v4d[0];
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: GeomVertexColumn::Packer_quantized::get_data2f
+//       Access: Public, Virtual
+//  Description: 
+////////////////////////////////////////////////////////////////////
+const LVecBase2f &GeomVertexColumn::Packer_quantized::
+get_data2f(const unsigned char *pointer) {
+  load(pointer);
+  _v2.set(_v4d[0], _v4d[1]);
+  return _v2;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: GeomVertexColumn::Packer_quantized::get_data3f
+//       Access: Public, Virtual
+//  Description: 
+////////////////////////////////////////////////////////////////////
+const LVecBase3f &GeomVertexColumn::Packer_quantized::
+get_data3f(const unsigned char *pointer) {
+  load(pointer);
+  _v3.set(_v4d[0], _v4d[1], _v4d[2]);
+  return _v3;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: GeomVertexColumn::Packer_quantized::get_data4f
+//       Access: Public, Virtual
+//  Description: 
+////////////////////////////////////////////////////////////////////
+const LVecBase4f &GeomVertexColumn::Packer_quantized::
+get_data4f(const unsigned char *pointer) {
+  load(pointer);
+  _v4.set(_v4d[0], _v4d[1], _v4d[2], _v4d[3]);
+  return _v4;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: GeomVertexColumn::Packer_quantized::get_data1d
+//       Access: Public, Virtual
+//  Description: 
+////////////////////////////////////////////////////////////////////
+double GeomVertexColumn::Packer_quantized::
+get_data1d(const unsigned char *pointer) {
+  load(pointer);
+  return _v4d[0];
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: GeomVertexColumn::Packer_quantized::get_data2d
+//       Access: Public, Virtual
+//  Description: 
+////////////////////////////////////////////////////////////////////
+const LVecBase2d &GeomVertexColumn::Packer_quantized::
+get_data2d(const unsigned char *pointer) {
+  load(pointer);
+  _v2d.set(_v4d[0], _v4d[1]);
+  return _v2d;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: GeomVertexColumn::Packer_quantized::get_data3d
+//       Access: Public, Virtual
+//  Description: 
+////////////////////////////////////////////////////////////////////
+const LVecBase3d &GeomVertexColumn::Packer_quantized::
+get_data3d(const unsigned char *pointer) {
+  load(pointer);
+  _v3d.set(_v4d[0], _v4d[1], _v4d[2]);
+  return _v3d;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: GeomVertexColumn::Packer_quantized::get_data4d
+//       Access: Public, Virtual
+//  Description: 
+////////////////////////////////////////////////////////////////////
+const LVecBase4d &GeomVertexColumn::Packer_quantized::
+get_data4d(const unsigned char *pointer) {
+  load(pointer);
+  return _v4d;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: GeomVertexColumn::Packer_quantized::set_data1f
+//       Access: Public, Virtual
+//  Description: 
+////////////////////////////////////////////////////////////////////
+void GeomVertexColumn::Packer_quantized::
+set_data1f(unsigned char *pointer, float data) {
+  store(pointer, data, 0.0, 0.0, 1.0);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: GeomVertexColumn::Packer_quantized::set_data2f
+//       Access: Public, Virtual
+//  Description: 
+////////////////////////////////////////////////////////////////////
+void GeomVertexColumn::Packer_quantized::
+set_data2f(unsigned char *pointer, const LVecBase2f &data) {
+  store(pointer, data[0], data[1], 0.0, 1.0);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: GeomVertexColumn::Packer_quantized::set_data3f
+//       Access: Public, Virtual
+//  Description: 
+////////////////////////////////////////////////////////////////////
+void GeomVertexColumn::Packer_quantized::
+set_data3f(unsigned char *pointer, const LVecBase3f &data) {
+  store(pointer, data[0], data[1], data[2], 1.0);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: GeomVertexColumn::Packer_quantized::set_data4f
+//       Access: Public, Virtual
+//  Description: 
+////////////////////////////////////////////////////////////////////
+void GeomVertexColumn::Packer_quantized::
+set_data4f(unsigned char *pointer, const LVecBase4f &data) {
+  store(pointer, data[0], data[1], data[2], data[3]);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: GeomVertexColumn::Packer_quantized::set_data1d
+//       Access: Public, Virtual
+//  Description: 
+////////////////////////////////////////////////////////////////////
+void GeomVertexColumn::Packer_quantized::
+set_data1d(unsigned char *pointer, double data) {
+  store(pointer, data, 0.0, 0.0, 1.0);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: GeomVertexColumn::Packer_quantized::set_data2d
+//       Access: Public, Virtual
+//  Description: 
+////////////////////////////////////////////////////////////////////
+void GeomVertexColumn::Packer_quantized::
+set_data2d(unsigned char *pointer, const LVecBase2d &data) {
+  store(pointer, data[0], data[1], 0.0, 1.0);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: GeomVertexColumn::Packer_quantized::set_data3d
+//       Access: Public, Virtual
+//  Description: 
+////////////////////////////////////////////////////////////////////
+void GeomVertexColumn::Packer_quantized::
+set_data3d(unsigned char *pointer, const LVecBase3d &data) {
+  store(pointer, data[0], data[1], data[2], 1.0);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: GeomVertexColumn::Packer_quantized::set_data4d
+//       Access: Public, Virtual
+//  Description: 
+////////////////////////////////////////////////////////////////////
+void GeomVertexColumn::Packer_quantized::
+set_data4d(unsigned char *pointer, const LVecBase4d &data) {
+  store(pointer, data[0], data[1], data[2], data[3]);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: GeomVertexColumn::Packer_quantized::load
+//       Access: Protected
+//  Description: Reads the stored integers and converts them to
+//               floating-point values in _v4d.  Components that are
+//               not stored are 0.0, except for the fourth component
+//               of a point or texcoord, which is 1.0.
+////////////////////////////////////////////////////////////////////
+void GeomVertexColumn::Packer_quantized::
+load(const unsigned char *pointer) {
+  const LVecBase4 &scale = _column->get_scale();
+  const LVecBase4 &offset = _column->get_offset();
+  int num_components = min(_column->get_num_components(), 4);
+
+  _v4d.set(0.0, 0.0, 0.0, _column->has_homogeneous_coord() ? 1.0 : 0.0);
+
+  int i;
+  switch (_column->get_numeric_type()) {
+  case NT_uint8:
+    for (i = 0; i < num_components; ++i) {
+      _v4d[i] = pointer[i] * (double)scale[i] + (double)offset[i];
+    }
+    break;
+
+  case NT_uint16:
+    {
+      const PN_uint16 *pi = (const PN_uint16 *)pointer;
+      for (i = 0; i < num_components; ++i) {
+        _v4d[i] = pi[i] * (double)scale[i] + (double)offset[i];
+      }
+    }
+    break;
+
+  case NT_uint32:
+    {
+      const PN_uint32 *pi = (const PN_uint32 *)pointer;
+      for (i = 0; i < num_components; ++i) {
+        _v4d[i] = pi[i] * (double)scale[i] + (double)offset[i];
+      }
+    }
+    break;
+
+  default:
+    nassertv(false);
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: GeomVertexColumn::Packer_quantized::store
+//       Access: Protected
+//  Description: Converts the indicated floating-point values to the
+//               nearest representable integers and stores as many
+//               of them as the column has components.  Values
+//               outside of the range of the column are clamped.
+////////////////////////////////////////////////////////////////////
+void GeomVertexColumn::Packer_quantized::
+store(unsigned char *pointer, double a, double b, double c, double d) {
+  const LVecBase4 &scale = _column->get_scale();
+  const LVecBase4 &offset = _column->get_offset();
+  int num_components = min(_column->get_num_components(), 4);
+
+  double max_value;
+  switch (_column->get_numeric_type()) {
+  case NT_uint8:
+    max_value = 255.0;
+    break;
+
+  case NT_uint16:
+    max_value = 65535.0;
+    break;
+
+  case NT_uint32:
+    max_value = 4294967295.0;
+    break;
+
+  default:
+    nassertv(false);
+    return;
+  }
+
+  double data[4] = { a, b, c, d };
+  double value[4];
+  int i;
+  for (i = 0; i < num_components; ++i) {
+    double v = floor((data[i] - offset[i]) / scale[i] + 0.5);
+    value[i] = max(0.0, min(v, max_value));
+  }
+
+  switch (_column->get_numeric_type()) {
+  case NT_uint8:
+    for (i = 0; i < num_components; ++i) {
+      pointer[i] = (unsigned char)value[i];
+    }
+    break;
+
+  case NT_uint16:
+    {
+      PN_uint16 *pi = (PN_uint16 *)pointer;
+      for (i = 0; i < num_components; ++i) {
+        pi[i] = (PN_uint16)value[i];
+      }
+    }
+    break;
+
+  case NT_uint32:
+    {
+      PN_uint32 *pi = (PN_uint32 *)pointer;
+      for (i = 0; i < num_components; ++i) {
+        pi[i] = (PN_uint32)value[i];
+      }
+    }
+    break;
+
+  default:
+    break;
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: GeomVertexColumn::Packer_octahedral::get_data3f
+//       Access: Public, Virtual
+//  Description: 
+////////////////////////////////////////////////////////////////////
+const LVecBase3f &GeomVertexColumn::Packer_octahedral::
+get_data3f(const unsigned char *pointer) {
+  decode(pointer);
+  _v3.set(_v3d[0], _v3d[1], _v3d[2]);
+  return _v3;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: GeomVertexColumn::Packer_octahedral::get_data4f
+//       Access: Public, Virtual
+//  Description: 
+////////////////////////////////////////////////////////////////////
+const LVecBase4f &GeomVertexColumn::Packer_octahedral::
+get_data4f(const unsigned char *pointer) {
+  decode(pointer);
+  _v4.set(_v3d[0], _v3d[1], _v3d[2], 0.0f);
+  return _v4;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: GeomVertexColumn::Packer_octahedral::get_data3d
+//       Access: Public, Virtual
+//  Description: 
+////////////////////////////////////////////////////////////////////
+const LVecBase3d &GeomVertexColumn::Packer_octahedral::
+get_data3d(const unsigned char *pointer) {
+  decode(pointer);
+  return _v3d;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: GeomVertexColumn::Packer_octahedral::get_data4d
+//       Access: Public, Virtual
+//  Description: 
+////////////////////////////////////////////////////////////////////
+const LVecBase4d &GeomVertexColumn::Packer_octahedral::
+get_data4d(const unsigned char *pointer) {
+  decode(pointer);
+  _v4d.set(_v3d[0], _v3d[1], _v3d[2], 0.0);
+  return _v4d;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: GeomVertexColumn::Packer_octahedral::set_data3f
+//       Access: Public, Virtual
+//  Description: 
+////////////////////////////////////////////////////////////////////
+void GeomVertexColumn::Packer_octahedral::
+set_data3f(unsigned char *pointer, const LVecBase3f &data) {
+  encode(pointer, data[0], data[1], data[2]);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: GeomVertexColumn::Packer_octahedral::set_data4f
+//       Access: Public, Virtual
+//  Description: 
+////////////////////////////////////////////////////////////////////
+void GeomVertexColumn::Packer_octahedral::
+set_data4f(unsigned char *pointer, const LVecBase4f &data) {
+  encode(pointer, data[0], data[1], data[2]);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: GeomVertexColumn::Packer_octahedral::set_data3d
+//       Access: Public, Virtual
+//  Description: 
+////////////////////////////////////////////////////////////////////
+void GeomVertexColumn::Packer_octahedral::
+set_data3d(unsigned char *pointer, const LVecBase3d &data) {
+  encode(pointer, data[0], data[1], data[2]);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: GeomVertexColumn::Packer_octahedral::set_data4d
+//       Access: Public, Virtual
+//  Description: 
+////////////////////////////////////////////////////////////////////
+void GeomVertexColumn::Packer_octahedral::
+set_data4d(unsigned char *pointer, const LVecBase4d &data) {
+  encode(pointer, data[0], data[1], data[2]);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: GeomVertexColumn::Packer_octahedral::decode
+//       Access: Private
+//  Description: Reads the two stored components and unfolds them
+//               into a unit vector in _v3d.
+////////////////////////////////////////////////////////////////////
+void GeomVertexColumn::Packer_octahedral::
+decode(const unsigned char *pointer) {
+  load(pointer);
+  double x = _v4d[0];
+  double y = _v4d[1];
+  double z = 1.0 - fabs(x) - fabs(y);
+  if (z < 0.0) {
+    // This point is on the lower half of the octahedron, which was
+    // folded out over the corners of the square.
+    double fx = (1.0 - fabs(y)) * (x >= 0.0 ? 1.0 : -1.0);
+    double fy = (1.0 - fabs(x)) * (y >= 0.0 ? 1.0 : -1.0);
+    x = fx;
+    y = fy;
+  }
+
+  _v3d.set(x, y, z);
+  _v3d.normalize();
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: GeomVertexColumn::Packer_octahedral::encode
+//       Access: Private
+//  Description: Projects the indicated vector onto the octahedron,
+//               and stores the folded-out x and y.  The vector need
+//               not be normalized, but its length is lost.
+////////////////////////////////////////////////////////////////////
+void GeomVertexColumn::Packer_octahedral::
+encode(unsigned char *pointer, double x, double y, double z) {
+  double len = fabs(x) + fabs(y) + fabs(z);
+  if (len == 0.0) {
+    store(pointer, 0.0, 0.0, 0.0, 0.0);
+    return;
+  }
+
+  x /= len;
+  y /= len;
+  if (z < 0.0) {
+    double fx = (1.0 - fabs(y)) * (x >= 0.0 ? 1.0 : -1.0);
+    double fy = (1.0 - fabs(x)) * (y >= 0.0 ? 1.0 : -1.0);
+    x = fx;
+    y = fy;
+  }
+
+  store(pointer, x, y, 0.0, 0.0);
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: GeomVertexColumn::Packer_uint16_1::get_data1i
 //       Access: Public, Virtual
@@ -60,6 +60,13 @@ PUBLISHED:
   INLINE int get_total_bytes() const;
   INLINE bool has_homogeneous_coord() const;
 
+  INLINE bool is_quantized() const;
+  INLINE bool is_octahedral() const;
+  INLINE const LVecBase4 &get_scale() const;
+  INLINE const LVecBase4 &get_offset() const;
+  INLINE int get_unquantized_num_components() const;
+  INLINE NumericType get_unquantized_numeric_type() const;
+
   INLINE bool overlaps_with(int start_byte, int num_bytes) const;
   INLINE bool is_bytewise_equivalent(const GeomVertexColumn &other) const;
 
@@ -69,6 +76,8 @@ PUBLISHED:
   void set_contents(Contents contents);
   void set_start(int start);
   void set_column_alignment(int column_alignment);
+  void set_scale_offset(const LVecBase4 &scale, const LVecBase4 &offset);
+  void clear_scale_offset();
 
   void output(ostream &out) const;
 
@@ -102,6 +111,9 @@ private:
   int _column_alignment;
   int _component_bytes;
   int _total_bytes;
+  bool _quantized;
+  LVecBase4 _scale;
+  LVecBase4 _offset;
   Packer *_packer;
 
   // This nested class provides the implementation for packing and
@@ -428,6 +440,64 @@ private:
     }
   };
 
+  // This handles quantized columns: integer values that stand for
+  // floating-point values, by way of the column's scale and offset.
+  // Like Packer_point, the fourth component of a point or texcoord
+  // is implicitly 1.0.
+  class Packer_quantized : public Packer {
+  public:
+    virtual float get_data1f(const unsigned char *pointer);
+    virtual const LVecBase2f &get_data2f(const unsigned char *pointer);
+    virtual const LVecBase3f &get_data3f(const unsigned char *pointer);
+    virtual const LVecBase4f &get_data4f(const unsigned char *pointer);
+    virtual double get_data1d(const unsigned char *pointer);
+    virtual const LVecBase2d &get_data2d(const unsigned char *pointer);
+    virtual const LVecBase3d &get_data3d(const unsigned char *pointer);
+    virtual const LVecBase4d &get_data4d(const unsigned char *pointer);
+    virtual void set_data1f(unsigned char *pointer, float data);
+    virtual void set_data2f(unsigned char *pointer, const LVecBase2f &data);
+    virtual void set_data3f(unsigned char *pointer, const LVecBase3f &data);
+    virtual void set_data4f(unsigned char *pointer, const LVecBase4f &data);
+    virtual void set_data1d(unsigned char *pointer, double data);
+    virtual void set_data2d(unsigned char *pointer, const LVecBase2d &data);
+    virtual void set_data3d(unsigned char *pointer, const LVecBase3d &data);
+    virtual void set_data4d(unsigned char *pointer, const LVecBase4d &data);
+
+    virtual const char *get_name() const {
+      return "Packer_quantized";
+    }
+
+  protected:
+    void load(const unsigned char *pointer);
+    void store(unsigned char *pointer, double a, double b,
+               double c, double d);
+  };
+
+  // This handles a unit normal vector stored in two quantized
+  // components, as a point on an octahedron unfolded onto the square
+  // from -1 to 1.  The 3- and 4-component forms of get_data() and
+  // set_data() convert to and from the full vector; the smaller
+  // forms access the two stored components directly.
+  class Packer_octahedral : public Packer_quantized {
+  public:
+    virtual const LVecBase3f &get_data3f(const unsigned char *pointer);
+    virtual const LVecBase4f &get_data4f(const unsigned char *pointer);
+    virtual const LVecBase3d &get_data3d(const unsigned char *pointer);
+    virtual const LVecBase4d &get_data4d(const unsigned char *pointer);
+    virtual void set_data3f(unsigned char *pointer, const LVecBase3f &data);
+    virtual void set_data4f(unsigned char *pointer, const LVecBase4f &data);
+    virtual void set_data3d(unsigned char *pointer, const LVecBase3d &data);
+    virtual void set_data4d(unsigned char *pointer, const LVecBase4d &data);
+
+    virtual const char *get_name() const {
+      return "Packer_octahedral";
+    }
+
+  private:
+    void decode(const unsigned char *pointer);
+    void encode(unsigned char *pointer, double x, double y, double z);
+  };
+
   class Packer_uint16_1 : public Packer {
   public:
     virtual int get_data1i(const unsigned char *pointer);
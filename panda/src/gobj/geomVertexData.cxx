@@ -1041,6 +1041,140 @@ reverse_normals() const {
   return new_data;
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: GeomVertexData::quantize
+//       Access: Published
+//  Description: Returns a new GeomVertexData that stores the same
+//               vertices in less memory.  Each floating-point point
+//               or texcoord column of two or three components is
+//               replaced by a column of the indicated integer type,
+//               with a scale and offset that map the integers onto
+//               the bounding box of the column's values (see
+//               GeomVertexColumn::set_scale_offset()).  The
+//               three-component normal column is replaced by a
+//               two-component octahedral normal of the same type
+//               (see GeomVertexColumn::is_octahedral()).
+//
+//               A point column is given the same scale on each
+//               axis, so that a renderer can apply it with a uniform
+//               scale in the model transform (see
+//               GeomVertexFormat::get_unquantized_format()).
+//
+//               numeric_type should be NT_uint16 or NT_uint8.  With
+//               NT_uint16, each point is kept to within 1/131070 of
+//               the largest dimension of the bounding box, and each
+//               normal to within a few thousandths of a degree.
+//
+//               Animated vertices are not quantized, since they
+//               are computed from floating-point values anyway.  If
+//               there is nothing to quantize, this returns the
+//               original GeomVertexData object, unchanged.
+////////////////////////////////////////////////////////////////////
+CPT(GeomVertexData) GeomVertexData::
+quantize(NumericType numeric_type) const {
+  nassertr(numeric_type == NT_uint8 || numeric_type == NT_uint16, this);
+
+  const GeomVertexFormat *orig_format = get_format();
+  int num_rows = get_num_rows();
+  if (num_rows == 0 ||
+      orig_format->get_animation().get_animation_type() != AT_none) {
+    return this;
+  }
+
+  double max_value = (numeric_type == NT_uint8) ? 255.0 : 65535.0;
+
+  PT(GeomVertexFormat) new_format = new GeomVertexFormat(*orig_format);
+  bool any_quantized = false;
+
+  int num_arrays = orig_format->get_num_arrays();
+  for (int ai = 0; ai < num_arrays; ++ai) {
+    const GeomVertexArrayFormat *array_format = orig_format->get_array(ai);
+    PT(GeomVertexArrayFormat) new_array = new GeomVertexArrayFormat;
+    bool array_quantized = false;
+
+    int num_columns = array_format->get_num_columns();
+    for (int ci = 0; ci < num_columns; ++ci) {
+      const GeomVertexColumn *column = array_format->get_column(ci);
+      int num_components = column->get_num_components();
+      Contents contents = column->get_contents();
+      bool is_float = (column->get_numeric_type() == NT_float32 ||
+                       column->get_numeric_type() == NT_float64);
+
+      if (is_float && contents == C_vector && num_components == 3 &&
+          column->get_name() == InternalName::get_normal()) {
+        // The octahedral square runs from -1 to 1.
+        GeomVertexColumn new_column(column->get_name(), 2, numeric_type,
+                                    contents, new_array->get_total_bytes());
+        PN_stdfloat step = 2.0 / max_value;
+        new_column.set_scale_offset(LVecBase4(step, step, 1.0f, 1.0f),
+                                    LVecBase4(-1.0f, -1.0f, 0.0f, 0.0f));
+        new_array->add_column(new_column);
+        array_quantized = true;
+        continue;
+      }
+
+      if (is_float && (contents == C_point || contents == C_texcoord) &&
+          (num_components == 2 || num_components == 3)) {
+        // Find the bounding box of the values in this column.
+        GeomVertexReader reader(this, column->get_name());
+        LVecBase3d min_point = reader.get_data3d();
+        LVecBase3d max_point = min_point;
+        bool finite = true;
+        while (!reader.is_at_end() && finite) {
+          const LVecBase3d &v = reader.get_data3d();
+          for (int i = 0; i < 3; ++i) {
+            if (cnan(v[i]) || cinf(v[i])) {
+              finite = false;
+            }
+            min_point[i] = min(min_point[i], v[i]);
+            max_point[i] = max(max_point[i], v[i]);
+          }
+        }
+
+        if (finite) {
+          LVecBase4 scale(1.0f, 1.0f, 1.0f, 1.0f);
+          LVecBase4 offset(0.0f, 0.0f, 0.0f, 0.0f);
+          double max_range = 0.0;
+          for (int i = 0; i < num_components; ++i) {
+            max_range = max(max_range, max_point[i] - min_point[i]);
+          }
+          for (int i = 0; i < num_components; ++i) {
+            double range = (contents == C_point) ? max_range : max_point[i] - min_point[i];
+            if (range > 0.0) {
+              scale[i] = range / max_value;
+            }
+            offset[i] = min_point[i];
+          }
+
+          GeomVertexColumn new_column(column->get_name(), num_components,
+                                      numeric_type, contents,
+                                      new_array->get_total_bytes());
+          new_column.set_scale_offset(scale, offset);
+          new_array->add_column(new_column);
+          array_quantized = true;
+          continue;
+        }
+      }
+
+      GeomVertexColumn new_column(*column);
+      new_column.set_start(new_array->get_total_bytes());
+      new_array->add_column(new_column);
+    }
+
+    if (array_quantized) {
+      new_format->set_array(ai, new_array);
+      any_quantized = true;
+    }
+  }
+
+  if (!any_quantized) {
+    return this;
+  }
+
+  CPT(GeomVertexFormat) format = GeomVertexFormat::register_format(new_format);
+  return convert_to(format);
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: GeomVertexData::animate_vertices
 //       Access: Published
@@ -1170,6 +1304,11 @@ transform_vertices(const LMatrix4 &mat) {
 //               vertices from begin_row up to but not including
 //               end_row.  The transform is applied to all "point" and
 //               "vector" type columns described in the format.
+//
+//               If any of those columns are quantized, the whole
+//               GeomVertexData is first converted to floating-point,
+//               since the transformed vertices will not generally fit
+//               within the original quantized range.
 ////////////////////////////////////////////////////////////////////
 void GeomVertexData::
 transform_vertices(const LMatrix4 &mat, int begin_row, int end_row) {
@@ -1180,6 +1319,24 @@ transform_vertices(const LMatrix4 &mat, int begin_row, int end_row) {
 
   const GeomVertexFormat *format = get_format();
 
+  if (format->has_quantized_columns()) {
+    // An octahedral normal can hold any direction, so it may stay.
+    bool any_quantized = false;
+    int ci;
+    for (ci = 0; ci < format->get_num_points() && !any_quantized; ci++) {
+      any_quantized = format->get_column(format->get_point(ci))->is_quantized();
+    }
+    for (ci = 0; ci < format->get_num_vectors() && !any_quantized; ci++) {
+      const GeomVertexColumn *column = format->get_column(format->get_vector(ci));
+      any_quantized = (column->is_quantized() && !column->is_octahedral());
+    }
+    if (any_quantized) {
+      CPT(GeomVertexFormat) unquantized = format->get_unquantized_format();
+      set_format(unquantized);
+      format = get_format();
+    }
+  }
+
   int ci;
   for (ci = 0; ci < format->get_num_points(); ci++) {
     GeomVertexRewriter data(this, format->get_point(ci));
@@ -151,6 +151,7 @@ PUBLISHED:
               NumericType numeric_type, Contents contents) const;
 
   CPT(GeomVertexData) reverse_normals() const;
+  CPT(GeomVertexData) quantize(NumericType numeric_type = NT_uint16) const;
 
   CPT(GeomVertexData) animate_vertices(bool force, Thread *current_thread) const;
   void clear_animated_vertices();
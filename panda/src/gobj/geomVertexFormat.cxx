@@ -215,16 +215,10 @@ get_union_format(const GeomVertexFormat *other) const {
           if (column_b != (GeomVertexColumn *)NULL &&
               column_b->get_total_bytes() > column_a->get_total_bytes()) {
             // Column b is larger.  Keep it.
-            new_array->add_column(column_b->get_name(), 
-                                  column_b->get_num_components(),
-                                  column_b->get_numeric_type(),
-                                  column_b->get_contents());
+            add_union_column(new_array, column_b, column_a);
           } else {
             // Column a is larger.  Keep it.
-            new_array->add_column(column_a->get_name(), 
-                                  column_a->get_num_components(),
-                                  column_a->get_numeric_type(),
-                                  column_a->get_contents());
+            add_union_column(new_array, column_a, column_b);
           }
         }
       }
@@ -242,16 +236,10 @@ get_union_format(const GeomVertexFormat *other) const {
           if (column_b != (GeomVertexColumn *)NULL &&
               column_b->get_total_bytes() > column_a->get_total_bytes()) {
             // Column b is larger.  Keep it.
-            new_array->add_column(column_b->get_name(), 
-                                  column_b->get_num_components(),
-                                  column_b->get_numeric_type(),
-                                  column_b->get_contents());
+            add_union_column(new_array, column_b, column_a);
           } else {
             // Column a is larger.  Keep it.
-            new_array->add_column(column_a->get_name(), 
-                                  column_a->get_num_components(),
-                                  column_a->get_numeric_type(),
-                                  column_a->get_contents());
+            add_union_column(new_array, column_a, column_b);
           }
         }
       }
@@ -266,6 +254,153 @@ get_union_format(const GeomVertexFormat *other) const {
   return GeomVertexFormat::register_format(new_format);
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: GeomVertexFormat::add_union_column
+//       Access: Private, Static
+//  Description: Adds the indicated column, which was chosen by
+//               get_union_format() as the larger of column and
+//               other_column (which may be NULL), to the end of
+//               new_array.  If either column is quantized and they
+//               don't store their values the same way, a
+//               floating-point column is added instead, since that
+//               can hold the values of both.
+////////////////////////////////////////////////////////////////////
+void GeomVertexFormat::
+add_union_column(GeomVertexArrayFormat *new_array,
+                 const GeomVertexColumn *column,
+                 const GeomVertexColumn *other_column) {
+  if (other_column != (GeomVertexColumn *)NULL &&
+      (column->is_quantized() || other_column->is_quantized()) &&
+      !column->is_bytewise_equivalent(*other_column)) {
+    new_array->add_column(column->get_name(),
+                          max(column->get_unquantized_num_components(),
+                              other_column->get_unquantized_num_components()),
+                          NT_stdfloat, column->get_contents());
+    return;
+  }
+
+  GeomVertexColumn new_column(column->get_name(),
+                              column->get_num_components(),
+                              column->get_numeric_type(),
+                              column->get_contents(),
+                              new_array->get_total_bytes());
+  if (column->is_quantized()) {
+    new_column.set_scale_offset(column->get_scale(), column->get_offset());
+  }
+  new_array->add_column(new_column);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: GeomVertexFormat::get_unquantized_format
+//       Access: Published
+//  Description: Returns a format like this one, but with each
+//               quantized column (see
+//               GeomVertexColumn::set_scale_offset()) replaced by a
+//               floating-point column of the same name.  Converting
+//               a GeomVertexData to the new format expands the
+//               quantized values.  This is used to prepare vertices
+//               for a renderer that can't undo the quantization
+//               itself, or before modifying the vertices in a way
+//               that might take them out of the quantized range.
+//
+//               If keep_vertex is true, a quantized vertex column
+//               of three components with the same scale on each (as
+//               made by GeomVertexData::quantize()) is kept as it
+//               is.  This is for a renderer that reads the vertex
+//               column as normalized integers, from 0 to 1, and
+//               applies the column's scale and offset in the model
+//               transform instead; see
+//               GeomMunger::keeps_quantized_vertex().
+//
+//               If there are no columns to expand, this returns the
+//               format itself.  This may only be called after the
+//               format has been registered.  The return value will
+//               have been already registered.
+////////////////////////////////////////////////////////////////////
+CPT(GeomVertexFormat) GeomVertexFormat::
+get_unquantized_format(bool keep_vertex) const {
+  nassertr(is_registered(), NULL);
+
+  if (!has_quantized_columns()) {
+    return this;
+  }
+
+  const GeomVertexColumn *kept_column = NULL;
+  if (keep_vertex) {
+    const GeomVertexColumn *column = get_vertex_column();
+    if (column != (GeomVertexColumn *)NULL && column->is_quantized() &&
+        column->get_num_components() == 3 &&
+        column->get_scale()[1] == column->get_scale()[0] &&
+        column->get_scale()[2] == column->get_scale()[0]) {
+      kept_column = column;
+    }
+  }
+
+  PT(GeomVertexFormat) new_format = new GeomVertexFormat(*this);
+  int num_arrays = get_num_arrays();
+  for (int ai = 0; ai < num_arrays; ++ai) {
+    const GeomVertexArrayFormat *array_format = get_array(ai);
+    int num_columns = array_format->get_num_columns();
+    int ci;
+    bool any_quantized = false;
+    for (ci = 0; ci < num_columns && !any_quantized; ++ci) {
+      const GeomVertexColumn *column = array_format->get_column(ci);
+      any_quantized = (column->is_quantized() && column != kept_column);
+    }
+    if (!any_quantized) {
+      continue;
+    }
+
+    // The floating-point columns are bigger, so the array has to be
+    // laid out again.
+    PT(GeomVertexArrayFormat) new_array = new GeomVertexArrayFormat;
+    for (ci = 0; ci < num_columns; ++ci) {
+      const GeomVertexColumn *column = array_format->get_column(ci);
+      if (column == kept_column) {
+        GeomVertexColumn new_column(*column);
+        new_column.set_start(new_array->get_total_bytes());
+        new_array->add_column(new_column);
+
+      } else if (column->is_quantized()) {
+        new_array->add_column(column->get_name(),
+                              column->get_unquantized_num_components(),
+                              column->get_unquantized_numeric_type(),
+                              column->get_contents());
+      } else {
+        new_array->add_column(column->get_name(),
+                              column->get_num_components(),
+                              column->get_numeric_type(),
+                              column->get_contents(), -1,
+                              column->get_column_alignment());
+      }
+    }
+    new_format->set_array(ai, new_array);
+  }
+
+  return GeomVertexFormat::register_format(new_format);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: GeomVertexFormat::has_quantized_columns
+//       Access: Published
+//  Description: Returns true if any of the columns of this format
+//               are quantized.  See get_unquantized_format().
+////////////////////////////////////////////////////////////////////
+bool GeomVertexFormat::
+has_quantized_columns() const {
+  int num_arrays = get_num_arrays();
+  for (int ai = 0; ai < num_arrays; ++ai) {
+    const GeomVertexArrayFormat *array_format = get_array(ai);
+    int num_columns = array_format->get_num_columns();
+    for (int ci = 0; ci < num_columns; ++ci) {
+      if (array_format->get_column(ci)->is_quantized()) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: GeomVertexFormat::modify_array
 //       Access: Published
@@ -77,6 +77,8 @@ PUBLISHED:
 
   CPT(GeomVertexFormat) get_post_animated_format() const;
   CPT(GeomVertexFormat) get_union_format(const GeomVertexFormat *other) const;
+  CPT(GeomVertexFormat) get_unquantized_format(bool keep_vertex = false) const;
+  bool has_quantized_columns() const;
 
   INLINE int get_num_arrays() const;
   INLINE const GeomVertexArrayFormat *get_array(int array) const;
@@ -179,6 +181,10 @@ private:
   void do_register();
   void do_unregister();
 
+  static void add_union_column(GeomVertexArrayFormat *new_array,
+                               const GeomVertexColumn *column,
+                               const GeomVertexColumn *other_column);
+
   bool _is_registered;
 
   GeomVertexAnimationSpec _animation;
@@ -0,0 +1,568 @@
+// Filename: meshSimplifier.cxx
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "meshSimplifier.h"
+
+// The edges along a border or seam are held in place by planes
+// perpendicular to their triangles, weighted this much more heavily
+// than the triangles themselves.
+static const double border_weight = 10.0;
+
+// An edge is not collapsed if that would turn any remaining triangle
+// by more than about 75 degrees, which includes flipping it over.
+static const double min_normal_dot = 0.25;
+
+// Sorts vertex indices by their positions, so that vertices with the
+// same position are adjacent, and the lowest index comes first.
+class SortByPosition {
+public:
+  INLINE SortByPosition(const pvector<LPoint3d> &positions) :
+    _positions(positions) { }
+  INLINE bool operator () (int a, int b) const {
+    const LPoint3d &pa = _positions[a];
+    const LPoint3d &pb = _positions[b];
+    if (pa[0] != pb[0]) {
+      return pa[0] < pb[0];
+    }
+    if (pa[1] != pb[1]) {
+      return pa[1] < pb[1];
+    }
+    if (pa[2] != pb[2]) {
+      return pa[2] < pb[2];
+    }
+    return a < b;
+  }
+
+  const pvector<LPoint3d> &_positions;
+};
+
+////////////////////////////////////////////////////////////////////
+//     Function: MeshSimplifier::Constructor
+//       Access: Public
+//  Description:
+////////////////////////////////////////////////////////////////////
+MeshSimplifier::
+MeshSimplifier() :
+  _error(0.0f)
+{
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: MeshSimplifier::simplify
+//       Access: Public
+//  Description: Reduces the num_triangles triangles whose vertex
+//               indices are listed in indices, three per triangle, to
+//               no more than target_triangles triangles, if that can
+//               be done without moving any vertex farther than
+//               max_error from the surface it stands for.  The
+//               remaining triangles are written back to the
+//               beginning of indices, and the number of them is
+//               returned.
+//
+//               positions holds the position of each of the
+//               num_vertices vertices.  All of the indices must be
+//               less than num_vertices.
+////////////////////////////////////////////////////////////////////
+int MeshSimplifier::
+simplify(int *indices, int num_triangles,
+         const LPoint3 *positions, int num_vertices,
+         int target_triangles, PN_stdfloat max_error) {
+  _error = 0.0f;
+  if (num_triangles <= max(target_triangles, 0)) {
+    return num_triangles;
+  }
+
+  int num_indices = num_triangles * 3;
+  int i;
+  for (i = 0; i < num_indices; ++i) {
+    nassertr(indices[i] >= 0 && indices[i] < num_vertices, num_triangles);
+  }
+
+  _positions.resize(num_vertices);
+  for (i = 0; i < num_vertices; ++i) {
+    _positions[i] = LCAST(double, positions[i]);
+  }
+
+  weld_positions(num_vertices);
+  make_edges(indices, num_triangles);
+  classify_vertices(indices, num_triangles);
+  compute_quadrics(indices, num_triangles);
+
+  double max_error_sq = (double)max_error * (double)max_error;
+  while (num_triangles > target_triangles) {
+    int new_num_triangles =
+      collapse_pass(indices, num_triangles, target_triangles, max_error_sq);
+    if (new_num_triangles == num_triangles) {
+      // Nothing more can be collapsed.
+      break;
+    }
+    num_triangles = new_num_triangles;
+    make_edges(indices, num_triangles);
+  }
+
+  _positions.clear();
+  _remap.clear();
+  _wedge.clear();
+  _kinds.clear();
+  _quadrics.clear();
+  _vertex_edges.clear();
+  _position_edges.clear();
+  _first_tri.clear();
+  _tris.clear();
+  _collapses.clear();
+  _locked.clear();
+  _target.clear();
+
+  return num_triangles;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: MeshSimplifier::weld_positions
+//       Access: Private
+//  Description: Fills in _remap and _wedge, which group together the
+//               vertices that share a position.
+////////////////////////////////////////////////////////////////////
+void MeshSimplifier::
+weld_positions(int num_vertices) {
+  pvector<int> order(num_vertices);
+  int i;
+  for (i = 0; i < num_vertices; ++i) {
+    order[i] = i;
+  }
+  sort(order.begin(), order.end(), SortByPosition(_positions));
+
+  _remap.resize(num_vertices);
+  _wedge.resize(num_vertices);
+  i = 0;
+  while (i < num_vertices) {
+    const LPoint3d &pos = _positions[order[i]];
+    int j = i + 1;
+    while (j < num_vertices && _positions[order[j]] == pos) {
+      ++j;
+    }
+    for (int k = i; k < j; ++k) {
+      _remap[order[k]] = order[i];
+      _wedge[order[k]] = (k + 1 < j) ? order[k + 1] : order[i];
+    }
+    i = j;
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: MeshSimplifier::make_edges
+//       Access: Private
+//  Description: Builds the sorted lists of the directed edges of the
+//               triangles, between vertices and between positions.
+////////////////////////////////////////////////////////////////////
+void MeshSimplifier::
+make_edges(const int *indices, int num_triangles) {
+  _vertex_edges.clear();
+  _position_edges.clear();
+  _vertex_edges.reserve(num_triangles * 3);
+  _position_edges.reserve(num_triangles * 3);
+
+  for (int t = 0; t < num_triangles; ++t) {
+    const int *tri = indices + t * 3;
+    for (int j = 0; j < 3; ++j) {
+      int a = tri[j];
+      int b = tri[(j + 1) % 3];
+      _vertex_edges.push_back(make_key(a, b));
+      _position_edges.push_back(make_key(_remap[a], _remap[b]));
+    }
+  }
+
+  sort(_vertex_edges.begin(), _vertex_edges.end());
+  sort(_position_edges.begin(), _position_edges.end());
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: MeshSimplifier::classify_vertices
+//       Access: Private
+//  Description: Decides, for each position, whether its vertices may
+//               move freely, only along a border or seam, or not at
+//               all.
+//
+//               An edge with no matching edge running the other way
+//               between the same vertices is open.  It is on a seam
+//               if there is a matching edge between other vertices
+//               with the same positions, and on the border of the
+//               mesh otherwise.
+////////////////////////////////////////////////////////////////////
+void MeshSimplifier::
+classify_vertices(const int *indices, int num_triangles) {
+  int num_vertices = (int)_remap.size();
+
+  pvector<int> border_out(num_vertices, 0);
+  pvector<int> border_in(num_vertices, 0);
+  pvector<int> seam_out(num_vertices, 0);
+  pvector<int> seam_in(num_vertices, 0);
+  pvector<unsigned char> used(num_vertices, 0);
+
+  for (int t = 0; t < num_triangles; ++t) {
+    const int *tri = indices + t * 3;
+    for (int j = 0; j < 3; ++j) {
+      int a = tri[j];
+      int b = tri[(j + 1) % 3];
+      used[a] = 1;
+      if (!has_edge(_vertex_edges, b, a)) {
+        int pa = _remap[a];
+        int pb = _remap[b];
+        if (has_edge(_position_edges, pb, pa)) {
+          ++seam_out[pa];
+          ++seam_in[pb];
+        } else {
+          ++border_out[pa];
+          ++border_in[pb];
+        }
+      }
+    }
+  }
+
+  _kinds.assign(num_vertices, (unsigned char)VK_locked);
+  for (int v = 0; v < num_vertices; ++v) {
+    if (_remap[v] != v) {
+      continue;
+    }
+
+    int num_wedges = 0;
+    int w = v;
+    do {
+      if (used[w]) {
+        ++num_wedges;
+      }
+      w = _wedge[w];
+    } while (w != v);
+
+    if (seam_out[v] == 0 && seam_in[v] == 0) {
+      if (num_wedges == 1 && border_out[v] == 0 && border_in[v] == 0) {
+        _kinds[v] = VK_manifold;
+      } else if (num_wedges == 1 && border_out[v] == 1 && border_in[v] == 1) {
+        _kinds[v] = VK_border;
+      }
+    } else if (border_out[v] == 0 && border_in[v] == 0 && num_wedges == 2 &&
+               seam_out[v] == 2 && seam_in[v] == 2) {
+      _kinds[v] = VK_seam;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: MeshSimplifier::compute_quadrics
+//       Access: Private
+//  Description: Computes the initial quadric of each position from
+//               the planes of the triangles around it, weighted by
+//               area, and the planes that hold its open edges in
+//               place.
+////////////////////////////////////////////////////////////////////
+void MeshSimplifier::
+compute_quadrics(const int *indices, int num_triangles) {
+  Quadric zero;
+  zero.clear();
+  _quadrics.assign(_remap.size(), zero);
+
+  for (int t = 0; t < num_triangles; ++t) {
+    const int *tri = indices + t * 3;
+    const LPoint3d &p0 = _positions[tri[0]];
+    const LPoint3d &p1 = _positions[tri[1]];
+    const LPoint3d &p2 = _positions[tri[2]];
+    LVector3d normal = cross(p1 - p0, p2 - p0);
+    double length = normal.length();
+    if (length == 0.0) {
+      continue;
+    }
+    normal /= length;
+    double d = -dot(normal, p0);
+    double area = length * 0.5;
+
+    int j;
+    for (j = 0; j < 3; ++j) {
+      _quadrics[_remap[tri[j]]].add_plane(normal, d, area);
+    }
+
+    for (j = 0; j < 3; ++j) {
+      int a = tri[j];
+      int b = tri[(j + 1) % 3];
+      if (!has_edge(_vertex_edges, b, a)) {
+        LVector3d edge = _positions[b] - _positions[a];
+        double edge_length = edge.length();
+        if (edge_length == 0.0) {
+          continue;
+        }
+        LVector3d edge_normal = cross(edge, normal);
+        edge_normal.normalize();
+        double edge_d = -dot(edge_normal, _positions[a]);
+        double weight = edge_length * edge_length * border_weight;
+        _quadrics[_remap[a]].add_plane(edge_normal, edge_d, weight);
+        _quadrics[_remap[b]].add_plane(edge_normal, edge_d, weight);
+      }
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: MeshSimplifier::collapse_pass
+//       Access: Private
+//  Description: Collapses as many of the cheapest edges as can be
+//               collapsed independently of each other, until the
+//               target is reached, and rewrites the triangles
+//               accordingly.  Returns the new number of triangles,
+//               which is unchanged if no edge could be collapsed.
+////////////////////////////////////////////////////////////////////
+int MeshSimplifier::
+collapse_pass(int *indices, int num_triangles, int target_triangles,
+              double max_error_sq) {
+  int num_vertices = (int)_remap.size();
+  int num_indices = num_triangles * 3;
+
+  // Find the triangles around each position.
+  _first_tri.assign(num_vertices + 1, 0);
+  int i;
+  for (i = 0; i < num_indices; ++i) {
+    ++_first_tri[_remap[indices[i]] + 1];
+  }
+  for (i = 0; i < num_vertices; ++i) {
+    _first_tri[i + 1] += _first_tri[i];
+  }
+  _tris.resize(num_indices);
+  {
+    pvector<int> next(_first_tri);
+    for (i = 0; i < num_indices; ++i) {
+      _tris[next[_remap[indices[i]]]++] = i / 3;
+    }
+  }
+
+  // Consider collapsing each edge in both directions, cheapest first.
+  _collapses.clear();
+  for (int t = 0; t < num_triangles; ++t) {
+    const int *tri = indices + t * 3;
+    for (int j = 0; j < 3; ++j) {
+      int a = tri[j];
+      int b = tri[(j + 1) % 3];
+      int pa = _remap[a];
+      int pb = _remap[b];
+      if (pa == pb) {
+        continue;
+      }
+      bool border = !has_edge(_position_edges, pb, pa);
+      bool seam = !border && !has_edge(_vertex_edges, b, a);
+      add_collapse(pa, pb, border, seam);
+      add_collapse(pb, pa, border, seam);
+    }
+  }
+  sort(_collapses.begin(), _collapses.end());
+
+  // Each collapse locks the triangles around the vertex it moves, so
+  // that the collapses made in one pass don't interfere.
+  _locked.assign(num_vertices, 0);
+  _target.resize(num_vertices);
+  for (i = 0; i < num_vertices; ++i) {
+    _target[i] = i;
+  }
+
+  int max_removed = num_triangles - target_triangles;
+  int num_removed = 0;
+  bool any_collapsed = false;
+
+  pvector<Collapse>::const_iterator ci;
+  for (ci = _collapses.begin(); ci != _collapses.end(); ++ci) {
+    const Collapse &collapse = (*ci);
+    if (collapse._error > max_error_sq || num_removed >= max_removed) {
+      break;
+    }
+    int from = collapse._from;
+    int to = collapse._to;
+    if (_locked[from] || _locked[to]) {
+      continue;
+    }
+    if (!map_wedges(from, to, indices) ||
+        flips_triangle(from, to, indices)) {
+      continue;
+    }
+
+    for (size_t k = 0; k < _new_targets.size(); k += 2) {
+      _target[_new_targets[k]] = _new_targets[k + 1];
+    }
+    _quadrics[to].add(_quadrics[from]);
+    _error = max(_error, (PN_stdfloat)sqrt(collapse._error));
+    any_collapsed = true;
+
+    for (int k = _first_tri[from]; k < _first_tri[from + 1]; ++k) {
+      const int *tri = indices + _tris[k] * 3;
+      bool has_to = false;
+      for (int j = 0; j < 3; ++j) {
+        int p = _remap[tri[j]];
+        _locked[p] = 1;
+        if (p == to) {
+          has_to = true;
+        }
+      }
+      if (has_to) {
+        ++num_removed;
+      }
+    }
+  }
+
+  if (!any_collapsed) {
+    return num_triangles;
+  }
+
+  // Move the collapsed vertices, and drop the triangles that have
+  // become degenerate.
+  int num_kept = 0;
+  for (int t = 0; t < num_triangles; ++t) {
+    int a = _target[indices[t * 3]];
+    int b = _target[indices[t * 3 + 1]];
+    int c = _target[indices[t * 3 + 2]];
+    int pa = _remap[a];
+    int pb = _remap[b];
+    int pc = _remap[c];
+    if (pa != pb && pb != pc && pc != pa) {
+      indices[num_kept * 3] = a;
+      indices[num_kept * 3 + 1] = b;
+      indices[num_kept * 3 + 2] = c;
+      ++num_kept;
+    }
+  }
+
+  return num_kept;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: MeshSimplifier::add_collapse
+//       Access: Private
+//  Description: Adds the collapse of the indicated position onto
+//               another to the list of candidates, if the kinds of
+//               the two positions allow it.  border and seam
+//               describe the edge between them.
+////////////////////////////////////////////////////////////////////
+void MeshSimplifier::
+add_collapse(int from, int to, bool border, bool seam) {
+  switch (_kinds[from]) {
+  case VK_manifold:
+    break;
+
+  case VK_border:
+    if (!border || _kinds[to] != VK_border) {
+      return;
+    }
+    break;
+
+  case VK_seam:
+    if (!seam || _kinds[to] != VK_seam) {
+      return;
+    }
+    break;
+
+  default:
+    return;
+  }
+
+  Collapse collapse;
+  collapse._from = from;
+  collapse._to = to;
+  collapse._error = _quadrics[from].calc_error(_positions[to]);
+  _collapses.push_back(collapse);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: MeshSimplifier::map_wedges
+//       Access: Private
+//  Description: Chooses, for each of the vertices in use at the from
+//               position, the vertex at the to position that it
+//               should become: the one it shares a triangle with.
+//               The pairs are stored in _new_targets.  Returns false
+//               if one of the vertices has no such partner.
+////////////////////////////////////////////////////////////////////
+bool MeshSimplifier::
+map_wedges(int from, int to, const int *indices) {
+  _new_targets.clear();
+
+  int begin = _first_tri[from];
+  int end = _first_tri[from + 1];
+  int w = from;
+  do {
+    bool used = false;
+    int target = -1;
+    for (int k = begin; k < end && target < 0; ++k) {
+      const int *tri = indices + _tris[k] * 3;
+      if (tri[0] == w || tri[1] == w || tri[2] == w) {
+        used = true;
+        for (int j = 0; j < 3; ++j) {
+          if (_remap[tri[j]] == to) {
+            target = tri[j];
+          }
+        }
+      }
+    }
+    if (used) {
+      if (target < 0) {
+        return false;
+      }
+      _new_targets.push_back(w);
+      _new_targets.push_back(target);
+    }
+    w = _wedge[w];
+  } while (w != from);
+
+  return !_new_targets.empty();
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: MeshSimplifier::flips_triangle
+//       Access: Private
+//  Description: Returns true if moving the from position onto the to
+//               position would turn any of the triangles that
+//               remain too far.
+////////////////////////////////////////////////////////////////////
+bool MeshSimplifier::
+flips_triangle(int from, int to, const int *indices) const {
+  const LPoint3d &to_pos = _positions[to];
+
+  for (int k = _first_tri[from]; k < _first_tri[from + 1]; ++k) {
+    const int *tri = indices + _tris[k] * 3;
+    int j;
+    bool has_to = false;
+    for (j = 0; j < 3; ++j) {
+      if (_remap[tri[j]] == to) {
+        has_to = true;
+      }
+    }
+    if (has_to) {
+      // This triangle goes away.
+      continue;
+    }
+
+    LPoint3d v[3];
+    for (j = 0; j < 3; ++j) {
+      v[j] = _positions[tri[j]];
+    }
+    LVector3d normal0 = cross(v[1] - v[0], v[2] - v[0]);
+    double length0 = normal0.length();
+    if (length0 == 0.0) {
+      continue;
+    }
+
+    for (j = 0; j < 3; ++j) {
+      if (_remap[tri[j]] == from) {
+        v[j] = to_pos;
+      }
+    }
+    LVector3d normal1 = cross(v[1] - v[0], v[2] - v[0]);
+    if (dot(normal0, normal1) <= min_normal_dot * length0 * normal1.length()) {
+      return true;
+    }
+  }
+
+  return false;
+}
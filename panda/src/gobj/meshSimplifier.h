@@ -0,0 +1,130 @@
+// Filename: meshSimplifier.h
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#ifndef MESHSIMPLIFIER_H
+#define MESHSIMPLIFIER_H
+
+#include "pandabase.h"
+#include "luse.h"
+#include "pvector.h"
+#include <algorithm>
+
+////////////////////////////////////////////////////////////////////
+//       Class : MeshSimplifier
+// Description : Reduces the number of triangles in an indexed
+//               triangle list by collapsing edges, choosing at each
+//               step the edges whose removal changes the shape of the
+//               surface the least, as measured by the quadric error
+//               metric of Garland and Heckbert.
+//
+//               Each edge is collapsed by moving one of its vertices
+//               onto the other, so the surviving vertices keep their
+//               original rows, and no new vertex values are ever
+//               computed.  Rows that share a position but differ in
+//               their other columns (normal, color, texture
+//               coordinates) mark a seam; a vertex on a seam, or on
+//               the open border of the mesh, may only be moved along
+//               the seam or border to another vertex on it, so seams
+//               and borders keep their shape and their vertex values.
+//               Vertices where seams or borders meet are never moved.
+//
+//               This is used by GeomTriangles; see
+//               GeomPrimitive::simplify().
+////////////////////////////////////////////////////////////////////
+class EXPCL_PANDA_GOBJ MeshSimplifier {
+public:
+  MeshSimplifier();
+
+  int simplify(int *indices, int num_triangles,
+               const LPoint3 *positions, int num_vertices,
+               int target_triangles, PN_stdfloat max_error);
+  INLINE PN_stdfloat get_error() const;
+
+private:
+  // The sum of the squared distances from a point to a set of
+  // weighted planes, stored as the symmetric matrix A, the vector b
+  // and the constant c of x'Ax + 2b'x + c.  _w is the total weight.
+  class Quadric {
+  public:
+    INLINE void clear();
+    INLINE void add_plane(const LVector3d &normal, double d, double weight);
+    INLINE void add(const Quadric &other);
+    INLINE double calc_error(const LPoint3d &point) const;
+
+    double _a00, _a11, _a22, _a01, _a02, _a12;
+    double _b0, _b1, _b2;
+    double _c;
+    double _w;
+  };
+
+  enum VertexKind {
+    VK_manifold,
+    VK_border,
+    VK_seam,
+    VK_locked,
+  };
+
+  class Collapse {
+  public:
+    INLINE bool operator < (const Collapse &other) const;
+
+    int _from;
+    int _to;
+    double _error;
+  };
+
+  typedef pvector<PN_uint64> EdgeKeys;
+  INLINE static PN_uint64 make_key(int a, int b);
+  INLINE static bool has_edge(const EdgeKeys &edges, int a, int b);
+
+  void weld_positions(int num_vertices);
+  void make_edges(const int *indices, int num_triangles);
+  void classify_vertices(const int *indices, int num_triangles);
+  void compute_quadrics(const int *indices, int num_triangles);
+  int collapse_pass(int *indices, int num_triangles, int target_triangles,
+                    double max_error_sq);
+  void add_collapse(int from, int to, bool border, bool seam);
+  bool map_wedges(int from, int to, const int *indices);
+  bool flips_triangle(int from, int to, const int *indices) const;
+
+private:
+  PN_stdfloat _error;
+
+  pvector<LPoint3d> _positions;
+
+  // _remap maps each vertex to the first vertex with the same
+  // position, which stands for all of them; _wedge links the
+  // vertices with the same position into a ring.
+  pvector<int> _remap;
+  pvector<int> _wedge;
+
+  pvector<unsigned char> _kinds;
+  pvector<Quadric> _quadrics;
+
+  EdgeKeys _vertex_edges;
+  EdgeKeys _position_edges;
+
+  // The triangles around each position, rebuilt for each pass.
+  pvector<int> _first_tri;
+  pvector<int> _tris;
+
+  pvector<Collapse> _collapses;
+  pvector<unsigned char> _locked;
+  pvector<int> _target;
+  pvector<int> _new_targets;
+};
+
+#include "meshSimplifier.I"
+
+#endif
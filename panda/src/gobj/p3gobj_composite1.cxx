@@ -33,5 +33,6 @@
 #include "material.cxx"
 #include "materialPool.cxx"
 #include "matrixLens.cxx"
+#include "meshSimplifier.cxx"
 #include "occlusionQueryContext.cxx"
 #include "orthographicLens.cxx"
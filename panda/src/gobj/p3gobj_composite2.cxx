@@ -26,6 +26,7 @@
 #include "userVertexSlider.cxx"
 #include "userVertexTransform.cxx"
 #include "vertexBufferContext.cxx"
+#include "vertexCacheOptimizer.cxx"
 #include "vertexDataBlock.cxx"
 #include "vertexDataBook.cxx"
 #include "vertexDataPage.cxx"
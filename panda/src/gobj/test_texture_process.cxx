@@ -0,0 +1,94 @@
+// Filename: test_texture_process.cxx
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "texture.h"
+#include "config_gobj.h"
+#include "load_prc_file.h"
+#include "thread.h"
+
+// Checks that the work divided among the texture-process-threads
+// (software mipmap generation, and squish compression when it is
+// available) produces exactly the same RAM images as doing it all in
+// the calling thread.
+
+////////////////////////////////////////////////////////////////////
+//     Function: make_texture
+//  Description: Returns a new RGBA texture filled with a
+//               deterministic pattern.  The odd size exercises the
+//               partial cells at the right and bottom edges.
+////////////////////////////////////////////////////////////////////
+static PT(Texture)
+make_texture() {
+  PT(Texture) tex = new Texture("test");
+  tex->setup_2d_texture(254, 190, Texture::T_unsigned_byte, Texture::F_rgba);
+  tex->set_minfilter(SamplerState::FT_linear_mipmap_linear);
+
+  PTA_uchar image = tex->modify_ram_image();
+  unsigned int seed = 1;
+  for (size_t i = 0; i < image.size(); ++i) {
+    seed = seed * 1103515245 + 12345;
+    image[i] = (unsigned char)((i / 7) ^ (seed >> 16));
+  }
+  return tex;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: process
+//  Description: Generates the mipmap levels of a new texture, and
+//               compresses them if squish is available, using the
+//               indicated number of threads.  Returns the resulting
+//               RAM images, concatenated.
+////////////////////////////////////////////////////////////////////
+static string
+process(int num_threads, bool &compressed) {
+  ostringstream strm;
+  strm << "texture-process-threads " << num_threads;
+  load_prc_file_data("", strm.str());
+
+  PT(Texture) tex = make_texture();
+  tex->generate_ram_mipmap_images();
+  compressed = tex->compress_ram_image(Texture::CM_dxt5);
+
+  string result;
+  for (int n = 0; n < tex->get_num_ram_mipmap_images(); ++n) {
+    CPTA_uchar image = tex->get_ram_mipmap_image(n);
+    result += string((const char *)image.p(), image.size());
+  }
+  return result;
+}
+
+int
+main(int argc, char *argv[]) {
+  if (!Thread::is_true_threads()) {
+    nout << "Not built with true threads; nothing to compare.\n";
+    return 0;
+  }
+
+  bool serial_compressed, threaded_compressed;
+  string serial = process(0, serial_compressed);
+  string threaded = process(4, threaded_compressed);
+
+  if (!serial_compressed) {
+    nout << "Built without squish; comparing the mipmap levels only.\n";
+  }
+
+  if (serial_compressed != threaded_compressed || serial != threaded) {
+    nout << "FAILED: threaded result differs from the serial result.\n";
+    return 1;
+  }
+
+  nout << "Threaded and serial results match (" << serial.size()
+       << " bytes).\n";
+  return 0;
+}
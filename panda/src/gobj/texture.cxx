@@ -42,10 +42,16 @@
 #include "streamReader.h"
 #include "texturePeeker.h"
 
+#include "asyncTaskManager.h"
+
 #ifdef HAVE_SQUISH
 #include <squish.h>
 #endif  // HAVE_SQUISH
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif  // __SSE2__
+
 #include <stddef.h>
 
 ConfigVariableEnum<Texture::QualityLevel> texture_quality_level
@@ -63,6 +69,34 @@ TypeHandle Texture::_type_handle;
 TypeHandle Texture::CData::_type_handle;
 AutoTextureScale Texture::_textures_power_2 = ATS_unspecified;
 
+// Calls function() for the jobs 0 .. num_jobs - 1, dividing them
+// among the threads of the "texture_process" task chain if
+// texture-process-threads is more than 1.  Returns when all of them
+// are finished.  The function is called without any locks held, and
+// must be safe to call from several threads at once for
+// non-overlapping ranges.
+static void
+run_texture_jobs(const string &name, int num_jobs,
+                 RangeAsyncTask::RangeFunc *function, void *user_data) {
+  int num_threads = texture_process_threads;
+  if (num_jobs < 2 || num_threads <= 1 || !Thread::is_true_threads()) {
+    (*function)(0, num_jobs, user_data);
+    return;
+  }
+
+  AsyncTaskManager *task_mgr = AsyncTaskManager::get_global_ptr();
+  AsyncTaskChain *chain = task_mgr->make_task_chain("texture_process");
+  if (chain->get_num_threads() != num_threads) {
+    chain->set_num_threads(num_threads);
+  }
+
+  // Give each thread several pieces, so that the threads finish at
+  // about the same time.
+  int grain_size = max(num_jobs / (num_threads * 8), 1);
+
+  chain->parallel_for_join(name, 0, num_jobs, grain_size, function, user_data);
+}
+
 // Stuff to read and write DDS files.
 
 //  little-endian, of course
@@ -6810,6 +6844,9 @@ compare_images(const PNMImage &a, const PNMImage &b) {
 //               They need not be a power of 2, or even a multiple of
 //               2.
 //
+//               The rows of all of the pages may be divided among
+//               several threads; see texture-process-threads.
+//
 //               Assumes the lock is already held.
 ////////////////////////////////////////////////////////////////////
 void Texture::
@@ -6860,93 +6897,37 @@ do_filter_2d_mipmap_pages(const CData *cdata,
   to._page_size = (size_t)to_y_size * to_row_size;
   to._image = PTA_uchar::empty_array(to._page_size * cdata->_z_size * cdata->_num_views, get_class_type());
 
-  bool alpha = has_alpha(cdata->_format);
-  int num_color_components = cdata->_num_components;
-  if (alpha) {
-    --num_color_components;
-  }
-
+  MipmapFilter mf;
+  mf._to = to._image.p();
+  mf._from = from._image.p();
+  mf._to_row_size = to_row_size;
+  mf._to_page_size = to._page_size;
+  mf._page_size = from._page_size;
+
+  // An axis of only one pixel is not halved; its one pixel is
+  // averaged with itself.
+  mf._pixel_step = (x_size != 1) ? pixel_size : 0;
+  mf._row_step = (y_size != 1) ? row_size : 0;
+  mf._to_x_size = to_x_size;
+  mf._to_y_size = to_y_size;
+
+  mf._alpha = has_alpha(cdata->_format);
+  mf._num_color_components = cdata->_num_components;
+  if (mf._alpha) {
+    --mf._num_color_components;
+  }
+  mf._filter_2d_component = filter_component;
+  mf._filter_2d_alpha = filter_alpha;
+
+  // Four-component unsigned bytes, by far the most common case, are
+  // averaged a whole row at a time.
+  mf._rgba8 = (filter_component == &filter_2d_unsigned_byte &&
+               pixel_size == 4 && mf._pixel_step != 0 && mf._row_step != 0);
+
+  // Each row of each page can be filtered independently.
   int num_pages = cdata->_z_size * cdata->_num_views;
-  for (int z = 0; z < num_pages; ++z) {
-    // For each level.
-    unsigned char *p = to._image.p() + z * to._page_size;
-    nassertv(p <= to._image.p() + to._image.size() + to._page_size);
-    const unsigned char *q = from._image.p() + z * from._page_size;
-    nassertv(q <= from._image.p() + from._image.size() + from._page_size);
-    if (y_size != 1) {
-      int y;
-      for (y = 0; y < y_size - 1; y += 2) {
-        // For each row.
-        nassertv(p == to._image.p() + z * to._page_size + (y / 2) * to_row_size);
-        nassertv(q == from._image.p() + z * from._page_size + y * row_size);
-        if (x_size != 1) {
-          int x;
-          for (x = 0; x < x_size - 1; x += 2) {
-            // For each pixel.
-            for (int c = 0; c < num_color_components; ++c) {
-              // For each component.
-              filter_component(p, q, pixel_size, row_size);
-            }
-            if (alpha) {
-              filter_alpha(p, q, pixel_size, row_size);
-            }
-            q += pixel_size;
-          }
-          if (x < x_size) {
-            // Skip the last odd pixel.
-            q += pixel_size;
-          }
-        } else {
-          // Just one pixel.
-          for (int c = 0; c < num_color_components; ++c) {
-            // For each component.
-            filter_component(p, q, 0, row_size);
-          }
-          if (alpha) {
-            filter_alpha(p, q, 0, row_size);
-          }
-        }
-        q += row_size;
-        Thread::consider_yield();
-      }
-      if (y < y_size) {
-        // Skip the last odd row.
-        q += row_size;
-      }
-    } else {
-      // Just one row.
-      if (x_size != 1) {
-        int x;
-        for (x = 0; x < x_size - 1; x += 2) {
-          // For each pixel.
-          for (int c = 0; c < num_color_components; ++c) {
-            // For each component.
-            filter_component(p, q, pixel_size, 0);
-          }
-          if (alpha) {
-            filter_alpha(p, q, pixel_size, 0);
-          }
-          q += pixel_size;
-        }
-        if (x < x_size) {
-          // Skip the last odd pixel.
-          q += pixel_size;
-        }
-      } else {
-        // Just one pixel.
-        for (int c = 0; c < num_color_components; ++c) {
-          // For each component.
-          filter_component(p, q, 0, 0);
-        }
-        if (alpha) {
-          filter_alpha(p, q, pixel_size, 0);
-        }
-      }
-    }
-
-    nassertv(p == to._image.p() + (z + 1) * to._page_size);
-    nassertv(q == from._image.p() + (z + 1) * from._page_size);
-  }
+  nassertv(from._page_size * num_pages <= from._image.size());
+  run_texture_jobs("mipmap", num_pages * to_y_size, &filter_2d_rows, &mf);
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -6960,6 +6941,9 @@ do_filter_2d_mipmap_pages(const CData *cdata,
 //               previous level.  They need not be a power of 2, or
 //               even a multiple of 2.
 //
+//               The rows of all of the pages may be divided among
+//               several threads; see texture-process-threads.
+//
 //               Assumes the lock is already held.
 ////////////////////////////////////////////////////////////////////
 void Texture::
@@ -7015,177 +6999,160 @@ do_filter_3d_mipmap_level(const CData *cdata,
   to._page_size = to_page_size;
   to._image = PTA_uchar::empty_array(to_page_size * to_z_size * cdata->_num_views, get_class_type());
 
-  bool alpha = has_alpha(cdata->_format);
-  int num_color_components = cdata->_num_components;
-  if (alpha) {
-    --num_color_components;
-  }
-
-  for (int view = 0; view < cdata->_num_views; ++view) {
-    unsigned char *start_to = to._image.p() + view * to_view_size;
-    const unsigned char *start_from = from._image.p() + view * view_size;
-    nassertv(start_to + to_view_size <= to._image.p() + to._image.size());
-    nassertv(start_from + view_size <= from._image.p() + from._image.size());
-    unsigned char *p = start_to;
-    const unsigned char *q = start_from;
-    if (z_size != 1) {
-      int z;
-      for (z = 0; z < z_size - 1; z += 2) {
-        // For each level.
-        nassertv(p == start_to + (z / 2) * to_page_size);
-        nassertv(q == start_from + z * page_size);
-        if (y_size != 1) {
-          int y;
-          for (y = 0; y < y_size - 1; y += 2) {
-            // For each row.
-            nassertv(p == start_to + (z / 2) * to_page_size + (y / 2) * to_row_size);
-            nassertv(q == start_from + z * page_size + y * row_size);
-            if (x_size != 1) {
-              int x;
-              for (x = 0; x < x_size - 1; x += 2) {
-                // For each pixel.
-                for (int c = 0; c < num_color_components; ++c) {
-                  // For each component.
-                  filter_component(p, q, pixel_size, row_size, page_size);
-                }
-                if (alpha) {
-                  filter_alpha(p, q, pixel_size, row_size, page_size);
-                }
-                q += pixel_size;
-              }
-              if (x < x_size) {
-                // Skip the last odd pixel.
-                q += pixel_size;
-              }
-            } else {
-              // Just one pixel.
-              for (int c = 0; c < num_color_components; ++c) {
-                // For each component.
-                filter_component(p, q, 0, row_size, page_size);
-              }
-              if (alpha) {
-                filter_alpha(p, q, 0, row_size, page_size);
-              }
-            }
-            q += row_size;
-            Thread::consider_yield();
-          }
-          if (y < y_size) {
-            // Skip the last odd row.
-            q += row_size;
-          }
-        } else {
-          // Just one row.
-          if (x_size != 1) {
-            int x;
-            for (x = 0; x < x_size - 1; x += 2) {
-              // For each pixel.
-              for (int c = 0; c < num_color_components; ++c) {
-                // For each component.
-                filter_component(p, q, pixel_size, 0, page_size);
-              }
-              if (alpha) {
-                filter_alpha(p, q, pixel_size, 0, page_size);
-              }
-              q += pixel_size;
-            }
-            if (x < x_size) {
-              // Skip the last odd pixel.
-              q += pixel_size;
-            }
-          } else {
-            // Just one pixel.
-            for (int c = 0; c < num_color_components; ++c) {
-              // For each component.
-              filter_component(p, q, 0, 0, page_size);
-            }
-            if (alpha) {
-              filter_alpha(p, q, 0, 0, page_size);
-            }
-          }
-        }
-        q += page_size;
-      }
-      if (z < z_size) {
-        // Skip the last odd page.
-        q += page_size;
-      }
+  MipmapFilter mf;
+  mf._to = to._image.p();
+  mf._from = from._image.p();
+  mf._to_row_size = to_row_size;
+  mf._to_page_size = to_page_size;
+  mf._to_view_size = to_view_size;
+  mf._view_size = view_size;
+
+  // An axis of only one pixel is not halved; its one pixel is
+  // averaged with itself.
+  mf._pixel_step = (x_size != 1) ? pixel_size : 0;
+  mf._row_step = (y_size != 1) ? row_size : 0;
+  mf._page_step = (z_size != 1) ? page_size : 0;
+  mf._to_x_size = to_x_size;
+  mf._to_y_size = to_y_size;
+  mf._to_z_size = to_z_size;
+
+  mf._alpha = has_alpha(cdata->_format);
+  mf._num_color_components = cdata->_num_components;
+  if (mf._alpha) {
+    --mf._num_color_components;
+  }
+  mf._filter_3d_component = filter_component;
+  mf._filter_3d_alpha = filter_alpha;
+
+  // Each row of each page of each view can be filtered independently.
+  nassertv(view_size * cdata->_num_views <= from._image.size());
+  run_texture_jobs("mipmap", cdata->_num_views * to_z_size * to_y_size,
+                   &filter_3d_rows, &mf);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: Texture::filter_2d_rows
+//       Access: Private, Static
+//  Description: Generates the rows begin .. end - 1 of the next
+//               mipmap level, for do_filter_2d_mipmap_pages().  The
+//               rows of all of the pages are numbered consecutively.
+////////////////////////////////////////////////////////////////////
+void Texture::
+filter_2d_rows(int begin, int end, void *data) {
+  const MipmapFilter &mf = *(const MipmapFilter *)data;
+
+  for (int i = begin; i < end; ++i) {
+    int z = i / mf._to_y_size;
+    int y = i % mf._to_y_size;
+    unsigned char *p = mf._to + z * mf._to_page_size + y * mf._to_row_size;
+    const unsigned char *q = mf._from + z * mf._page_size + (size_t)y * 2 * mf._row_step;
+
+    if (mf._rgba8) {
+      filter_2d_rgba8_row(p, q, mf._row_step, mf._to_x_size);
+
     } else {
-      // Just one page.
-      if (y_size != 1) {
-        int y;
-        for (y = 0; y < y_size - 1; y += 2) {
-          // For each row.
-          nassertv(p == start_to + (y / 2) * to_row_size);
-          nassertv(q == start_from + y * row_size);
-          if (x_size != 1) {
-            int x;
-            for (x = 0; x < x_size - 1; x += 2) {
-              // For each pixel.
-              for (int c = 0; c < num_color_components; ++c) {
-                // For each component.
-                filter_component(p, q, pixel_size, row_size, 0);
-              }
-              if (alpha) {
-                filter_alpha(p, q, pixel_size, row_size, 0);
-              }
-              q += pixel_size;
-            }
-            if (x < x_size) {
-              // Skip the last odd pixel.
-              q += pixel_size;
-            }
-          } else {
-            // Just one pixel.
-            for (int c = 0; c < num_color_components; ++c) {
-              // For each component.
-              filter_component(p, q, 0, row_size, 0);
-            }
-            if (alpha) {
-              filter_alpha(p, q, 0, row_size, 0);
-            }
-          }
-          q += row_size;
-          Thread::consider_yield();
-        }
-        if (y < y_size) {
-          // Skip the last odd row.
-          q += row_size;
+      for (int x = 0; x < mf._to_x_size; ++x) {
+        // For each pixel.
+        for (int c = 0; c < mf._num_color_components; ++c) {
+          // For each component.
+          mf._filter_2d_component(p, q, mf._pixel_step, mf._row_step);
         }
-      } else {
-        // Just one row.
-        if (x_size != 1) {
-          int x;
-          for (x = 0; x < x_size - 1; x += 2) {
-            // For each pixel.
-            for (int c = 0; c < num_color_components; ++c) {
-              // For each component.
-              filter_component(p, q, pixel_size, 0, 0);
-            }
-            if (alpha) {
-              filter_alpha(p, q, pixel_size, 0, 0);
-            }
-            q += pixel_size;
-          }
-          if (x < x_size) {
-            // Skip the last odd pixel.
-            q += pixel_size;
-          }
-        } else {
-          // Just one pixel.
-          for (int c = 0; c < num_color_components; ++c) {
-            // For each component.
-            filter_component(p, q, 0, 0, 0);
-          }
-          if (alpha) {
-            filter_alpha(p, q, 0, 0, 0);
-          }
+        if (mf._alpha) {
+          mf._filter_2d_alpha(p, q, mf._pixel_step, mf._row_step);
         }
+        // Skip the other pixel of the pair.
+        q += mf._pixel_step;
       }
     }
+    Thread::consider_yield();
+  }
+}
 
-    nassertv(p == start_to + to_z_size * to_page_size);
-    nassertv(q == start_from + z_size * page_size);
+////////////////////////////////////////////////////////////////////
+//     Function: Texture::filter_3d_rows
+//       Access: Private, Static
+//  Description: Generates the rows begin .. end - 1 of the next
+//               mipmap level, for do_filter_3d_mipmap_level().  The
+//               rows of all of the pages of all of the views are
+//               numbered consecutively.
+////////////////////////////////////////////////////////////////////
+void Texture::
+filter_3d_rows(int begin, int end, void *data) {
+  const MipmapFilter &mf = *(const MipmapFilter *)data;
+
+  for (int i = begin; i < end; ++i) {
+    int y = i % mf._to_y_size;
+    int z = (i / mf._to_y_size) % mf._to_z_size;
+    int view = i / (mf._to_y_size * mf._to_z_size);
+    unsigned char *p = mf._to + view * mf._to_view_size +
+      z * mf._to_page_size + y * mf._to_row_size;
+    const unsigned char *q = mf._from + view * mf._view_size +
+      (size_t)z * 2 * mf._page_step + (size_t)y * 2 * mf._row_step;
+
+    for (int x = 0; x < mf._to_x_size; ++x) {
+      // For each pixel.
+      for (int c = 0; c < mf._num_color_components; ++c) {
+        // For each component.
+        mf._filter_3d_component(p, q, mf._pixel_step, mf._row_step, mf._page_step);
+      }
+      if (mf._alpha) {
+        mf._filter_3d_alpha(p, q, mf._pixel_step, mf._row_step, mf._page_step);
+      }
+      // Skip the other pixel of the pair.
+      q += mf._pixel_step;
+    }
+    Thread::consider_yield();
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: Texture::filter_2d_rgba8_row
+//       Access: Private, Static
+//  Description: Averages each 2x2 block of four-component unsigned
+//               byte pixels in the row beginning at q and the row
+//               after it, producing to_x_size pixels at p.  This
+//               gives the same result as filter_2d_unsigned_byte()
+//               on each component, but handles two output pixels at
+//               a time with SSE2 where it is available.
+////////////////////////////////////////////////////////////////////
+void Texture::
+filter_2d_rgba8_row(unsigned char *p, const unsigned char *q,
+                    size_t row_size, int to_x_size) {
+  const unsigned char *q2 = q + row_size;
+  int x = 0;
+
+#ifdef __SSE2__
+  __m128i zero = _mm_setzero_si128();
+  for (; x + 2 <= to_x_size; x += 2) {
+    // Four pixels from each row, widened to 16 bits per component,
+    // and the two rows summed.
+    __m128i a = _mm_loadu_si128((const __m128i *)q);
+    __m128i b = _mm_loadu_si128((const __m128i *)q2);
+    __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero),
+                               _mm_unpacklo_epi8(b, zero));
+    __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero),
+                               _mm_unpackhi_epi8(b, zero));
+
+    // Now add each pair of pixels across.
+    lo = _mm_add_epi16(lo, _mm_srli_si128(lo, 8));
+    hi = _mm_add_epi16(hi, _mm_srli_si128(hi, 8));
+    __m128i sum = _mm_srli_epi16(_mm_unpacklo_epi64(lo, hi), 2);
+    _mm_storel_epi64((__m128i *)p, _mm_packus_epi16(sum, sum));
+
+    p += 8;
+    q += 16;
+    q2 += 16;
+  }
+#endif  // __SSE2__
+
+  for (; x < to_x_size; ++x) {
+    for (int c = 0; c < 4; ++c) {
+      p[c] = (unsigned char)(((unsigned int)q[c] + (unsigned int)q[c + 4] +
+                              (unsigned int)q2[c] + (unsigned int)q2[c + 4]) >> 2);
+    }
+    p += 4;
+    q += 8;
+    q2 += 8;
   }
 }
 
@@ -7368,11 +7335,98 @@ filter_3d_float(unsigned char *&p, const unsigned char *&q,
   q += 4;
 }
 
+#ifdef HAVE_SQUISH
+// One row of 4 x 4 cells of one page of one mipmap level, to be
+// compressed by squish_rows().
+class SquishRow {
+public:
+  const unsigned char *_source_page;
+  const unsigned char *_source_page_end;
+  unsigned char *_dest;
+  int _x_size;
+  int _y;
+};
+
+class SquishJobs {
+public:
+  pvector<SquishRow> _rows;
+  int _num_components;
+  int _squish_flags;
+  int _cell_size;
+};
+
+static void
+squish_rows(int begin, int end, void *user_data) {
+  const SquishJobs &jobs = *(const SquishJobs *)user_data;
+  int num_components = jobs._num_components;
+
+  for (int ri = begin; ri < end; ++ri) {
+    const SquishRow &row = jobs._rows[ri];
+    unsigned const char *source_page = row._source_page;
+    unsigned const char *source_page_end = row._source_page_end;
+    int x_size = row._x_size;
+    int y = row._y;
+
+    // Convert one 4 x 4 cell at a time.
+    unsigned char *d = row._dest;
+    for (int x = 0; x < x_size; x += 4) {
+      unsigned char tb[16 * 4];
+      int mask = 0;
+      unsigned char *t = tb;
+      for (int i = 0; i < 16; ++i) {
+        int xi = x + i % 4;
+        int yi = y + i / 4;
+        unsigned const char *s = source_page + (yi * x_size + xi) * num_components;
+        if (s < source_page_end) {
+          switch (num_components) {
+          case 1:
+            t[0] = s[0];   // r
+            t[1] = s[0];   // g
+            t[2] = s[0];   // b
+            t[3] = 255;    // a
+            break;
+
+          case 2:
+            t[0] = s[0];   // r
+            t[1] = s[0];   // g
+            t[2] = s[0];   // b
+            t[3] = s[1];   // a
+            break;
+
+          case 3:
+            t[0] = s[2];   // r
+            t[1] = s[1];   // g
+            t[2] = s[0];   // b
+            t[3] = 255;    // a
+            break;
+
+          case 4:
+            t[0] = s[2];   // r
+            t[1] = s[1];   // g
+            t[2] = s[0];   // b
+            t[3] = s[3];   // a
+            break;
+          }
+          mask |= (1 << i);
+        }
+        t += 4;
+      }
+      squish::CompressMasked(tb, mask, d, jobs._squish_flags);
+      d += jobs._cell_size;
+    }
+    Thread::consider_yield();
+  }
+}
+#endif  // HAVE_SQUISH
+
 ////////////////////////////////////////////////////////////////////
 //     Function: Texture::do_squish
 //       Access: Private
 //  Description: Invokes the squish library to compress the RAM
-//               image(s).
+//               image(s).  The rows of cells of all of the mipmap
+//               levels and pages are compressed independently, and
+//               may be divided among several threads; see
+//               texture-process-threads.
 ////////////////////////////////////////////////////////////////////
 bool Texture::
 do_squish(CData *cdata, Texture::CompressionMode compression, int squish_flags) {
@@ -7387,6 +7441,11 @@ do_squish(CData *cdata, Texture::CompressionMode compression, int squish_flags)
     do_generate_ram_mipmap_images(cdata);
   }
 
+  SquishJobs jobs;
+  jobs._num_components = cdata->_num_components;
+  jobs._squish_flags = squish_flags;
+  jobs._cell_size = squish::GetStorageRequirements(4, 4, squish_flags);
+
   RamImages compressed_ram_images;
   compressed_ram_images.reserve(cdata->_ram_images.size());
   for (size_t n = 0; n < cdata->_ram_images.size(); ++n) {
@@ -7395,7 +7454,7 @@ do_squish(CData *cdata, Texture::CompressionMode compression, int squish_flags)
     int y_size = do_get_expected_mipmap_y_size(cdata, n);
     int num_pages = do_get_expected_mipmap_num_pages(cdata, n);
     int page_size = squish::GetStorageRequirements(x_size, y_size, squish_flags);
-    int cell_size = squish::GetStorageRequirements(4, 4, squish_flags);
+    int row_size = ((x_size + 3) / 4) * jobs._cell_size;
 
     compressed_image._page_size = page_size;
     compressed_image._image = PTA_uchar::empty_array(page_size * num_pages);
@@ -7403,59 +7462,21 @@ do_squish(CData *cdata, Texture::CompressionMode compression, int squish_flags)
       unsigned char *dest_page = compressed_image._image.p() + z * page_size;
       unsigned const char *source_page = cdata->_ram_images[n]._image.p() + z * cdata->_ram_images[n]._page_size;
       unsigned const char *source_page_end = source_page + cdata->_ram_images[n]._page_size;
-      // Convert one 4 x 4 cell at a time.
-      unsigned char *d = dest_page;
       for (int y = 0; y < y_size; y += 4) {
-        for (int x = 0; x < x_size; x += 4) {
-          unsigned char tb[16 * 4];
-          int mask = 0;
-          unsigned char *t = tb;
-          for (int i = 0; i < 16; ++i) {
-            int xi = x + i % 4;
-            int yi = y + i / 4;
-            unsigned const char *s = source_page + (yi * x_size + xi) * cdata->_num_components;
-            if (s < source_page_end) {
-              switch (cdata->_num_components) {
-              case 1:
-                t[0] = s[0];   // r
-                t[1] = s[0];   // g
-                t[2] = s[0];   // b
-                t[3] = 255;    // a
-                break;
-
-              case 2:
-                t[0] = s[0];   // r
-                t[1] = s[0];   // g
-                t[2] = s[0];   // b
-                t[3] = s[1];   // a
-                break;
-
-              case 3:
-                t[0] = s[2];   // r
-                t[1] = s[1];   // g
-                t[2] = s[0];   // b
-                t[3] = 255;    // a
-                break;
-
-              case 4:
-                t[0] = s[2];   // r
-                t[1] = s[1];   // g
-                t[2] = s[0];   // b
-                t[3] = s[3];   // a
-                break;
-              }
-              mask |= (1 << i);
-            }
-            t += 4;
-          }
-          squish::CompressMasked(tb, mask, d, squish_flags);
-          d += cell_size;
-          Thread::consider_yield();
-        }
+        SquishRow row;
+        row._source_page = source_page;
+        row._source_page_end = source_page_end;
+        row._dest = dest_page + (y / 4) * row_size;
+        row._x_size = x_size;
+        row._y = y;
+        jobs._rows.push_back(row);
       }
     }
     compressed_ram_images.push_back(compressed_image);
   }
+
+  run_texture_jobs("squish", (int)jobs._rows.size(), &squish_rows, &jobs);
+
   cdata->_ram_images.swap(compressed_ram_images);
   cdata->_ram_image_compression = compression;
   return true;
@@ -758,6 +758,37 @@ private:
   static void filter_3d_float(unsigned char *&p, const unsigned char *&q,
                               size_t pixel_size, size_t row_size, size_t page_size);
 
+  // The parameters of one mipmap level being generated, shared by
+  // all of its rows, which may be filtered on different threads.
+  class MipmapFilter {
+  public:
+    unsigned char *_to;
+    const unsigned char *_from;
+    size_t _to_row_size;
+    size_t _to_page_size;
+    size_t _to_view_size;
+    size_t _page_size;
+    size_t _view_size;
+    size_t _pixel_step;
+    size_t _row_step;
+    size_t _page_step;
+    int _to_x_size;
+    int _to_y_size;
+    int _to_z_size;
+    int _num_color_components;
+    bool _alpha;
+    bool _rgba8;
+    Filter2DComponent *_filter_2d_component;
+    Filter2DComponent *_filter_2d_alpha;
+    Filter3DComponent *_filter_3d_component;
+    Filter3DComponent *_filter_3d_alpha;
+  };
+
+  static void filter_2d_rows(int begin, int end, void *data);
+  static void filter_3d_rows(int begin, int end, void *data);
+  static void filter_2d_rgba8_row(unsigned char *p, const unsigned char *q,
+                                  size_t row_size, int to_x_size);
+
   bool do_squish(CData *cdata, CompressionMode compression, int squish_flags);
   bool do_unsquish(CData *cdata, int squish_flags);
 
@@ -0,0 +1,277 @@
+// Filename: vertexCacheOptimizer.cxx
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "vertexCacheOptimizer.h"
+
+#include <algorithm>
+
+////////////////////////////////////////////////////////////////////
+//     Function: VertexCacheOptimizer::Constructor
+//       Access: Public
+//  Description: The cache_size is the size of the LRU cache that is
+//               simulated while the triangles are ordered.  It should
+//               be at least as large as the actual post-transform
+//               cache of the hardware; the usual value of 32 does
+//               well for caches of any smaller size too.
+////////////////////////////////////////////////////////////////////
+VertexCacheOptimizer::
+VertexCacheOptimizer(int cache_size) :
+  _cache_size(max(cache_size, 4))
+{
+  // A vertex used by the most recent triangle gets a fixed score,
+  // regardless of which of its three vertices it was, so that the
+  // next triangle doesn't favor one particular edge.  After that the
+  // score falls off with the position in the cache.
+  _cache_scores.reserve(_cache_size);
+  int i;
+  for (i = 0; i < 3; ++i) {
+    _cache_scores.push_back(0.75f);
+  }
+  for (i = 3; i < _cache_size; ++i) {
+    float f = 1.0f - (float)(i - 3) / (float)(_cache_size - 3);
+    _cache_scores.push_back(f * csqrt(f));
+  }
+
+  // Vertices with only a few triangles left get a boost, so that
+  // they are finished off rather than left as lone triangles that
+  // will need the vertex to be transformed again later.
+  _valence_scores.reserve(64);
+  _valence_scores.push_back(0.0f);
+  for (i = 1; i < 64; ++i) {
+    _valence_scores.push_back(2.0f / csqrt((float)i));
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: VertexCacheOptimizer::optimize
+//       Access: Public
+//  Description: Reorders the num_triangles triangles whose vertex
+//               indices are listed in indices, three per triangle.
+//               All of the indices must be less than num_vertices.
+////////////////////////////////////////////////////////////////////
+void VertexCacheOptimizer::
+optimize(int *indices, int num_triangles, int num_vertices) {
+  if (num_triangles < 2) {
+    return;
+  }
+
+  build_adjacency(indices, num_triangles, num_vertices);
+
+  pvector<int> result;
+  result.reserve(num_triangles * 3);
+
+  _cache.clear();
+  _cache.reserve(_cache_size + 3);
+  _new_cache.reserve(_cache_size + 3);
+
+  // Start with the best triangle in the whole mesh.  After this, the
+  // best triangle is chosen only from those that use a vertex in the
+  // cache.
+  int best_tri = 0;
+  float best_score = _triangles[0]._score;
+  int ti;
+  for (ti = 1; ti < num_triangles; ++ti) {
+    if (_triangles[ti]._score > best_score) {
+      best_tri = ti;
+      best_score = _triangles[ti]._score;
+    }
+  }
+
+  int next_scan = 0;
+  for (int num_emitted = 0; num_emitted < num_triangles; ++num_emitted) {
+    if (best_tri < 0) {
+      // None of the vertices in the cache is used by any more
+      // triangles.  Rather than searching the whole mesh for the
+      // best triangle, which would make the algorithm quadratic,
+      // just take the next one in the original order.
+      while (_triangles[next_scan]._emitted) {
+        ++next_scan;
+      }
+      best_tri = next_scan;
+    }
+
+    const int *tri = indices + best_tri * 3;
+    result.push_back(tri[0]);
+    result.push_back(tri[1]);
+    result.push_back(tri[2]);
+    add_triangle(indices, best_tri);
+
+    // The vertices of the new triangle go to the front of the cache,
+    // and everything else moves down.
+    _new_cache.clear();
+    int i;
+    for (i = 0; i < 3; ++i) {
+      if (find(_new_cache.begin(), _new_cache.end(), tri[i]) == _new_cache.end()) {
+        _new_cache.push_back(tri[i]);
+      }
+    }
+    pvector<int>::const_iterator ci;
+    for (ci = _cache.begin(); ci != _cache.end(); ++ci) {
+      int v = (*ci);
+      if (v != tri[0] && v != tri[1] && v != tri[2]) {
+        _new_cache.push_back(v);
+      }
+    }
+
+    int num_cached = (int)_new_cache.size();
+    for (i = 0; i < num_cached; ++i) {
+      VertexInfo &vertex = _vertices[_new_cache[i]];
+      vertex._cache_pos = (i < _cache_size) ? i : -1;
+      vertex._score = get_vertex_score(vertex._cache_pos, vertex._num_remaining);
+    }
+
+    // Rescore the triangles that use any of the vertices whose scores
+    // have changed, including those that just fell out of the cache,
+    // and choose the best of them for next time.
+    best_tri = -1;
+    best_score = -1.0f;
+    for (i = 0; i < num_cached; ++i) {
+      const VertexInfo &vertex = _vertices[_new_cache[i]];
+      const int *vt = &_vertex_tris[vertex._first_tri];
+      for (int j = 0; j < vertex._num_remaining; ++j) {
+        int t = vt[j];
+        const int *tv = indices + t * 3;
+        float score = _vertices[tv[0]]._score + _vertices[tv[1]]._score +
+          _vertices[tv[2]]._score;
+        _triangles[t]._score = score;
+        if (score > best_score) {
+          best_tri = t;
+          best_score = score;
+        }
+      }
+    }
+
+    if (num_cached > _cache_size) {
+      _new_cache.resize(_cache_size);
+    }
+    _cache.swap(_new_cache);
+  }
+
+  nassertv((int)result.size() == num_triangles * 3);
+  memcpy(indices, &result[0], num_triangles * 3 * sizeof(int));
+
+  _vertices.clear();
+  _vertex_tris.clear();
+  _triangles.clear();
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: VertexCacheOptimizer::calc_acmr
+//       Access: Public, Static
+//  Description: Returns the average cache miss ratio of the indicated
+//               triangles: the number of vertices that would have to
+//               be transformed per triangle drawn with a FIFO
+//               post-transform cache of the indicated size.  This
+//               is 3.0 for a mesh that shares no vertices, and
+//               approaches 0.5 for a well-ordered regular grid.
+////////////////////////////////////////////////////////////////////
+double VertexCacheOptimizer::
+calc_acmr(const int *indices, int num_triangles, int cache_size) {
+  if (num_triangles <= 0) {
+    return 0.0;
+  }
+
+  int num_indices = num_triangles * 3;
+  int max_index = 0;
+  int i;
+  for (i = 0; i < num_indices; ++i) {
+    max_index = max(max_index, indices[i]);
+  }
+
+  // With a FIFO cache, a vertex is still in the cache if fewer than
+  // cache_size misses have happened since it was loaded.
+  pvector<int> loaded_at(max_index + 1, -cache_size - 1);
+  int num_misses = 0;
+  for (i = 0; i < num_indices; ++i) {
+    int &stamp = loaded_at[indices[i]];
+    if (num_misses - stamp > cache_size) {
+      ++num_misses;
+      stamp = num_misses;
+    }
+  }
+
+  return (double)num_misses / (double)num_triangles;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: VertexCacheOptimizer::build_adjacency
+//       Access: Private
+//  Description: Fills in the per-vertex list of triangles, and
+//               computes the initial scores.
+////////////////////////////////////////////////////////////////////
+void VertexCacheOptimizer::
+build_adjacency(const int *indices, int num_triangles, int num_vertices) {
+  int num_indices = num_triangles * 3;
+
+  VertexInfo blank;
+  blank._cache_pos = -1;
+  blank._first_tri = 0;
+  blank._num_remaining = 0;
+  blank._score = 0.0f;
+  _vertices.assign(num_vertices, blank);
+
+  int i;
+  for (i = 0; i < num_indices; ++i) {
+    nassertv(indices[i] >= 0 && indices[i] < num_vertices);
+    ++_vertices[indices[i]]._num_remaining;
+  }
+
+  int first_tri = 0;
+  Vertices::iterator vi;
+  for (vi = _vertices.begin(); vi != _vertices.end(); ++vi) {
+    VertexInfo &vertex = (*vi);
+    vertex._first_tri = first_tri;
+    first_tri += vertex._num_remaining;
+    vertex._score = get_vertex_score(-1, vertex._num_remaining);
+    vertex._num_remaining = 0;
+  }
+
+  _vertex_tris.resize(num_indices);
+  for (i = 0; i < num_indices; ++i) {
+    VertexInfo &vertex = _vertices[indices[i]];
+    _vertex_tris[vertex._first_tri + vertex._num_remaining] = i / 3;
+    ++vertex._num_remaining;
+  }
+
+  _triangles.resize(num_triangles);
+  for (i = 0; i < num_triangles; ++i) {
+    const int *tv = indices + i * 3;
+    TriangleInfo &tri = _triangles[i];
+    tri._score = _vertices[tv[0]]._score + _vertices[tv[1]]._score +
+      _vertices[tv[2]]._score;
+    tri._emitted = false;
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: VertexCacheOptimizer::add_triangle
+//       Access: Private
+//  Description: Marks the indicated triangle emitted, and removes it
+//               from the triangle lists of its vertices.
+////////////////////////////////////////////////////////////////////
+void VertexCacheOptimizer::
+add_triangle(const int *indices, int tri) {
+  _triangles[tri]._emitted = true;
+
+  const int *tv = indices + tri * 3;
+  for (int i = 0; i < 3; ++i) {
+    VertexInfo &vertex = _vertices[tv[i]];
+    int *begin = &_vertex_tris[vertex._first_tri];
+    int *end = begin + vertex._num_remaining;
+    int *p = find(begin, end, tri);
+    nassertv(p != end);
+    (*p) = *(end - 1);
+    --vertex._num_remaining;
+  }
+}
@@ -0,0 +1,97 @@
+// Filename: vertexCacheOptimizer.h
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#ifndef VERTEXCACHEOPTIMIZER_H
+#define VERTEXCACHEOPTIMIZER_H
+
+#include "pandabase.h"
+#include "pnotify.h"
+#include "pvector.h"
+#include "cmath.h"
+
+////////////////////////////////////////////////////////////////////
+//       Class : VertexCacheOptimizer
+// Description : Reorders the triangles of an indexed triangle list so
+//               that vertices are reused while they are still in the
+//               graphics card's post-transform vertex cache.
+//
+//               This is Tom Forsyth's "linear-speed vertex cache
+//               optimization" algorithm.  Each vertex is given a
+//               score according to its position in a simulated LRU
+//               cache and the number of triangles still waiting to
+//               use it, and the triangle with the best total score
+//               among those touching the cache is emitted next.  It
+//               runs in time linear in the number of triangles, and
+//               generally does as well on modern hardware as
+//               long triangle strips.
+//
+//               The vertices within each triangle are kept in their
+//               original order, so the winding and the provoking
+//               vertex of each triangle are unchanged.
+//
+//               This is used by GeomTriangles; see
+//               GeomPrimitive::optimize_vertex_cache().
+////////////////////////////////////////////////////////////////////
+class EXPCL_PANDA_GOBJ VertexCacheOptimizer {
+public:
+  VertexCacheOptimizer(int cache_size);
+
+  void optimize(int *indices, int num_triangles, int num_vertices);
+
+  static double calc_acmr(const int *indices, int num_triangles,
+                          int cache_size);
+
+private:
+  INLINE float get_vertex_score(int cache_pos, int num_remaining) const;
+
+  void build_adjacency(const int *indices, int num_triangles,
+                       int num_vertices);
+  void add_triangle(const int *indices, int tri);
+
+private:
+  int _cache_size;
+  pvector<float> _cache_scores;
+  pvector<float> _valence_scores;
+
+  class VertexInfo {
+  public:
+    int _cache_pos;
+    int _first_tri;
+    int _num_remaining;
+    float _score;
+  };
+  typedef pvector<VertexInfo> Vertices;
+  Vertices _vertices;
+
+  // For each vertex, the triangles that have not yet been emitted
+  // that use it, starting at the vertex's _first_tri.
+  pvector<int> _vertex_tris;
+
+  class TriangleInfo {
+  public:
+    float _score;
+    bool _emitted;
+  };
+  typedef pvector<TriangleInfo> Triangles;
+  Triangles _triangles;
+
+  // The simulated cache.  It holds up to _cache_size + 3 vertices
+  // while a triangle is being added.
+  pvector<int> _cache;
+  pvector<int> _new_cache;
+};
+
+#include "vertexCacheOptimizer.I"
+
+#endif
@@ -34,6 +34,9 @@ operator = (const VertexDataBuffer &copy) {
     PANDA_FREE_ARRAY(_resident_data);
     _resident_data = NULL;
   }
+  // A shared buffer may be shared again; it is read-only anyway.
+  _shared_data = copy._shared_data;
+  _shared_pointer = copy._shared_pointer;
   if (copy._resident_data != (unsigned char *)NULL && copy._size != 0) {
     // We only allocate _size bytes, not the full _reserved_size
     // allocated by the original copy.
@@ -62,19 +65,54 @@ swap(VertexDataBuffer &other) {
   size_t size = _size;
   size_t reserved_size = _reserved_size;
   PT(VertexDataBlock) block = _block;
+  CPTA_uchar shared_data = _shared_data;
+  const unsigned char *shared_pointer = _shared_pointer;
 
   _resident_data = other._resident_data;
   _size = other._size;
   _reserved_size = other._reserved_size;
   _block = other._block;
+  _shared_data = other._shared_data;
+  _shared_pointer = other._shared_pointer;
 
   other._resident_data = resident_data;
   other._size = size;
   other._reserved_size = reserved_size;
   other._block = block;
+  other._shared_data = shared_data;
+  other._shared_pointer = shared_pointer;
   nassertv(_reserved_size >= _size);
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: VertexDataBuffer::share_data
+//       Access: Public
+//  Description: Discards the buffer's current contents, and makes it
+//               read its size bytes directly out of the indicated
+//               array, beginning at offset, rather than copying them.
+//               The array is kept referenced for as long as the
+//               buffer remains in shared state; the first attempt to
+//               modify the buffer copies the data into independent
+//               memory.
+//
+//               The array must not be modified while it is shared.
+//               Datagram arrays are copy-on-write, so this is safe
+//               for the array returned by Datagram::get_array().
+////////////////////////////////////////////////////////////////////
+void VertexDataBuffer::
+share_data(const CPTA_uchar &data, size_t offset, size_t size) {
+  LightMutexHolder holder(_lock);
+  nassertv(offset + size <= data.size());
+
+  do_unclean_realloc(0);
+  if (size != 0) {
+    _shared_data = data;
+    _shared_pointer = data.p() + offset;
+    _reserved_size = size;
+    _size = size;
+  }
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: VertexDataBuffer::do_clean_realloc
 //       Access: Private
@@ -135,8 +173,10 @@ do_unclean_realloc(size_t reserved_size) {
         << this << ".unclean_realloc(" << reserved_size << ")\n";
     }
 
-    // If we're paged out, discard the page.
+    // If we're paged out or shared, discard the page or the share.
     _block = NULL;
+    _shared_data.clear();
+    _shared_pointer = NULL;
         
     if (_resident_data != (unsigned char *)NULL) {
       nassertv(_reserved_size != 0);
@@ -177,6 +217,20 @@ do_page_out(VertexDataBook &book) {
     // We're already paged out.
     return;
   }
+
+  if (_shared_pointer != (const unsigned char *)NULL) {
+    // A shared buffer goes onto a page too, so that it can be
+    // evicted along with everything else; this releases the share.
+    _block = book.alloc(_size);
+    nassertv(_block != (VertexDataBlock *)NULL);
+    unsigned char *pointer = _block->get_pointer(true);
+    nassertv(pointer != (unsigned char *)NULL);
+    memcpy(pointer, _shared_pointer, _size);
+
+    _shared_data.clear();
+    _shared_pointer = NULL;
+    return;
+  }
   nassertv(_resident_data != (unsigned char *)NULL);
 
   if (_size == 0) {
@@ -221,9 +275,23 @@ do_page_in() {
     return;
   }
 
-  nassertv(_block != (VertexDataBlock *)NULL);
   nassertv(_reserved_size == _size);
 
+  if (_shared_pointer != (const unsigned char *)NULL) {
+    // Copy the shared data into independent memory, and release the
+    // share.
+    get_class_type().inc_memory_usage(TypeHandle::MC_array, (int)_size);
+    _resident_data = (unsigned char *)PANDA_MALLOC_ARRAY(_size);
+    nassertv(_resident_data != (unsigned char *)NULL);
+
+    memcpy(_resident_data, _shared_pointer, _size);
+    _shared_data.clear();
+    _shared_pointer = NULL;
+    return;
+  }
+
+  nassertv(_block != (VertexDataBlock *)NULL);
+
   get_class_type().inc_memory_usage(TypeHandle::MC_array, (int)_size);
   _resident_data = (unsigned char *)PANDA_MALLOC_ARRAY(_size);
   nassertv(_resident_data != (unsigned char *)NULL);
@@ -19,6 +19,7 @@
 #include "vertexDataBook.h"
 #include "vertexDataBlock.h"
 #include "pointerTo.h"
+#include "pta_uchar.h"
 #include "virtualFile.h"
 #include "pStatCollector.h"
 #include "lightMutex.h"
@@ -44,12 +45,21 @@
 //               read-only.  In this state, _reserved_size will always
 //               equal _size.
 //
+//               shared - the buffer's memory is part of a read-only
+//               array owned by someone else, typically the Datagram
+//               it was read from (in _shared_data).  This memory,
+//               too, is considered read-only, and _reserved_size will
+//               always equal _size.
+//
 //               VertexDataBuffers start out in independent state.
 //               They get moved to paged state when their owning
 //               GeomVertexArrayData objects get evicted from the
 //               _independent_lru.  They can get moved back to
 //               independent state if they are modified
 //               (e.g. get_write_pointer() or realloc() is called).
+//               A shared buffer is likewise copied into independent
+//               memory when it is modified, or onto a page when it
+//               is paged out.
 //
 //               The idea is to keep the highly dynamic and
 //               frequently-modified VertexDataBuffers resident in
@@ -78,6 +88,9 @@ public:
 
   INLINE void page_out(VertexDataBook &book);
 
+  void share_data(const CPTA_uchar &data, size_t offset, size_t size);
+  INLINE bool is_shared() const;
+
   void swap(VertexDataBuffer &other);
 
 private:
@@ -91,6 +104,8 @@ private:
   size_t _size;
   size_t _reserved_size;
   PT(VertexDataBlock) _block;
+  CPTA_uchar _shared_data;
+  const unsigned char *_shared_pointer;
   LightMutex _lock;
 
 public:
@@ -955,7 +955,7 @@ transfer_geom(GeomNode *geom_node, const InternalName *texcoord_name,
       if (column != (const GeomVertexColumn *)NULL) {
         vdata = vdata->replace_column
           (InternalName::get_texcoord(), column->get_num_components(),
-           column->get_numeric_type(), column->get_contents());
+           column->get_unquantized_numeric_type(), column->get_contents());
         geom->set_vertex_data(vdata);
         
         GeomVertexReader from(vdata, texcoord_name, current_thread);
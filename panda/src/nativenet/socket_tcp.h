@@ -4,6 +4,10 @@
 #include "pandabase.h"
 #include "socket_ip.h"
 
+#ifdef IS_LINUX
+#include <linux/sockios.h>
+#endif
+
 /////////////////////////////////////////////////////////////////////
 // Class : Socket_TCP
 //
@@ -33,7 +37,9 @@ PUBLISHED:
     std::string RecvData(int max_len);
 public:
     inline int  SendData(const char * data, int size);
+    inline int  SendGather(const char * const *data, const int *lengths, int count);
     inline int  RecvData(char * data, int size);
+    inline int  GetSendBacklog();
   
 public:
   static TypeHandle get_class_type() {
@@ -245,4 +251,75 @@ inline int Socket_TCP::SendData(const std::string &str)
     return SendData(str.data(), str.size());
 };
 
+////////////////////////////////////////////////////////////////////
+// Function name : Socket_TCP::SendGather
+// Description   : Sends the count buffers, the ith of which is
+//                 lengths[i] bytes beginning at data[i], one after
+//                 another on the stream, with a single system call
+//                 where the platform supports it.
+//
+// Return type  : int
+//      - if error
+//      0 if socket closed for write or lengh is 0
+//      + bytes writen ( May be smaller than requested, and may end
+//        partway through one of the buffers)
+////////////////////////////////////////////////////////////////////
+inline int Socket_TCP::SendGather(const char * const *data, const int *lengths, int count)
+{
+#if defined(WIN32) || defined(WIN32_VC) || defined(WIN64_VC)
+    static const int max_buffers = 64;
+    WSABUF bufs[max_buffers];
+    if (count > max_buffers)
+        count = max_buffers;
+    for (int i = 0; i < count; ++i)
+    {
+        bufs[i].buf = (char *)data[i];
+        bufs[i].len = lengths[i];
+    }
+    DWORD sent = 0;
+    if (WSASend(_socket, bufs, count, &sent, 0, NULL, NULL) != 0)
+        return -1;
+    return (int)sent;
+
+#elif defined(IS_LINUX) || defined(IS_OSX) || defined(IS_FREEBSD)
+    static const int max_buffers = 256;
+    struct iovec iovs[max_buffers];
+    if (count > max_buffers)
+        count = max_buffers;
+    for (int i = 0; i < count; ++i)
+    {
+        iovs[i].iov_base = (void *)data[i];
+        iovs[i].iov_len = lengths[i];
+    }
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iovs;
+    msg.msg_iovlen = count;
+    return sendmsg(_socket, &msg, 0);
+
+#else
+    if (count == 0)
+        return 0;
+    return SendData(data[0], lengths[0]);
+#endif
+}
+
+////////////////////////////////////////////////////////////////////
+// Function name : Socket_TCP::GetSendBacklog
+// Description   : Returns the number of bytes written to the socket
+//                 that the peer has not yet acknowledged, or -1 if
+//                 this cannot be determined on this platform.
+////////////////////////////////////////////////////////////////////
+inline int Socket_TCP::GetSendBacklog()
+{
+#if defined(IS_LINUX) && defined(SIOCOUTQ)
+    int backlog = 0;
+    if (ioctl(_socket, SIOCOUTQ, &backlog) != 0)
+        return -1;
+    return backlog;
+#else
+    return -1;
+#endif
+}
+
 #endif //__SOCKET_TCP_H__
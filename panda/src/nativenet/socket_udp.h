@@ -44,6 +44,11 @@ public:
 PUBLISHED:
     inline bool SendTo(const string &data, const Socket_Address & address);
     inline bool SetToBroadCast();
+
+public:
+    inline int SendPackets(const char * const *headers, const int *header_lengths,
+                           const char * const *data, const int *lengths,
+                           const Socket_Address *addresses, int num_packets);
   
 public:
   static TypeHandle get_class_type() {
@@ -162,4 +167,96 @@ inline bool Socket_UDP::SendTo(const string &data, const Socket_Address & addres
   return SendTo(data.data(), data.size(), address);
 }
 
+////////////////////////////////////////////////////////////////////
+// Function name : Socket_UDP::SendPackets
+// Description   : Sends num_packets datagrams at once: the ith is
+//                 header_lengths[i] bytes beginning at headers[i],
+//                 followed by lengths[i] bytes beginning at data[i],
+//                 and goes to addresses[i] (or to the connected
+//                 address, if addresses is NULL).  headers may be
+//                 NULL if the datagrams have no separate header.
+//
+//                 The header and data are gathered by the kernel, so
+//                 neither needs to be copied into one buffer first.
+//
+//                 Returns the number of datagrams sent, which is less
+//                 than num_packets if one fails; if the first one
+//                 fails, returns -1.  On Linux this is a single
+//                 sendmmsg() call per 64 datagrams.
+////////////////////////////////////////////////////////////////////
+inline int Socket_UDP::SendPackets(const char * const *headers, const int *header_lengths,
+                                   const char * const *data, const int *lengths,
+                                   const Socket_Address *addresses, int num_packets)
+{
+#ifdef IS_LINUX
+    static const int chunk_size = 64;
+    struct mmsghdr msgs[chunk_size];
+    struct iovec iovs[chunk_size * 2];
+
+    int num_sent = 0;
+    while (num_sent < num_packets)
+    {
+        int count = num_packets - num_sent;
+        if (count > chunk_size)
+            count = chunk_size;
+
+        memset(msgs, 0, sizeof(struct mmsghdr) * count);
+        for (int i = 0; i < count; ++i)
+        {
+            struct iovec *iov = &iovs[i * 2];
+            msgs[i].msg_hdr.msg_iov = iov;
+            if (headers != NULL && header_lengths[num_sent + i] != 0)
+            {
+                iov->iov_base = (void *)headers[num_sent + i];
+                iov->iov_len = header_lengths[num_sent + i];
+                ++iov;
+            }
+            iov->iov_base = (void *)data[num_sent + i];
+            iov->iov_len = lengths[num_sent + i];
+            msgs[i].msg_hdr.msg_iovlen = (iov - msgs[i].msg_hdr.msg_iov) + 1;
+            if (addresses != NULL)
+            {
+                msgs[i].msg_hdr.msg_name = (void *)&addresses[num_sent + i].GetAddressInfo();
+                msgs[i].msg_hdr.msg_namelen = sizeof(sockaddr);
+            }
+        }
+
+        int val = sendmmsg(_socket, msgs, count, 0);
+        if (val <= 0)
+            break;
+
+        num_sent += val;
+        if (val < count)
+            break;
+    }
+    return (num_sent == 0 && num_packets != 0) ? -1 : num_sent;
+
+#else
+    string buffer;
+    int num_sent = 0;
+    while (num_sent < num_packets)
+    {
+        const char *packet = data[num_sent];
+        int len = lengths[num_sent];
+        if (headers != NULL && header_lengths[num_sent] != 0)
+        {
+            buffer.assign(headers[num_sent], header_lengths[num_sent]);
+            buffer.append(packet, len);
+            packet = buffer.data();
+            len = buffer.size();
+        }
+
+        bool okflag;
+        if (addresses != NULL)
+            okflag = SendTo(packet, len, addresses[num_sent]);
+        else
+            okflag = Send(packet, len);
+        if (!okflag)
+            break;
+        ++num_sent;
+    }
+    return (num_sent == 0 && num_packets != 0) ? -1 : num_sent;
+#endif
+}
+
 #endif //__SOCKET_UDP_H__
@@ -22,8 +22,11 @@ PUBLISHED:
     inline bool SendTo(const char * data, int len, const Socket_Address & address);
     inline bool InitNoAddress();
     inline bool SetToBroadCast();
-  
+
 public:
+    inline int GetPackets(char * data, int max_len, int *lengths,
+                          Socket_Address *addresses, int max_packets);
+
   static TypeHandle get_class_type() {
     return _type_handle;
   }
@@ -163,6 +166,78 @@ inline bool Socket_UDP_Incoming::SendTo(const char * data, int len, const Socket
     return (DO_SOCKET_WRITE_TO(_socket, data, len, &address.GetAddressInfo()) == len);
 }
 
+////////////////////////////////////////////////////////////////////
+// Function name : Socket_UDP_Incoming::GetPackets
+// Description   : Reads as many datagrams as are waiting, up to
+//                 max_packets.  The ith datagram is stored in the
+//                 max_len bytes beginning at data + i * max_len, with
+//                 its length in lengths[i] and its sender in
+//                 addresses[i].  On a blocking socket, this waits
+//                 only for the first datagram.
+//
+//                 Returns the number of datagrams read, 0 on a
+//                 blocking error, or -1 on any other error.  On Linux
+//                 this is a single recvmmsg() call; elsewhere it
+//                 reads just one datagram.
+////////////////////////////////////////////////////////////////////
+inline int Socket_UDP_Incoming::GetPackets(char * data, int max_len, int *lengths,
+                                           Socket_Address *addresses, int max_packets)
+{
+#ifdef IS_LINUX
+    // We read in chunks of this many, to keep the headers on the
+    // stack.
+    static const int chunk_size = 64;
+    struct mmsghdr msgs[chunk_size];
+    struct iovec iovs[chunk_size];
+
+    int num_read = 0;
+    while (num_read < max_packets)
+    {
+        int count = max_packets - num_read;
+        if (count > chunk_size)
+            count = chunk_size;
+
+        memset(msgs, 0, sizeof(struct mmsghdr) * count);
+        for (int i = 0; i < count; ++i)
+        {
+            iovs[i].iov_base = data + (num_read + i) * max_len;
+            iovs[i].iov_len = max_len;
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+            msgs[i].msg_hdr.msg_name = &addresses[num_read + i].GetAddressInfo();
+            msgs[i].msg_hdr.msg_namelen = sizeof(sockaddr);
+        }
+
+        // Only the first chunk may wait.
+        int flags = (num_read == 0) ? MSG_WAITFORONE : MSG_DONTWAIT;
+        int val = recvmmsg(_socket, msgs, count, flags, NULL);
+        if (val <= 0)
+        {
+            if (num_read != 0 || GetLastError() == LOCAL_BLOCKING_ERROR)
+                break;
+            return -1;
+        }
+
+        for (int i = 0; i < val; ++i)
+            lengths[num_read + i] = msgs[i].msg_len;
+        num_read += val;
+
+        if (val < count)
+            break;
+    }
+    return num_read;
+
+#else
+    if (max_packets <= 0)
+        return 0;
+
+    lengths[0] = max_len;
+    if (!GetPacket(data, &lengths[0], addresses[0]))
+        return -1;
+    return (lengths[0] == 0) ? 0 : 1;
+#endif
+}
+
 
 
 
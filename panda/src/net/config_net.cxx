@@ -143,6 +143,30 @@ ConfigVariableEnum<ThreadPriority> net_thread_priority
  PRC_DESC("The default thread priority when creating threaded readers "
           "or writers."));
 
+ConfigVariableBool net_use_epoll
+("net-use-epoll", true,
+ PRC_DESC("Set this true to have a ConnectionReader monitor its sockets "
+          "with epoll, where it is available (currently only on Linux), "
+          "or false to always use select().  With epoll, a reader may "
+          "monitor many thousands of sockets, and its threads wait for "
+          "activity in parallel; select() is limited to FD_SETSIZE "
+          "sockets, and only one reader thread at a time may call it."));
+
+ConfigVariableInt net_udp_batch_size
+("net-udp-batch-size", 32,
+ PRC_DESC("The maximum number of UDP datagrams that a ConnectionReader "
+          "will read, or a threaded ConnectionWriter will send, on a "
+          "single socket with one system call (where recvmmsg() and "
+          "sendmmsg() are available).  Set this to 1 to read and write "
+          "one datagram at a time."));
+
+ConfigVariableInt collect_tcp_max_bytes
+("collect-tcp-max-bytes", 65536,
+ PRC_DESC("In collect-tcp mode, a Connection sends its collected TCP "
+          "datagrams as soon as this many bytes are waiting, even if "
+          "collect-tcp-interval has not yet elapsed.  Set this to 0 to "
+          "collect on the time interval alone."));
+
 
 ////////////////////////////////////////////////////////////////////
 //     Function: init_libnet
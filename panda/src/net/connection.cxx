@@ -26,6 +26,7 @@
 #include "socket_tcp.h"
 #include "socket_udp.h"
 #include "dcast.h"
+#include "pvector.h"
 
 
 ////////////////////////////////////////////////////////////////////
@@ -43,8 +44,9 @@ Connection(ConnectionManager *manager, Socket_IP *socket) :
 {
   _collect_tcp = collect_tcp;
   _collect_tcp_interval = collect_tcp_interval;
+  _collect_tcp_max_bytes = collect_tcp_max_bytes;
   _queued_data_start = 0.0;
-  _queued_count = 0;
+  _queued_bytes = 0;
 
 #if defined(HAVE_THREADS) && defined(SIMPLE_THREADS)
   // In the presence of SIMPLE_THREADS, we use non-blocking I/O.  We
@@ -173,28 +175,47 @@ get_collect_tcp_interval() const {
   return _collect_tcp_interval;
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: Connection::set_collect_tcp_max_bytes
+//       Access: Published
+//  Description: Specifies the number of bytes of TCP datagrams that
+//               may be collected before they are all sent at once,
+//               even if the collect-tcp interval has not yet elapsed.
+//               Set this to 0 to send on the time interval alone.
+//               This only has meaning if "collect-tcp" mode is
+//               enabled; see set_collect_tcp().
+////////////////////////////////////////////////////////////////////
+void Connection::
+set_collect_tcp_max_bytes(int max_bytes) {
+  _collect_tcp_max_bytes = max_bytes;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: Connection::get_collect_tcp_max_bytes
+//       Access: Published
+//  Description: Returns the number of bytes of TCP datagrams that
+//               may be collected before they are all sent at once.
+//               See set_collect_tcp_max_bytes().
+////////////////////////////////////////////////////////////////////
+int Connection::
+get_collect_tcp_max_bytes() const {
+  return _collect_tcp_max_bytes;
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: Connection::consider_flush
 //       Access: Published
 //  Description: Sends the most recently queued TCP datagram(s) if
-//               enough time has elapsed.  This only has meaning if
-//               set_collect_tcp() has been set to true.
+//               enough time has elapsed, or enough data has been
+//               queued.  This only has meaning if set_collect_tcp()
+//               has been set to true.
 ////////////////////////////////////////////////////////////////////
 bool Connection::
 consider_flush() {
   LightReMutexHolder holder(_write_mutex);
 
-  if (!_collect_tcp) {
+  if (should_flush()) {
     return do_flush();
-
-  } else {
-    double elapsed = 
-      TrueClock::get_global_ptr()->get_short_time() - _queued_data_start;
-    // If the elapsed time is negative, someone must have reset the
-    // clock back, so just go ahead and flush.
-    if (elapsed < 0.0 || elapsed >= _collect_tcp_interval) {
-      return do_flush();
-    }
   }
 
   return true;
@@ -213,6 +234,62 @@ flush() {
   return do_flush();
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: Connection::get_num_queued_datagrams
+//       Access: Published
+//  Description: Returns the number of TCP datagrams that have been
+//               collected but not yet sent.  See set_collect_tcp().
+////////////////////////////////////////////////////////////////////
+int Connection::
+get_num_queued_datagrams() const {
+  LightReMutexHolder holder(_write_mutex);
+  return _write_queue.size();
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: Connection::get_num_queued_bytes
+//       Access: Published
+//  Description: Returns the total number of bytes, including
+//               headers, of the TCP datagrams that have been
+//               collected but not yet sent.  See set_collect_tcp().
+////////////////////////////////////////////////////////////////////
+int Connection::
+get_num_queued_bytes() const {
+  LightReMutexHolder holder(_write_mutex);
+  return _queued_bytes;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: Connection::get_send_backlog
+//       Access: Published
+//  Description: Returns the number of bytes that have been sent on
+//               this TCP connection but are not yet known to have
+//               arrived: those still collected, as reported by
+//               get_num_queued_bytes(), plus, where the operating
+//               system can report it, those written to the socket
+//               but not yet acknowledged by the other end.
+//
+//               A sender that produces data faster than the
+//               connection can carry it will see this number grow;
+//               it may use this as a signal to send less, or less
+//               often, until the backlog drains.
+////////////////////////////////////////////////////////////////////
+int Connection::
+get_send_backlog() const {
+  LightReMutexHolder holder(_write_mutex);
+  int backlog = _queued_bytes;
+
+  if (_socket != (Socket_IP *)NULL &&
+      _socket->is_exact_type(Socket_TCP::get_class_type())) {
+    int unacked = ((Socket_TCP *)_socket)->GetSendBacklog();
+    if (unacked > 0) {
+      backlog += unacked;
+    }
+  }
+
+  return backlog;
+}
+
 /*
 This method is disabled.  We don't provide enough interface to use
 non-blocking I/O effectively at this level, so we shouldn't provide
@@ -366,22 +443,26 @@ send_datagram(const NetDatagram &datagram, int tcp_header_size) {
 
     LightReMutexHolder holder(_write_mutex);
     DatagramUDPHeader header(datagram);
-    string data;
-    data += header.get_header();
-    data += datagram.get_message();
-    
+    string header_data = header.get_header();
+
     if (net_cat.is_debug()) {
       header.verify_datagram(datagram);
     }
-    
-    int bytes_to_send = data.length();
+
+    // The header and the datagram are handed to the socket
+    // separately, so the datagram's data need not be copied.
+    const char *header_ptr = header_data.data();
+    int header_length = header_data.length();
+    const char *data = (const char *)datagram.get_data();
+    int length = datagram.get_length();
+    int bytes_to_send = header_length + length;
     Socket_Address addr = datagram.get_address().get_addr();
 
-    bool okflag = udp->SendTo(data, addr);
+    bool okflag = (udp->SendPackets(&header_ptr, &header_length, &data, &length, &addr, 1) == 1);
 #if defined(HAVE_THREADS) && defined(SIMPLE_THREADS)
     while (!okflag && udp->GetLastError() == LOCAL_BLOCKING_ERROR && udp->Active()) {
       Thread::force_yield();
-      okflag = udp->SendTo(data, addr);
+      okflag = (udp->SendPackets(&header_ptr, &header_length, &data, &length, &addr, 1) == 1);
     }
 #endif  // SIMPLE_THREADS
       
@@ -407,16 +488,13 @@ send_datagram(const NetDatagram &datagram, int tcp_header_size) {
   DatagramTCPHeader header(datagram, tcp_header_size);
 
   LightReMutexHolder holder(_write_mutex);
-  _queued_data += header.get_header();
-  _queued_data += datagram.get_message();
-  _queued_count++;
+  queue_tcp_datagram(datagram, header.get_header());
   
   if (net_cat.is_debug()) {
     header.verify_datagram(datagram, tcp_header_size);
   }
 
-  if (!_collect_tcp || 
-      TrueClock::get_global_ptr()->get_short_time() - _queued_data_start >= _collect_tcp_interval) {
+  if (should_flush()) {
     return do_flush();
   }
 
@@ -439,22 +517,23 @@ send_raw_datagram(const NetDatagram &datagram) {
     Socket_UDP *udp;
     DCAST_INTO_R(udp, _socket, false);
 
-    string data = datagram.get_message();
+    const char *data = (const char *)datagram.get_data();
+    int length = datagram.get_length();
 
     LightReMutexHolder holder(_write_mutex);
     Socket_Address addr = datagram.get_address().get_addr();
-    bool okflag = udp->SendTo(data, addr);
+    bool okflag = udp->SendTo(data, length, addr);
 #if defined(HAVE_THREADS) && defined(SIMPLE_THREADS)
     while (!okflag && udp->GetLastError() == LOCAL_BLOCKING_ERROR && udp->Active()) {
       Thread::force_yield();
-      okflag = udp->SendTo(data, addr);
+      okflag = udp->SendTo(data, length, addr);
     }
 #endif  // SIMPLE_THREADS
     
     if (net_cat.is_spam()) {
       net_cat.spam()
         << "Sent UDP datagram with " 
-        << data.size() << " bytes to " << (void *)this 
+        << length << " bytes to " << (void *)this 
         << ", ok = " << okflag << "\n";
     }
 
@@ -463,77 +542,333 @@ send_raw_datagram(const NetDatagram &datagram) {
 
   // We might queue up TCP packets for later sending.
   LightReMutexHolder holder(_write_mutex);
-  _queued_data += datagram.get_message();
-  _queued_count++;
+  queue_tcp_datagram(datagram, string());
 
-  if (!_collect_tcp || 
-      TrueClock::get_global_ptr()->get_short_time() - _queued_data_start >= _collect_tcp_interval) {
+  if (should_flush()) {
     return do_flush();
   }
 
   return true;
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: Connection::send_datagrams
+//       Access: Private
+//  Description: This method is intended only to be called by
+//               ConnectionWriter.  It writes several datagrams at
+//               once to the socket, with or without the Datagram
+//               headers according to raw_mode, and returns the number
+//               written successfully.
+//
+//               On a UDP socket, the datagrams are all handed to the
+//               socket together, which can be done with a single
+//               system call on some platforms.  On a TCP socket, they
+//               are all queued together, and then written with one
+//               gather write (unless collect-tcp mode holds them for
+//               later).
+////////////////////////////////////////////////////////////////////
+int Connection::
+send_datagrams(const NetDatagram *datagrams, int num_datagrams,
+               int tcp_header_size, bool raw_mode) {
+  nassertr(_socket != (Socket_IP *)NULL, 0);
+
+  if (!_socket->is_exact_type(Socket_UDP::get_class_type())) {
+    LightReMutexHolder holder(_write_mutex);
+    int num_already_queued = (int)_write_queue.size();
+    int num_queued = 0;
+    for (int i = 0; i < num_datagrams; ++i) {
+      const NetDatagram &datagram = datagrams[i];
+      if (raw_mode) {
+        queue_tcp_datagram(datagram, string());
+
+      } else {
+        if (tcp_header_size == 2 && datagram.get_length() >= 0x10000) {
+          net_cat.error()
+            << "Attempt to send TCP datagram of " << datagram.get_length()
+            << " bytes--too long!\n";
+          nassert_raise("Datagram too long");
+          continue;
+        }
+        DatagramTCPHeader header(datagram, tcp_header_size);
+        queue_tcp_datagram(datagram, header.get_header());
+      }
+      ++num_queued;
+    }
+
+    if (should_flush()) {
+      int num_written = 0;
+      if (!do_flush(&num_written)) {
+        // Report only those of ours that made it out completely.
+        return max(num_written - num_already_queued, 0);
+      }
+    }
+    return num_queued;
+  }
+
+  Socket_UDP *udp;
+  DCAST_INTO_R(udp, _socket, 0);
+
+  // Collect the headers, if we want them, into one small buffer.
+  // The datagrams themselves are not copied; the socket gathers each
+  // header and its datagram together as it sends them.
+  string headers;
+  pvector<const char *> buffers;
+  pvector<int> lengths;
+  pvector<int> header_lengths;
+  pvector<Socket_Address> addrs;
+  buffers.reserve(num_datagrams);
+  lengths.reserve(num_datagrams);
+  addrs.reserve(num_datagrams);
+
+  size_t total_bytes = 0;
+  for (int i = 0; i < num_datagrams; ++i) {
+    const NetDatagram &datagram = datagrams[i];
+    if (!raw_mode) {
+      DatagramUDPHeader header(datagram);
+      headers += header.get_header();
+      header_lengths.push_back(datagram_udp_header_size);
+    }
+    buffers.push_back((const char *)datagram.get_data());
+    lengths.push_back(datagram.get_length());
+    addrs.push_back(datagram.get_address().get_addr());
+    total_bytes += lengths.back();
+  }
+  total_bytes += headers.length();
+
+  // We can't take the pointers into the header buffer until it's
+  // finished growing.
+  pvector<const char *> header_buffers;
+  if (!raw_mode) {
+    header_buffers.reserve(num_datagrams);
+    for (int i = 0; i < num_datagrams; ++i) {
+      header_buffers.push_back(headers.data() + i * datagram_udp_header_size);
+    }
+  }
+
+  LightReMutexHolder holder(_write_mutex);
+  int num_sent = 0;
+  bool okflag = true;
+  while (num_sent < num_datagrams) {
+    int result = udp->SendPackets(raw_mode ? NULL : &header_buffers[num_sent],
+                                  raw_mode ? NULL : &header_lengths[num_sent],
+                                  &buffers[num_sent], &lengths[num_sent],
+                                  &addrs[num_sent], num_datagrams - num_sent);
+    if (result > 0) {
+      num_sent += result;
+      continue;
+    }
+#if defined(HAVE_THREADS) && defined(SIMPLE_THREADS)
+    if (udp->GetLastError() == LOCAL_BLOCKING_ERROR && udp->Active()) {
+      Thread::force_yield();
+      continue;
+    }
+#endif  // SIMPLE_THREADS
+    okflag = false;
+    break;
+  }
+
+  if (net_cat.is_spam()) {
+    net_cat.spam()
+      << "Sent " << num_sent << " of " << num_datagrams
+      << " UDP datagrams with " << total_bytes << " bytes to "
+      << (void *)this << "\n";
+  }
+
+  check_send_error(okflag);
+  return num_sent;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: Connection::queue_tcp_datagram
+//       Access: Private
+//  Description: Adds the indicated datagram, preceded by the
+//               indicated header bytes, to the queue of TCP data
+//               waiting to be written by do_flush().  This assumes
+//               the _write_mutex is already held.
+//
+//               The datagram's data is shared, not copied, unless
+//               collect-tcp mode is on.  In that mode the datagram
+//               may sit in the queue after the caller has returned,
+//               and the caller is free to modify its array in place
+//               (e.g. with Datagram::modify_array()) in the meantime.
+////////////////////////////////////////////////////////////////////
+void Connection::
+queue_tcp_datagram(const Datagram &datagram, const string &header) {
+  nassertv(header.size() <= sizeof(PN_uint32));
+
+  _write_queue.push_back(QueuedDatagram());
+  QueuedDatagram &queued = _write_queue.back();
+  if (_collect_tcp) {
+    queued._datagram = Datagram(datagram.get_data(), datagram.get_length());
+  } else {
+    queued._datagram = datagram;
+  }
+  queued._header_size = header.size();
+  memcpy(queued._header, header.data(), header.size());
+
+  _queued_bytes += header.size() + datagram.get_length();
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: Connection::should_flush
+//       Access: Private
+//  Description: Returns true if the queued TCP datagrams should be
+//               written now: always, unless collect-tcp mode is
+//               enabled, in which case only once the collect-tcp
+//               interval has elapsed or enough data has been queued.
+//               This assumes the _write_mutex is already held.
+////////////////////////////////////////////////////////////////////
+bool Connection::
+should_flush() const {
+  if (!_collect_tcp) {
+    return true;
+  }
+
+  if (_collect_tcp_max_bytes > 0 && _queued_bytes >= _collect_tcp_max_bytes) {
+    return true;
+  }
+
+  double elapsed = 
+    TrueClock::get_global_ptr()->get_short_time() - _queued_data_start;
+  // If the elapsed time is negative, someone must have reset the
+  // clock back, so just go ahead and flush.
+  return (elapsed < 0.0 || elapsed >= _collect_tcp_interval);
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: Connection::do_flush
 //       Access: Private
 //  Description: The private implementation of flush(), this assumes
 //               the _write_mutex is already held.
+//
+//               The queued headers and datagrams are written
+//               directly from where they are, as many as possible at
+//               a time with a single gather write.
+//
+//               If num_written is not NULL, it is filled in with the
+//               number of queued datagrams that were written
+//               completely, which is all of them unless the write
+//               fails.
 ////////////////////////////////////////////////////////////////////
 bool Connection::
-do_flush() {
-  if (_queued_data.empty()) {
-    _queued_count = 0;
+do_flush(int *num_written) {
+  if (num_written != (int *)NULL) {
+    *num_written = (int)_write_queue.size();
+  }
+  if (_write_queue.empty()) {
     _queued_data_start = TrueClock::get_global_ptr()->get_short_time();
     return true;
   }
 
   if (net_cat.is_spam()) {
     net_cat.spam()
-      << "Sending " << _queued_count << " TCP datagram(s) with " 
-      << _queued_data.length() << " total bytes to " << (void *)this << "\n";
+      << "Sending " << _write_queue.size() << " TCP datagram(s) with " 
+      << _queued_bytes << " total bytes to " << (void *)this << "\n";
   }
 
   Socket_TCP *tcp;
   DCAST_INTO_R(tcp, _socket, false);
 
-  string sending_data;
-  _queued_data.swap(sending_data);
+  WriteQueue sending;
+  _write_queue.swap(sending);
 
-  _queued_count = 0;
+  _queued_bytes = 0;
   _queued_data_start = TrueClock::get_global_ptr()->get_short_time();
 
+  // Make a list of all of the buffers to write, in order, and note
+  // where each datagram's buffers end.
+  pvector<const char *> buffers;
+  pvector<int> lengths;
+  pvector<int> datagram_ends;
+  buffers.reserve(sending.size() * 2);
+  lengths.reserve(sending.size() * 2);
+  datagram_ends.reserve(sending.size());
+
+  WriteQueue::const_iterator qi;
+  for (qi = sending.begin(); qi != sending.end(); ++qi) {
+    const QueuedDatagram &queued = (*qi);
+    if (queued._header_size != 0) {
+      buffers.push_back((const char *)queued._header);
+      lengths.push_back(queued._header_size);
+    }
+    if (queued._datagram.get_length() != 0) {
+      buffers.push_back((const char *)queued._datagram.get_data());
+      lengths.push_back(queued._datagram.get_length());
+    }
+    datagram_ends.push_back((int)buffers.size());
+  }
+
+  // Now write them, picking up where the last write left off,
+  // possibly partway through a buffer.
+  int num_buffers = buffers.size();
+  int bi = 0;
+  bool okflag = true;
+
 #if defined(HAVE_THREADS) && defined(SIMPLE_THREADS)
   int max_send = net_max_write_per_epoch;
-  int data_sent = tcp->SendData(sending_data.data(), min((size_t)max_send, sending_data.size()));
-  bool okflag = (data_sent == (int)sending_data.size());
-  if (!okflag) {
-    int total_sent = 0;
-    if (data_sent > 0) {
-      total_sent += data_sent;
+#endif  // SIMPLE_THREADS
+
+  while (bi < num_buffers) {
+    int count = num_buffers - bi;
+
+#if defined(HAVE_THREADS) && defined(SIMPLE_THREADS)
+    // Don't hand more than max_send bytes to the socket at once, so
+    // that we yield to other threads regularly.
+    int clipped_length = 0;
+    int bytes = 0;
+    count = 0;
+    while (bi + count < num_buffers && (count == 0 || bytes < max_send)) {
+      bytes += lengths[bi + count];
+      ++count;
     }
-    double last_report = 0;
-    while (!okflag && tcp->Active() &&
-           (data_sent > 0 || tcp->GetLastError() == LOCAL_BLOCKING_ERROR)) {
-      if (data_sent == 0) {
+    int last = bi + count - 1;
+    if (max_send > 0 && bytes > max_send) {
+      clipped_length = lengths[last];
+      lengths[last] -= (bytes - max_send);
+    }
+    int data_sent = tcp->SendGather(&buffers[bi], &lengths[bi], count);
+    if (clipped_length != 0) {
+      lengths[last] = clipped_length;
+    }
+
+    if (data_sent <= 0) {
+      if (tcp->Active() && tcp->GetLastError() == LOCAL_BLOCKING_ERROR) {
         Thread::force_yield();
-      } else {
-        Thread::consider_yield();
+        continue;
       }
-      data_sent = tcp->SendData(sending_data.data() + total_sent, min((size_t)max_send, sending_data.size() - total_sent));
-      if (data_sent > 0) {
-        total_sent += data_sent;
-      }
-      okflag = (total_sent == (int)sending_data.size());
+      okflag = false;
+      break;
     }
-  }
+    Thread::consider_yield();
 
 #else  // SIMPLE_THREADS
-  int data_sent = tcp->SendData(sending_data);
-  bool okflag = (data_sent == (int)sending_data.size());
-
+    int data_sent = tcp->SendGather(&buffers[bi], &lengths[bi], count);
+    if (data_sent <= 0) {
+      okflag = false;
+      break;
+    }
 #endif  // SIMPLE_THREADS
 
+    // Skip past the buffers that were written completely, and the
+    // part of the next one that was written.
+    while (bi < num_buffers && data_sent >= lengths[bi]) {
+      data_sent -= lengths[bi];
+      ++bi;
+    }
+    if (data_sent > 0) {
+      buffers[bi] += data_sent;
+      lengths[bi] -= data_sent;
+    }
+  }
+
+  if (!okflag && num_written != (int *)NULL) {
+    *num_written = 0;
+    while (*num_written < (int)datagram_ends.size() &&
+           datagram_ends[*num_written] <= bi) {
+      ++(*num_written);
+    }
+  }
+
   return check_send_error(okflag);
 }
 
@@ -19,6 +19,8 @@
 #include "referenceCount.h"
 #include "netAddress.h"
 #include "lightReMutex.h"
+#include "datagram.h"
+#include "pvector.h"
 
 class Socket_IP;
 class ConnectionManager;
@@ -43,10 +45,16 @@ PUBLISHED:
   bool get_collect_tcp() const;
   void set_collect_tcp_interval(double interval);
   double get_collect_tcp_interval() const;
+  void set_collect_tcp_max_bytes(int max_bytes);
+  int get_collect_tcp_max_bytes() const;
 
   BLOCKING bool consider_flush();
   BLOCKING bool flush();
 
+  int get_num_queued_datagrams() const;
+  int get_num_queued_bytes() const;
+  int get_send_backlog() const;
+
   // Socket options.
   //  void set_nonblock(bool flag);
   void set_linger(bool flag, double time);
@@ -62,18 +70,38 @@ PUBLISHED:
 private:
   bool send_datagram(const NetDatagram &datagram, int tcp_header_size);
   bool send_raw_datagram(const NetDatagram &datagram);
-  bool do_flush();
+  int send_datagrams(const NetDatagram *datagrams, int num_datagrams,
+                     int tcp_header_size, bool raw_mode);
+  void queue_tcp_datagram(const Datagram &datagram, const string &header);
+  bool should_flush() const;
+  bool do_flush(int *num_written = NULL);
   bool check_send_error(bool okflag);
 
   ConnectionManager *_manager;
   Socket_IP *_socket;
   LightReMutex _write_mutex;
 
+  // A TCP datagram waiting to be written.  Unless collect-tcp mode
+  // is on, the queue is always flushed before the send call returns,
+  // so we just keep a reference to the caller's own data, rather than
+  // copying it; in collect-tcp mode, the datagram may outlive the
+  // call, so we copy its data (see queue_tcp_datagram()).  Either
+  // way, the header and the data are written together with a gather
+  // write.
+  class QueuedDatagram {
+  public:
+    Datagram _datagram;
+    unsigned char _header[sizeof(PN_uint32)];
+    int _header_size;
+  };
+  typedef pvector<QueuedDatagram> WriteQueue;
+
   bool _collect_tcp;
   double _collect_tcp_interval;
+  int _collect_tcp_max_bytes;
   double _queued_data_start;
-  string _queued_data;
-  int _queued_count;
+  WriteQueue _write_queue;
+  int _queued_bytes;
 
   friend class ConnectionWriter;
 };
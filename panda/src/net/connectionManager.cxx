@@ -33,6 +33,10 @@
 #include <ifaddrs.h>
 #endif
 
+#ifdef IS_LINUX
+#include <poll.h>
+#endif
+
 ////////////////////////////////////////////////////////////////////
 //     Function: ConnectionManager::Constructor
 //       Access: Published
@@ -279,9 +283,19 @@ open_TCP_client_connection(const NetAddress &address, int timeout_ms) {
     TrueClock *clock = TrueClock::get_global_ptr();
     double start = clock->get_short_time();
     Thread::force_yield();
+#ifdef IS_LINUX
+    // We use poll() here instead of select(), since the socket may be
+    // numbered beyond FD_SETSIZE.
+    struct pollfd pfd;
+    pfd.fd = socket->GetSocket();
+    pfd.events = POLLOUT;
+    pfd.revents = 0;
+    int ready = ::poll(&pfd, 1, 0);
+#else
     Socket_fdset fset;
     fset.setForSocket(*socket);
     int ready = fset.WaitForWrite(true, 0);
+#endif
     while (ready == 0) {
       double elapsed = clock->get_short_time() - start;
       if (elapsed * 1000.0 > timeout_ms) {
@@ -290,8 +304,12 @@ open_TCP_client_connection(const NetAddress &address, int timeout_ms) {
         break;
       }
       Thread::force_yield();
+#ifdef IS_LINUX
+      ready = ::poll(&pfd, 1, 0);
+#else
       fset.setForSocket(*socket);
       ready = fset.WaitForWrite(true, 0);
+#endif
     }
   }
 
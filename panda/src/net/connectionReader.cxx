@@ -28,8 +28,56 @@
 #include "atomicAdjust.h"
 #include "config_downloader.h"
 
+#ifdef IS_LINUX
+#include <sys/epoll.h>
+#include <poll.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
 static const int read_buffer_size = maximum_udp_datagram + datagram_udp_header_size;
 
+// The maximum number of events a thread will collect from a single
+// call to epoll_wait().  The sockets so collected are served only by
+// that thread, so this shouldn't be too large.
+static const int epoll_batch_size = 16;
+
+// The most UDP datagrams we will read from one socket at once,
+// whatever net-udp-batch-size says.  They are read onto the stack.
+static const int max_udp_batch_size = 64;
+
+////////////////////////////////////////////////////////////////////
+//     Function: get_udp_batch_size
+//  Description: Returns the number of UDP datagrams to try to read
+//               at once, from net-udp-batch-size.
+////////////////////////////////////////////////////////////////////
+static int
+get_udp_batch_size() {
+  return max(1, min((int)net_udp_batch_size, max_udp_batch_size));
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: socket_has_data
+//  Description: Returns true if there is data (or an error) waiting
+//               to be read on the indicated socket, without blocking.
+////////////////////////////////////////////////////////////////////
+static bool
+socket_has_data(const Socket_IP &socket) {
+#ifdef IS_LINUX
+  // We use poll() here instead of select(), since the socket may be
+  // numbered beyond FD_SETSIZE.
+  struct pollfd pfd;
+  pfd.fd = socket.GetSocket();
+  pfd.events = POLLIN;
+  pfd.revents = 0;
+  return (::poll(&pfd, 1, 0) != 0);
+#else
+  Socket_fdset fdset;
+  fdset.setForSocket(socket);
+  return (fdset.WaitForRead(true, 0) != 0);
+#endif
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: ConnectionReader::SocketInfo::Constructor
 //       Access: Public
@@ -41,6 +89,7 @@ SocketInfo(const PT(Connection) &connection) :
 {
   _busy = false;
   _error = false;
+  _epoll_key = 0;
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -125,6 +174,19 @@ ConnectionReader(ConnectionManager *manager, int num_threads,
 
   _currently_polling_thread = -1;
 
+  _epoll_fd = -1;
+  _next_epoll_key = 0;
+#ifdef IS_LINUX
+  if (net_use_epoll) {
+    _epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (_epoll_fd == -1) {
+      net_cat.warning()
+        << "Unable to create epoll instance (" << strerror(errno)
+        << "), using select() instead.\n";
+    }
+  }
+#endif  // IS_LINUX
+
   string reader_thread_name = thread_name;
   if (thread_name.empty()) {
     reader_thread_name = "ReaderThread";
@@ -172,6 +234,12 @@ ConnectionReader::
       sinfo->_connection.clear();
     }
   }
+
+#ifdef IS_LINUX
+  if (_epoll_fd != -1) {
+    close(_epoll_fd);
+  }
+#endif
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -206,7 +274,12 @@ add_connection(Connection *connection) {
     }
   }
 
-  _sockets.push_back(new SocketInfo(connection));
+  SocketInfo *sinfo = new SocketInfo(connection);
+  _sockets.push_back(sinfo);
+
+  if (_epoll_fd != -1) {
+    register_epoll_socket(sinfo);
+  }
 
   return true;
 }
@@ -236,6 +309,10 @@ remove_connection(Connection *connection) {
     return false;
   }
 
+  if ((*si)->_epoll_key != 0) {
+    unregister_epoll_socket(*si);
+  }
+
   _removed_sockets.push_back(*si);
   _sockets.erase(si);
 
@@ -442,17 +519,11 @@ flush_read_connection(Connection *connection) {
   // right here in this thread, since we've already removed this
   // connection from the reader.
 
-  Socket_fdset fdset;
-  fdset.clear();
-  fdset.setForSocket(*(sinfo.get_socket()));
-  int num_results = fdset.WaitForRead(true, 0);
-  while (num_results != 0) {
+  while (socket_has_data(*(sinfo.get_socket()))) {
     sinfo._busy = true;
     if (!process_incoming_data(&sinfo)) {
       break;
     }
-    fdset.setForSocket(*(sinfo.get_socket()));
-    num_results = fdset.WaitForRead(true, 0);
   }
 }
 
@@ -481,11 +552,37 @@ void ConnectionReader::
 finish_socket(SocketInfo *sinfo) {
   nassertv(sinfo->_busy);
 
+  if (_epoll_fd != -1) {
+    // The socket was registered one-shot, so epoll won't report it
+    // again until we rearm it.  If there is still unread data on it,
+    // it will be reported again right away.
+    LightMutexHolder holder(_sockets_mutex);
+    sinfo->_busy = false;
+    rearm_epoll_socket(sinfo);
+    return;
+  }
+
   // By marking the SocketInfo nonbusy, we make it available for
   // future polls.
   sinfo->_busy = false;
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: ConnectionReader::receive_datagrams
+//       Access: Protected, Virtual
+//  Description: Called when several datagrams have been read from a
+//               socket at once.  The default implementation passes
+//               each one to receive_datagram() in turn; a derived
+//               class may override this to handle them all together.
+////////////////////////////////////////////////////////////////////
+void ConnectionReader::
+receive_datagrams(const pvector<NetDatagram> &datagrams) {
+  pvector<NetDatagram>::const_iterator di;
+  for (di = datagrams.begin(); di != datagrams.end(); ++di) {
+    receive_datagram(*di);
+  }
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: ConnectionReader::process_incoming_data
 //       Access: Protected, Virtual
@@ -521,19 +618,21 @@ bool ConnectionReader::
 process_incoming_udp_data(SocketInfo *sinfo) {
   Socket_UDP *socket;
   DCAST_INTO_R(socket, sinfo->get_socket(), false);
-  Socket_Address addr;
 
-  // Read as many bytes as we can.
-  char buffer[read_buffer_size];
-  int bytes_read = read_buffer_size;
+  // Read as many datagrams as are waiting, up to net-udp-batch-size,
+  // with a single system call if we can.
+  char buffer[max_udp_batch_size * read_buffer_size];
+  int lengths[max_udp_batch_size];
+  Socket_Address addrs[max_udp_batch_size];
 
-  bool okflag = socket->GetPacket(buffer, &bytes_read, addr);
+  int num_read = socket->GetPackets(buffer, read_buffer_size, lengths, addrs,
+                                    get_udp_batch_size());
 
-  if (!okflag) {
+  if (num_read < 0) {
     finish_socket(sinfo);
     return false;
 
-  } else if (bytes_read == 0) {
+  } else if (num_read == 0) {
     // The socket was closed (!).  This shouldn't happen with a UDP
     // connection.  Oh well.  Report that and return.
     if (_manager != (ConnectionManager *)NULL) {
@@ -543,38 +642,46 @@ process_incoming_udp_data(SocketInfo *sinfo) {
     return false;
   }
 
-  // Since we are not running in raw mode, we decode the header to
-  // determine how big the datagram is.  This means we must have read
-  // at least a full header.
-  if (bytes_read < datagram_udp_header_size) {
-    net_cat.error()
-      << "Did not read entire header, discarding UDP datagram.\n";
-    finish_socket(sinfo);
-    return true;
-  }
-  
-  DatagramUDPHeader header(buffer);
-  
-  char *dp = buffer + datagram_udp_header_size;
-  bytes_read -= datagram_udp_header_size;
-  
-  NetDatagram datagram(dp, bytes_read);
-  
   // Now that we've read all the data, it's time to finish the socket
-  // so another thread can read the next datagram.
+  // so another thread can read the next datagrams.
   finish_socket(sinfo);
-  
+
   if (_shutdown) {
     return false;
   }
-  
-  // And now do whatever we need to do to process the datagram.
-  if (!header.verify_datagram(datagram)) {
-    net_cat.error()
-      << "Ignoring invalid UDP datagram.\n";
-  } else {
+
+  pvector<NetDatagram> datagrams;
+  datagrams.reserve(num_read);
+
+  for (int i = 0; i < num_read; ++i) {
+    char *dp = buffer + i * read_buffer_size;
+    int bytes_read = lengths[i];
+
+    // Since we are not running in raw mode, we decode the header to
+    // determine how big the datagram is.  This means we must have
+    // read at least a full header.
+    if (bytes_read < datagram_udp_header_size) {
+      net_cat.error()
+        << "Did not read entire header, discarding UDP datagram.\n";
+      continue;
+    }
+
+    DatagramUDPHeader header(dp);
+    dp += datagram_udp_header_size;
+    bytes_read -= datagram_udp_header_size;
+
+    datagrams.push_back(NetDatagram(dp, bytes_read));
+    NetDatagram &datagram = datagrams.back();
+
+    if (!header.verify_datagram(datagram)) {
+      net_cat.error()
+        << "Ignoring invalid UDP datagram.\n";
+      datagrams.pop_back();
+      continue;
+    }
+
     datagram.set_connection(sinfo->_connection);
-    datagram.set_address(NetAddress(addr));
+    datagram.set_address(NetAddress(addrs[i]));
 
     if (net_cat.is_spam()) {
       net_cat.spam()
@@ -583,8 +690,13 @@ process_incoming_udp_data(SocketInfo *sinfo) {
         << " bytes on " << (void *)datagram.get_connection()
         << " from " << datagram.get_address() << "\n";
     }
+  }
 
-    receive_datagram(datagram);
+  // And now do whatever we need to do to process the datagrams.
+  if (datagrams.size() == 1) {
+    receive_datagram(datagrams.front());
+  } else if (!datagrams.empty()) {
+    receive_datagrams(datagrams);
   }
 
   return true;
@@ -736,19 +848,21 @@ bool ConnectionReader::
 process_raw_incoming_udp_data(SocketInfo *sinfo) {
   Socket_UDP *socket;
   DCAST_INTO_R(socket, sinfo->get_socket(), false);
-  Socket_Address addr;
 
-  // Read as many bytes as we can.
-  char buffer[read_buffer_size];
-  int bytes_read = read_buffer_size;
+  // Read as many datagrams as are waiting, up to net-udp-batch-size,
+  // with a single system call if we can.
+  char buffer[max_udp_batch_size * read_buffer_size];
+  int lengths[max_udp_batch_size];
+  Socket_Address addrs[max_udp_batch_size];
 
-  bool okflag = socket->GetPacket(buffer, &bytes_read, addr);
+  int num_read = socket->GetPackets(buffer, read_buffer_size, lengths, addrs,
+                                    get_udp_batch_size());
 
-  if (!okflag) {
+  if (num_read < 0) {
     finish_socket(sinfo);
     return false;
 
-  } else if (bytes_read == 0) {
+  } else if (num_read == 0) {
     // The socket was closed (!).  This shouldn't happen with a UDP
     // connection.  Oh well.  Report that and return.
     if (_manager != (ConnectionManager *)NULL) {
@@ -758,29 +872,38 @@ process_raw_incoming_udp_data(SocketInfo *sinfo) {
     return false;
   }
 
-  // In raw mode, we simply extract all the bytes and make that a
-  // datagram.
-  NetDatagram datagram(buffer, bytes_read);
-  
   // Now that we've read all the data, it's time to finish the socket
-  // so another thread can read the next datagram.
+  // so another thread can read the next datagrams.
   finish_socket(sinfo);
-  
+
   if (_shutdown) {
     return false;
   }
-  
-  datagram.set_connection(sinfo->_connection);
-  datagram.set_address(NetAddress(addr));
 
-  if (net_cat.is_spam()) {
-    net_cat.spam()
-      << "Received raw UDP datagram with " << datagram.get_length() 
-      << " bytes on " << (void *)datagram.get_connection()
-      << " from " << datagram.get_address() << "\n";
+  pvector<NetDatagram> datagrams;
+  datagrams.reserve(num_read);
+
+  for (int i = 0; i < num_read; ++i) {
+    // In raw mode, we simply extract all the bytes and make that a
+    // datagram.
+    datagrams.push_back(NetDatagram(buffer + i * read_buffer_size, lengths[i]));
+    NetDatagram &datagram = datagrams.back();
+    datagram.set_connection(sinfo->_connection);
+    datagram.set_address(NetAddress(addrs[i]));
+
+    if (net_cat.is_spam()) {
+      net_cat.spam()
+        << "Received raw UDP datagram with " << datagram.get_length() 
+        << " bytes on " << (void *)datagram.get_connection()
+        << " from " << datagram.get_address() << "\n";
+    }
   }
 
-  receive_datagram(datagram);
+  if (datagrams.size() == 1) {
+    receive_datagram(datagrams.front());
+  } else {
+    receive_datagrams(datagrams);
+  }
 
   return true;
 }
@@ -879,6 +1002,17 @@ thread_run(int thread_index) {
 ////////////////////////////////////////////////////////////////////
 ConnectionReader::SocketInfo *ConnectionReader::
 get_next_available_socket(bool allow_block, int current_thread_index) {
+  if (_epoll_fd != -1) {
+    if (current_thread_index < 0) {
+      // The list of ready sockets for poll() is shared by all callers
+      // of poll(), so it needs protecting.  (The reader threads each
+      // have their own list, and don't need the mutex at all.)
+      MutexHolder holder(_select_mutex);
+      return get_next_epoll_socket(allow_block, current_thread_index);
+    }
+    return get_next_epoll_socket(allow_block, current_thread_index);
+  }
+
   // Go to sleep on the select() mutex.  This guarantees that only one
   // thread is in this function at a time.
   MutexHolder holder(_select_mutex);
@@ -958,6 +1092,85 @@ get_next_available_socket(bool allow_block, int current_thread_index) {
   return (SocketInfo *)NULL;
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: ConnectionReader::get_next_epoll_socket
+//       Access: Private
+//  Description: The epoll equivalent of get_next_available_socket().
+//               Each reader thread waits on the epoll instance
+//               independently, and keeps the sockets reported to it
+//               on its own list; since the sockets are registered
+//               one-shot, no other thread will be handed the same
+//               socket until it has been finished.
+////////////////////////////////////////////////////////////////////
+ConnectionReader::SocketInfo *ConnectionReader::
+get_next_epoll_socket(bool allow_block, int current_thread_index) {
+#ifdef IS_LINUX
+  ReadyKeys &ready = (current_thread_index >= 0) ?
+    _threads[current_thread_index]->_ready : _poll_ready;
+
+  while (!_shutdown) {
+    // First, hand out any sockets remaining from the previous
+    // epoll_wait() call.
+    while (!ready.empty()) {
+      PN_uint64 key = ready.back();
+      ready.pop_back();
+
+      LightMutexHolder holder(_sockets_mutex);
+      EpollSockets::const_iterator ei = _epoll_sockets.find(key);
+      if (ei != _epoll_sockets.end()) {
+        // Some noise on this socket.
+        SocketInfo *sinfo = (*ei).second;
+        sinfo->_busy = true;
+        return sinfo;
+      }
+
+      // Otherwise, the socket was removed after epoll reported it.
+    }
+
+    int timeout = (int)(get_net_max_block() * 1000.0);
+    if (!allow_block) {
+      timeout = 0;
+    }
+#if defined(HAVE_THREADS) && defined(SIMPLE_THREADS)
+    // As above, we never wait at all in the presence of
+    // SIMPLE_THREADS.
+    timeout = 0;
+#endif
+
+    struct epoll_event events[epoll_batch_size];
+    int num_events = epoll_wait(_epoll_fd, events, epoll_batch_size, timeout);
+
+    {
+      // This is a fine time to delete the removed sockets.
+      LightMutexHolder holder(_sockets_mutex);
+      delete_removed_sockets();
+    }
+
+    if (num_events > 0) {
+      for (int i = 0; i < num_events; ++i) {
+        ready.push_back(events[i].data.u64);
+      }
+
+    } else if (num_events < 0 && errno != EINTR) {
+      // If we had an error, just return.  But yield the timeslice
+      // first.
+      Thread::force_yield();
+      return (SocketInfo *)NULL;
+
+    } else if (!allow_block) {
+      return (SocketInfo *)NULL;
+
+    } else {
+      // If we reached net_max_block, go back and reconsider, after
+      // checking the shutdown flag.
+      Thread::force_yield();
+    }
+  }
+#endif  // IS_LINUX
+
+  return (SocketInfo *)NULL;
+}
+
 
 ////////////////////////////////////////////////////////////////////
 //     Function: ConnectionReader::rebuild_select_list
@@ -983,8 +1196,20 @@ rebuild_select_list() {
 
   // This is also a fine time to delete the contents of the
   // _removed_sockets list.
+  delete_removed_sockets();
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: ConnectionReader::delete_removed_sockets
+//       Access: Private
+//  Description: Deletes the sockets on the _removed_sockets list that
+//               are no longer busy.  Assumes _sockets_mutex is held.
+////////////////////////////////////////////////////////////////////
+void ConnectionReader::
+delete_removed_sockets() {
   if (!_removed_sockets.empty()) {
     Sockets still_busy_sockets;
+    Sockets::const_iterator si;
     for (si = _removed_sockets.begin(); si != _removed_sockets.end(); ++si) {
       SocketInfo *sinfo = (*si);
       if (sinfo->_busy) {
@@ -1016,3 +1241,82 @@ accumulate_fdset(Socket_fdset &fdset) {
     }
   }
 }
+
+////////////////////////////////////////////////////////////////////
+//     Function: ConnectionReader::register_epoll_socket
+//       Access: Private
+//  Description: Adds the indicated socket to the epoll instance,
+//               under a new key.  Assumes _sockets_mutex is held.
+////////////////////////////////////////////////////////////////////
+void ConnectionReader::
+register_epoll_socket(SocketInfo *sinfo) {
+#ifdef IS_LINUX
+  PN_uint64 key = ++_next_epoll_key;
+
+  struct epoll_event event;
+  event.events = EPOLLIN | EPOLLET | EPOLLONESHOT;
+  event.data.u64 = key;
+  if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, sinfo->get_socket()->GetSocket(),
+                &event) != 0) {
+    net_cat.error()
+      << "Unable to monitor socket with epoll: " << strerror(errno) << "\n";
+    sinfo->_error = true;
+    return;
+  }
+
+  sinfo->_epoll_key = key;
+  _epoll_sockets[key] = sinfo;
+#endif  // IS_LINUX
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: ConnectionReader::unregister_epoll_socket
+//       Access: Private
+//  Description: Removes the indicated socket from the epoll instance.
+//               Any noise already reported on it will be ignored.
+//               Assumes _sockets_mutex is held.
+////////////////////////////////////////////////////////////////////
+void ConnectionReader::
+unregister_epoll_socket(SocketInfo *sinfo) {
+#ifdef IS_LINUX
+  _epoll_sockets.erase(sinfo->_epoll_key);
+  sinfo->_epoll_key = 0;
+
+  // If the socket has already been closed, the kernel has already
+  // forgotten it, and its descriptor may even belong to some other
+  // socket by now.
+  Socket_IP *socket = sinfo->get_socket();
+  if (socket->Active()) {
+    struct epoll_event event;
+    epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, socket->GetSocket(), &event);
+  }
+#endif  // IS_LINUX
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: ConnectionReader::rearm_epoll_socket
+//       Access: Private
+//  Description: Reenables reporting of noise on the indicated socket,
+//               which has been reported once and since finished.
+//               Does nothing if the socket has since been removed.
+//               Assumes _sockets_mutex is held.
+////////////////////////////////////////////////////////////////////
+void ConnectionReader::
+rearm_epoll_socket(SocketInfo *sinfo) {
+#ifdef IS_LINUX
+  if (sinfo->_epoll_key == 0) {
+    return;
+  }
+
+  struct epoll_event event;
+  event.events = EPOLLIN | EPOLLET | EPOLLONESHOT;
+  event.data.u64 = sinfo->_epoll_key;
+  if (epoll_ctl(_epoll_fd, EPOLL_CTL_MOD, sinfo->get_socket()->GetSocket(),
+                &event) != 0) {
+    if (net_cat.is_debug()) {
+      net_cat.debug()
+        << "Unable to rearm socket with epoll: " << strerror(errno) << "\n";
+    }
+  }
+#endif  // IS_LINUX
+}
@@ -24,6 +24,7 @@
 #include "lightMutex.h"
 #include "pvector.h"
 #include "pset.h"
+#include "pmap.h"
 #include "socket_fdset.h"
 #include "atomicAdjust.h"
 
@@ -53,6 +54,12 @@ class Socket_IP;
 //               ConnectionListener derives from this class, extending
 //               it to accept connections on a rendezvous socket
 //               rather than read datagrams.
+//
+//               On Linux, the sockets are monitored with epoll rather
+//               than select() (unless net-use-epoll is false), which
+//               lifts the FD_SETSIZE limit on the number of sockets
+//               and lets the reader threads wait for noise in
+//               parallel.
 ////////////////////////////////////////////////////////////////////
 class EXPCL_PANDA_NET ConnectionReader {
 PUBLISHED:
@@ -67,6 +74,12 @@ PUBLISHED:
   // the arrays returned by a previous call to PR_Poll(), or (b)
   // execute (and possibly block on) a new call to PR_Poll().
 
+  // When epoll is available, each thread instead waits on the epoll
+  // descriptor itself.  Every socket is registered edge-triggered and
+  // one-shot, so each burst of noise is reported to exactly one
+  // thread, and the socket is not reported again until that thread
+  // has finished with it and rearmed it in finish_socket().
+
   ConnectionReader(ConnectionManager *manager, int num_threads,
                    const string &thread_name = string());
   virtual ~ConnectionReader();
@@ -92,6 +105,7 @@ PUBLISHED:
 protected:
   virtual void flush_read_connection(Connection *connection);
   virtual void receive_datagram(const NetDatagram &datagram)=0;
+  virtual void receive_datagrams(const pvector<NetDatagram> &datagrams);
 
   class SocketInfo {
   public:
@@ -102,6 +116,10 @@ protected:
     PT(Connection) _connection;
     bool _busy;
     bool _error;
+
+    // The key under which this socket is registered with epoll, or 0
+    // if it is not registered.
+    PN_uint64 _epoll_key;
   };
   typedef pvector<SocketInfo *> Sockets;
 
@@ -131,15 +149,26 @@ private:
 
   SocketInfo *get_next_available_socket(bool allow_block, 
                                         int current_thread_index);
+  SocketInfo *get_next_epoll_socket(bool allow_block,
+                                    int current_thread_index);
 
   void rebuild_select_list();
+  void delete_removed_sockets();
   void accumulate_fdset(Socket_fdset &fdset);
 
+  void register_epoll_socket(SocketInfo *sinfo);
+  void unregister_epoll_socket(SocketInfo *sinfo);
+  void rearm_epoll_socket(SocketInfo *sinfo);
+
 private:
   bool _raw_mode;
   int _tcp_header_size;
   bool _shutdown;
 
+  // The keys of sockets that epoll has reported noise on, but that
+  // have not yet been handed out.
+  typedef pvector<PN_uint64> ReadyKeys;
+
   class ReaderThread : public Thread {
   public:
     ReaderThread(ConnectionReader *reader, const string &thread_name, 
@@ -148,6 +177,7 @@ private:
 
     ConnectionReader *_reader;
     int _thread_index;
+    ReadyKeys _ready;
   };
 
   typedef pvector< PT(ReaderThread) > Threads;
@@ -169,6 +199,17 @@ private:
   // contains -1 if no thread is so waiting.
   AtomicAdjust::Integer _currently_polling_thread;
 
+  // These are used instead of the above when we are using epoll.
+  // _epoll_fd is -1 if we are not.  _epoll_sockets maps each
+  // registered key back to its socket; it is protected by
+  // _sockets_mutex.  Since a key is never reused, noise reported on
+  // a socket that has since been removed is simply ignored.
+  int _epoll_fd;
+  typedef pmap<PN_uint64, SocketInfo *> EpollSockets;
+  EpollSockets _epoll_sockets;
+  PN_uint64 _next_epoll_key;
+  ReadyKeys _poll_ready;
+
   friend class ConnectionManager;
   friend class ReaderThread;
 };
@@ -232,6 +232,53 @@ send(const Datagram &datagram, const PT(Connection) &connection,
   }
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: ConnectionWriter::send
+//       Access: Public
+//  Description: Enqueues several datagrams for transmittal at once.
+//               Each datagram must already have its connection set,
+//               and, if that is a UDP connection, its address too.
+//
+//               Runs of datagrams for the same UDP connection are
+//               written together, with a single system call where
+//               sendmmsg() is available; a threaded ConnectionWriter
+//               does the same with whatever datagrams it finds
+//               waiting on its queue.
+//
+//               Returns the number of datagrams that were
+//               successfully sent or queued.  If block is true, this
+//               waits for room on the queue as necessary.
+////////////////////////////////////////////////////////////////////
+int ConnectionWriter::
+send(const pvector<NetDatagram> &datagrams, bool block) {
+  nassertr(!_shutdown, 0);
+
+#ifndef NDEBUG
+  pvector<NetDatagram>::const_iterator di;
+  for (di = datagrams.begin(); di != datagrams.end(); ++di) {
+    nassertr((*di).get_connection() != (Connection *)NULL, 0);
+    if ((int)(*di).get_length() > maximum_udp_datagram &&
+        (*di).get_connection()->get_socket()->is_exact_type(Socket_UDP::get_class_type())) {
+      net_cat.warning()
+        << "Attempt to send UDP datagram of " << (*di).get_length()
+        << " bytes, more than the\n"
+        << "currently defined maximum of " << maximum_udp_datagram
+        << " bytes.\n";
+    }
+  }
+#endif  // NDEBUG
+
+  if (datagrams.empty()) {
+    return 0;
+  }
+
+  if (_immediate) {
+    return send_datagrams(&datagrams[0], datagrams.size());
+  } else {
+    return _queue.insert(datagrams, block);
+  }
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: ConnectionWriter::is_valid_for_udp
 //       Access: Public
@@ -383,13 +430,38 @@ void ConnectionWriter::
 thread_run(int thread_index) {
   nassertv(!_immediate);
 
-  NetDatagram datagram;
-  while (_queue.extract(datagram)) {
-    if (_raw_mode) {
-      datagram.get_connection()->send_raw_datagram(datagram);
-    } else {
-      datagram.get_connection()->send_datagram(datagram, _tcp_header_size);
-    }
+  // We take as many datagrams from the queue at once as we might be
+  // able to send together.
+  int batch_size = max((int)net_udp_batch_size, 1);
+
+  pvector<NetDatagram> datagrams;
+  while (_queue.extract(datagrams, batch_size) > 0) {
+    send_datagrams(&datagrams[0], datagrams.size());
     Thread::consider_yield();
   }
 }
+
+////////////////////////////////////////////////////////////////////
+//     Function: ConnectionWriter::send_datagrams
+//       Access: Private
+//  Description: Sends the indicated datagrams immediately, handing
+//               each run of consecutive datagrams for the same
+//               connection to that connection at once.  Returns the
+//               number sent successfully.
+////////////////////////////////////////////////////////////////////
+int ConnectionWriter::
+send_datagrams(const NetDatagram *datagrams, int num_datagrams) {
+  int num_sent = 0;
+  int i = 0;
+  while (i < num_datagrams) {
+    Connection *connection = datagrams[i].get_connection();
+    int j = i + 1;
+    while (j < num_datagrams && datagrams[j].get_connection() == connection) {
+      ++j;
+    }
+    num_sent += connection->send_datagrams(datagrams + i, j - i,
+                                           _tcp_header_size, _raw_mode);
+    i = j;
+  }
+  return num_sent;
+}
@@ -56,6 +56,11 @@ PUBLISHED:
 
   bool is_valid_for_udp(const Datagram &datagram) const;
 
+public:
+  int send(const pvector<NetDatagram> &datagrams, bool block = false);
+
+PUBLISHED:
+
   ConnectionManager *get_manager() const;
   bool is_immediate() const;
   int get_num_threads() const;
@@ -74,6 +79,7 @@ protected:
 private:
   void thread_run(int thread_index);
   bool send_datagram(const NetDatagram &datagram);
+  int send_datagrams(const NetDatagram *datagrams, int num_datagrams);
 
 protected:
   ConnectionManager *_manager;
@@ -97,6 +97,50 @@ insert(const NetDatagram &data, bool block) {
 }
 
 
+////////////////////////////////////////////////////////////////////
+//     Function: DatagramQueue::insert
+//       Access: Public
+//  Description: Inserts all of the indicated datagrams onto the end
+//               of the queue at once, waking up any threads that are
+//               waiting on the queue.  If block is true, this waits
+//               for room for each of them as necessary; otherwise, it
+//               stops when the queue is full.
+//
+//               Returns the number of datagrams inserted.
+////////////////////////////////////////////////////////////////////
+int DatagramQueue::
+insert(const pvector<NetDatagram> &data, bool block) {
+  MutexHolder holder(_cvlock);
+
+  int num_inserted = 0;
+  pvector<NetDatagram>::const_iterator di;
+  for (di = data.begin(); di != data.end(); ++di) {
+    bool enqueue_ok = ((int)_queue.size() < _max_queue_size);
+    if (block) {
+      while (!enqueue_ok && !_shutdown) {
+        // Let the extracting threads get going on what we've got so
+        // far.
+        _cv.notify_all();
+        _cv.wait();
+        enqueue_ok = ((int)_queue.size() < _max_queue_size);
+      }
+    }
+    if (!enqueue_ok) {
+      break;
+    }
+    _queue.push_back(*di);
+    ++num_inserted;
+  }
+
+  if (num_inserted > 1) {
+    _cv.notify_all();
+  } else {
+    _cv.notify();
+  }
+
+  return num_inserted;
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: DatagramQueue::extract
 //       Access: Public
@@ -141,6 +185,46 @@ extract(NetDatagram &result) {
   return true;
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: DatagramQueue::extract
+//       Access: Public
+//  Description: Extracts up to max_datagrams datagrams from the head
+//               of the queue at once, replacing the contents of
+//               result with them.  Like the single-datagram version
+//               of extract(), this blocks until at least one datagram
+//               is available.
+//
+//               The return value is the number of datagrams
+//               extracted, or 0 if the queue was destroyed while
+//               waiting.
+////////////////////////////////////////////////////////////////////
+int DatagramQueue::
+extract(pvector<NetDatagram> &result, int max_datagrams) {
+  // As above, clear the result first, since it may hold connection
+  // pointers.
+  result.clear();
+
+  MutexHolder holder(_cvlock);
+
+  while (_queue.empty() && !_shutdown) {
+    _cv.wait();
+  }
+
+  if (_shutdown) {
+    return 0;
+  }
+
+  int num_datagrams = min(max_datagrams, (int)_queue.size());
+  nassertr(num_datagrams > 0, 0);
+  result.insert(result.end(), _queue.begin(), _queue.begin() + num_datagrams);
+  _queue.erase(_queue.begin(), _queue.begin() + num_datagrams);
+
+  // Wake up any threads waiting to stuff things into the queue.
+  _cv.notify_all();
+
+  return num_datagrams;
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: DatagramQueue::set_max_queue_size
 //       Access: Public
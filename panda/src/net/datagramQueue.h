@@ -21,6 +21,7 @@
 #include "pmutex.h"
 #include "conditionVarFull.h"
 #include "pdeque.h"
+#include "pvector.h"
 
 ////////////////////////////////////////////////////////////////////
 //       Class : DatagramQueue
@@ -35,7 +36,9 @@ public:
   void shutdown();
 
   bool insert(const NetDatagram &data, bool block = false);
+  int insert(const pvector<NetDatagram> &data, bool block = false);
   bool extract(NetDatagram &result);
+  int extract(pvector<NetDatagram> &result, int max_datagrams);
 
   void set_max_queue_size(int max_size);
   int get_max_queue_size() const;
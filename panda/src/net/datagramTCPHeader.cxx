@@ -27,23 +27,23 @@
 ////////////////////////////////////////////////////////////////////
 DatagramTCPHeader::
 DatagramTCPHeader(const NetDatagram &datagram, int header_size) {
-  const string &str = datagram.get_message();
+  size_t length = datagram.get_length();
   switch (header_size) {
   case 0:
     break;
 
   case datagram_tcp16_header_size:
     {
-      PN_uint16 size = str.length();
-      nassertv(size == str.length());
+      PN_uint16 size = length;
+      nassertv(size == length);
       _header.add_uint16(size);
     }
     break;
 
   case datagram_tcp32_header_size:
     {
-      PN_uint32 size = str.length();
-      nassertv(size == str.length());
+      PN_uint32 size = length;
+      nassertv(size == length);
       _header.add_uint32(size);
     }
     break;
@@ -105,8 +105,7 @@ verify_datagram(const NetDatagram &datagram, int header_size) const {
     return true;
   }
 
-  const string &str = datagram.get_message();
-  int actual_size = str.length();
+  int actual_size = datagram.get_length();
   int expected_size = get_datagram_size(header_size);
   if (actual_size == expected_size) {
     return true;
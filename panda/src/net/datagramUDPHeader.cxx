@@ -27,10 +27,11 @@
 ////////////////////////////////////////////////////////////////////
 DatagramUDPHeader::
 DatagramUDPHeader(const NetDatagram &datagram) {
-  const string &str = datagram.get_message();
+  const PN_uint8 *data = (const PN_uint8 *)datagram.get_data();
+  size_t length = datagram.get_length();
   PN_uint16 checksum = 0;
-  for (size_t p = 0; p < str.size(); p++) {
-    checksum += (PN_uint16)(PN_uint8)str[p];
+  for (size_t p = 0; p < length; p++) {
+    checksum += (PN_uint16)data[p];
   }
 
   // Now pack the header.
@@ -58,11 +59,12 @@ DatagramUDPHeader(const void *data) : _header(data, datagram_udp_header_size) {
 ////////////////////////////////////////////////////////////////////
 bool DatagramUDPHeader::
 verify_datagram(const NetDatagram &datagram) const {
-  const string &str = datagram.get_message();
+  const PN_uint8 *data = (const PN_uint8 *)datagram.get_data();
+  size_t length = datagram.get_length();
 
   PN_uint16 checksum = 0;
-  for (size_t p = 0; p < str.size(); p++) {
-    checksum += (PN_uint16)(PN_uint8)str[p];
+  for (size_t p = 0; p < length; p++) {
+    checksum += (PN_uint16)data[p];
   }
 
   if (checksum == get_datagram_checksum()) {
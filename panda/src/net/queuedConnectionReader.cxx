@@ -98,6 +98,23 @@ get_data(Datagram &result) {
   return true;
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: QueuedConnectionReader::get_data
+//       Access: Public
+//  Description: This flavor of QueuedConnectionReader::get_data()
+//               extracts up to max_datagrams datagrams at once,
+//               appending them to the result, and returns the number
+//               extracted.  It is cheaper than extracting the same
+//               datagrams one at a time.
+//
+//               Unlike the other flavors, this does not poll the
+//               sockets first; call data_available() for that.
+////////////////////////////////////////////////////////////////////
+int QueuedConnectionReader::
+get_data(pvector<NetDatagram> &result, int max_datagrams) {
+  return get_things(result, max_datagrams);
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: QueuedConnectionReader::receive_datagram
 //       Access: Protected, Virtual
@@ -127,6 +144,29 @@ receive_datagram(const NetDatagram &datagram) {
 #endif  // SIMULATE_NETWORK_DELAY
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: QueuedConnectionReader::receive_datagrams
+//       Access: Protected, Virtual
+//  Description: An internal function called by ConnectionReader()
+//               when several datagrams have become available at once,
+//               from a batched read.  They are queued up together.
+////////////////////////////////////////////////////////////////////
+void QueuedConnectionReader::
+receive_datagrams(const pvector<NetDatagram> &datagrams) {
+#ifdef SIMULATE_NETWORK_DELAY
+  pvector<NetDatagram>::const_iterator di;
+  for (di = datagrams.begin(); di != datagrams.end(); ++di) {
+    delay_datagram(*di);
+  }
+
+#else  // SIMULATE_NETWORK_DELAY
+  if (enqueue_things(datagrams) != (int)datagrams.size()) {
+    net_cat.error()
+      << "QueuedConnectionReader queue full!\n";
+  }
+#endif  // SIMULATE_NETWORK_DELAY
+}
+
 
 #ifdef SIMULATE_NETWORK_DELAY
 ////////////////////////////////////////////////////////////////////
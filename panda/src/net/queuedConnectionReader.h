@@ -44,8 +44,12 @@ PUBLISHED:
   bool get_data(NetDatagram &result);
   bool get_data(Datagram &result);
 
+public:
+  int get_data(pvector<NetDatagram> &result, int max_datagrams);
+
 protected:
   virtual void receive_datagram(const NetDatagram &datagram);
+  virtual void receive_datagrams(const pvector<NetDatagram> &datagrams);
 
 #ifdef SIMULATE_NETWORK_DELAY
 PUBLISHED:
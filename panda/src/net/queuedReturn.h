@@ -22,6 +22,7 @@
 #include "netAddress.h"
 #include "lightMutex.h"
 #include "pdeque.h"
+#include "pvector.h"
 #include "config_net.h"
 #include "lightMutexHolder.h"
 
@@ -50,9 +51,11 @@ protected:
 
   INLINE bool thing_available() const;
   bool get_thing(Thing &thing);
+  int get_things(pvector<Thing> &result, int max_things);
 
   bool enqueue_thing(const Thing &thing);
   bool enqueue_unique_thing(const Thing &thing);
+  int enqueue_things(const pvector<Thing> &things);
 
 private:
   LightMutex _mutex;
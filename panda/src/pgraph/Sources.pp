@@ -31,6 +31,7 @@
     colorWriteAttrib.I colorWriteAttrib.h \
     compassEffect.I compassEffect.h \
     config_pgraph.h \
+    cullArena.I cullArena.h \
     cullBin.I cullBin.h \
     cullBinEnums.h \
     cullBinAttrib.I cullBinAttrib.h \
@@ -141,6 +142,7 @@
     colorWriteAttrib.cxx \
     compassEffect.cxx \
     config_pgraph.cxx \
+    cullArena.cxx \
     cullBin.cxx \
     cullBinAttrib.cxx \
     cullBinManager.cxx \
@@ -243,6 +245,7 @@
     colorWriteAttrib.I colorWriteAttrib.h \
     compassEffect.I compassEffect.h \
     config_pgraph.h \
+    cullArena.I cullArena.h \
     cullBin.I cullBin.h \
     cullBinEnums.h \
     cullBinAttrib.I cullBinAttrib.h \
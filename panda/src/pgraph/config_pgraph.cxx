@@ -28,6 +28,7 @@
 #include "colorWriteAttrib.h"
 #include "compassEffect.h"
 #include "cullFaceAttrib.h"
+#include "cullArena.h"
 #include "cullBin.h"
 #include "cullBinAttrib.h"
 #include "cullResult.h"
@@ -309,6 +310,14 @@ ConfigVariableBool flatten_geoms
           "only the NodePath interfaces; you may still make the lower-level "
           "SceneGraphReducer calls directly."));
 
+ConfigVariableInt flatten_threads
+("flatten-threads", 0,
+ PRC_DESC("Specifies the default number of threads that a SceneGraphReducer "
+          "may use to flatten independent subgraphs of the scene graph "
+          "at the same time.  If this is 0 or 1, flattening is done "
+          "entirely in the calling thread.  See "
+          "SceneGraphReducer::set_num_threads()."));
+
 ConfigVariableInt max_lenses
 ("max-lenses", 100,
  PRC_DESC("Specifies an upper limit on the maximum number of lenses "
@@ -413,6 +422,7 @@ init_libpgraph() {
   ColorWriteAttrib::init_type();
   CompassEffect::init_type();
   CullFaceAttrib::init_type();
+  CullArena::init_type();
   CullBin::init_type();
   CullBinAttrib::init_type();
   CullResult::init_type();
@@ -58,6 +58,7 @@ extern ConfigVariableInt max_collect_indices;
 extern EXPCL_PANDA_PGRAPH ConfigVariableBool premunge_data;
 extern ConfigVariableBool preserve_geom_nodes;
 extern ConfigVariableBool flatten_geoms;
+extern EXPCL_PANDA_PGRAPH ConfigVariableInt flatten_threads;
 extern EXPCL_PANDA_PGRAPH ConfigVariableInt max_lenses;
 extern ConfigVariableBool default_antialias_enable;
 
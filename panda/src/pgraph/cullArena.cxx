@@ -0,0 +1,207 @@
+// Filename: cullArena.cxx
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "cullArena.h"
+#include "memoryUsage.h"
+#include "pnotify.h"
+
+TypeHandle CullArena::_type_handle;
+
+////////////////////////////////////////////////////////////////////
+//     Function: CullArena::Constructor
+//       Access: Public
+//  Description: The arena obtains memory from the heap block_size
+//               bytes at a time.  No single allocation may be larger
+//               than a block.
+////////////////////////////////////////////////////////////////////
+CullArena::
+CullArena(size_t block_size) :
+  _block_size(block_size),
+  _current(NULL),
+  _next_alloc(NULL),
+  _end(NULL),
+  _retired(NULL),
+  _free(NULL)
+{
+#ifdef DO_MEMORY_USAGE
+  MemoryUsage::update_type(this, get_class_type());
+#endif
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CullArena::Destructor
+//       Access: Public
+//  Description: Frees all of the blocks that no longer hold any live
+//               objects.  Any blocks that do are left to be freed by
+//               the release() of their last object.
+////////////////////////////////////////////////////////////////////
+CullArena::
+~CullArena() {
+  retire_current();
+
+  while (_free != (Block *)NULL) {
+    Block *block = _free;
+    _free = block->_next;
+    free_block(block);
+  }
+
+  while (_retired != (Block *)NULL) {
+    Block *block = _retired;
+    _retired = block->_next;
+    if (!AtomicAdjust::dec(block->_num_live)) {
+      free_block(block);
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CullArena::recycle
+//       Access: Public
+//  Description: Makes the memory of any blocks whose objects have all
+//               been released available again for allocation.  This
+//               is normally called once per frame, by
+//               CullResult::make_next().
+////////////////////////////////////////////////////////////////////
+void CullArena::
+recycle() {
+  // A retired block whose count is down to just the arena's own hold
+  // on it is empty, and nothing can be released into it any more.
+  Block **prev = &_retired;
+  while (*prev != (Block *)NULL) {
+    Block *block = (*prev);
+    if (AtomicAdjust::get(block->_num_live) == 1) {
+      (*prev) = block->_next;
+      block->_next = _free;
+      _free = block;
+    } else {
+      prev = &block->_next;
+    }
+  }
+
+  // The current block can be rewound to the beginning if everything
+  // allocated from it has been released.
+  if (_current != (Block *)NULL) {
+    AtomicAdjust::Integer empty_count = 1 + (AtomicAdjust::Integer)_block_size
+      - (AtomicAdjust::Integer)_current->_num_allocated;
+    if (AtomicAdjust::get(_current->_num_live) == empty_count) {
+      AtomicAdjust::add(_current->_num_live, (AtomicAdjust::Integer)_current->_num_allocated);
+      _current->_num_allocated = 0;
+      _next_alloc = (char *)_current + get_block_header_size();
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CullArena::get_num_blocks
+//       Access: Public
+//  Description: Returns the number of blocks currently held by the
+//               arena, whether in use or not.  This is mainly useful
+//               for reporting.
+////////////////////////////////////////////////////////////////////
+size_t CullArena::
+get_num_blocks() const {
+  size_t count = (_current != (Block *)NULL) ? 1 : 0;
+  for (Block *block = _retired; block != (Block *)NULL; block = block->_next) {
+    ++count;
+  }
+  for (Block *block = _free; block != (Block *)NULL; block = block->_next) {
+    ++count;
+  }
+  return count;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CullArena::alloc_slow
+//       Access: Private
+//  Description: Called by allocate() when the current block is full.
+//               Retires it and starts a new one.
+////////////////////////////////////////////////////////////////////
+void *CullArena::
+alloc_slow(size_t size) {
+  size_t prefix_size = get_prefix_size();
+  size_t alloc_size = (prefix_size + size + prefix_size - 1) & ~(prefix_size - 1);
+  nassertr(get_block_header_size() + alloc_size <= _block_size, NULL);
+
+  retire_current();
+
+  Block *block = _free;
+  if (block != (Block *)NULL) {
+    _free = block->_next;
+  } else {
+    block = (Block *)PANDA_MALLOC_ARRAY(_block_size);
+    block->_num_live = 1;
+  }
+  make_current(block);
+
+  return allocate(size);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CullArena::retire_current
+//       Access: Private
+//  Description: Moves the current block, if any, onto the retired
+//               list.  Its count is adjusted from the inflated value
+//               it had while current to the actual number of live
+//               objects still in it (plus one for the arena).
+////////////////////////////////////////////////////////////////////
+void CullArena::
+retire_current() {
+  if (_current == (Block *)NULL) {
+    return;
+  }
+
+  Block *block = _current;
+  AtomicAdjust::add(block->_num_live,
+                    (AtomicAdjust::Integer)block->_num_allocated - (AtomicAdjust::Integer)_block_size);
+  block->_next = _retired;
+  _retired = block;
+
+  _current = NULL;
+  _next_alloc = NULL;
+  _end = NULL;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CullArena::make_current
+//       Access: Private
+//  Description: Starts allocating from the indicated empty block.
+//
+//               While a block is current, its count is inflated by
+//               _block_size, which exceeds the number of objects it
+//               could possibly hold.  This way the allocating thread
+//               need not touch the count at all as it hands out
+//               objects, and releases from other threads can never
+//               bring it to zero.  retire_current() settles the
+//               difference.
+////////////////////////////////////////////////////////////////////
+void CullArena::
+make_current(Block *block) {
+  AtomicAdjust::add(block->_num_live, (AtomicAdjust::Integer)_block_size);
+  block->_num_allocated = 0;
+  block->_next = NULL;
+
+  _current = block;
+  _next_alloc = (char *)block + get_block_header_size();
+  _end = (char *)block + _block_size;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CullArena::free_block
+//       Access: Private, Static
+//  Description: Returns a block's memory to the heap.
+////////////////////////////////////////////////////////////////////
+void CullArena::
+free_block(Block *block) {
+  PANDA_FREE_ARRAY(block);
+}
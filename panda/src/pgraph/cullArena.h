@@ -0,0 +1,118 @@
+// Filename: cullArena.h
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#ifndef CULLARENA_H
+#define CULLARENA_H
+
+#include "pandabase.h"
+#include "referenceCount.h"
+#include "atomicAdjust.h"
+#include "memoryHook.h"
+
+////////////////////////////////////////////////////////////////////
+//       Class : CullArena
+// Description : A bump allocator for objects that live only as long
+//               as one frame's cull result, such as CullableObjects.
+//               Each CullResult shares its arena with the CullResult
+//               created from it by make_next(), and make_next()
+//               recycles the arena's blocks that are no longer in
+//               use.
+//
+//               Allocation takes no lock and no atomic operation:
+//               the culling thread simply bumps a pointer within the
+//               current block.  Objects may be freed from any thread
+//               (normally the draw thread); this just decrements the
+//               live count of the block the object came from.  A
+//               block is reused once its count drops to zero, so
+//               memory is recycled whole blocks at a time, and never
+//               returned to the system until the arena is destroyed.
+//
+//               Each allocation is preceded by a small prefix that
+//               records the block it came from.  Classes that may be
+//               allocated either from an arena or from the regular
+//               heap use mark_unowned() and release() to share the
+//               same operator delete; see CullableObject.
+//
+//               Only one thread may allocate from a given arena at a
+//               time.
+////////////////////////////////////////////////////////////////////
+class EXPCL_PANDA_PGRAPH CullArena : public ReferenceCount {
+public:
+  CullArena(size_t block_size = 65536);
+  ~CullArena();
+
+  INLINE void *allocate(size_t size);
+  void recycle();
+
+  INLINE static size_t get_prefix_size();
+  INLINE static void *mark_unowned(void *buffer);
+  INLINE static void *get_unowned_buffer(void *ptr);
+  INLINE static bool release(void *ptr);
+
+  size_t get_num_blocks() const;
+
+private:
+  class Block {
+  public:
+    // The number of objects still alive in this block, plus one for
+    // the arena's own hold on the block.  While the block is the
+    // arena's current block, this is also inflated by _block_size,
+    // so that it can never reach zero while we are still handing out
+    // objects from it; see make_current().
+    TVOLATILE AtomicAdjust::Integer _num_live;
+
+    // The number of objects handed out from this block since it last
+    // became current.  Only the allocating thread touches this.
+    size_t _num_allocated;
+
+    Block *_next;
+  };
+
+  INLINE static size_t get_block_header_size();
+  INLINE static Block *&get_prefix_block(void *ptr);
+
+  void *alloc_slow(size_t size);
+  void retire_current();
+  void make_current(Block *block);
+  static void free_block(Block *block);
+
+  size_t _block_size;
+
+  Block *_current;
+  char *_next_alloc;
+  char *_end;
+
+  // Blocks that have filled up but may still have live objects.
+  Block *_retired;
+
+  // Blocks that are completely empty and ready to be reused.
+  Block *_free;
+
+public:
+  static TypeHandle get_class_type() {
+    return _type_handle;
+  }
+  static void init_type() {
+    ReferenceCount::init_type();
+    register_type(_type_handle, "CullArena",
+                  ReferenceCount::get_class_type());
+  }
+
+private:
+  static TypeHandle _type_handle;
+};
+
+#include "cullArena.I"
+
+#endif
@@ -25,7 +25,9 @@
 //  Description: 
 ////////////////////////////////////////////////////////////////////
 CullHandler::
-CullHandler() {
+CullHandler() :
+  _cull_arena(NULL)
+{
 }
 
 ////////////////////////////////////////////////////////////////////
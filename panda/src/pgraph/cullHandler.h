@@ -18,6 +18,7 @@
 #include "pandabase.h"
 #include "cullableObject.h"
 #include "graphicsStateGuardianBase.h"
+#include "cullArena.h"
 
 class CullTraverser;
 
@@ -37,9 +38,16 @@ public:
                              const CullTraverser *traverser);
   virtual void end_traverse();
 
+  INLINE CullArena *get_cull_arena() const;
+
   INLINE static void draw(CullableObject *object,
                           GraphicsStateGuardianBase *gsg,
                           bool force, Thread *current_thread);
+
+protected:
+  // If this is non-NULL, the objects passed to record_object() should
+  // be allocated from it.
+  CullArena *_cull_arena;
 };
 
 #include "cullHandler.I"
@@ -57,14 +57,21 @@ static const double bin_color_flash_rate = 1.0;  // 1 state change per second
 ////////////////////////////////////////////////////////////////////
 //     Function: CullResult::Constructor
 //       Access: Public
-//  Description: 
+//  Description: If cull_arena is NULL, a new CullArena is created
+//               for this CullResult.
 ////////////////////////////////////////////////////////////////////
 CullResult::
 CullResult(GraphicsStateGuardianBase *gsg,
-           const PStatCollector &draw_region_pcollector) :
+           const PStatCollector &draw_region_pcollector,
+           CullArena *cull_arena) :
   _gsg(gsg),
-  _draw_region_pcollector(draw_region_pcollector)
+  _draw_region_pcollector(draw_region_pcollector),
+  _cull_arena(cull_arena)
 {
+  if (_cull_arena == (CullArena *)NULL) {
+    _cull_arena = new CullArena;
+  }
+
 #ifdef DO_MEMORY_USAGE
   MemoryUsage::update_type(this, get_class_type());
 #endif
@@ -77,10 +84,15 @@ CullResult(GraphicsStateGuardianBase *gsg,
 //               contains a copy of just the subset of the data from
 //               this CullResult object that is worth keeping around
 //               for next frame.
+//
+//               The new CullResult shares this one's CullArena, and
+//               any arena memory whose objects have all been freed
+//               by now is recycled for the new frame.
 ////////////////////////////////////////////////////////////////////
 PT(CullResult) CullResult::
 make_next() const {
-  PT(CullResult) new_result = new CullResult(_gsg, _draw_region_pcollector);
+  PT(CullResult) new_result = new CullResult(_gsg, _draw_region_pcollector, _cull_arena);
+  _cull_arena->recycle();
   new_result->_bins.reserve(_bins.size());
 
   CullBinManager *bin_manager = CullBinManager::get_global_ptr();
@@ -177,7 +189,7 @@ add_object(CullableObject *object, const CullTraverser *traverser) {
           if (m_dual_transparent) 
 #endif
             {
-              CullableObject *transparent_part = new CullableObject(*object);
+              CullableObject *transparent_part = new (_cull_arena) CullableObject(*object);
               CPT(RenderState) transparent_state = object->has_decals() ? 
                 get_dual_transparent_state_decals() : 
                 get_dual_transparent_state();
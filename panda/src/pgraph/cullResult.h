@@ -20,6 +20,7 @@
 #include "renderState.h"
 #include "cullableObject.h"
 #include "geomMunger.h"
+#include "cullArena.h"
 #include "referenceCount.h"
 #include "pointerTo.h"
 #include "pvector.h"
@@ -47,7 +48,8 @@ class SceneSetup;
 class EXPCL_PANDA_PGRAPH CullResult : public ReferenceCount {
 public:
   CullResult(GraphicsStateGuardianBase *gsg,
-             const PStatCollector &draw_region_pcollector);
+             const PStatCollector &draw_region_pcollector,
+             CullArena *cull_arena = NULL);
   INLINE ~CullResult();
 
 PUBLISHED:
@@ -62,6 +64,8 @@ PUBLISHED:
   PT(PandaNode) make_result_graph();
 
 public:
+  INLINE CullArena *get_cull_arena() const;
+
   static void bin_removed(int bin_index);
 
 private:
@@ -77,6 +81,10 @@ private:
 
   GraphicsStateGuardianBase *_gsg;
   PStatCollector _draw_region_pcollector;
+
+  // This is shared with the CullResult we were made from, if any.  It
+  // is declared before _bins so that it outlives the objects in them.
+  PT(CullArena) _cull_arena;
   
   typedef pvector< PT(CullBin) > Bins;
   Bins _bins;
@@ -695,7 +695,8 @@ start_decal(const CullTraverserData &data) {
 
   // Now create a new, empty CullableObject to separate the decals
   // from the non-decals.
-  CullableObject *separator = new CullableObject;
+  CullArena *arena = _cull_handler->get_cull_arena();
+  CullableObject *separator = new (arena) CullableObject;
   separator->set_next(decals);
 
   // And now get the base Geoms, again in reverse order.
@@ -754,8 +755,8 @@ start_decal(const CullTraverserData &data) {
 
     CullableObject *next = object;
     object =
-      new CullableObject(geom, state, net_transform, 
-                         modelview_transform, internal_transform);
+      new (arena) CullableObject(geom, state, net_transform, 
+                                 modelview_transform, internal_transform);
     object->set_next(next);
   }
 
@@ -867,8 +868,9 @@ r_get_decals(CullTraverserData &data, CullableObject *decals) {
 
         CullableObject *next = decals;
         decals =
-          new CullableObject(geom, state, net_transform, 
-                             modelview_transform, internal_transform);
+          new (_cull_handler->get_cull_arena())
+          CullableObject(geom, state, net_transform, 
+                         modelview_transform, internal_transform);
         decals->set_next(next);
       }
     }
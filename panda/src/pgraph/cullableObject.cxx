@@ -34,6 +34,7 @@
 
 CullableObject::FormatMap CullableObject::_format_map;
 LightMutex CullableObject::_format_lock;
+DeletedBufferChain *CullableObject::_deleted_chain = NULL;
 
 PStatCollector CullableObject::_munge_geom_pcollector("*:Munge:Geom");
 PStatCollector CullableObject::_munge_sprites_pcollector("*:Munge:Sprites");
@@ -164,6 +165,34 @@ munge_geom(GraphicsStateGuardianBase *gsg,
       }
     }
 
+    if (munger->keeps_quantized_vertex()) {
+      // The GSG will read a quantized vertex column as normalized
+      // integers, from 0 to 1, so the column's scale and offset have
+      // to be applied by the transform instead.
+      GeomVertexDataPipelineReader data_reader(_munged_data, current_thread);
+      const GeomVertexColumn *column = data_reader.get_format()->get_vertex_column();
+      if (column != (GeomVertexColumn *)NULL && column->is_quantized()) {
+        PN_stdfloat max_value;
+        switch (column->get_numeric_type()) {
+        case Geom::NT_uint8:
+          max_value = 255.0f;
+          break;
+        case Geom::NT_uint16:
+          max_value = 65535.0f;
+          break;
+        default:
+          max_value = 4294967295.0f;
+          break;
+        }
+        const LVecBase4 &scale = column->get_scale();
+        const LVecBase4 &offset = column->get_offset();
+        CPT(TransformState) dequantize = TransformState::make_pos_hpr_scale
+          (LVecBase3(offset[0], offset[1], offset[2]), LVecBase3(0.0f, 0.0f, 0.0f),
+           LVecBase3(scale[0], scale[1], scale[2]) * max_value);
+        _internal_transform = _internal_transform->compose(dequantize);
+      }
+    }
+
 #ifndef NDEBUG
     if (show_vertex_animation) {
       GeomVertexDataPipelineReader data_reader(_munged_data, current_thread);
@@ -330,8 +359,8 @@ munge_points_to_quads(const CullTraverser *traverser, bool force) {
       if (has_normal) {
         const GeomVertexColumn *c = normal.get_column();
         new_array_format->add_column
-          (InternalName::get_normal(), c->get_num_components(),
-           c->get_numeric_type(), c->get_contents());
+          (InternalName::get_normal(), c->get_unquantized_num_components(),
+           c->get_unquantized_numeric_type(), c->get_contents());
       }
       if (has_color) {
         const GeomVertexColumn *c = color.get_column();
@@ -348,8 +377,8 @@ munge_points_to_quads(const CullTraverser *traverser, bool force) {
       } else if (has_texcoord) {
         const GeomVertexColumn *c = texcoord.get_column();
         new_array_format->add_column
-          (InternalName::get_texcoord(), c->get_num_components(),
-           c->get_numeric_type(), c->get_contents());
+          (InternalName::get_texcoord(), c->get_unquantized_num_components(),
+           c->get_unquantized_numeric_type(), c->get_contents());
       }
 
       new_format = GeomVertexFormat::register_format(new_array_format);
@@ -32,6 +32,7 @@
 #include "sceneSetup.h"
 #include "lightMutex.h"
 #include "callbackObject.h"
+#include "cullArena.h"
 
 class CullTraverser;
 
@@ -79,7 +80,14 @@ public:
 
 public:
   ~CullableObject();
-  ALLOC_DELETED_CHAIN(CullableObject);
+
+  // CullableObjects may be allocated either from the heap (via a
+  // DeletedChain), or from a CullArena with new (arena)
+  // CullableObject(...).  Either kind is freed with plain delete.
+  INLINE void *operator new(size_t size);
+  INLINE void *operator new(size_t size, CullArena *arena);
+  INLINE void operator delete(void *ptr);
+  INLINE void operator delete(void *ptr, CullArena *arena);
 
   void output(ostream &out) const;
 
@@ -144,6 +152,9 @@ private:
   static FormatMap _format_map;
   static LightMutex _format_lock;
 
+  INLINE static DeletedBufferChain *get_deleted_chain();
+  static DeletedBufferChain *_deleted_chain;
+
   static PStatCollector _munge_geom_pcollector;
   static PStatCollector _munge_sprites_pcollector;
   static PStatCollector _munge_sprites_verts_pcollector;
@@ -610,10 +610,12 @@ add_for_draw(CullTraverser *trav, CullTraverserData &data) {
       }
     }
 
+    CullHandler *handler = trav->get_cull_handler();
     CullableObject *object =
-      new CullableObject(geom, state, net_transform,
-                         modelview_transform, internal_transform);
-    trav->get_cull_handler()->record_object(object, trav);
+      new (handler->get_cull_arena())
+      CullableObject(geom, state, net_transform,
+                     modelview_transform, internal_transform);
+    handler->record_object(object, trav);
   }
 }
 
@@ -764,6 +766,36 @@ decompose() {
   CLOSE_ITERATE_CURRENT_AND_UPSTREAM(_cycler);
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: GeomNode::optimize_vertex_cache
+//       Access: Published
+//  Description: Calls optimize_vertex_cache() on each Geom in the
+//               GeomNode, reordering the triangles for the
+//               post-transform vertex cache.  Triangle strips and
+//               fans are decomposed into triangles in the process.
+//
+//               See also SceneGraphReducer::optimize_vertex_cache(),
+//               which is the normal way this is called, and which
+//               also reorders the vertices to match.
+////////////////////////////////////////////////////////////////////
+void GeomNode::
+optimize_vertex_cache() {
+  Thread *current_thread = Thread::get_current_thread();
+  OPEN_ITERATE_CURRENT_AND_UPSTREAM(_cycler, current_thread) {
+    CDStageWriter cdata(_cycler, pipeline_stage, current_thread);
+
+    GeomList::iterator gi;
+    PT(GeomList) geoms = cdata->modify_geoms();
+    for (gi = geoms->begin(); gi != geoms->end(); ++gi) {
+      GeomEntry &entry = (*gi);
+      nassertv(entry._geom.test_ref_count_integrity());
+      PT(Geom) geom = entry._geom.get_write_pointer();
+      geom->optimize_vertex_cache_in_place();
+    }
+  }
+  CLOSE_ITERATE_CURRENT_AND_UPSTREAM(_cycler);
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: GeomNode::unify
 //       Access: Published
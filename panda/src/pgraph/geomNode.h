@@ -86,6 +86,7 @@ PUBLISHED:
 
   void decompose();
   void unify(int max_indices, bool preserve_order);
+  void optimize_vertex_cache();
 
   void write_geoms(ostream &out, int indent_level) const;
   void write_verbose(ostream &out, int indent_level) const;
@@ -38,6 +38,7 @@ PStatCollector GeomTransformer::_apply_set_color_collector("*:Flatten:apply:set
 PStatCollector GeomTransformer::_apply_scale_color_collector("*:Flatten:apply:scale color");
 PStatCollector GeomTransformer::_apply_texture_color_collector("*:Flatten:apply:texture color");
 PStatCollector GeomTransformer::_apply_set_format_collector("*:Flatten:apply:set format");
+PStatCollector GeomTransformer::_apply_quantize_collector("*:Flatten:apply:quantize");
 
 TypeHandle GeomTransformer::NewCollectedData::_type_handle;
 
@@ -113,6 +114,35 @@ register_vertices(GeomNode *node, bool might_have_unused) {
   CLOSE_ITERATE_CURRENT_AND_UPSTREAM(node->_cycler);
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: GeomTransformer::reorder_vertices
+//       Access: Public
+//  Description: Records the association of the Geoms in the node
+//               with their GeomVertexDatas, for the purpose of later
+//               rearranging the vertices into the order in which the
+//               primitives first use them, so that the vertices are
+//               fetched from memory in sequence.  Unused vertices are
+//               removed at the same time.  The rearranging is done in
+//               finish_apply().
+////////////////////////////////////////////////////////////////////
+void GeomTransformer::
+reorder_vertices(GeomNode *node) {
+  Thread *current_thread = Thread::get_current_thread();
+  OPEN_ITERATE_CURRENT_AND_UPSTREAM(node->_cycler, current_thread) {
+    GeomNode::CDStageWriter cdata(node->_cycler, pipeline_stage, current_thread);
+    GeomNode::GeomList::iterator gi;
+    PT(GeomNode::GeomList) geoms = cdata->modify_geoms();
+    for (gi = geoms->begin(); gi != geoms->end(); ++gi) {
+      GeomNode::GeomEntry &entry = (*gi);
+      PT(Geom) geom = entry._geom.get_write_pointer();
+      VertexDataAssoc &assoc = _vdata_assoc[geom->get_vertex_data()];
+      assoc._geoms.push_back(geom);
+      assoc._reorder = true;
+    }
+  }
+  CLOSE_ITERATE_CURRENT_AND_UPSTREAM(node->_cycler);
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: GeomTransformer::transform_vertices
 //       Access: Public
@@ -218,12 +248,19 @@ transform_texcoords(Geom *geom, const InternalName *from_name,
     // We have not yet converted these texcoords.  Do so now.
     if (st._vertex_data->has_column(to_name)) {
       new_vdata = new GeomVertexData(*st._vertex_data);
+      if (new_vdata->get_format()->get_column(to_name)->is_quantized()) {
+        // The transformed texcoords won't necessarily fit within the
+        // range of the quantized column.
+        CPT(GeomVertexFormat) unquantized =
+          new_vdata->get_format()->get_unquantized_format();
+        new_vdata->set_format(unquantized);
+      }
     } else {
       const GeomVertexColumn *old_column = 
         st._vertex_data->get_format()->get_column(from_name);
       new_vdata = st._vertex_data->replace_column
         (to_name, old_column->get_num_components(),
-         old_column->get_numeric_type(),
+         old_column->get_unquantized_numeric_type(),
          old_column->get_contents());
     }
     
@@ -907,6 +944,65 @@ reverse_normals(Geom *geom) {
   return true;
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: GeomTransformer::quantize_vertices
+//       Access: Public
+//  Description: Replaces the vertex data of the Geom with a quantized
+//               copy, using the indicated integer type; see
+//               GeomVertexData::quantize().  Returns true if the Geom
+//               was changed, false otherwise.
+////////////////////////////////////////////////////////////////////
+bool GeomTransformer::
+quantize_vertices(Geom *geom, Geom::NumericType numeric_type) {
+  PStatTimer timer(_apply_quantize_collector);
+
+  nassertr(geom != (Geom *)NULL, false);
+  CPT(GeomVertexData) orig_data = geom->get_vertex_data();
+  NewVertexData &new_data = _quantized[orig_data];
+  if (new_data._vdata.is_null()) {
+    new_data._vdata = orig_data->quantize(numeric_type);
+  }
+
+  if (new_data._vdata == orig_data) {
+    // No change.
+    return false;
+  }
+
+  geom->set_vertex_data(new_data._vdata);
+  if (orig_data->get_ref_count() > 1) {
+    _vdata_assoc[new_data._vdata]._might_have_unused = true;
+    _vdata_assoc[orig_data]._might_have_unused = true;
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: GeomTransformer::quantize_vertices
+//       Access: Public
+//  Description: Quantizes the vertex datas within the GeomNode.
+//               Returns true if the GeomNode was changed, false
+//               otherwise.
+////////////////////////////////////////////////////////////////////
+bool GeomTransformer::
+quantize_vertices(GeomNode *node, Geom::NumericType numeric_type) {
+  bool any_changed = false;
+
+  GeomNode::CDWriter cdata(node->_cycler);
+  GeomNode::GeomList::iterator gi;
+  PT(GeomNode::GeomList) geoms = cdata->modify_geoms();
+  for (gi = geoms->begin(); gi != geoms->end(); ++gi) {
+    GeomNode::GeomEntry &entry = (*gi);
+    PT(Geom) new_geom = entry._geom.get_read_pointer()->make_copy();
+    if (quantize_vertices(new_geom, numeric_type)) {
+      entry._geom = new_geom;
+      any_changed = true;
+    }
+  }
+
+  return any_changed;
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: GeomTransformer::doubleside
 //       Access: Public
@@ -1000,7 +1096,9 @@ finish_apply() {
   for (vi = _vdata_assoc.begin(); vi != _vdata_assoc.end(); ++vi) {
     const GeomVertexData *vdata = (*vi).first;
     VertexDataAssoc &assoc = (*vi).second;
-    if (assoc._might_have_unused) {
+    if (assoc._reorder) {
+      assoc.reorder_vertices(vdata);
+    } else if (assoc._might_have_unused) {
       assoc.remove_unused_vertices(vdata);
     }
   }
@@ -1011,6 +1109,7 @@ finish_apply() {
   _tcolors.clear();
   _format.clear();
   _reversed_normals.clear();
+  _quantized.clear();
 }
   
 ////////////////////////////////////////////////////////////////////
@@ -1084,7 +1183,9 @@ collect_vertex_data(Geom *geom, int collect_bits, bool format_only) {
     _new_collected_map[key] = ncd;
   }
 
-  if (ncd->_new_format != format) {
+  if (ncd->_new_format != format &&
+      ncd->_merged_formats.insert(format).second) {
+    // This is a format we haven't merged in yet.
     ncd->_new_format = format->get_union_format(ncd->_new_format);
   }
 
@@ -1336,12 +1437,22 @@ apply_collect_changes() {
     _new_btable->set_rows(_new_btable_rows);
     _new_data->set_transform_blend_table(_new_btable);
   }
+  if (_new_ttable != (TransformTable *)NULL) {
+    _new_data->set_transform_table(TransformTable::register_table(_new_ttable));
+  }
+  if (_new_sliders != (SliderTable *)NULL) {
+    _new_data->set_slider_table(SliderTable::register_table(_new_sliders));
+  }
 
   update_geoms();
 
   _new_data.clear();
   _new_btable.clear();
   _new_btable_rows.clear();
+  _new_ttable.clear();
+  _added_transforms.clear();
+  _identity_ttable.clear();
+  _new_sliders.clear();
 
   return 1;
 }
@@ -1374,62 +1485,52 @@ append_vdata(const GeomVertexData *vdata, int vertex_offset) {
   // slightly different kinds of data.
   
   if (vdata->get_transform_table() != (TransformTable *)NULL ||
-      _new_data->get_transform_table() != (TransformTable *)NULL) {
+      _new_ttable != (TransformTable *)NULL) {
     // The TransformTable.
     CPT(TransformTable) old_table;
     if (vdata->get_transform_table() != (TransformTable *)NULL) {
       old_table = vdata->get_transform_table();
     } else {
-      PT(TransformTable) temp_table = new TransformTable;
-      // There's an implicit identity transform for all nodes.
-      PT(VertexTransform) identity_transform = new UserVertexTransform("identity");
-      temp_table->add_transform(identity_transform);
-      old_table = TransformTable::register_table(temp_table);
-    }
-    
-    // First, build a mapping of the transforms we already have in the
-    // current table.  We must do this because the TransformTable
-    // doesn't automatically unquify index numbers for us (it doesn't
-    // store an index).
-    typedef pmap<const VertexTransform *, int> AddedTransforms;
-    AddedTransforms added_transforms;
-    
-    int num_old_transforms = old_table->get_num_transforms();
-    for (int i = 0; i < num_old_transforms; i++) {
-      added_transforms[old_table->get_transform(i)] = i;
+      if (_identity_ttable == (TransformTable *)NULL) {
+        PT(TransformTable) temp_table = new TransformTable;
+        // There's an implicit identity transform for all nodes.
+        PT(VertexTransform) identity_transform = new UserVertexTransform("identity");
+        temp_table->add_transform(identity_transform);
+        _identity_ttable = TransformTable::register_table(temp_table);
+      }
+      old_table = _identity_ttable;
     }
-    
-    // Now create a new table.  We have to create a new table instead
-    // of modifying the existing one, since a registered
-    // TransformTable cannot be modified.
-    PT(TransformTable) new_table;
-    if (_new_data->get_transform_table() != (TransformTable *)NULL) {
-      new_table = new TransformTable(*_new_data->get_transform_table());
-    } else {
-      new_table = new TransformTable;
+
+    // The new table is built up in _new_ttable, and registered only
+    // when all of the vdatas have been appended, since a registered
+    // TransformTable cannot be modified.  _added_transforms records
+    // the index of each transform already in it, since the
+    // TransformTable doesn't automatically uniquify index numbers for
+    // us (it doesn't store an index).
+    if (_new_ttable == (TransformTable *)NULL) {
+      _new_ttable = new TransformTable;
     }
-    
+
     // Now walk through the old table and copy over its transforms.
     // We will build up an IndexMap of old index numbers to new index
     // numbers while we go, which we can use to modify the vertices.
     IndexMap transform_map;
-    
+
     int num_transforms = old_table->get_num_transforms();
     transform_map.reserve(num_transforms);
     for (int ti = 0; ti < num_transforms; ++ti) {
       const VertexTransform *transform = old_table->get_transform(ti);
-      AddedTransforms::iterator ai = added_transforms.find(transform);
-      if (ai != added_transforms.end()) {
+      AddedTransforms::iterator ai = _added_transforms.find(transform);
+      if (ai != _added_transforms.end()) {
         // Already got this one in the table.
         transform_map.push_back((*ai).second);
       } else {
         // This is a new one.
-        int tj = new_table->add_transform(transform);
+        int tj = _new_ttable->add_transform(transform);
         transform_map.push_back(tj);
-        added_transforms[transform] = tj;
+        _added_transforms[transform] = tj;
       }
     }
-    _new_data->set_transform_table(TransformTable::register_table(new_table));
 
     // And now modify the vertices to update the indices to their new
     // values in the new table.  This requires a nested loop, since
@@ -1468,9 +1569,16 @@ append_vdata(const GeomVertexData *vdata, int vertex_offset) {
       _new_btable->add_blend(TransformBlend());
     }
 
-    SparseArray new_rows = old_btable->get_rows();
-    new_rows <<= vertex_offset;
-    _new_btable_rows |= new_rows;
+    // Add the rows one subrange at a time; since the vdatas are
+    // appended in order, each one goes on the end, which is much
+    // cheaper than a general union of the two arrays.
+    const SparseArray &old_rows = old_btable->get_rows();
+    int num_subranges = old_rows.get_num_subranges();
+    for (int si = 0; si < num_subranges; ++si) {
+      int from = old_rows.get_subrange_begin(si);
+      int to = old_rows.get_subrange_end(si);
+      _new_btable_rows.set_range(from + vertex_offset, to - from);
+    }
 
     // We still need to build up the IndexMap.
     IndexMap blend_map;
@@ -1500,25 +1608,22 @@ append_vdata(const GeomVertexData *vdata, int vertex_offset) {
   }
   
   if (vdata->get_slider_table() != (SliderTable *)NULL) {
-    // The SliderTable.  This one requires making a copy, like the
-    // TransformTable (since it can't be modified once registered
-    // either), but at least it uniquifies sliders added to it.  Also,
-    // it doesn't require indexing into it, so we don't have to build
-    // an IndexMap to modify the vertices with.
+    // The SliderTable.  This one is built up in _new_sliders and
+    // registered at the end, like the TransformTable (since it can't
+    // be modified once registered either), but at least it uniquifies
+    // sliders added to it.  Also, it doesn't require indexing into it,
+    // so we don't have to build an IndexMap to modify the vertices
+    // with.
     const SliderTable *old_sliders = vdata->get_slider_table();
-    PT(SliderTable) new_sliders;
-    if (_new_data->get_slider_table() != (SliderTable *)NULL) {
-      new_sliders = new SliderTable(*_new_data->get_slider_table());
-    } else {
-      new_sliders = new SliderTable;
+    if (_new_sliders == (SliderTable *)NULL) {
+      _new_sliders = new SliderTable;
     }
     int num_sliders = old_sliders->get_num_sliders();
     for (int si = 0; si < num_sliders; ++si) {
       SparseArray new_rows = old_sliders->get_slider_rows(si);
       new_rows <<= vertex_offset;
-      new_sliders->add_slider(old_sliders->get_slider(si), new_rows);
+      _new_sliders->add_slider(old_sliders->get_slider(si), new_rows);
     }
-    _new_data->set_slider_table(SliderTable::register_table(new_sliders));
   }
 }
 
@@ -1679,3 +1784,160 @@ remove_unused_vertices(const GeomVertexData *vdata) {
     geom->set_vertex_data(new_vdata);
   }
 }
+
+////////////////////////////////////////////////////////////////////
+//     Function: GeomTransformer::VertexDataAssoc::reorder_vertices
+//       Access: Public
+//  Description: Rearranges the vertices so that they appear in the
+//               order in which the Geoms' primitives first reference
+//               them, dropping any that are not referenced at all,
+//               and reindexes the primitives to match.
+////////////////////////////////////////////////////////////////////
+void GeomTransformer::VertexDataAssoc::
+reorder_vertices(const GeomVertexData *vdata) {
+  if (_geoms.empty()) {
+    // Trivial case.
+    return;
+  }
+
+  PT(Thread) current_thread = Thread::get_current_thread();
+
+  int num_vertices = vdata->get_num_rows();
+  vector_int remap_array(num_vertices, -1);
+  vector_int order;
+  order.reserve(num_vertices);
+
+  bool any_referenced = false;
+  GeomList::iterator gi;
+  for (gi = _geoms.begin(); gi != _geoms.end(); ++gi) {
+    Geom *geom = (*gi);
+    if (geom->get_vertex_data() != vdata) {
+      continue;
+    }
+
+    any_referenced = true;
+    int num_primitives = geom->get_num_primitives();
+    for (int i = 0; i < num_primitives; ++i) {
+      CPT(GeomPrimitive) prim = geom->get_primitive(i);
+
+      GeomPrimitivePipelineReader reader(prim, current_thread);
+      int num_prim_vertices = reader.get_num_vertices();
+      for (int vi = 0; vi < num_prim_vertices; ++vi) {
+        int index = reader.get_vertex(vi);
+        nassertv(index >= 0 && index < num_vertices);
+        if (remap_array[index] < 0) {
+          remap_array[index] = (int)order.size();
+          order.push_back(index);
+        }
+      }
+    }
+  }
+
+  if (!any_referenced) {
+    return;
+  }
+
+  int new_num_vertices = (int)order.size();
+  if (new_num_vertices == num_vertices) {
+    bool in_order = true;
+    for (int i = 0; i < num_vertices && in_order; ++i) {
+      in_order = (order[i] == i);
+    }
+    if (in_order) {
+      // Nothing to do.
+      return;
+    }
+  }
+
+  // Now recopy the actual vertex data, one array at a time.
+  PT(GeomVertexData) new_vdata = new GeomVertexData(*vdata);
+  new_vdata->unclean_set_num_rows(new_num_vertices);
+
+  int num_arrays = vdata->get_num_arrays();
+  nassertv(num_arrays == new_vdata->get_num_arrays());
+
+  GeomVertexDataPipelineReader reader(vdata, current_thread);
+  reader.check_array_readers();
+  GeomVertexDataPipelineWriter writer(new_vdata, true, current_thread);
+  writer.check_array_writers();
+
+  for (int a = 0; a < num_arrays; ++a) {
+    const GeomVertexArrayDataHandle *array_reader = reader.get_array_reader(a);
+    GeomVertexArrayDataHandle *array_writer = writer.get_array_writer(a);
+
+    int stride = array_reader->get_array_format()->get_stride();
+    nassertv(stride == array_writer->get_array_format()->get_stride());
+
+    for (int new_index = 0; new_index < new_num_vertices; ++new_index) {
+      array_writer->copy_subdata_from(new_index * stride, stride,
+                                      array_reader,
+                                      order[new_index] * stride, stride);
+    }
+  }
+
+  // Update the rows in the TransformBlendTable, if any.  The rows
+  // are no longer contiguous, so they must be remapped one at a time.
+  PT(TransformBlendTable) tbtable = new_vdata->modify_transform_blend_table();
+  if (!tbtable.is_null()) {
+    const SparseArray &rows = tbtable->get_rows();
+    SparseArray new_rows;
+    int num_subranges = rows.get_num_subranges();
+    for (int si = 0; si < num_subranges; ++si) {
+      int from = rows.get_subrange_begin(si);
+      int to = min(rows.get_subrange_end(si), num_vertices);
+      for (int index = from; index < to; ++index) {
+        if (remap_array[index] >= 0) {
+          new_rows.set_bit(remap_array[index]);
+        }
+      }
+    }
+    tbtable->set_rows(new_rows);
+  }
+
+  // Likewise for the rows affected by each slider.
+  const SliderTable *sliders = new_vdata->get_slider_table();
+  if (sliders != (SliderTable *)NULL) {
+    PT(SliderTable) new_sliders = new SliderTable(*sliders);
+    int num_sliders = sliders->get_num_sliders();
+    for (int n = 0; n < num_sliders; ++n) {
+      const SparseArray &rows = sliders->get_slider_rows(n);
+      SparseArray new_rows;
+      int num_subranges = rows.get_num_subranges();
+      for (int si = 0; si < num_subranges; ++si) {
+        int from = rows.get_subrange_begin(si);
+        int to = min(rows.get_subrange_end(si), num_vertices);
+        for (int index = from; index < to; ++index) {
+          if (remap_array[index] >= 0) {
+            new_rows.set_bit(remap_array[index]);
+          }
+        }
+      }
+      new_sliders->set_slider_rows(n, new_rows);
+    }
+    new_vdata->set_slider_table(SliderTable::register_table(new_sliders));
+  }
+
+  // Finally, reindex the Geoms.
+  for (gi = _geoms.begin(); gi != _geoms.end(); ++gi) {
+    Geom *geom = (*gi);
+    if (geom->get_vertex_data() != vdata) {
+      continue;
+    }
+
+    int num_primitives = geom->get_num_primitives();
+    for (int i = 0; i < num_primitives; ++i) {
+      PT(GeomPrimitive) prim = geom->modify_primitive(i);
+      prim->make_indexed();
+      PT(GeomVertexArrayData) vertices = prim->modify_vertices();
+      GeomVertexRewriter rewriter(vertices, 0, current_thread);
+
+      while (!rewriter.is_at_end()) {
+        int index = rewriter.get_data1i();
+        nassertv(index >= 0 && index < num_vertices);
+        rewriter.set_data1i(remap_array[index]);
+      }
+    }
+
+    geom->set_vertex_data(new_vdata);
+  }
+}
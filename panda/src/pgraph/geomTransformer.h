@@ -21,6 +21,10 @@
 #include "geom.h"
 #include "geomVertexData.h"
 #include "texMatrixAttrib.h"
+#include "transformTable.h"
+#include "sliderTable.h"
+#include "pmap.h"
+#include "pset.h"
 
 class GeomNode;
 class RenderState;
@@ -55,6 +59,7 @@ public:
 
   void register_vertices(Geom *geom, bool might_have_unused);
   void register_vertices(GeomNode *node, bool might_have_unused);
+  void reorder_vertices(GeomNode *node);
 
   bool transform_vertices(Geom *geom, const LMatrix4 &mat);
   bool transform_vertices(GeomNode *node, const LMatrix4 &mat);
@@ -84,6 +89,8 @@ public:
   bool make_compatible_state(GeomNode *node);
 
   bool reverse_normals(Geom *geom);
+  bool quantize_vertices(Geom *geom, Geom::NumericType numeric_type);
+  bool quantize_vertices(GeomNode *node, Geom::NumericType numeric_type);
   bool doubleside(GeomNode *node);
   bool reverse(GeomNode *node);
 
@@ -102,13 +109,16 @@ private:
 
   // Keeps track of the Geoms that are associated with a particular
   // GeomVertexData.  Also tracks whether the vertex data might have
-  // unused vertices because of our actions.
+  // unused vertices because of our actions, and whether the vertices
+  // should be put in the order they are first used.
   class VertexDataAssoc {
   public:
     INLINE VertexDataAssoc();
     bool _might_have_unused;
+    bool _reorder;
     GeomList _geoms;
     void remove_unused_vertices(const GeomVertexData *vdata);
+    void reorder_vertices(const GeomVertexData *vdata);
   };
   typedef pmap<CPT(GeomVertexData), VertexDataAssoc> VertexDataAssocMap;
   VertexDataAssocMap _vdata_assoc;
@@ -197,6 +207,10 @@ private:
   typedef pmap<CPT(GeomVertexData), NewVertexData> ReversedNormals;
   ReversedNormals _reversed_normals;
 
+  // The table of GeomVertexData objects that have been quantized.
+  typedef pmap<CPT(GeomVertexData), NewVertexData> QuantizedVertices;
+  QuantizedVertices _quantized;
+
   class NewCollectedKey {
   public:
     INLINE bool operator < (const NewCollectedKey &other) const;
@@ -229,6 +243,7 @@ private:
     int apply_collect_changes();
 
     CPT(GeomVertexFormat) _new_format;
+    pset<const GeomVertexFormat *> _merged_formats;
     string _vdata_name;
     GeomEnums::UsageHint _usage_hint;
     SourceDatas _source_datas;
@@ -246,6 +261,16 @@ private:
     PT(TransformBlendTable) _new_btable;
     SparseArray _new_btable_rows;
 
+    // The TransformTable and SliderTable are built up here as each
+    // vdata is appended, and only registered with _new_data at the
+    // end, so that the growing tables need not be copied for each
+    // vdata.
+    typedef pmap<const VertexTransform *, int> AddedTransforms;
+    PT(TransformTable) _new_ttable;
+    AddedTransforms _added_transforms;
+    CPT(TransformTable) _identity_ttable;
+    PT(SliderTable) _new_sliders;
+
     // We need a TypeHandle just for ALLOC_DELETED_CHAIN.
   public:
     static TypeHandle get_class_type() {
@@ -277,6 +302,7 @@ private:
   static PStatCollector _apply_scale_color_collector;
   static PStatCollector _apply_texture_color_collector;
   static PStatCollector _apply_set_format_collector;
+  static PStatCollector _apply_quantize_collector;
     
 public:
   static void init_type() {
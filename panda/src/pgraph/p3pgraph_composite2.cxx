@@ -1,3 +1,4 @@
+#include "cullArena.cxx"
 #include "cullBin.cxx"
 #include "cullBinAttrib.cxx"
 #include "cullBinManager.cxx"
@@ -23,6 +23,7 @@
 #include "geomNode.h"
 #include "config_gobj.h"
 #include "thread.h"
+#include "asyncTaskManager.h"
 
 PStatCollector SceneGraphReducer::_flatten_collector("*:Flatten:flatten");
 PStatCollector SceneGraphReducer::_apply_collector("*:Flatten:apply");
@@ -32,6 +33,8 @@ PStatCollector SceneGraphReducer::_collect_collector("*:Flatten:collect");
 PStatCollector SceneGraphReducer::_make_nonindexed_collector("*:Flatten:make nonindexed");
 PStatCollector SceneGraphReducer::_unify_collector("*:Flatten:unify");
 PStatCollector SceneGraphReducer::_remove_unused_collector("*:Flatten:remove unused vertices");
+PStatCollector SceneGraphReducer::_optimize_vertex_cache_collector("*:Flatten:optimize vertex cache");
+PStatCollector SceneGraphReducer::_quantize_vertices_collector("*:Flatten:quantize vertices");
 PStatCollector SceneGraphReducer::_premunge_collector("*:Premunge");
 
 ////////////////////////////////////////////////////////////////////
@@ -106,16 +109,9 @@ flatten(PandaNode *root, int combine_siblings_bits) {
   do {
     num_pass_nodes = 0;
 
-    // Get a copy of the children list, so we don't have to worry
-    // about self-modifications.
-    PandaNode::Children cr = root->get_children();
-
-    // Now visit each of the children in turn.
-    int num_children = cr.get_num_children();
-    for (int i = 0; i < num_children; i++) {
-      PT(PandaNode) child_node = cr.get_child(i);
-      num_pass_nodes += r_flatten(root, child_node, combine_siblings_bits);
-    }
+    // Visit each of the children in turn.
+    num_pass_nodes += flatten_children(root, combine_siblings_bits,
+                                       _incremental);
 
     if (combine_siblings_bits != 0 && 
         root->get_num_children() >= 2 && 
@@ -131,9 +127,25 @@ flatten(PandaNode *root, int combine_siblings_bits) {
     // may get flattened next pass.
   } while ((combine_siblings_bits & CS_recurse) != 0 && num_pass_nodes != 0);
 
+  if (_incremental) {
+    record_subgraphs(root);
+  }
+
   return num_total_nodes;
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: SceneGraphReducer::clear_incremental
+//       Access: Published
+//  Description: Forgets which subgraphs were flattened by the last
+//               incremental flatten(), so that the next flatten()
+//               visits everything.  See set_incremental().
+////////////////////////////////////////////////////////////////////
+void SceneGraphReducer::
+clear_incremental() {
+  _flattened.clear();
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: SceneGraphReducer::remove_column
 //       Access: Published
@@ -235,6 +247,59 @@ remove_unused_vertices(PandaNode *root) {
   Thread::consider_yield();
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: SceneGraphReducer::optimize_vertex_cache
+//       Access: Published
+//  Description: Reorders the triangles of every GeomNode at this
+//               level and below so that vertices are reused while
+//               they are still in the graphics card's post-transform
+//               vertex cache, and then reorders the vertices of each
+//               GeomVertexData into the order in which the triangles
+//               now use them, so that they are also fetched from
+//               memory in sequence.  Triangle strips and fans are
+//               decomposed into indexed triangles in the process,
+//               and unused vertices are removed.
+//
+//               This is best called last, after flatten() and
+//               unify(), since combining Geoms afterwards may undo
+//               the ordering.  See GeomPrimitive::optimize_vertex_cache().
+////////////////////////////////////////////////////////////////////
+void SceneGraphReducer::
+optimize_vertex_cache(PandaNode *root) {
+  nassertv(check_live_flatten(root));
+  PStatTimer timer(_optimize_vertex_cache_collector);
+
+  r_optimize_vertex_cache(root, _transformer);
+  _transformer.finish_apply();
+  Thread::consider_yield();
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: SceneGraphReducer::quantize_vertices
+//       Access: Published
+//  Description: Stores the vertices of the GeomNodes at the indicated
+//               root and below in a compact form: points and texcoords
+//               as integers of the indicated type (NT_uint16 or
+//               NT_uint8) scaled to fit the bounding box of each
+//               GeomVertexData, and normals in octahedral form.  See
+//               GeomVertexData::quantize().  Returns the number of
+//               GeomNodes modified.
+//
+//               This is best called last, after flatten() and
+//               unify(); transforming quantized vertices expands
+//               them to floating-point again.  Animated vertices are
+//               left alone.
+////////////////////////////////////////////////////////////////////
+int SceneGraphReducer::
+quantize_vertices(PandaNode *root, Geom::NumericType numeric_type) {
+  nassertr(check_live_flatten(root), 0);
+
+  PStatTimer timer(_quantize_vertices_collector);
+  int count = r_quantize_vertices(root, numeric_type, _transformer);
+  _transformer.finish_apply();
+  return count;
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: SceneGraphReducer::check_live_flatten
 //       Access: Published
@@ -430,92 +495,219 @@ r_flatten(PandaNode *grandparent_node, PandaNode *parent_node,
     }
     
   } else {
-    if ((combine_siblings_bits & CS_within_radius) != 0) {
-      CPT(BoundingVolume) bv = parent_node->get_bounds();
-      if (bv->is_of_type(BoundingSphere::get_class_type())) {
-        const BoundingSphere *bs = DCAST(BoundingSphere, bv);
+    num_nodes += flatten_below(parent_node, combine_siblings_bits);
+    num_nodes += flatten_finish(grandparent_node, parent_node,
+                                combine_siblings_bits);
+  }
+
+  return num_nodes;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: SceneGraphReducer::flatten_children
+//       Access: Protected
+//  Description: Calls r_flatten() on each of the children of the
+//               indicated node.  If skip_unchanged is true, children
+//               whose subgraphs have not changed since the last
+//               incremental flatten are skipped.
+//
+//               If more than one thread has been requested with
+//               set_num_threads(), and we are not already flattening
+//               in parallel, the children are flattened in parallel.
+//               Everything below each child is flattened in a task
+//               of its own, but collapsing the child itself into
+//               parent_node is left for this thread, afterwards,
+//               since that changes parent_node's list of children.
+//               A child whose subgraph contains an instanced node
+//               (one with more than one parent) is flattened by this
+//               thread too, since the instance might also be reached
+//               from another child's task.
+////////////////////////////////////////////////////////////////////
+int SceneGraphReducer::
+flatten_children(PandaNode *parent_node, int combine_siblings_bits,
+                 bool skip_unchanged) {
+  int num_nodes = 0;
+
+  // Get a copy of the children list, so we don't have to worry
+  // about self-modifications.
+  PandaNode::Children cr = parent_node->get_children();
+  int num_children = cr.get_num_children();
+
+  ParallelFlatten pf(this, parent_node);
+  pf._jobs.reserve(num_children);
+  for (int i = 0; i < num_children; i++) {
+    PandaNode *child_node = cr.get_child(i);
+    if (!skip_unchanged || is_subgraph_changed(child_node)) {
+      FlattenJob job;
+      job._child = child_node;
+      job._combine_siblings_bits = combine_siblings_bits;
+      job._num_nodes = 0;
+      job._result = FR_serial;
+      pf._jobs.push_back(job);
+    }
+  }
+
+  int num_jobs = (int)pf._jobs.size();
+  if (num_jobs >= 2 && _num_threads > 1 && !_in_parallel &&
+      Thread::is_true_threads()) {
+    AsyncTaskManager *task_mgr = AsyncTaskManager::get_global_ptr();
+    AsyncTaskChain *chain = task_mgr->make_task_chain("flatten");
+    if (chain->get_num_threads() != _num_threads) {
+      chain->set_num_threads(_num_threads);
+    }
+
+    // Give each thread several pieces, so that a few large subgraphs
+    // don't hold up the rest.
+    int grain_size = max(num_jobs / (_num_threads * 8), 1);
+
+    // Any change below a child marks the bounds stale all the way up
+    // through parent_node, which is shared by all of the tasks.  Mark
+    // it stale now, from this thread, so that the tasks stop at
+    // parent_node, finding it already stale, and never modify it.
+    parent_node->mark_bounds_stale();
+
+    _in_parallel = true;
+    chain->parallel_for_join("flatten", 0, num_jobs, grain_size,
+                             &st_flatten_jobs, &pf);
+    _in_parallel = false;
+  }
+
+  // Now finish the jobs, in order.  If we didn't flatten in parallel
+  // after all, they are all still marked FR_serial.
+  FlattenJobs::iterator ji;
+  for (ji = pf._jobs.begin(); ji != pf._jobs.end(); ++ji) {
+    FlattenJob &job = (*ji);
+    num_nodes += job._num_nodes;
+    switch (job._result) {
+    case FR_done:
+      break;
+
+    case FR_finish:
+      num_nodes += flatten_finish(parent_node, job._child,
+                                  job._combine_siblings_bits);
+      break;
+
+    case FR_serial:
+      num_nodes += r_flatten(parent_node, job._child, combine_siblings_bits);
+      break;
+    }
+  }
+
+  return num_nodes;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: SceneGraphReducer::flatten_below
+//       Access: Protected
+//  Description: The first part of r_flatten(): flattens the nodes
+//               below parent_node, without changing parent_node's
+//               relationship to its own parent.  combine_siblings_bits
+//               may be adjusted according to the size of parent_node,
+//               for use by the rest of the flatten.
+////////////////////////////////////////////////////////////////////
+int SceneGraphReducer::
+flatten_below(PandaNode *parent_node, int &combine_siblings_bits) {
+  int num_nodes = 0;
+
+  if ((combine_siblings_bits & CS_within_radius) != 0) {
+    CPT(BoundingVolume) bv = parent_node->get_bounds();
+    if (bv->is_of_type(BoundingSphere::get_class_type())) {
+      const BoundingSphere *bs = DCAST(BoundingSphere, bv);
+      if (pgraph_cat.is_spam()) {
+        pgraph_cat.spam()
+          << "considering radius of " << *parent_node
+          << ": " << *bs << " vs. " << _combine_radius << "\n";
+      }
+      if (!bs->is_infinite() && (bs->is_empty() || bs->get_radius() <= _combine_radius)) {
+        // This node fits within the specified radius; from here on
+        // down, we will have CS_other set, instead of
+        // CS_within_radius.
         if (pgraph_cat.is_spam()) {
           pgraph_cat.spam()
-            << "considering radius of " << *parent_node
-            << ": " << *bs << " vs. " << _combine_radius << "\n";
-        }
-        if (!bs->is_infinite() && (bs->is_empty() || bs->get_radius() <= _combine_radius)) {
-          // This node fits within the specified radius; from here on
-          // down, we will have CS_other set, instead of
-          // CS_within_radius.
-          if (pgraph_cat.is_spam()) {
-            pgraph_cat.spam()
-              << "node fits within radius; flattening tighter.\n";
-          }
-          combine_siblings_bits &= ~CS_within_radius;
-          combine_siblings_bits |= (CS_geom_node | CS_other | CS_recurse);
+            << "node fits within radius; flattening tighter.\n";
         }
+        combine_siblings_bits &= ~CS_within_radius;
+        combine_siblings_bits |= (CS_geom_node | CS_other | CS_recurse);
       }
     }
+  }
 
-    // First, recurse on each of the children.
-    {
-      PandaNode::Children cr = parent_node->get_children();
-      int num_children = cr.get_num_children();
-      for (int i = 0; i < num_children; i++) {
-        PT(PandaNode) child_node = cr.get_child(i);
-        num_nodes += r_flatten(parent_node, child_node, combine_siblings_bits);
-      }
-    }
+  // First, recurse on each of the children.
+  num_nodes += flatten_children(parent_node, combine_siblings_bits, false);
     
-    // Now that the above loop has removed some children, the child
-    // list saved above is no longer accurate, so hereafter we must
-    // ask the node for its real child list.
+  // Now that the above loop has removed some children, the child
+  // list saved above is no longer accurate, so hereafter we must
+  // ask the node for its real child list.
     
-    // If we have CS_recurse set, then we flatten siblings before
-    // trying to flatten children.  Otherwise, we flatten children
-    // first, and then flatten siblings, which avoids overly
-    // enthusiastic flattening.
-    if ((combine_siblings_bits & CS_recurse) != 0 && 
-        parent_node->get_num_children() >= 2 &&
-        parent_node->safe_to_combine_children()) {
-      num_nodes += flatten_siblings(parent_node, combine_siblings_bits);
-    }
+  // If we have CS_recurse set, then we flatten siblings before
+  // trying to flatten children.  Otherwise, we flatten children
+  // first, and then flatten siblings, which avoids overly
+  // enthusiastic flattening.
+  if ((combine_siblings_bits & CS_recurse) != 0 && 
+      parent_node->get_num_children() >= 2 &&
+      parent_node->safe_to_combine_children()) {
+    num_nodes += flatten_siblings(parent_node, combine_siblings_bits);
+  }
+
+  return num_nodes;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: SceneGraphReducer::flatten_finish
+//       Access: Protected
+//  Description: The second part of r_flatten(), after
+//               flatten_below(): if parent_node is left with only
+//               one child, collapses the two into one node, which
+//               replaces parent_node under grandparent_node;
+//               otherwise, combines parent_node's children where
+//               possible.
+//
+//               grandparent_node is modified only if parent_node has
+//               exactly one child.
+////////////////////////////////////////////////////////////////////
+int SceneGraphReducer::
+flatten_finish(PandaNode *grandparent_node, PandaNode *parent_node,
+               int combine_siblings_bits) {
+  int num_nodes = 0;
 
-    if (parent_node->get_num_children() == 1) {
-      // If we now have exactly one child, consider flattening the node
-      // out.
-      PT(PandaNode) child_node = parent_node->get_child(0);
-      int child_sort = parent_node->get_child_sort(0);
+  if (parent_node->get_num_children() == 1) {
+    // If we now have exactly one child, consider flattening the node
+    // out.
+    PT(PandaNode) child_node = parent_node->get_child(0);
+    int child_sort = parent_node->get_child_sort(0);
       
-      if (consider_child(grandparent_node, parent_node, child_node)) {
-        // Ok, do it.
-        parent_node->remove_child(child_node);
+    if (consider_child(grandparent_node, parent_node, child_node)) {
+      // Ok, do it.
+      parent_node->remove_child(child_node);
         
-        if (do_flatten_child(grandparent_node, parent_node, child_node)) {
-          // Done!
-          num_nodes++;
-        } else {
-          // Chicken out.
-          parent_node->add_child(child_node, child_sort);
-        }
+      if (do_flatten_child(grandparent_node, parent_node, child_node)) {
+        // Done!
+        num_nodes++;
+      } else {
+        // Chicken out.
+        parent_node->add_child(child_node, child_sort);
       }
     }
+  }
 
-    if ((combine_siblings_bits & CS_recurse) == 0 &&
-        (combine_siblings_bits & ~CS_recurse) != 0 && 
-        parent_node->get_num_children() >= 2 &&
-        parent_node->safe_to_combine_children()) {
-      num_nodes += flatten_siblings(parent_node, combine_siblings_bits);
-    }
+  if ((combine_siblings_bits & CS_recurse) == 0 &&
+      (combine_siblings_bits & ~CS_recurse) != 0 && 
+      parent_node->get_num_children() >= 2 &&
+      parent_node->safe_to_combine_children()) {
+    num_nodes += flatten_siblings(parent_node, combine_siblings_bits);
+  }
 
-    // Finally, if any of our remaining children are plain PandaNodes
-    // with no children, just remove them.
-    if (parent_node->safe_to_combine_children()) {
-      for (int i = parent_node->get_num_children() - 1; i >= 0; --i) {
-        PandaNode *child_node = parent_node->get_child(i);
-        if (child_node->is_exact_type(PandaNode::get_class_type()) &&
-            child_node->get_num_children() == 0 &&
-            child_node->get_transform()->is_identity() &&
-            child_node->get_effects()->is_empty()) {
-          parent_node->remove_child(child_node);
-          ++num_nodes;
-        }
+  // Finally, if any of our remaining children are plain PandaNodes
+  // with no children, just remove them.
+  if (parent_node->safe_to_combine_children()) {
+    for (int i = parent_node->get_num_children() - 1; i >= 0; --i) {
+      PandaNode *child_node = parent_node->get_child(i);
+      if (child_node->is_exact_type(PandaNode::get_class_type()) &&
+          child_node->get_num_children() == 0 &&
+          child_node->get_transform()->is_identity() &&
+          child_node->get_effects()->is_empty()) {
+        parent_node->remove_child(child_node);
+        ++num_nodes;
       }
     }
   }
@@ -523,6 +715,152 @@ r_flatten(PandaNode *grandparent_node, PandaNode *parent_node,
   return num_nodes;
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: SceneGraphReducer::flatten_job
+//       Access: Protected
+//  Description: Called in a task thread to flatten the subgraph of
+//               one of parent_node's children, in parallel with its
+//               siblings.  Anything that would modify parent_node is
+//               left for flatten_children() to do afterwards.
+////////////////////////////////////////////////////////////////////
+void SceneGraphReducer::
+flatten_job(PandaNode *parent_node, FlattenJob &job) {
+  PandaNode *child_node = job._child;
+  if (r_has_instances(child_node)) {
+    // This subgraph might be shared with another task.
+    job._result = FR_serial;
+    return;
+  }
+
+  if (!child_node->safe_to_flatten_below()) {
+    job._result = FR_done;
+    return;
+  }
+
+  job._num_nodes = flatten_below(child_node, job._combine_siblings_bits);
+  if (child_node->get_num_children() == 1) {
+    // This will collapse child_node into its child, which replaces
+    // child_node under parent_node.
+    job._result = FR_finish;
+  } else {
+    job._num_nodes += flatten_finish(parent_node, child_node,
+                                     job._combine_siblings_bits);
+    job._result = FR_done;
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: SceneGraphReducer::st_flatten_jobs
+//       Access: Protected, Static
+//  Description: The task function that flattens a range of the jobs
+//               set up by flatten_children().
+////////////////////////////////////////////////////////////////////
+void SceneGraphReducer::
+st_flatten_jobs(int begin, int end, void *user_data) {
+  ParallelFlatten *pf = (ParallelFlatten *)user_data;
+  for (int i = begin; i < end; ++i) {
+    pf->_reducer->flatten_job(pf->_parent_node, pf->_jobs[i]);
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: SceneGraphReducer::r_has_instances
+//       Access: Protected, Static
+//  Description: Returns true if the indicated node, or any node
+//               below it, has more than one parent.
+////////////////////////////////////////////////////////////////////
+bool SceneGraphReducer::
+r_has_instances(PandaNode *node) {
+  if (node->get_num_parents() > 1) {
+    return true;
+  }
+
+  PandaNode::Children cr = node->get_children();
+  int num_children = cr.get_num_children();
+  for (int i = 0; i < num_children; i++) {
+    if (r_has_instances(cr.get_child(i))) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: SceneGraphReducer::is_subgraph_changed
+//       Access: Protected
+//  Description: Returns true if the subgraph at the indicated node
+//               has changed since it was last flattened with
+//               incremental mode enabled, or if it was not
+//               flattened then at all.
+////////////////////////////////////////////////////////////////////
+bool SceneGraphReducer::
+is_subgraph_changed(PandaNode *node) const {
+  FlattenedSubgraphs::const_iterator fi = _flattened.find(node);
+  if (fi == _flattened.end()) {
+    return true;
+  }
+
+  const FlattenedSubgraph &fs = (*fi).second;
+  if (fs._node.was_deleted()) {
+    // A different node that happens to have the same pointer.
+    return true;
+  }
+
+  // A change to a node's state, effects, tags, transform or children
+  // increments its modified counter directly.  A change to its
+  // geometry marks its bounds stale instead; recomputing the bounds
+  // here brings the counter up to date for those nodes too.
+  node->get_bounds();
+
+  pvector<UpdateSeq> modified;
+  modified.reserve(fs._modified.size());
+  r_get_modified(node, modified);
+  return (modified != fs._modified);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: SceneGraphReducer::record_subgraphs
+//       Access: Protected
+//  Description: Records the current state of each of the children of
+//               root, for the next incremental flatten.
+////////////////////////////////////////////////////////////////////
+void SceneGraphReducer::
+record_subgraphs(PandaNode *root) {
+  _flattened.clear();
+
+  PandaNode::Children cr = root->get_children();
+  int num_children = cr.get_num_children();
+  for (int i = 0; i < num_children; i++) {
+    PandaNode *child_node = cr.get_child(i);
+
+    // Bring the bounds up to date first, since recomputing them would
+    // increment the modified counters afterwards.
+    child_node->get_bounds();
+
+    FlattenedSubgraph &fs = _flattened[child_node];
+    fs._node = child_node;
+    r_get_modified(child_node, fs._modified);
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: SceneGraphReducer::r_get_modified
+//       Access: Protected, Static
+//  Description: Appends the modified counter of the indicated node,
+//               and of each node below it, in order, to the vector.
+////////////////////////////////////////////////////////////////////
+void SceneGraphReducer::
+r_get_modified(PandaNode *node, pvector<UpdateSeq> &modified) {
+  modified.push_back(node->get_bam_modified());
+
+  PandaNode::Children cr = node->get_children();
+  int num_children = cr.get_num_children();
+  for (int i = 0; i < num_children; i++) {
+    r_get_modified(cr.get_child(i), modified);
+  }
+}
+
 class SortByState {
 public:
   INLINE bool
@@ -620,11 +958,17 @@ flatten_siblings(PandaNode *parent_node, int combine_siblings_bits) {
             PT(PandaNode) new_node = 
               do_flatten_siblings(parent_node, child1, child2);
             if (new_node != (PandaNode *)NULL) {
-              // We successfully collapsed a node.
+              // We successfully collapsed a node.  Carry on comparing
+              // the combined node with the rest of the list; there's
+              // no need to start over from the beginning, since the
+              // nodes before it have already failed to combine with
+              // a node of the same type.
               (*ai1_hold) = new_node;
+              child1 = new_node;
+              if (ai1 == ai2_hold) {
+                ai1 = ai2;
+              }
               nodes.erase(ai2_hold);
-              ai1 = nodes.begin();
-              ai2 = nodes.end();
               num_nodes++;
             }
           }
@@ -1023,6 +1367,54 @@ r_decompose(PandaNode *node) {
   }
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: SceneGraphReducer::r_optimize_vertex_cache
+//       Access: Private
+//  Description: The recursive implementation of
+//               optimize_vertex_cache().
+////////////////////////////////////////////////////////////////////
+void SceneGraphReducer::
+r_optimize_vertex_cache(PandaNode *node, GeomTransformer &transformer) {
+  if (node->is_geom_node()) {
+    GeomNode *geom_node = DCAST(GeomNode, node);
+    geom_node->optimize_vertex_cache();
+    transformer.reorder_vertices(geom_node);
+  }
+
+  PandaNode::Children children = node->get_children();
+  int num_children = children.get_num_children();
+  for (int i = 0; i < num_children; ++i) {
+    r_optimize_vertex_cache(children.get_child(i), transformer);
+  }
+  Thread::consider_yield();
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: SceneGraphReducer::r_quantize_vertices
+//       Access: Private
+//  Description: The recursive implementation of quantize_vertices().
+////////////////////////////////////////////////////////////////////
+int SceneGraphReducer::
+r_quantize_vertices(PandaNode *node, Geom::NumericType numeric_type,
+                    GeomTransformer &transformer) {
+  int num_changed = 0;
+
+  if (node->is_geom_node()) {
+    if (transformer.quantize_vertices(DCAST(GeomNode, node), numeric_type)) {
+      ++num_changed;
+    }
+  }
+
+  PandaNode::Children children = node->get_children();
+  int num_children = children.get_num_children();
+  for (int i = 0; i < num_children; ++i) {
+    num_changed +=
+      r_quantize_vertices(children.get_child(i), numeric_type, transformer);
+  }
+
+  return num_changed;
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: SceneGraphReducer::r_premunge
 //       Access: Private
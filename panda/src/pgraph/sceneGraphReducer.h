@@ -16,6 +16,7 @@
 #define SCENEGRAPHREDUCER_H
 
 #include "pandabase.h"
+#include "config_pgraph.h"
 #include "transformState.h"
 #include "renderAttrib.h"
 #include "renderState.h"
@@ -26,6 +27,10 @@
 #include "typedObject.h"
 #include "pointerTo.h"
 #include "graphicsStateGuardianBase.h"
+#include "weakPointerTo.h"
+#include "updateSeq.h"
+#include "pvector.h"
+#include "pmap.h"
 
 class PandaNode;
 
@@ -127,6 +132,13 @@ PUBLISHED:
   INLINE void set_combine_radius(PN_stdfloat combine_radius);
   INLINE PN_stdfloat get_combine_radius() const;
 
+  INLINE void set_num_threads(int num_threads);
+  INLINE int get_num_threads() const;
+
+  INLINE void set_incremental(bool incremental);
+  INLINE bool get_incremental() const;
+  void clear_incremental();
+
   INLINE void apply_attribs(PandaNode *node, int attrib_types = ~(TT_clip_plane | TT_cull_face | TT_apply_texture_color));
   INLINE void apply_attribs(PandaNode *node, const AccumulatedAttribs &attribs,
                             int attrib_types, GeomTransformer &transformer);
@@ -144,6 +156,9 @@ PUBLISHED:
   INLINE int make_nonindexed(PandaNode *root, int nonindexed_bits = ~0);
   void unify(PandaNode *root, bool preserve_order);
   void remove_unused_vertices(PandaNode *root);
+  void optimize_vertex_cache(PandaNode *root);
+  int quantize_vertices(PandaNode *root,
+                        Geom::NumericType numeric_type = Geom::NT_uint16);
 
   INLINE void premunge(PandaNode *root, const RenderState *initial_state);
   bool check_live_flatten(PandaNode *node);
@@ -157,6 +172,35 @@ protected:
   int flatten_siblings(PandaNode *parent_node,
                        int combine_siblings_bits);
 
+  enum FlattenResult {
+    FR_done,
+    FR_finish,
+    FR_serial,
+  };
+
+  // The flattening of one child's subgraph, as handed to a task
+  // thread by flatten_children().
+  class FlattenJob {
+  public:
+    PT(PandaNode) _child;
+    int _combine_siblings_bits;
+    int _num_nodes;
+    FlattenResult _result;
+  };
+  typedef pvector<FlattenJob> FlattenJobs;
+
+  int flatten_children(PandaNode *parent_node, int combine_siblings_bits,
+                       bool skip_unchanged);
+  int flatten_below(PandaNode *parent_node, int &combine_siblings_bits);
+  int flatten_finish(PandaNode *grandparent_node, PandaNode *parent_node,
+                     int combine_siblings_bits);
+  void flatten_job(PandaNode *parent_node, FlattenJob &job);
+  static void st_flatten_jobs(int begin, int end, void *user_data);
+  static bool r_has_instances(PandaNode *node);
+  bool is_subgraph_changed(PandaNode *node) const;
+  void record_subgraphs(PandaNode *root);
+  static void r_get_modified(PandaNode *node, pvector<UpdateSeq> &modified);
+
   bool consider_child(PandaNode *grandparent_node,
                       PandaNode *parent_node, PandaNode *child_node);
   bool consider_siblings(PandaNode *parent_node, PandaNode *child1,
@@ -184,6 +228,9 @@ protected:
   void r_unify(PandaNode *node, int max_indices, bool preserve_order);
   void r_register_vertices(PandaNode *node, GeomTransformer &transformer);
   void r_decompose(PandaNode *node);
+  void r_optimize_vertex_cache(PandaNode *node, GeomTransformer &transformer);
+  int r_quantize_vertices(PandaNode *node, Geom::NumericType numeric_type,
+                          GeomTransformer &transformer);
 
   void r_premunge(PandaNode *node, const RenderState *state);
 
@@ -191,6 +238,29 @@ private:
   PT(GraphicsStateGuardianBase) _gsg;
   PN_stdfloat _combine_radius;
   GeomTransformer _transformer;
+  int _num_threads;
+  bool _in_parallel;
+  bool _incremental;
+
+
+  class ParallelFlatten {
+  public:
+    INLINE ParallelFlatten(SceneGraphReducer *reducer, PandaNode *parent_node);
+
+    SceneGraphReducer *_reducer;
+    PandaNode *_parent_node;
+    FlattenJobs _jobs;
+  };
+
+  // The children of the root as of the last incremental flatten, with
+  // the modified counter of each node in the subgraph at the time.
+  class FlattenedSubgraph {
+  public:
+    WPT(PandaNode) _node;
+    pvector<UpdateSeq> _modified;
+  };
+  typedef pmap<PandaNode *, FlattenedSubgraph> FlattenedSubgraphs;
+  FlattenedSubgraphs _flattened;
 
   static PStatCollector _flatten_collector;
   static PStatCollector _apply_collector;
@@ -200,6 +270,8 @@ private:
   static PStatCollector _make_nonindexed_collector;
   static PStatCollector _unify_collector;
   static PStatCollector _remove_unused_collector;
+  static PStatCollector _optimize_vertex_cache_collector;
+  static PStatCollector _quantize_vertices_collector;
   static PStatCollector _premunge_collector;
 };
 
@@ -20,6 +20,7 @@
     fadeLodNode.I fadeLodNode.h fadeLodNodeData.h \
     lightLensNode.h lightLensNode.I \
     lightNode.h lightNode.I \
+    lodGenerator.h lodGenerator.I \
     lodNode.I lodNode.h lodNodeType.h \
     nodeCullCallbackData.h nodeCullCallbackData.I \
     pointLight.h pointLight.I \
@@ -40,6 +41,7 @@
     fadeLodNode.cxx fadeLodNodeData.cxx \
     lightLensNode.cxx \
     lightNode.cxx \
+    lodGenerator.cxx \
     lodNode.cxx lodNodeType.cxx \
     nodeCullCallbackData.cxx \
     pointLight.cxx \
@@ -60,6 +62,7 @@
     fadeLodNode.I fadeLodNode.h fadeLodNodeData.h \
     lightLensNode.h lightLensNode.I \
     lightNode.h lightNode.I \
+    lodGenerator.h lodGenerator.I \
     lodNode.I lodNode.h lodNodeType.h \
     nodeCullCallbackData.h nodeCullCallbackData.I \
     pointLight.h pointLight.I \
@@ -0,0 +1,192 @@
+// Filename: lodGenerator.cxx
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "lodGenerator.h"
+#include "lodNode.h"
+#include "geomNode.h"
+#include "geom.h"
+#include "geomPrimitive.h"
+#include "boundingSphere.h"
+#include "finiteBoundingVolume.h"
+#include "config_pgraph.h"
+
+////////////////////////////////////////////////////////////////////
+//     Function: LODGenerator::Constructor
+//       Access: Published
+//  Description:
+////////////////////////////////////////////////////////////////////
+LODGenerator::
+LODGenerator() :
+  _min_triangles(1000),
+  _num_levels(3),
+  _fraction(0.5f),
+  _max_error(0.02f),
+  _switch_distance(10.0f)
+{
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: LODGenerator::generate
+//       Access: Published
+//  Description: Generates levels of detail for each GeomNode at the
+//               indicated node and below that has at least
+//               get_min_triangles() triangles.  Returns the number of
+//               GeomNodes that were given levels of detail.
+////////////////////////////////////////////////////////////////////
+int LODGenerator::
+generate(PandaNode *root) {
+  return r_generate(root);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: LODGenerator::r_generate
+//       Access: Private
+//  Description: The recursive implementation of generate().
+////////////////////////////////////////////////////////////////////
+int LODGenerator::
+r_generate(PandaNode *node) {
+  if (node->is_lod_node()) {
+    // Someone has already made levels of detail here.
+    return 0;
+  }
+
+  int count = 0;
+
+  PandaNode::Children children = node->get_children();
+  int num_children = children.get_num_children();
+  for (int i = 0; i < num_children; ++i) {
+    count += r_generate(children.get_child(i));
+  }
+
+  if (node->is_exact_type(GeomNode::get_class_type())) {
+    if (make_lods(DCAST(GeomNode, node))) {
+      ++count;
+    }
+  }
+
+  return count;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: LODGenerator::make_lods
+//       Access: Private
+//  Description: Replaces the geoms of the indicated GeomNode with an
+//               LODNode holding the original geoms and the simplified
+//               levels, if it has enough triangles to simplify.
+//               Returns true if the GeomNode was changed.
+////////////////////////////////////////////////////////////////////
+bool LODGenerator::
+make_lods(GeomNode *geom_node) {
+  int num_geoms = geom_node->get_num_geoms();
+  int num_triangles = 0;
+  int i;
+  for (i = 0; i < num_geoms; ++i) {
+    num_triangles += count_triangles(geom_node->get_geom(i));
+  }
+  if (num_triangles < max(_min_triangles, 1)) {
+    return false;
+  }
+
+  LPoint3 center;
+  PN_stdfloat radius;
+  CPT(BoundingVolume) bounds = geom_node->get_internal_bounds();
+  if (bounds->is_empty() || bounds->is_infinite()) {
+    return false;
+  }
+  if (bounds->is_of_type(BoundingSphere::get_class_type())) {
+    const BoundingSphere *sphere = DCAST(BoundingSphere, bounds);
+    center = sphere->get_center();
+    radius = sphere->get_radius();
+  } else if (bounds->is_of_type(FiniteBoundingVolume::get_class_type())) {
+    const FiniteBoundingVolume *fbv = DCAST(FiniteBoundingVolume, bounds);
+    center = (fbv->get_min() + fbv->get_max()) * 0.5f;
+    radius = (fbv->get_max() - fbv->get_min()).length() * 0.5f;
+  } else {
+    return false;
+  }
+  if (radius <= 0.0f) {
+    return false;
+  }
+
+  PT(LODNode) lod = LODNode::make_default_lod(geom_node->get_name());
+  lod->set_center(center);
+
+  PT(GeomNode) level = new GeomNode(geom_node->get_name());
+  level->add_geoms_from(geom_node);
+  lod->add_child(level);
+
+  PN_stdfloat fraction = 1.0f;
+  PN_stdfloat max_error = _max_error * radius;
+  int level_triangles = num_triangles;
+  for (int li = 0; li < _num_levels; ++li) {
+    fraction *= _fraction;
+    PT(GeomNode) lower = new GeomNode(geom_node->get_name());
+    int lower_triangles = 0;
+    for (i = 0; i < num_geoms; ++i) {
+      PT(Geom) geom = geom_node->get_geom(i)->simplify(fraction, max_error);
+      lower_triangles += count_triangles(geom);
+      lower->add_geom(geom, geom_node->get_geom_state(i));
+    }
+
+    if (lower_triangles > level_triangles * 9 / 10) {
+      // Not worth another level.
+      break;
+    }
+    lod->add_child(lower);
+    level_triangles = lower_triangles;
+    max_error *= 2.0f;
+  }
+
+  int num_levels = lod->get_num_children();
+  if (num_levels < 2) {
+    return false;
+  }
+
+  PN_stdfloat distance = radius * _switch_distance;
+  lod->add_switch(distance, 0.0f);
+  for (i = 1; i < num_levels - 1; ++i) {
+    lod->add_switch(distance * 2.0f, distance);
+    distance *= 2.0f;
+  }
+  lod->add_switch(make_inf(distance), distance);
+
+  if (pgraph_cat.is_debug()) {
+    pgraph_cat.debug()
+      << "Generated " << num_levels - 1 << " levels of detail for "
+      << *geom_node << ", " << num_triangles << " down to "
+      << level_triangles << " triangles\n";
+  }
+
+  geom_node->remove_all_geoms();
+  geom_node->add_child(lod);
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: LODGenerator::count_triangles
+//       Access: Private, Static
+//  Description: Returns the number of triangles drawn by the Geom.
+////////////////////////////////////////////////////////////////////
+int LODGenerator::
+count_triangles(const Geom *geom) {
+  int num_triangles = 0;
+  int num_primitives = geom->get_num_primitives();
+  for (int i = 0; i < num_primitives; ++i) {
+    CPT(GeomPrimitive) prim = geom->get_primitive(i);
+    if (prim->get_primitive_type() == GeomPrimitive::PT_polygons) {
+      num_triangles += prim->get_num_faces();
+    }
+  }
+  return num_triangles;
+}
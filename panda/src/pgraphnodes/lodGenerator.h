@@ -0,0 +1,88 @@
+// Filename: lodGenerator.h
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#ifndef LODGENERATOR_H
+#define LODGENERATOR_H
+
+#include "pandabase.h"
+#include "luse.h"
+
+class PandaNode;
+class GeomNode;
+class Geom;
+
+////////////////////////////////////////////////////////////////////
+//       Class : LODGenerator
+// Description : Walks a scene graph and gives each GeomNode with
+//               enough triangles a set of automatically simplified
+//               levels of detail, so that distant geometry is drawn
+//               with fewer vertices without an artist having to
+//               author each level.
+//
+//               The geoms of each such GeomNode are moved to the
+//               first child of a new LODNode, which is parented to
+//               the GeomNode; the following children hold copies
+//               simplified with Geom::simplify(), each with about
+//               the indicated fraction of the triangles of the one
+//               before.  The simplified levels share the original
+//               vertex data.
+//
+//               The first level is shown out to the switch distance,
+//               given as a multiple of the radius of the GeomNode's
+//               bounding volume, and each level after that is shown
+//               out to twice the distance of the one before.  The
+//               error allowed in each level doubles along with the
+//               distance, so that it stays about the same size on
+//               the screen.  The last level is shown at any greater
+//               distance.
+//
+//               GeomNodes already below an LODNode are left alone.
+////////////////////////////////////////////////////////////////////
+class EXPCL_PANDA_PGRAPHNODES LODGenerator {
+PUBLISHED:
+  LODGenerator();
+
+  INLINE void set_min_triangles(int min_triangles);
+  INLINE int get_min_triangles() const;
+
+  INLINE void set_num_levels(int num_levels);
+  INLINE int get_num_levels() const;
+
+  INLINE void set_fraction(PN_stdfloat fraction);
+  INLINE PN_stdfloat get_fraction() const;
+
+  INLINE void set_max_error(PN_stdfloat max_error);
+  INLINE PN_stdfloat get_max_error() const;
+
+  INLINE void set_switch_distance(PN_stdfloat switch_distance);
+  INLINE PN_stdfloat get_switch_distance() const;
+
+  int generate(PandaNode *root);
+
+private:
+  int r_generate(PandaNode *node);
+  bool make_lods(GeomNode *geom_node);
+  static int count_triangles(const Geom *geom);
+
+private:
+  int _min_triangles;
+  int _num_levels;
+  PN_stdfloat _fraction;
+  PN_stdfloat _max_error;
+  PN_stdfloat _switch_distance;
+};
+
+#include "lodGenerator.I"
+
+#endif
@@ -1,3 +1,4 @@
+#include "lodGenerator.cxx"
 #include "lodNode.cxx"
 #include "lodNodeType.cxx"
 #include "nodeCullCallbackData.cxx"
@@ -66,6 +66,10 @@ public:
 
   virtual TypeHandle get_parent_type() const;
   virtual void output(ostream &out) const;
+
+  // The cycler hands node references from one stage to the next
+  // directly, and needs node_unref_only() to do so.
+  friend class PipelineCyclerTrueImpl;
 };
 
 INLINE ostream &
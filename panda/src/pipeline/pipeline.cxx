@@ -90,7 +90,7 @@ cycle() {
       << "Beginning the pipeline cycle\n";
   }
 
-  pvector< PT(CycleData) > saved_cdatas;
+  pvector<CycleData *> saved_cdatas;
   saved_cdatas.reserve(_num_dirty_cyclers);
   {
     ReMutexHolder holder(_lock);
@@ -103,32 +103,31 @@ cycle() {
     nassertv(!_cycling);
     _cycling = true;
     
-    // Move the dirty list to prev_dirty, for processing.
-    PipelineCyclerLinks prev_dirty;
-    prev_dirty.make_head();
-    prev_dirty.take_list(_dirty);
-    _num_dirty_cyclers = 0;
+    // Walk through the dirty list in place; only those cyclers that
+    // become clean need to be moved, to the clean list.
+    PipelineCyclerLinks *links = _dirty._next;
 
     switch (_num_stages) {
     case 2:
-      while (prev_dirty._next != &prev_dirty) {
-        PipelineCyclerTrueImpl *cycler = (PipelineCyclerTrueImpl *)prev_dirty._next;
-        cycler->remove_from_list();
+      while (links != &_dirty) {
+        PipelineCyclerTrueImpl *cycler = (PipelineCyclerTrueImpl *)links;
+        links = links->_next;
         ReMutexHolder holder2(cycler->_lock);
         
         // We save the result of cycle(), so that we can defer the
         // side-effects that might occur when CycleDatas destruct, at
         // least until the end of this loop.
-        saved_cdatas.push_back(cycler->cycle_2());
+        CycleData *last_val = cycler->cycle_2();
+        if (last_val != (CycleData *)NULL) {
+          saved_cdatas.push_back(last_val);
+        }
         
-        if (cycler->_dirty) {
-          // The cycler is still dirty after cycling.  Keep it on the
-          // dirty list for next time.
-          cycler->insert_before(&_dirty);
-          ++_num_dirty_cyclers;
-        } else {
-          // The cycler is now clean.  Add it back to the clean list.
+        if (!cycler->_dirty) {
+          // The cycler is now clean.  Move it back to the clean list;
+          // otherwise it stays on the dirty list for next time.
+          cycler->remove_from_list();
           cycler->insert_before(&_clean);
+          --_num_dirty_cyclers;
 #ifdef DEBUG_THREADS
           inc_cycler_type(_dirty_cycler_types, cycler->get_parent_type(), -1);
 #endif
@@ -137,18 +136,20 @@ cycle() {
       break;
 
     case 3:
-      while (prev_dirty._next != &prev_dirty) {
-        PipelineCyclerTrueImpl *cycler = (PipelineCyclerTrueImpl *)prev_dirty._next;
-        cycler->remove_from_list();
+      while (links != &_dirty) {
+        PipelineCyclerTrueImpl *cycler = (PipelineCyclerTrueImpl *)links;
+        links = links->_next;
         ReMutexHolder holder2(cycler->_lock);
         
-        saved_cdatas.push_back(cycler->cycle_3());
+        CycleData *last_val = cycler->cycle_3();
+        if (last_val != (CycleData *)NULL) {
+          saved_cdatas.push_back(last_val);
+        }
         
-        if (cycler->_dirty) {
-          cycler->insert_before(&_dirty);
-          ++_num_dirty_cyclers;
-        } else {
+        if (!cycler->_dirty) {
+          cycler->remove_from_list();
           cycler->insert_before(&_clean);
+          --_num_dirty_cyclers;
 #ifdef DEBUG_THREADS
           inc_cycler_type(_dirty_cycler_types, cycler->get_parent_type(), -1);
 #endif
@@ -157,18 +158,20 @@ cycle() {
       break;
 
     default:
-      while (prev_dirty._next != &prev_dirty) {
-        PipelineCyclerTrueImpl *cycler = (PipelineCyclerTrueImpl *)prev_dirty._next;
-        cycler->remove_from_list();
+      while (links != &_dirty) {
+        PipelineCyclerTrueImpl *cycler = (PipelineCyclerTrueImpl *)links;
+        links = links->_next;
         ReMutexHolder holder2(cycler->_lock);
         
-        saved_cdatas.push_back(cycler->cycle());
+        CycleData *last_val = cycler->cycle();
+        if (last_val != (CycleData *)NULL) {
+          saved_cdatas.push_back(last_val);
+        }
         
-        if (cycler->_dirty) {
-          cycler->insert_before(&_dirty);
-          ++_num_dirty_cyclers;
-        } else {
+        if (!cycler->_dirty) {
+          cycler->remove_from_list();
           cycler->insert_before(&_clean);
+          --_num_dirty_cyclers;
 #ifdef DEBUG_THREADS
           inc_cycler_type(_dirty_cycler_types, cycler->get_parent_type(), -1);
 #endif
@@ -178,7 +181,6 @@ cycle() {
     }
       
     // Now we're ready for the next frame.
-    prev_dirty.clear_head();
     _cycling = false;
   }
 
@@ -186,6 +188,10 @@ cycle() {
   // destruct, which may cause cascading deletes, and which will in
   // turn cause PipelineCyclers to remove themselves from (or add
   // themselves to) the _dirty list.
+  pvector<CycleData *>::iterator ci;
+  for (ci = saved_cdatas.begin(); ci != saved_cdatas.end(); ++ci) {
+    unref_delete(*ci);
+  }
   saved_cdatas.clear();
 
   if (pipeline_cat.is_debug()) {
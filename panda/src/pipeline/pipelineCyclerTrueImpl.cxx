@@ -270,22 +270,37 @@ write_stage_upstream(int pipeline_stage, bool force_to_0, Thread *current_thread
 //               is, if all of the pipeline pointers are the same.
 //
 //               The return value is the CycleData pointer which fell
-//               off the end of the cycle.  If this is allowed to
-//               destruct immediately, there may be side-effects that
-//               cascade through the system, so the caller may choose
-//               to hold the pointer until it can safely be released
-//               later.
+//               off the end of the cycle, or NULL if the last stage
+//               did not change.  The caller inherits a reference
+//               (but not a node reference) to this pointer, and
+//               must eventually release it with unref_delete().  If
+//               this is allowed to destruct immediately, there may be
+//               side-effects that cascade through the system, so the
+//               caller may choose to hold the pointer until it can
+//               safely be released later.
 ////////////////////////////////////////////////////////////////////
-PT(CycleData) PipelineCyclerTrueImpl::
+CycleData *PipelineCyclerTrueImpl::
 cycle() {
-  PT(CycleData) last_val = _data[_num_stages - 1]._cdata.p();
-  nassertr(_lock.debug_is_locked(), last_val);
-  nassertr(_dirty, last_val);
+  nassertr(_lock.debug_is_locked(), NULL);
+  nassertr(_dirty, NULL);
 
+  CycleData *last_val = NULL;
   int i;
   for (i = _num_stages - 1; i > 0; --i) {
     nassertr(_data[i]._writes_outstanding == 0, last_val);
-    _data[i]._cdata = _data[i - 1]._cdata;
+    CycleData *new_val = _data[i - 1]._cdata.p();
+    if (_data[i]._cdata.p() != new_val) {
+      new_val->node_ref();
+      CycleData *old_val = _data[i]._cdata.exchange_owned(new_val);
+      if (i == _num_stages - 1) {
+        old_val->node_unref_only();
+        last_val = old_val;
+      } else {
+        // This one was also passed down to stage i + 1 already, so
+        // this can't be the last node reference.
+        old_val->node_unref();
+      }
+    }
   }
 
   for (i = 1; i < _num_stages; ++i) {
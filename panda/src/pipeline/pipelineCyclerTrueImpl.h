@@ -105,9 +105,9 @@ public:
   };
 
 private:
-  PT(CycleData) cycle();
-  INLINE PT(CycleData) cycle_2();
-  INLINE PT(CycleData) cycle_3();
+  CycleData *cycle();
+  INLINE CycleData *cycle_2();
+  INLINE CycleData *cycle_3();
   void set_num_stages(int num_stages);
 
 private:
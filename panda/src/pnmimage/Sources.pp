@@ -5,7 +5,7 @@
 #begin lib_target
   #define TARGET p3pnmimage
   #define LOCAL_LIBS \
-    p3linmath p3putil p3express p3mathutil
+    p3linmath p3putil p3express p3mathutil p3event
 
   #define COMBINED_SOURCES $[TARGET]_composite1.cxx $[TARGET]_composite2.cxx 
 
@@ -59,6 +59,15 @@ ConfigVariableDouble pfm_resize_radius
           "always call box_filter() or gaussian_filter() explicitly with "
           "a specific radius."));
 
+ConfigVariableInt pnm_filter_threads
+("pnm-filter-threads", 0,
+ PRC_DESC("The number of threads that PNMImage::box_filter_from(), "
+          "gaussian_filter_from() and quick_filter_from() may divide the "
+          "rows of a large image among.  These are the threads of the "
+          "\"pnm_filter\" task chain.  0 or 1 filters the whole image "
+          "on the calling thread.  This has no effect unless Panda was "
+          "compiled with true threads."));
+
 ////////////////////////////////////////////////////////////////////
 //     Function: init_libpnmimage
 //  Description: Initializes the library.  This must be called at
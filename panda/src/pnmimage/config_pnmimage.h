@@ -19,6 +19,7 @@
 #include "notifyCategoryProxy.h"
 #include "configVariableBool.h"
 #include "configVariableDouble.h"
+#include "configVariableInt.h"
 
 NotifyCategoryDecl(pnmimage, EXPCL_PANDA_PNMIMAGE, EXPTP_PANDA_PNMIMAGE);
 
@@ -27,6 +28,7 @@ extern ConfigVariableBool pfm_reverse_dimensions;
 extern ConfigVariableBool pfm_resize_gaussian;
 extern ConfigVariableBool pfm_resize_quick;
 extern ConfigVariableDouble pfm_resize_radius;
+extern ConfigVariableInt pnm_filter_threads;
 
 extern EXPCL_PANDA_PNMIMAGE void init_libpnmimage();
 
@@ -39,6 +39,15 @@
 
 #include "pnmImage.h"
 #include "pfmFile.h"
+#include "config_pnmimage.h"
+#include "asyncTaskManager.h"
+#include "asyncTaskChain.h"
+
+#include <algorithm>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 // WorkType is an abstraction that allows the filtering process to be
 // recompiled to use either floating-point or integer arithmetic.  On SGI
@@ -313,218 +322,374 @@ gaussian_filter_impl(double scale, double width,
 }
 
 
-// We have a function, defined in pnm-image-filter-core.cxx, that will scale
-// an image in both X and Y directions for a particular channel, by setting
-// up the temporary matrix appropriately and calling the above functions.
+// The PNMImage filters don't convolve one channel at a time through
+// the functions above.  Instead, all of the channels of a pixel are
+// filtered together as four single-precision floats (red, green,
+// blue and alpha, or gray in the first), which is one SIMD register
+// where SSE is available.  Each axis of the kernel is first reduced
+// to a table of normalized weights for each destination pixel, so
+// the inner loops are nothing but multiply-adds.  The results are
+// within a float's rounding error of the double-precision convolution
+// that filter_row() would compute.
+
+// The rows of each pass are independent, so a large image may be
+// divided among several threads; see pnm-filter-threads.
+
+// One destination pixel along an axis: the range of source pixels
+// that contribute to it, and the index of the first of their weights
+// within the kernel's _weights.
+class FilterSpan {
+public:
+  int _first;
+  int _count;
+  int _weight_index;
+};
+
+// The precomputed weights for filtering an axis of source_len pixels
+// into dest_len pixels.
+class FilterKernel {
+public:
+  void build(int dest_len, int source_len, double width,
+             FilterFunction *make_filter);
+
+  pvector<FilterSpan> _spans;
+  pvector<float> _weights;
+};
+
+// Computes the same weights that filter_row() applies, normalized so
+// that each destination pixel's weights sum to 1.
+void FilterKernel::
+build(int dest_len, int source_len, double width,
+      FilterFunction *make_filter) {
+  double scale = (double)dest_len / (double)source_len;
+
+  WorkType *filter;
+  double filter_width;
+  make_filter(scale, width, filter, filter_width);
 
-// What we really need is a series of such functions, one for each channel,
-// and also one to scale by X first, and one to scale by Y first.  This sounds
-// a lot like a C++ template: we want to compile the same function several
-// times to work on slightly different sorts of things each time.  However,
-// the things we want to vary are the particular member functions of PNMImage
-// that we call (e.g. Red(), Green(), etc.), and we can't declare a template
-// of member functions, only of types.
+  double iscale;
+  if (scale < 1.0) {
+    iscale = 1.0;
+    filter_width /= scale;
+  } else {
+    iscale = scale;
+  }
 
-// It's doable using templates.  It would involve the declaration of
-// lots of silly little functor objects.  This is much more compact
-// and no more difficult to read.
+  _spans.resize(dest_len);
+  _weights.clear();
+  pvector<double> weights;
 
-// The function in pnm-image-filter-core.cxx uses macros to access the member
-// functions of PNMImage.  Hence, we only need to redefine those macros
-// with each instance of the function to cause each instance to operate on
-// the correct member.
+  for (int dest_x = 0; dest_x < dest_len; dest_x++) {
+    double center = (dest_x + 0.5) / scale - 0.5;
+    int left = max((int)cfloor(center - filter_width), 0);
+    int right = min((int)cceil(center + filter_width), source_len - 1);
+    int right_center = (int)cceil(center);
 
+    weights.clear();
+    WorkType net_weight = 0;
+    int source_x;
+    for (source_x = left; source_x <= right; source_x++) {
+      int index;
+      if (source_x < right_center) {
+        index = (int)(iscale * (center - source_x) + 0.5);
+      } else {
+        index = (int)(iscale * (source_x - center) + 0.5);
+      }
+      weights.push_back(filter[index]);
+      net_weight += filter[index];
+    }
 
-// These instances scale by X first, then by Y.
+    FilterSpan &span = _spans[dest_x];
+    span._first = left;
+    span._count = 0;
+    span._weight_index = (int)_weights.size();
+    if (net_weight > 0) {
+      span._count = (int)weights.size();
+      for (size_t i = 0; i < weights.size(); ++i) {
+        _weights.push_back((float)(weights[i] / net_weight));
+      }
+    }
+  }
 
-#define FUNCTION_NAME filter_red_xy
-#define IMAGETYPE PNMImage
-#define ASIZE get_x_size
-#define BSIZE get_y_size
-#define GETVAL(a, b, channel) get_red(a, b)
-#define SETVAL(a, b, channel, v) set_red(a, b, v)
-#include "pnm-image-filter-core.cxx"
-#undef SETVAL
-#undef GETVAL
-#undef BSIZE
-#undef ASIZE
-#undef IMAGETYPE
-#undef FUNCTION_NAME
+  PANDA_FREE_ARRAY(filter);
+}
 
-#define FUNCTION_NAME filter_green_xy
-#define IMAGETYPE PNMImage
-#define ASIZE get_x_size
-#define BSIZE get_y_size
-#define GETVAL(a, b, channel) get_green(a, b)
-#define SETVAL(a, b, channel, v) set_green(a, b, v)
-#include "pnm-image-filter-core.cxx"
-#undef SETVAL
-#undef GETVAL
-#undef BSIZE
-#undef ASIZE
-#undef IMAGETYPE
-#undef FUNCTION_NAME
+// Adds weight * source to the four floats of dest.
+INLINE void
+accumulate_pixel(float *dest, const float *source, float weight) {
+#ifdef __SSE2__
+  __m128 w = _mm_set1_ps(weight);
+  _mm_storeu_ps(dest, _mm_add_ps(_mm_loadu_ps(dest),
+                                 _mm_mul_ps(w, _mm_loadu_ps(source))));
+#else
+  dest[0] += weight * source[0];
+  dest[1] += weight * source[1];
+  dest[2] += weight * source[2];
+  dest[3] += weight * source[3];
+#endif  // __SSE2__
+}
 
-#define FUNCTION_NAME filter_blue_xy
-#define IMAGETYPE PNMImage
-#define ASIZE get_x_size
-#define BSIZE get_y_size
-#define GETVAL(a, b, channel) get_blue(a, b)
-#define SETVAL(a, b, channel, v) set_blue(a, b, v)
-#include "pnm-image-filter-core.cxx"
-#undef SETVAL
-#undef GETVAL
-#undef BSIZE
-#undef ASIZE
-#undef IMAGETYPE
-#undef FUNCTION_NAME
+// Adds weight * source to each of the num_pixels pixels of dest.
+static void
+accumulate_row(float *dest, const float *source, int num_pixels,
+               float weight) {
+#ifdef __SSE2__
+  __m128 w = _mm_set1_ps(weight);
+  float *dest_end = dest + num_pixels * 4;
+  while (dest < dest_end) {
+    _mm_storeu_ps(dest, _mm_add_ps(_mm_loadu_ps(dest),
+                                   _mm_mul_ps(w, _mm_loadu_ps(source))));
+    dest += 4;
+    source += 4;
+  }
+#else
+  int num_values = num_pixels * 4;
+  for (int i = 0; i < num_values; ++i) {
+    dest[i] += weight * source[i];
+  }
+#endif  // __SSE2__
+}
 
-#define FUNCTION_NAME filter_gray_xy
-#define IMAGETYPE PNMImage
-#define ASIZE get_x_size
-#define BSIZE get_y_size
-#define GETVAL(a, b, channel) get_bright(a, b)
-#define SETVAL(a, b, channel, v) set_xel(a, b, v)
-#include "pnm-image-filter-core.cxx"
-#undef SETVAL
-#undef GETVAL
-#undef BSIZE
-#undef ASIZE
-#undef IMAGETYPE
-#undef FUNCTION_NAME
+// Filters a row of pixels along its length.
+static void
+filter_pixel_row(float *dest, const float *source,
+                 const FilterKernel &kernel) {
+  int dest_len = (int)kernel._spans.size();
+  for (int dest_x = 0; dest_x < dest_len; dest_x++) {
+    const FilterSpan &span = kernel._spans[dest_x];
+    float *pixel = dest + dest_x * 4;
+    pixel[0] = pixel[1] = pixel[2] = pixel[3] = 0.0f;
+
+    const float *weight = &kernel._weights[0] + span._weight_index;
+    const float *from = source + span._first * 4;
+    for (int i = 0; i < span._count; ++i) {
+      accumulate_pixel(pixel, from, weight[i]);
+      from += 4;
+    }
+  }
+}
 
-#define FUNCTION_NAME filter_alpha_xy
-#define IMAGETYPE PNMImage
-#define ASIZE get_x_size
-#define BSIZE get_y_size
-#define GETVAL(a, b, channel) get_alpha(a, b)
-#define SETVAL(a, b, channel, v) set_alpha(a, b, v)
-#include "pnm-image-filter-core.cxx"
-#undef SETVAL
-#undef GETVAL
-#undef BSIZE
-#undef ASIZE
-#undef IMAGETYPE
-#undef FUNCTION_NAME
+// The parameters shared by all of the rows of one filter operation.
+class PixelFilter {
+public:
+  PNMImage *_dest;
+  const PNMImage *_source;
+  bool _gray;
+  bool _alpha;
+  FilterKernel _x_kernel;
+  FilterKernel _y_kernel;
+
+  // The image after the first pass.
+  pvector<float> _matrix;
+  int _matrix_x_size;
+};
+
+// Reads row y of the source image into four floats per pixel, scaled
+// to the range 0..1.
+static void
+load_pixel_row(float *row, const PixelFilter &pf, int y) {
+  const PNMImage &source = *pf._source;
+  int x_size = source.get_x_size();
+  float scale = 1.0f / (float)source.get_maxval();
+
+  for (int x = 0; x < x_size; ++x) {
+    float *pixel = row + x * 4;
+    if (pf._gray) {
+      pixel[0] = (float)source.get_bright(x, y);
+      pixel[1] = pixel[2] = 0.0f;
+    } else {
+      const xel &v = source.get_xel_val(x, y);
+      pixel[0] = (float)PPM_GETR(v) * scale;
+      pixel[1] = (float)PPM_GETG(v) * scale;
+      pixel[2] = (float)PPM_GETB(v) * scale;
+    }
+    pixel[3] = pf._alpha ? (float)source.get_alpha_val(x, y) * scale : 0.0f;
+  }
+}
 
+// Writes four floats per pixel into row y of the dest image.
+static void
+store_pixel_row(const float *row, const PixelFilter &pf, int y) {
+  PNMImage &dest = *pf._dest;
+  int x_size = dest.get_x_size();
+
+  for (int x = 0; x < x_size; ++x) {
+    const float *pixel = row + x * 4;
+    if (pf._gray) {
+      dest.set_xel(x, y, pixel[0]);
+    } else {
+      dest.set_xel_val(x, y, dest.to_val(pixel[0]), dest.to_val(pixel[1]),
+                       dest.to_val(pixel[2]));
+    }
+    if (pf._alpha) {
+      dest.set_alpha_val(x, y, dest.to_val(pixel[3]));
+    }
+  }
+}
 
-// These instances scale by Y first, then by X.
+// When the image is filtered by X first, the first pass filters each
+// source row across into the matrix, which has the source's height
+// and the dest's width.
+static void
+filter_rows_x(void *data, int begin, int end) {
+  PixelFilter &pf = *(PixelFilter *)data;
+  pvector<float> row(pf._source->get_x_size() * 4);
+  for (int y = begin; y < end; ++y) {
+    load_pixel_row(&row[0], pf, y);
+    filter_pixel_row(&pf._matrix[(size_t)y * pf._matrix_x_size * 4], &row[0],
+                     pf._x_kernel);
+    Thread::consider_yield();
+  }
+}
 
-#define FUNCTION_NAME filter_red_yx
-#define IMAGETYPE PNMImage
-#define ASIZE get_y_size
-#define BSIZE get_x_size
-#define GETVAL(a, b, channel) get_red(b, a)
-#define SETVAL(a, b, channel, v) set_red(b, a, v)
-#include "pnm-image-filter-core.cxx"
-#undef SETVAL
-#undef GETVAL
-#undef BSIZE
-#undef ASIZE
-#undef IMAGETYPE
-#undef FUNCTION_NAME
+// ...and the second pass filters the matrix rows down into each dest
+// row.
+static void
+filter_columns_matrix(void *data, int begin, int end) {
+  PixelFilter &pf = *(PixelFilter *)data;
+  int x_size = pf._matrix_x_size;
+  pvector<float> row(x_size * 4);
+  for (int y = begin; y < end; ++y) {
+    fill(row.begin(), row.end(), 0.0f);
+    const FilterSpan &span = pf._y_kernel._spans[y];
+    const float *weight = &pf._y_kernel._weights[0] + span._weight_index;
+    for (int i = 0; i < span._count; ++i) {
+      accumulate_row(&row[0], &pf._matrix[(size_t)(span._first + i) * x_size * 4],
+                     x_size, weight[i]);
+    }
+    store_pixel_row(&row[0], pf, y);
+    Thread::consider_yield();
+  }
+}
 
-#define FUNCTION_NAME filter_green_yx
-#define IMAGETYPE PNMImage
-#define ASIZE get_y_size
-#define BSIZE get_x_size
-#define GETVAL(a, b, channel) get_green(b, a)
-#define SETVAL(a, b, channel, v) set_green(b, a, v)
-#include "pnm-image-filter-core.cxx"
-#undef SETVAL
-#undef GETVAL
-#undef BSIZE
-#undef ASIZE
-#undef IMAGETYPE
-#undef FUNCTION_NAME
+// When the image is filtered by Y first, the first pass filters the
+// source rows down into each row of the matrix, which has the dest's
+// height and the source's width.
+static void
+filter_columns_source(void *data, int begin, int end) {
+  PixelFilter &pf = *(PixelFilter *)data;
+  int x_size = pf._matrix_x_size;
+  pvector<float> source_row(x_size * 4);
+  for (int y = begin; y < end; ++y) {
+    float *row = &pf._matrix[(size_t)y * x_size * 4];
+    fill(row, row + x_size * 4, 0.0f);
+    const FilterSpan &span = pf._y_kernel._spans[y];
+    const float *weight = &pf._y_kernel._weights[0] + span._weight_index;
+    for (int i = 0; i < span._count; ++i) {
+      load_pixel_row(&source_row[0], pf, span._first + i);
+      accumulate_row(row, &source_row[0], x_size, weight[i]);
+    }
+    Thread::consider_yield();
+  }
+}
 
-#define FUNCTION_NAME filter_blue_yx
-#define IMAGETYPE PNMImage
-#define ASIZE get_y_size
-#define BSIZE get_x_size
-#define GETVAL(a, b, channel) get_blue(b, a)
-#define SETVAL(a, b, channel, v) set_blue(b, a, v)
-#include "pnm-image-filter-core.cxx"
-#undef SETVAL
-#undef GETVAL
-#undef BSIZE
-#undef ASIZE
-#undef IMAGETYPE
-#undef FUNCTION_NAME
+// ...and the second pass filters each matrix row across into the
+// dest row.
+static void
+filter_rows_matrix(void *data, int begin, int end) {
+  PixelFilter &pf = *(PixelFilter *)data;
+  pvector<float> row(pf._dest->get_x_size() * 4);
+  for (int y = begin; y < end; ++y) {
+    filter_pixel_row(&row[0], &pf._matrix[(size_t)y * pf._matrix_x_size * 4],
+                     pf._x_kernel);
+    store_pixel_row(&row[0], pf, y);
+    Thread::consider_yield();
+  }
+}
 
-#define FUNCTION_NAME filter_gray_yx
-#define IMAGETYPE PNMImage
-#define ASIZE get_y_size
-#define BSIZE get_x_size
-#define GETVAL(a, b, channel) get_bright(b, a)
-#define SETVAL(a, b, channel, v) set_xel(b, a, v)
-#include "pnm-image-filter-core.cxx"
-#undef SETVAL
-#undef GETVAL
-#undef BSIZE
-#undef ASIZE
-#undef IMAGETYPE
-#undef FUNCTION_NAME
+typedef void FilterRowsFunc(void *data, int begin, int end);
 
-#define FUNCTION_NAME filter_alpha_yx
-#define IMAGETYPE PNMImage
-#define ASIZE get_y_size
-#define BSIZE get_x_size
-#define GETVAL(a, b, channel) get_alpha(b, a)
-#define SETVAL(a, b, channel, v) set_alpha(b, a, v)
-#include "pnm-image-filter-core.cxx"
-#undef SETVAL
-#undef GETVAL
-#undef BSIZE
-#undef ASIZE
-#undef IMAGETYPE
-#undef FUNCTION_NAME
+// The rows passed to filter_rows_parallel(), for the tasks that
+// process them.
+class FilterRows {
+public:
+  FilterRowsFunc *_func;
+  void *_data;
+};
+
+static void
+filter_row_range(int begin, int end, void *user_data) {
+  FilterRows *rows = (FilterRows *)user_data;
+  (*rows->_func)(rows->_data, begin, end);
+}
+
+// Calls func() for the rows 0 .. num_rows - 1, dividing them into
+// contiguous ranges among the pnm-filter-threads threads of the
+// "pnm_filter" task chain.  Returns when all of the rows have been
+// processed.  num_values is the approximate amount of work per row,
+// used to decide whether the image is worth dividing.
+static void
+filter_rows_parallel(FilterRowsFunc *func, void *data, int num_rows,
+                     int num_values) {
+  // Don't bother with threads for less than a quarter million values
+  // or so; handing out the rows would cost more than it saves.
+  static const int min_values_per_thread = 0x40000;
+
+  int num_threads = min((int)pnm_filter_threads, num_rows);
+  if (num_values > 0) {
+    num_threads = min(num_threads,
+                      (int)(((double)num_rows * num_values) / min_values_per_thread));
+  }
+  if (num_threads <= 1 || !Thread::is_true_threads()) {
+    (*func)(data, 0, num_rows);
+    return;
+  }
 
+  AsyncTaskManager *task_mgr = AsyncTaskManager::get_global_ptr();
+  AsyncTaskChain *chain = task_mgr->make_task_chain("pnm_filter");
+  if (chain->get_num_threads() != (int)pnm_filter_threads) {
+    chain->set_num_threads(pnm_filter_threads);
+  }
+
+  FilterRows rows;
+  rows._func = func;
+  rows._data = data;
+  int grain_size = (num_rows + num_threads - 1) / num_threads;
+  chain->parallel_for_join("pnm_filter", 0, num_rows, grain_size,
+                           &filter_row_range, &rows);
+}
 
 // filter_image pulls everything together, and filters one image into
 // another.  Both images can be the same with no ill effects.
 static void
 filter_image(PNMImage &dest, const PNMImage &source,
              double width, FilterFunction *make_filter) {
+  if (!dest.is_valid() || !source.is_valid()) {
+    return;
+  }
 
-  // We want to scale by the smallest destination axis first, for a
-  // slight performance gain.
+  PixelFilter pf;
+  pf._dest = &dest;
+  pf._source = &source;
+  pf._gray = (dest.is_grayscale() || source.is_grayscale());
+  pf._alpha = (dest.has_alpha() && source.has_alpha());
+  pf._x_kernel.build(dest.get_x_size(), source.get_x_size(), width, make_filter);
+  pf._y_kernel.build(dest.get_y_size(), source.get_y_size(), width, make_filter);
 
-  // In the PNMImage case (unlike the PfmFile case), the channel
-  // parameter is not used.  We *could* use it to avoid the
-  // replication of quite so many functions, but we replicate them
-  // anyway, for another tiny performance gain.
+  // We want to scale by the smallest destination axis first, for a
+  // slight performance gain.  Either way, the first pass is finished
+  // by all threads before the second pass begins, so that the dest
+  // image may be the same as the source image.
 
   if (dest.get_x_size() <= dest.get_y_size()) {
-    if (dest.is_grayscale() || source.is_grayscale()) {
-      filter_gray_xy(dest, source, width, make_filter, 0);
-    } else {
-      filter_red_xy(dest, source, width, make_filter, 0);
-      filter_green_xy(dest, source, width, make_filter, 0);
-      filter_blue_xy(dest, source, width, make_filter, 0);
-    }
-
-    if (dest.has_alpha() && source.has_alpha()) {
-      filter_alpha_xy(dest, source, width, make_filter, 0);
-    }
+    pf._matrix_x_size = dest.get_x_size();
+    pf._matrix.resize((size_t)pf._matrix_x_size * source.get_y_size() * 4);
+    filter_rows_parallel(&filter_rows_x, &pf, source.get_y_size(),
+                         source.get_x_size() * 4);
+    filter_rows_parallel(&filter_columns_matrix, &pf, dest.get_y_size(),
+                         dest.get_x_size() * 4);
 
   } else {
-    if (dest.is_grayscale() || source.is_grayscale()) {
-      filter_gray_yx(dest, source, width, make_filter, 0);
-    } else {
-      filter_red_yx(dest, source, width, make_filter, 0);
-      filter_green_yx(dest, source, width, make_filter, 0);
-      filter_blue_yx(dest, source, width, make_filter, 0);
-    }
-
-    if (dest.has_alpha() && source.has_alpha()) {
-      filter_alpha_yx(dest, source, width, make_filter, 0);
-    }
+    pf._matrix_x_size = source.get_x_size();
+    pf._matrix.resize((size_t)pf._matrix_x_size * dest.get_y_size() * 4);
+    filter_rows_parallel(&filter_columns_source, &pf, dest.get_y_size(),
+                         source.get_x_size() * 4);
+    filter_rows_parallel(&filter_rows_matrix, &pf, dest.get_y_size(),
+                         source.get_x_size() * 4);
   }
 }
 
 
-
 ////////////////////////////////////////////////////////////////////
 //     Function: PNMImage::box_filter_from
 //       Access: Public
@@ -553,10 +718,17 @@ gaussian_filter_from(double width, const PNMImage &copy) {
   filter_image(*this, copy, width, &gaussian_filter_impl);
 }
 
-// Now we do it again, this time for PfmFile.  In this case we also
-// need to support the sparse variants, since PfmFiles can be
-// incomplete.  However, we don't need to have a different function
-// for each channel.
+// For PfmFile, we have a function, defined in
+// pnm-image-filter-core.cxx, that will scale an image in both X and Y
+// directions for a particular channel, by setting up the temporary
+// matrix appropriately and calling filter_row(), above.  We need one
+// instance of it to scale by X first, and one to scale by Y first.
+
+// The function in pnm-image-filter-core.cxx uses macros to access the
+// member functions of PfmFile.  Hence, we only need to redefine those
+// macros with each instance of the function to cause each instance to
+// operate on the correct member.  We also need to support the sparse
+// variants, since PfmFiles can be incomplete.
 
 #define FUNCTION_NAME filter_pfm_xy
 #define IMAGETYPE PfmFile
@@ -775,6 +947,48 @@ box_filter_region(const PNMImage &image,
   alpha_result = (xelval)(alpha / pixel_count + 0.5);
 }
 
+// The parameters of quick_filter_from(), shared by all of its rows.
+class QuickFilter {
+public:
+  PNMImage *_dest;
+  const PNMImage *_from;
+  int _to_xoff, _to_yoff;
+  int _x_begin, _x_end;
+  int _y_begin;
+  double _x_scale, _y_scale;
+};
+
+// Filters the dest rows _y_begin + begin .. _y_begin + end - 1.
+static void
+quick_filter_rows(void *data, int begin, int end) {
+  const QuickFilter &qf = *(const QuickFilter *)data;
+  PNMImage &dest = *qf._dest;
+
+  for (int to_y = qf._y_begin + begin; to_y < qf._y_begin + end; to_y++) {
+    double from_y0 = to_y * qf._y_scale;
+    double from_y1 = (to_y+1) * qf._y_scale;
+
+    double from_x0 = qf._x_begin * qf._x_scale;
+    for (int to_x = qf._x_begin; to_x < qf._x_end; to_x++) {
+      double from_x1 = (to_x+1) * qf._x_scale;
+
+      // Now the box from (from_x0, from_y0) - (from_x1, from_y1)
+      // but not including (from_x1, from_y1) maps to the pixel (to_x, to_y).
+      xelval alpha_result;
+      box_filter_region(*qf._from,
+                        from_x0, from_y0, from_x1, from_y1,
+                        dest[qf._to_yoff + to_y][qf._to_xoff + to_x],
+                        alpha_result);
+      if (dest.has_alpha()) {
+        dest.set_alpha_val(qf._to_xoff+to_x, qf._to_yoff+to_y, alpha_result);
+      }
+
+      from_x0 = from_x1;
+    }
+    Thread::consider_yield();
+  }
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: PNMImage::quick_filter_from
 //       Access: Public
@@ -786,6 +1000,9 @@ box_filter_region(const PNMImage &image,
 //               specified, they will further restrict the size of the
 //               resulting image. There's no point in using
 //               quick_box_filter() on a single image.
+//
+//               The rows of a large image may be divided among
+//               several threads; see pnm-filter-threads.
 ////////////////////////////////////////////////////////////////////
 void PNMImage::
 quick_filter_from(const PNMImage &from, int xborder, int yborder) {
@@ -795,41 +1012,22 @@ quick_filter_from(const PNMImage &from, int xborder, int yborder) {
   int to_xs = get_x_size() - xborder;
   int to_ys = get_y_size() - yborder;
 
-  int to_xoff = xborder / 2;
-  int to_yoff = yborder / 2;
-
-  double from_x0, from_x1, from_y0, from_y1;
-  int to_x, to_y;
-
-  double x_scale = (double)from_xs / (double)to_xs;
-  double y_scale = (double)from_ys / (double)to_ys;
-
-  from_y0 = max(0, -to_yoff) * y_scale;
-  for (to_y = max(0, -to_yoff);
-       to_y < min(to_ys, get_y_size()-to_yoff);
-       to_y++) {
-    from_y1 = (to_y+1) * y_scale;
-
-    from_x0 = max(0, -to_xoff) * x_scale;
-    for (to_x = max(0, -to_xoff);
-         to_x < min(to_xs, get_x_size()-to_xoff);
-         to_x++) {
-      from_x1 = (to_x+1) * x_scale;
-
-      // Now the box from (from_x0, from_y0) - (from_x1, from_y1)
-      // but not including (from_x1, from_y1) maps to the pixel (to_x, to_y).
-      xelval alpha_result;
-      box_filter_region(from,
-                        from_x0, from_y0, from_x1, from_y1,
-                        (*this)[to_yoff + to_y][to_xoff + to_x],
-                        alpha_result);
-      if (has_alpha()) {
-        set_alpha_val(to_xoff+to_x, to_yoff+to_y, alpha_result);
-      }
-
-      from_x0 = from_x1;
-    }
-    from_y0 = from_y1;
-    Thread::consider_yield();
+  QuickFilter qf;
+  qf._dest = this;
+  qf._from = &from;
+  qf._to_xoff = xborder / 2;
+  qf._to_yoff = yborder / 2;
+  qf._x_scale = (double)from_xs / (double)to_xs;
+  qf._y_scale = (double)from_ys / (double)to_ys;
+  qf._x_begin = max(0, -qf._to_xoff);
+  qf._x_end = min(to_xs, get_x_size()-qf._to_xoff);
+  qf._y_begin = max(0, -qf._to_yoff);
+  int y_end = min(to_ys, get_y_size()-qf._to_yoff);
+
+  if (y_end > qf._y_begin) {
+    // Each dest row reads about y_scale rows of the source.
+    int num_values = (int)(from_xs * max(qf._y_scale, 1.0)) * 4;
+    filter_rows_parallel(&quick_filter_rows, &qf, y_end - qf._y_begin,
+                         num_values);
   }
 }
@@ -20,6 +20,7 @@
 #include "config_pnmimage.h"
 #include "perlinNoise2.h"
 #include "stackedPerlinNoise2.h"
+#include "thread.h"
 #include <algorithm>
 
 ////////////////////////////////////////////////////////////////////
@@ -343,6 +344,125 @@ read(PNMReader *reader) {
   return true;
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: PNMImage::read_region
+//       Access: Published
+//  Description: Reads only the rectangle of the indicated image file
+//               that begins at pixel (x, y) and is x_size by y_size
+//               pixels, clipped to the size of the image.  The
+//               rectangle becomes the whole of this image.  Returns
+//               true if successful, false on error.
+//
+//               This is intended for processing an image that is too
+//               large to hold in memory all at once, a band or tile
+//               at a time.  The read size, if any, is ignored.
+////////////////////////////////////////////////////////////////////
+bool PNMImage::
+read_region(const Filename &filename, int x, int y, int x_size, int y_size,
+            PNMFileType *type, bool report_unknown_type) {
+  PNMReader *reader = make_reader(filename, type, report_unknown_type);
+  if (reader == (PNMReader *)NULL) {
+    clear();
+    return false;
+  }
+
+  return read_region(reader, x, y, x_size, y_size);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PNMImage::read_region
+//       Access: Published
+//  Description: This flavor of read_region() uses an already-existing
+//               PNMReader to read the rectangle.  
+//
+//               If the reader supports reading a row at a time (PNM,
+//               non-interlaced PNG, TIFF, and several others do), the
+//               file is read only as far as the last row of the
+//               rectangle, and only one full row is held in memory
+//               besides the rectangle itself.  Otherwise, the whole
+//               image must be read first and the rectangle copied
+//               out of it.
+//
+//               The PNMReader is always deleted upon completion,
+//               whether successful or not.
+////////////////////////////////////////////////////////////////////
+bool PNMImage::
+read_region(PNMReader *reader, int x, int y, int x_size, int y_size) {
+  clear();
+
+  if (reader == NULL) {
+    return false;
+  }
+
+  if (!reader->is_valid()) {
+    delete reader;
+    return false;
+  }
+
+  int orig_x_size = reader->get_x_size();
+  int orig_y_size = reader->get_y_size();
+  int x_end = min(x + x_size, orig_x_size);
+  int y_end = min(y + y_size, orig_y_size);
+  x = max(x, 0);
+  y = max(y, 0);
+  if (x >= x_end || y >= y_end) {
+    delete reader;
+    return false;
+  }
+
+  if (reader->is_floating_point() || !reader->supports_read_row()) {
+    // We have no choice but to read the whole image.
+    PNMImage image;
+    if (!image.read(reader)) {
+      return false;
+    }
+    clear(x_end - x, y_end - y, image.get_num_channels(),
+          image.get_maxval(), image.get_type());
+    copy_sub_image(image, 0, 0, x, y, x_end - x, y_end - y);
+    return true;
+  }
+
+  reader->prepare_read();
+  clear(x_end - x, y_end - y, reader->get_num_channels(),
+        reader->get_maxval(), reader->get_type());
+  _comment = reader->get_comment();
+
+  // Each row is read in full into this buffer, and then the part of
+  // it within the rectangle is copied out.
+  xel *row_array = (xel *)PANDA_MALLOC_ARRAY(orig_x_size * sizeof(xel));
+  xelval *row_alpha = (xelval *)PANDA_MALLOC_ARRAY(orig_x_size * sizeof(xelval));
+
+  int yi;
+  for (yi = 0; yi < y_end; ++yi) {
+    if (!reader->read_row(row_array, row_alpha, orig_x_size, orig_y_size)) {
+      break;
+    }
+    if (yi >= y) {
+      int row = (yi - y) * _x_size;
+      memcpy(_array + row, row_array + x, _x_size * sizeof(xel));
+      if (has_alpha()) {
+        memcpy(_alpha + row, row_alpha + x, _x_size * sizeof(xelval));
+      }
+    }
+    Thread::consider_yield();
+  }
+
+  PANDA_FREE_ARRAY(row_array);
+  PANDA_FREE_ARRAY(row_alpha);
+  delete reader;
+
+  if (yi <= y) {
+    // We didn't get any of the rows we wanted.
+    clear();
+    return false;
+  }
+
+  // As in read(), a truncated file leaves us with fewer rows.
+  _y_size = yi - y;
+  setup_rc();
+  return true;
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: PNMImage::write
 //       Access: Published
@@ -99,6 +99,12 @@ PUBLISHED:
                      PNMFileType *type = NULL,
                      bool report_unknown_type = true);
   BLOCKING bool read(PNMReader *reader);
+  BLOCKING bool read_region(const Filename &filename,
+                            int x, int y, int x_size, int y_size,
+                            PNMFileType *type = NULL,
+                            bool report_unknown_type = true);
+  BLOCKING bool read_region(PNMReader *reader,
+                            int x, int y, int x_size, int y_size);
 
   BLOCKING bool write(const Filename &filename, PNMFileType *type = NULL) const;
   BLOCKING bool write(ostream &data, const string &filename = string(),
@@ -194,6 +194,9 @@ Reader(PNMFileType *type, istream *file, bool owns_file, string magic_number) :
 {
   _png = NULL;
   _info = NULL;
+  _interlaced = false;
+  _row = NULL;
+  _rows_read = 0;
   _is_valid = false;
 
   _png = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL,
@@ -227,14 +230,16 @@ Reader(PNMFileType *type, istream *file, bool owns_file, string magic_number) :
   png_uint_32 height;
   int bit_depth;
   int color_type;
+  int interlace_type;
 
   png_get_IHDR(_png, _info, &width, &height,
-               &bit_depth, &color_type, NULL, NULL, NULL);
+               &bit_depth, &color_type, &interlace_type, NULL, NULL);
 
   pnmimage_png_cat.debug()
     << "width = " << width << " height = " << height << " bit_depth = "
     << bit_depth << " color_type = " << color_type << "\n";
 
+  _interlaced = (interlace_type != PNG_INTERLACE_NONE);
   _x_size = width;
   _y_size = height;
   _maxval = ( 1 << bit_depth ) - 1;
@@ -290,6 +295,11 @@ Reader(PNMFileType *type, istream *file, bool owns_file, string magic_number) :
     }
   }
 
+  if (_interlaced) {
+    // An interlaced file must be read all at once, by read_data().
+    png_set_interlace_handling(_png);
+  }
+
   png_read_update_info(_png, _info);
 }
 
@@ -301,6 +311,10 @@ Reader(PNMFileType *type, istream *file, bool owns_file, string magic_number) :
 PNMFileTypePNG::Reader::
 ~Reader() {
   free_png();
+  if (_row != (png_bytep)NULL) {
+    PANDA_FREE_ARRAY(_row);
+    _row = NULL;
+  }
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -322,6 +336,13 @@ read_data(xel *array, xelval *alpha_data) {
     return 0;
   }
 
+  if (supports_read_row()) {
+    // A non-interlaced file can be read a row at a time, which
+    // saves holding a second copy of the whole image, and lets the
+    // base class reduce it as it goes if a read size was requested.
+    return PNMReader::read_data(array, alpha_data);
+  }
+
   if (setjmp(_jmpbuf)) {
     // This is the ANSI C way to handle exceptions.  If setjmp(),
     // above, returns true, it means that libpng detected an exception
@@ -344,9 +365,8 @@ read_data(xel *array, xelval *alpha_data) {
   }
     
   // We need to read a full copy of the image in first, in libpng's
-  // 2-d array format, mainly because we keep array and alpha data
-  // separately, and there doesn't appear to be good support to get
-  // this stuff out row-at-a-time for interlaced files.
+  // 2-d array format, because there doesn't appear to be good support
+  // to get this stuff out row-at-a-time for interlaced files.
   png_bytep *rows = (png_bytep *)PANDA_MALLOC_ARRAY(num_rows * sizeof(png_bytep));
   int yi;
 
@@ -356,69 +376,74 @@ read_data(xel *array, xelval *alpha_data) {
 
   png_read_image(_png, rows);
 
-  bool get_color = !is_grayscale();
-  bool get_alpha = has_alpha();
-
-  int pi = 0;
   for (yi = 0; yi < num_rows; yi++) {
-    png_bytep source = rows[yi];
-    for (int xi = 0; xi < _x_size; xi++) {
-      int red = 0;
-      int green = 0;
-      int blue = 0;
-      int alpha = 0;
-
-      if (_maxval > 255) {
-        if (get_color) {
-          red = (source[0] << 8) | source[1];
-          source += 2;
-
-          green = (source[0] << 8) | source[1];
-          source += 2;
-        }
+    convert_row(rows[yi], array + yi * _x_size, alpha_data + yi * _x_size,
+                _x_size);
+    PANDA_FREE_ARRAY(rows[yi]);
+  }
 
-        blue = (source[0] << 8) | source[1];
-        source += 2;
+  PANDA_FREE_ARRAY(rows);
 
-        if (get_alpha) {
-          alpha = (source[0] << 8) | source[1];
-          source += 2;
-        }
-        
-      } else {
-        if (get_color) {
-          red = *source;
-          source++;
+  png_read_end(_png, NULL);
 
-          green = *source;
-          source++;
-        }
+  return _y_size;
+}
 
-        blue = *source;
-        source++;
+////////////////////////////////////////////////////////////////////
+//     Function: PNMFileTypePNG::Reader::supports_read_row
+//       Access: Public, Virtual
+//  Description: Returns true if this particular PNMReader is capable
+//               of returning the data one row at a time, via repeated
+//               calls to read_row().  Returns false if the only way
+//               to read from this file is all at once, via
+//               read_data().
+//
+//               This is true for all but interlaced PNG files, whose
+//               rows are not complete until the last pass has been
+//               read.
+////////////////////////////////////////////////////////////////////
+bool PNMFileTypePNG::Reader::
+supports_read_row() const {
+  return _is_valid && !_interlaced;
+}
 
-        if (get_alpha) {
-          alpha = *source;
-          source++;
-        }
-      }
-      
-      PPM_ASSIGN(array[pi], red, green, blue);
-      if (get_alpha) {
-        alpha_data[pi] = alpha;
-      }
-      pi++;
-    }
+////////////////////////////////////////////////////////////////////
+//     Function: PNMFileTypePNG::Reader::read_row
+//       Access: Public, Virtual
+//  Description: If supports_read_row(), above, returns true, this
+//               function may be called repeatedly to read the image,
+//               one horizontal row at a time, beginning from the top.
+//               Returns true if the row is successfully read, false
+//               if there is an error or end of file.
+////////////////////////////////////////////////////////////////////
+bool PNMFileTypePNG::Reader::
+read_row(xel *array, xelval *alpha_data, int x_size, int y_size) {
+  if (!is_valid() || _rows_read >= y_size) {
+    return false;
+  }
 
-    nassertr(source <= rows[yi] + row_byte_length, yi);
-    PANDA_FREE_ARRAY(rows[yi]);
+  if (setjmp(_jmpbuf)) {
+    // libpng detected an exception while reading the row.
+    free_png();
+    return false;
   }
 
-  PANDA_FREE_ARRAY(rows);
+  if (_row == (png_bytep)NULL) {
+    // We only need the one row of libpng data; png_read_update_info()
+    // has already accounted for the transforms in the row size.
+    size_t row_byte_length = png_get_rowbytes(_png, _info);
+    _row = (png_bytep)PANDA_MALLOC_ARRAY(row_byte_length * sizeof(png_byte));
+  }
 
-  png_read_end(_png, NULL);
+  png_read_row(_png, _row, NULL);
+  convert_row(_row, array, alpha_data, x_size);
 
-  return _y_size;
+  ++_rows_read;
+  if (_rows_read == y_size) {
+    png_read_end(_png, NULL);
+  }
+
+  return true;
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -435,6 +460,66 @@ free_png() {
   }
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: PNMFileTypePNG::Reader::convert_row
+//       Access: Private
+//  Description: Unpacks one row of libpng data into the indicated
+//               x_size pixels of array and alpha_data.
+////////////////////////////////////////////////////////////////////
+void PNMFileTypePNG::Reader::
+convert_row(png_bytep source, xel *array, xelval *alpha_data,
+            int x_size) const {
+  bool get_color = !is_grayscale();
+  bool get_alpha = has_alpha();
+
+  for (int xi = 0; xi < x_size; xi++) {
+    int red = 0;
+    int green = 0;
+    int blue = 0;
+    int alpha = 0;
+
+    if (_maxval > 255) {
+      if (get_color) {
+        red = (source[0] << 8) | source[1];
+        source += 2;
+
+        green = (source[0] << 8) | source[1];
+        source += 2;
+      }
+
+      blue = (source[0] << 8) | source[1];
+      source += 2;
+
+      if (get_alpha) {
+        alpha = (source[0] << 8) | source[1];
+        source += 2;
+      }
+        
+    } else {
+      if (get_color) {
+        red = *source;
+        source++;
+
+        green = *source;
+        source++;
+      }
+
+      blue = *source;
+      source++;
+
+      if (get_alpha) {
+        alpha = *source;
+        source++;
+      }
+    }
+      
+    PPM_ASSIGN(array[xi], red, green, blue);
+    if (get_alpha) {
+      alpha_data[xi] = alpha;
+    }
+  }
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: PNMFileTypePNG::Reader::png_read_data
 //       Access: Private, Static
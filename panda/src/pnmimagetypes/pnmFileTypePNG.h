@@ -54,9 +54,13 @@ public:
     virtual ~Reader();
 
     virtual int read_data(xel *array, xelval *alpha_data);
+    virtual bool supports_read_row() const;
+    virtual bool read_row(xel *array, xelval *alpha_data, int x_size, int y_size);
 
   private:
     void free_png();
+    void convert_row(png_bytep source, xel *array, xelval *alpha_data,
+                     int x_size) const;
     static void png_read_data(png_structp png_ptr, png_bytep data, 
                               png_size_t length);
 
@@ -65,6 +69,11 @@ public:
 
     png_structp _png;
     png_infop _info;
+    bool _interlaced;
+
+    // The buffer for one row of libpng data, used by read_row().
+    png_bytep _row;
+    int _rows_read;
 
     // We need a jmp_buf to support libpng's fatal error handling, in
     // which the error handler must not immediately leave libpng code,
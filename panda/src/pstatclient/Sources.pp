@@ -17,6 +17,7 @@
      pStatCollector.I pStatCollector.h pStatCollectorDef.h  \
      pStatCollectorForward.I pStatCollectorForward.h \
      pStatFrameData.I pStatFrameData.h pStatProperties.h  \
+     pStatRingBuffer.I pStatRingBuffer.h \
      pStatServerControlMessage.h pStatThread.I pStatThread.h  \
      pStatTimer.I pStatTimer.h
 
@@ -28,6 +29,7 @@
      pStatCollectorDef.cxx  \
      pStatCollectorForward.cxx \
      pStatFrameData.cxx pStatProperties.cxx  \
+     pStatRingBuffer.cxx \
      pStatServerControlMessage.cxx \
      pStatThread.cxx
 
@@ -40,6 +42,7 @@
     pStatCollectorForward.I pStatCollectorForward.h \
     pStatFrameData.I pStatFrameData.h \
     pStatProperties.h \
+    pStatRingBuffer.I pStatRingBuffer.h \
     pStatServerControlMessage.h pStatThread.I pStatThread.h \
     pStatTimer.I pStatTimer.h
 
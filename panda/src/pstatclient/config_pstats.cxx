@@ -94,6 +94,38 @@ ConfigVariableBool pstats_mem_other
           "the total into a single \"Other\" category, or false to show "
           "each nonzero memory category."));
 
+ConfigVariableBool pstats_shared_memory
+("pstats-shared-memory", true,
+ PRC_DESC("Set this true to send frame data to a PStats server running on "
+          "the same machine through a ring buffer in shared memory, rather "
+          "than through the network.  This is much cheaper, and no data is "
+          "lost unless the server falls behind by more than "
+          "pstats-shared-memory-size bytes.  Both the client and the "
+          "server must allow it; if either does not, or the shared memory "
+          "can't be set up, the network is used as before.  This has no "
+          "effect in a build without native atomic operations, such as "
+          "one without true threads."));
+
+ConfigVariableInt pstats_shared_memory_size
+("pstats-shared-memory-size", 4 * 1024 * 1024,
+ PRC_DESC("The size in bytes of the shared-memory ring buffer used when "
+          "pstats-shared-memory is in effect."));
+
+ConfigVariableBool pstats_tsc
+("pstats-tsc", true,
+ PRC_DESC("Set this true to timestamp collector start and stop events with "
+          "the CPU's time stamp counter, where there is one, calibrated "
+          "against the usual clock.  This is much cheaper than reading the "
+          "clock.  Set it false if the counter is unreliable on this "
+          "machine, for instance because it varies with the CPU speed."));
+
+ConfigVariableInt pstats_tick_buffer_size
+("pstats-tick-buffer-size", 4096,
+ PRC_DESC("The number of collector start and stop events that each thread "
+          "may buffer without taking a lock, before they are moved into the "
+          "frame data.  This is rounded up to a power of two.  Set it to 0 "
+          "to lock on every event, as before."));
+
 ////////////////////////////////////////////////////////////////////
 //     Function: init_libpstatclient
 //  Description: Initializes the library.  This must be called at
@@ -46,6 +46,12 @@ extern EXPCL_PANDA_PSTATCLIENT ConfigVariableDouble pstats_average_time;
 
 extern EXPCL_PANDA_PSTATCLIENT ConfigVariableBool pstats_mem_other;
 
+extern EXPCL_PANDA_PSTATCLIENT ConfigVariableBool pstats_shared_memory;
+extern EXPCL_PANDA_PSTATCLIENT ConfigVariableInt pstats_shared_memory_size;
+
+extern EXPCL_PANDA_PSTATCLIENT ConfigVariableBool pstats_tsc;
+extern EXPCL_PANDA_PSTATCLIENT ConfigVariableInt pstats_tick_buffer_size;
+
 extern EXPCL_PANDA_PSTATCLIENT void init_libpstatclient();
 
 #endif
@@ -3,5 +3,6 @@
 #include "pStatCollectorForward.cxx"
 #include "pStatFrameData.cxx"
 #include "pStatProperties.cxx"
+#include "pStatRingBuffer.cxx"
 #include "pStatServerControlMessage.cxx"
 #include "pStatThread.cxx"
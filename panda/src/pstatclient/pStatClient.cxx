@@ -37,6 +37,7 @@ PStatCollector PStatClient::_heap_array_size_pcollector("System memory:Heap:Arra
 PStatCollector PStatClient::_heap_array_other_size_pcollector("System memory:Heap:Array:Other");
 PStatCollector PStatClient::_heap_external_size_pcollector("System memory:Heap:External");
 PStatCollector PStatClient::_mmap_size_pcollector("System memory:MMap");
+PStatCollector PStatClient::_sampled_heap_size_pcollector("Sampled heap");
 
 PStatCollector PStatClient::_mmap_nf_unused_size_pcollector("System memory:MMap:NeverFree:Unused");
 PStatCollector PStatClient::_mmap_dc_active_other_size_pcollector("System memory:MMap:NeverFree:Active:Other");
@@ -222,6 +223,12 @@ main_tick() {
 
     _mmap_size_pcollector.set_level(MemoryUsage::get_panda_mmap_size());
 
+    if (MemoryUsage::is_sampling()) {
+      // This is an estimate of the same memory counted under "Heap",
+      // so we report it separately rather than as a child.
+      _sampled_heap_size_pcollector.set_level(MemoryUsage::get_sampled_heap_size());
+    }
+
     TypeRegistry *type_reg = TypeRegistry::ptr();
     int num_typehandles = type_reg->get_num_typehandles();
 
@@ -424,6 +431,7 @@ void PStatClient::
 client_disconnect() {
   ReMutexHolder holder(_lock);
   if (has_impl()) {
+    _impl->client_stop_recording();
     _impl->client_disconnect();
     delete _impl;
     _impl = NULL;
@@ -436,6 +444,8 @@ client_disconnect() {
     thread->_is_active = false;
     thread->_next_packet = 0.0;
     thread->_frame_data.clear();
+    // Discard anything still in the tick buffer, too.
+    AtomicAdjust::set(thread->_tick_read, AtomicAdjust::get(thread->_tick_write));
   }
 
   CollectorPointer *collectors = (CollectorPointer *)_collectors;
@@ -450,6 +460,34 @@ client_disconnect() {
   }
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: PStatClient::client_start_recording
+//       Access: Published
+//  Description: The nonstatic implementation of start_recording().
+////////////////////////////////////////////////////////////////////
+bool PStatClient::
+client_start_recording(const Filename &filename) {
+  ReMutexHolder holder(_lock);
+  return get_impl()->client_start_recording(filename);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PStatClient::client_stop_recording
+//       Access: Published
+//  Description: The nonstatic implementation of stop_recording().
+////////////////////////////////////////////////////////////////////
+void PStatClient::
+client_stop_recording() {
+  ReMutexHolder holder(_lock);
+  if (has_impl()) {
+    _impl->client_stop_recording();
+    if (!_impl->client_is_connected()) {
+      // Nothing else is using the stats now.
+      client_disconnect();
+    }
+  }
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: PStatClient::get_global_pstats
 //       Access: Published, Static
@@ -729,7 +767,27 @@ start(int collector_index, int thread_index) {
   InternalThread *thread = get_thread_ptr(thread_index);
 
   if (client_is_connected() && collector->is_active() && thread->_is_active) {
+    if (thread->_tick_events != (TickEvent *)NULL &&
+        thread->_tick_owner == Thread::get_current_thread()) {
+      // We are the thread itself, so we don't need the lock.
+      if (collector->_per_thread[thread_index]._nested_count == 0) {
+        if (thread->_thread_active &&
+            !add_tick_event(thread, collector_index)) {
+          LightMutexHolder holder(thread->_thread_lock);
+          flush_tick_events(thread);
+          add_tick_event(thread, collector_index);
+        }
+      }
+      collector->_per_thread[thread_index]._nested_count++;
+      return;
+    }
+
     LightMutexHolder holder(thread->_thread_lock);
+    // Once the thread has begun recording through its tick buffer,
+    // it alone may touch its _per_thread data.
+    nassertv(thread->_tick_events == (TickEvent *)NULL ||
+             thread->_tick_owner == Thread::get_current_thread());
+    flush_tick_events(thread);
     if (collector->_per_thread[thread_index]._nested_count == 0) {
       // This collector wasn't already started in this thread; record
       // a new data point.
@@ -738,6 +796,12 @@ start(int collector_index, int thread_index) {
       }
     }
     collector->_per_thread[thread_index]._nested_count++;
+
+    if (thread->_tick_events == (TickEvent *)NULL &&
+        thread->_tick_owner == Thread::get_current_thread()) {
+      // Next time, the thread can use the fast path.
+      thread->make_tick_events();
+    }
   }
 }
 
@@ -760,6 +824,11 @@ start(int collector_index, int thread_index, double as_of) {
 
   if (client_is_connected() && collector->is_active() && thread->_is_active) {
     LightMutexHolder holder(thread->_thread_lock);
+    // Once the thread has begun recording through its tick buffer,
+    // it alone may touch its _per_thread data.
+    nassertv(thread->_tick_events == (TickEvent *)NULL ||
+             thread->_tick_owner == Thread::get_current_thread());
+    flush_tick_events(thread);
     if (collector->_per_thread[thread_index]._nested_count == 0) {
       // This collector wasn't already started in this thread; record
       // a new data point.
@@ -789,7 +858,38 @@ stop(int collector_index, int thread_index) {
   InternalThread *thread = get_thread_ptr(thread_index);
 
   if (client_is_connected() && collector->is_active() && thread->_is_active) {
+    if (thread->_tick_events != (TickEvent *)NULL &&
+        thread->_tick_owner == Thread::get_current_thread()) {
+      // We are the thread itself, so we don't need the lock.
+      if (collector->_per_thread[thread_index]._nested_count == 0) {
+        if (pstats_cat.is_debug()) {
+          pstats_cat.debug()
+            << "Collector " << get_collector_fullname(collector_index)
+            << " was already stopped in thread " << get_thread_name(thread_index)
+            << "!\n";
+        }
+        return;
+      }
+
+      collector->_per_thread[thread_index]._nested_count--;
+
+      if (collector->_per_thread[thread_index]._nested_count == 0) {
+        if (thread->_thread_active &&
+            !add_tick_event(thread, collector_index | 0x8000)) {
+          LightMutexHolder holder(thread->_thread_lock);
+          flush_tick_events(thread);
+          add_tick_event(thread, collector_index | 0x8000);
+        }
+      }
+      return;
+    }
+
     LightMutexHolder holder(thread->_thread_lock);
+    // Once the thread has begun recording through its tick buffer,
+    // it alone may touch its _per_thread data.
+    nassertv(thread->_tick_events == (TickEvent *)NULL ||
+             thread->_tick_owner == Thread::get_current_thread());
+    flush_tick_events(thread);
     if (collector->_per_thread[thread_index]._nested_count == 0) {
       if (pstats_cat.is_debug()) {
         pstats_cat.debug()
@@ -831,6 +931,11 @@ stop(int collector_index, int thread_index, double as_of) {
 
   if (client_is_connected() && collector->is_active() && thread->_is_active) {
     LightMutexHolder holder(thread->_thread_lock);
+    // Once the thread has begun recording through its tick buffer,
+    // it alone may touch its _per_thread data.
+    nassertv(thread->_tick_events == (TickEvent *)NULL ||
+             thread->_tick_owner == Thread::get_current_thread());
+    flush_tick_events(thread);
     if (collector->_per_thread[thread_index]._nested_count == 0) {
       if (pstats_cat.is_debug()) {
         pstats_cat.debug()
@@ -851,6 +956,44 @@ stop(int collector_index, int thread_index, double as_of) {
   }
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: PStatClient::flush_tick_events
+//       Access: Private
+//  Description: Moves any events waiting in the thread's tick buffer
+//               into its frame data, converting their timestamps to
+//               the PStatClient's clock.  The caller must hold the
+//               thread's _thread_lock.
+////////////////////////////////////////////////////////////////////
+void PStatClient::
+flush_tick_events(InternalThread *thread) {
+  int num_events = thread->_num_tick_events;
+  if (num_events == 0) {
+    return;
+  }
+  AtomicAdjust::Integer mask = num_events * 2 - 1;
+  AtomicAdjust::Integer read = AtomicAdjust::get(thread->_tick_read);
+  AtomicAdjust::Integer write = AtomicAdjust::get(thread->_tick_write);
+  if (read == write || !has_impl()) {
+    return;
+  }
+
+  PStatClientImpl::TickScale scale;
+  _impl->get_tick_scale(scale);
+
+  while (read != write) {
+    const TickEvent &event = thread->_tick_events[read & (num_events - 1)];
+    double time = scale.get_time(event._ticks);
+    if (event._index & 0x8000) {
+      thread->_frame_data.add_stop(event._index & 0x7fff, time);
+    } else {
+      thread->_frame_data.add_start(event._index, time);
+    }
+    read = (read + 1) & mask;
+  }
+
+  AtomicAdjust::set(thread->_tick_read, read);
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: PStatClient::clear_level
 //       Access: Private
@@ -1120,9 +1263,15 @@ deactivate_hook(Thread *thread) {
 
   if (ithread->_thread_active) {
     // Start _thread_block_pcollector, by hand, being careful not to
-    // grab any mutexes while we do it.
-    double now = _impl->get_real_time();
-    ithread->_frame_data.add_start(_thread_block_pcollector.get_index(), now);
+    // grab any mutexes while we do it.  It goes through the tick
+    // buffer if we have one, to stay in order with the events already
+    // there.
+    int index = _thread_block_pcollector.get_index();
+    if (ithread->_tick_events == (TickEvent *)NULL ||
+        !add_tick_event(ithread, index)) {
+      double now = _impl->get_real_time();
+      ithread->_frame_data.add_start(index, now);
+    }
     ithread->_thread_active = false;
   }
 }
@@ -1148,8 +1297,12 @@ activate_hook(Thread *thread) {
   InternalThread *ithread = get_thread_ptr(thread->get_pstats_index());
 
   if (!ithread->_thread_active) {
-    double now = _impl->get_real_time();
-    ithread->_frame_data.add_stop(_thread_block_pcollector.get_index(), now);
+    int index = _thread_block_pcollector.get_index();
+    if (ithread->_tick_events == (TickEvent *)NULL ||
+        !add_tick_event(ithread, index | 0x8000)) {
+      double now = _impl->get_real_time();
+      ithread->_frame_data.add_stop(index, now);
+    }
     ithread->_thread_active = true;
   }
 }
@@ -1187,7 +1340,12 @@ InternalThread(Thread *thread) :
   _frame_number(0),
   _next_packet(0.0),
   _thread_active(true),
-  _thread_lock(string("PStatClient::InternalThread ") + thread->get_name())
+  _thread_lock(string("PStatClient::InternalThread ") + thread->get_name()),
+  _tick_owner(thread),
+  _tick_events(NULL),
+  _num_tick_events(0),
+  _tick_write(0),
+  _tick_read(0)
 {
 }
 
@@ -1205,8 +1363,41 @@ InternalThread(const string &name, const string &sync_name) :
   _frame_number(0),
   _next_packet(0.0),
   _thread_active(true),
-  _thread_lock(string("PStatClient::InternalThread ") + name)
+  _thread_lock(string("PStatClient::InternalThread ") + name),
+  _tick_owner(NULL),
+  _tick_events(NULL),
+  _num_tick_events(0),
+  _tick_write(0),
+  _tick_read(0)
 {
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: PStatClient::InternalThread::make_tick_events
+//       Access: Private
+//  Description: Allocates the tick buffer, of the size given by
+//               pstats-tick-buffer-size.  This is called by the
+//               thread itself, with _thread_lock held, the first time
+//               it records an event.  We don't do it in the
+//               constructor, since the main thread's InternalThread is
+//               made at static init time, before the config variables
+//               are available.
+////////////////////////////////////////////////////////////////////
+void PStatClient::InternalThread::
+make_tick_events() {
+  int size = pstats_tick_buffer_size;
+  if (size <= 0) {
+    return;
+  }
+
+  int num_events = 1;
+  while (num_events < size) {
+    num_events <<= 1;
+  }
+  _tick_write = 0;
+  _tick_read = 0;
+  _num_tick_events = num_events;
+  _tick_events = new TickEvent[num_events];
+}
+
 #endif // DO_PSTATS
@@ -31,6 +31,7 @@
 #include "atomicAdjust.h"
 #include "numeric_types.h"
 #include "bitArray.h"
+#include "filename.h"
 
 class PStatCollector;
 class PStatCollectorDef;
@@ -89,6 +90,10 @@ PUBLISHED:
   INLINE static void disconnect();
   INLINE static bool is_connected();
 
+  INLINE static bool start_recording(const Filename &filename);
+  INLINE static void stop_recording();
+  INLINE static bool is_recording();
+
   INLINE static void resume_after_pause();
 
   static void main_tick();
@@ -100,6 +105,10 @@ PUBLISHED:
   void client_disconnect();
   INLINE bool client_is_connected() const;
 
+  bool client_start_recording(const Filename &filename);
+  void client_stop_recording();
+  INLINE bool client_is_recording() const;
+
   INLINE void client_resume_after_pause();
 
   static PStatClient *get_global_pstats();
@@ -140,6 +149,8 @@ private:
 
   INLINE Collector *get_collector_ptr(int collector_index) const;
   INLINE InternalThread *get_thread_ptr(int thread_index) const;
+  INLINE bool add_tick_event(InternalThread *thread, int index);
+  void flush_tick_events(InternalThread *thread);
 
   virtual void deactivate_hook(Thread *thread);
   virtual void activate_hook(Thread *thread);
@@ -197,6 +208,15 @@ private:
   AtomicAdjust::Integer _collectors_size;  // size of the allocated array
   AtomicAdjust::Integer _num_collectors;   // number of in-use elements within the array
 
+  // A start or stop event, waiting in a thread's tick buffer to be
+  // added to its frame data.  The high bit of the index is set for a
+  // stop, as in PStatFrameData.
+  class TickEvent {
+  public:
+    PN_uint64 _ticks;
+    int _index;
+  };
+
   // This defines a single thread, i.e. a separate chain of execution,
   // independent of all other threads.  Timing and level data are
   // maintained separately for each thread.
@@ -205,6 +225,8 @@ private:
     InternalThread(Thread *thread);
     InternalThread(const string &name, const string &sync_name = "Main");
 
+    void make_tick_events();
+
     WPT(Thread) _thread;
     string _name;
     string _sync_name;
@@ -220,6 +242,19 @@ private:
     // particular thread, as well as writes to the _per_thread data
     // for this particular thread in the Collector class, above.
     LightMutex _thread_lock;
+
+    // When start() and stop() are called from the thread itself,
+    // they append to this ring instead of taking the lock, and
+    // update the thread's _per_thread data without it.  From then
+    // on, only the thread itself may start or stop collectors on
+    // its behalf; this is asserted.  flush_tick_events() empties the ring into _frame_data,
+    // with the lock held.  The indices run modulo twice the size, so
+    // that a full ring can be told from an empty one.
+    Thread *_tick_owner;
+    TickEvent *_tick_events;
+    int _num_tick_events;
+    AtomicAdjust::Integer _tick_write;
+    AtomicAdjust::Integer _tick_read;
   };
   typedef InternalThread *ThreadPointer;
   AtomicAdjust::Pointer _threads;  // ThreadPointer *_threads;
@@ -236,6 +271,7 @@ private:
   static PStatCollector _heap_array_other_size_pcollector;
   static PStatCollector _heap_external_size_pcollector;
   static PStatCollector _mmap_size_pcollector;
+  static PStatCollector _sampled_heap_size_pcollector;
 
   static PStatCollector _mmap_nf_unused_size_pcollector;
   static PStatCollector _mmap_dc_active_other_size_pcollector;
@@ -267,6 +303,9 @@ PUBLISHED:
   INLINE static bool connect(const string & = string(), int = -1) { return false; }
   INLINE static void disconnect() { }
   INLINE static bool is_connected() { return false; }
+  INLINE static bool start_recording(const Filename &) { return false; }
+  INLINE static void stop_recording() { }
+  INLINE static bool is_recording() { return false; }
   INLINE static void resume_after_pause() { }
 
   INLINE static void main_tick() { }
@@ -65,6 +65,10 @@ encode(Datagram &datagram) const {
     }
     break;
 
+  case T_shared_memory:
+    datagram.add_string(_shared_memory_name);
+    break;
+
   default:
     pstats_cat.error()
       << "Invalid PStatClientControlMessage::Type " << (int)_type << "\n";
@@ -118,6 +122,10 @@ decode(const Datagram &datagram, PStatClientVersion *version) {
     }
     break;
 
+  case T_shared_memory:
+    _shared_memory_name = source.get_string();
+    break;
+
   case T_datagram:
     // Not, strictly speaking, a control message.
     return false;
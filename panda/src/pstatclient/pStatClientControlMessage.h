@@ -42,6 +42,7 @@ public:
     T_hello,
     T_define_collectors,
     T_define_threads,
+    T_shared_memory,
     T_invalid
   };
 
@@ -59,6 +60,9 @@ public:
   // Used for T_define_threads
   int _first_thread_index;
   pvector<string> _names;
+
+  // Used for T_shared_memory
+  string _shared_memory_name;
 };
 
 
@@ -24,6 +24,8 @@
 #include "pStatThread.h"
 #include "config_pstats.h"
 #include "pStatProperties.h"
+#include "lightMutexHolder.h"
+#include "reMutexHolder.h"
 #include "cmath.h"
 
 #include <algorithm>
@@ -54,10 +56,36 @@ PStatClientImpl(PStatClient *client) :
   _got_udp_port = false;
   _collectors_reported = 0;
   _threads_reported = 0;
+  _is_recording = false;
+  _record_collectors_reported = 0;
+  _record_threads_reported = 0;
 
   _client_name = pstats_name;
   _max_rate = pstats_max_rate;
 
+#ifdef PSTATS_HAVE_TSC
+  _use_tsc = pstats_tsc;
+#else
+  _use_tsc = false;
+#endif
+
+  _first_tick_time = _clock->get_short_time();
+  _first_ticks = get_ticks();
+  _tick_scale._tick_base = _first_ticks;
+  _tick_scale._time_base = _first_tick_time;
+  if (_use_tsc) {
+    // We need a rough idea of the counter's rate right away.  Watch
+    // it for a millisecond; calibrate_ticks() will refine it as we
+    // go.
+    double now;
+    do {
+      now = _clock->get_short_time();
+    } while (now - _first_tick_time < 0.001);
+    calibrate_ticks();
+  } else {
+    _tick_scale._seconds_per_tick = 0.000000001;
+  }
+
   _tcp_count = 1;
   _udp_count = 1;
 
@@ -150,6 +178,11 @@ client_disconnect() {
     close_connection(_udp_connection);
   }
 
+  {
+    LightMutexHolder holder(_ring_lock);
+    _ring.close();
+  }
+
   _tcp_connection.clear();
   _udp_connection.clear();
 
@@ -160,6 +193,64 @@ client_disconnect() {
   _threads_reported = 0;
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: PStatClientImpl::client_start_recording
+//       Access: Public
+//  Description: Called only by PStatClient::client_start_recording().
+////////////////////////////////////////////////////////////////////
+bool PStatClientImpl::
+client_start_recording(const Filename &filename) {
+  client_stop_recording();
+
+  LightMutexHolder holder(_record_lock);
+  if (!_record_file.open(filename) ||
+      !_record_file.write_header(get_pstats_capture_header())) {
+    pstats_cat.error()
+      << "Couldn't open " << filename << " for recording.\n";
+    _record_file.close();
+    return false;
+  }
+
+  // The file begins with the same greeting we would send to a server,
+  // so that a reader knows which version of the protocol follows.
+  PStatClientControlMessage message;
+  message._type = PStatClientControlMessage::T_hello;
+  message._client_hostname = get_hostname();
+  message._client_progname = _client_name;
+  message._major_version = get_current_pstat_major_version();
+  message._minor_version = get_current_pstat_minor_version();
+
+  Datagram datagram;
+  message.encode(datagram);
+  _record_file.put_datagram(datagram);
+
+  _record_collectors_reported = 0;
+  _record_threads_reported = 0;
+  record_new_definitions();
+
+  _is_recording = true;
+
+  if (pstats_cat.is_debug()) {
+    pstats_cat.debug()
+      << "Recording to " << filename << "\n";
+  }
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PStatClientImpl::client_stop_recording
+//       Access: Public
+//  Description: Called only by PStatClient::client_stop_recording().
+////////////////////////////////////////////////////////////////////
+void PStatClientImpl::
+client_stop_recording() {
+  LightMutexHolder holder(_record_lock);
+  if (_is_recording) {
+    _record_file.close();
+    _is_recording = false;
+  }
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: PStatClientImpl::new_frame
 //       Access: Public
@@ -180,9 +271,10 @@ new_frame(int thread_index) {
     transmit_control_data();
   }
 
-  // If we've got the UDP port by the time the frame starts, it's
-  // time to become active and start actually tracking data.
-  if (_got_udp_port) {
+  // If we've got the UDP port by the time the frame starts, or we
+  // are recording, it's time to become active and start actually
+  // tracking data.
+  if (_got_udp_port || _is_recording) {
     pthread->_is_active = true;
   }
 
@@ -190,6 +282,12 @@ new_frame(int thread_index) {
     return;
   }
 
+  {
+    // Collect the events the thread has buffered up to now.
+    LightMutexHolder holder(pthread->_thread_lock);
+    _client->flush_tick_events(pthread);
+  }
+
   double frame_start = get_real_time();
   int frame_number = -1;
   PStatFrameData frame_data;
@@ -247,9 +345,10 @@ add_frame(int thread_index, const PStatFrameData &frame_data) {
     transmit_control_data();
   }
 
-  // If we've got the UDP port by the time the frame starts, it's
-  // time to become active and start actually tracking data.
-  if (_got_udp_port) {
+  // If we've got the UDP port by the time the frame starts, or we
+  // are recording, it's time to become active and start actually
+  // tracking data.
+  if (_got_udp_port || _is_recording) {
     pthread->_is_active = true;
   }
 
@@ -281,7 +380,15 @@ transmit_frame_data(int thread_index, int frame_number,
                     const PStatFrameData &frame_data) {
   nassertv(thread_index >= 0 && thread_index < _client->_num_threads);
   PStatClient::InternalThread *thread = _client->get_thread_ptr(thread_index);
-  if (_is_connected && thread->_is_active) {
+  if (_is_recording && thread->_is_active) {
+    // Every frame goes into the capture file, regardless of how often
+    // we send them to the server.
+    record_frame_data(thread_index, frame_number, frame_data);
+  }
+
+  // The thread may also be active because we are recording, before
+  // the server has told us its UDP port; in that case we must wait.
+  if (_is_connected && _got_udp_port && thread->_is_active) {
 
     // We don't want to send too many packets in a hurry and flood the
     // server.  Check that enough time has elapsed for us to send a
@@ -302,12 +409,26 @@ transmit_frame_data(int thread_index, int frame_number,
       datagram.add_uint16(thread_index);
       datagram.add_uint32(frame_number);
 
-      bool sent;
+      bool sent = false;
+      bool sent_shared = false;
+      bool encoded = frame_data.write_datagram(datagram, _client);
+
+      if (encoded) {
+        // If the server is reading our shared memory, that's where it
+        // goes.  There's no limit on its size there.
+        LightMutexHolder holder(_ring_lock);
+        if (_ring.is_attached()) {
+          sent = _ring.write_datagram(datagram);
+          sent_shared = true;
+        }
+      }
 
-      if (!frame_data.write_datagram(datagram, _client)) {
+      if (!encoded) {
         // Too many events to fit in a single datagram.  Maybe it was
         // a long frame load or something.  Just drop the datagram.
-        sent = false;
+
+      } else if (sent_shared) {
+        // Already taken care of.
 
       } else if (_writer.is_valid_for_udp(datagram)) {
         if (_udp_count * _udp_count_factor < _tcp_count * _tcp_count_factor) {
@@ -364,6 +485,8 @@ transmit_frame_data(int thread_index, int frame_number,
 ////////////////////////////////////////////////////////////////////
 void PStatClientImpl::
 transmit_control_data() {
+  calibrate_ticks();
+
   // Check for new messages from the server.
   while (_is_connected && _reader.data_available()) {
     NetDatagram datagram;
@@ -384,6 +507,118 @@ transmit_control_data() {
     report_new_collectors();
     report_new_threads();
   }
+
+  if (_is_recording) {
+    ReMutexHolder client_holder(_client->_lock);
+    LightMutexHolder holder(_record_lock);
+    record_new_definitions();
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PStatClientImpl::get_tick_scale
+//       Access: Public
+//  Description: Fills in the scale by which values returned by
+//               get_ticks() may presently be converted to the time
+//               scale of get_real_time().
+////////////////////////////////////////////////////////////////////
+void PStatClientImpl::
+get_tick_scale(TickScale &scale) const {
+  LightMutexHolder holder(_tick_lock);
+  scale = _tick_scale;
+  scale._time_base += _delta;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PStatClientImpl::calibrate_ticks
+//       Access: Private
+//  Description: Measures the rate of the clock behind get_ticks()
+//               against the real clock.  This is called once a frame
+//               by the main thread.
+////////////////////////////////////////////////////////////////////
+void PStatClientImpl::
+calibrate_ticks() {
+  if (!_use_tsc) {
+    // get_ticks() is the real clock, in nanoseconds.
+    return;
+  }
+
+  double now = _clock->get_short_time();
+  PN_uint64 ticks = get_ticks();
+  if (ticks == _first_ticks) {
+    return;
+  }
+
+  LightMutexHolder holder(_tick_lock);
+  _tick_scale._seconds_per_tick =
+    (now - _first_tick_time) / (double)(PN_int64)(ticks - _first_ticks);
+  _tick_scale._tick_base = ticks;
+  _tick_scale._time_base = now;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PStatClientImpl::record_frame_data
+//       Access: Private
+//  Description: Writes the frame data for one thread to the capture
+//               file, in the same form in which it would be sent to
+//               the server.
+////////////////////////////////////////////////////////////////////
+void PStatClientImpl::
+record_frame_data(int thread_index, int frame_number,
+                  const PStatFrameData &frame_data) {
+  Datagram datagram;
+  datagram.add_uint8(0);
+  datagram.add_uint16(thread_index);
+  datagram.add_uint32(frame_number);
+
+  if (!frame_data.write_datagram(datagram, _client)) {
+    // Too many events to encode; we drop it just as the server
+    // would never see it.
+    return;
+  }
+
+  // This frame may have come from another thread, and may mention a
+  // collector the main thread hasn't written out yet.  The client's
+  // lock keeps us from building its definition at the same time as
+  // the main thread.
+  ReMutexHolder client_holder(_client->_lock);
+  LightMutexHolder holder(_record_lock);
+  if (_is_recording) {
+    record_new_definitions();
+
+    if (!_record_file.put_datagram(datagram)) {
+      pstats_cat.error()
+        << "Error writing to " << _record_file.get_filename()
+        << "; recording stopped.\n";
+      _record_file.close();
+      _is_recording = false;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PStatClientImpl::record_new_definitions
+//       Access: Private
+//  Description: Writes any collectors and threads that have been
+//               defined since the last call to the capture file.  The
+//               caller must hold the client's lock and _record_lock.
+////////////////////////////////////////////////////////////////////
+void PStatClientImpl::
+record_new_definitions() {
+  while (true) {
+    Datagram datagram;
+    if (!encode_new_collectors(_record_collectors_reported, datagram)) {
+      break;
+    }
+    _record_file.put_datagram(datagram);
+  }
+  while (true) {
+    Datagram datagram;
+    if (!encode_new_threads(_record_threads_reported, datagram)) {
+      break;
+    }
+    _record_file.put_datagram(datagram);
+  }
 }
 
 
@@ -434,25 +669,11 @@ send_hello() {
 ////////////////////////////////////////////////////////////////////
 void PStatClientImpl::
 report_new_collectors() {
-  // Empirically, we determined that you can't send more than about
-  // 1400 collectors at once without exceeding the 64K limit on a
-  // single datagram.  So we limit ourselves here to sending only
-  // half that many.
-  static const int max_collectors_at_once = 700;
-
-  while (_is_connected && _collectors_reported < _client->_num_collectors) {
-    PStatClientControlMessage message;
-    message._type = PStatClientControlMessage::T_define_collectors;
-    int i = 0;
-    while (_collectors_reported < _client->_num_collectors &&
-           i < max_collectors_at_once) {
-      message._collectors.push_back(_client->get_collector_def(_collectors_reported));
-      _collectors_reported++;
-      i++;
-    }
-
+  while (_is_connected) {
     Datagram datagram;
-    message.encode(datagram);
+    if (!encode_new_collectors(_collectors_reported, datagram)) {
+      break;
+    }
     _writer.send(datagram, _tcp_connection, true);
   }
 }
@@ -465,23 +686,108 @@ report_new_collectors() {
 ////////////////////////////////////////////////////////////////////
 void PStatClientImpl::
 report_new_threads() {
-  while (_is_connected && _threads_reported < _client->_num_threads) {
-    PStatClientControlMessage message;
-    message._type = PStatClientControlMessage::T_define_threads;
-    message._first_thread_index = _threads_reported;
-    PStatClient::ThreadPointer *threads =
-      (PStatClient::ThreadPointer *)_client->_threads;
-    while (_threads_reported < _client->_num_threads) {
-      message._names.push_back(threads[_threads_reported]->_name);
-      _threads_reported++;
-    }
-
+  while (_is_connected) {
     Datagram datagram;
-    message.encode(datagram);
+    if (!encode_new_threads(_threads_reported, datagram)) {
+      break;
+    }
     _writer.send(datagram, _tcp_connection, true);
   }
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: PStatClientImpl::encode_new_collectors
+//       Access: Private
+//  Description: Encodes a message defining the next batch of
+//               collectors after the first num_reported, and advances
+//               num_reported past them.  Returns false if there were
+//               no new collectors to define.
+////////////////////////////////////////////////////////////////////
+bool PStatClientImpl::
+encode_new_collectors(int &num_reported, Datagram &datagram) {
+  // Empirically, we determined that you can't send more than about
+  // 1400 collectors at once without exceeding the 64K limit on a
+  // single datagram.  So we limit ourselves here to sending only
+  // half that many.
+  static const int max_collectors_at_once = 700;
+
+  if (num_reported >= _client->_num_collectors) {
+    return false;
+  }
+
+  PStatClientControlMessage message;
+  message._type = PStatClientControlMessage::T_define_collectors;
+  int i = 0;
+  while (num_reported < _client->_num_collectors &&
+         i < max_collectors_at_once) {
+    message._collectors.push_back(_client->get_collector_def(num_reported));
+    num_reported++;
+    i++;
+  }
+
+  message.encode(datagram);
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PStatClientImpl::encode_new_threads
+//       Access: Private
+//  Description: Encodes a message defining all of the threads after
+//               the first num_reported, and advances num_reported
+//               past them.  Returns false if there were no new
+//               threads to define.
+////////////////////////////////////////////////////////////////////
+bool PStatClientImpl::
+encode_new_threads(int &num_reported, Datagram &datagram) {
+  if (num_reported >= _client->_num_threads) {
+    return false;
+  }
+
+  PStatClientControlMessage message;
+  message._type = PStatClientControlMessage::T_define_threads;
+  message._first_thread_index = num_reported;
+  PStatClient::ThreadPointer *threads =
+    (PStatClient::ThreadPointer *)_client->_threads;
+  while (num_reported < _client->_num_threads) {
+    message._names.push_back(threads[num_reported]->_name);
+    num_reported++;
+  }
+
+  message.encode(datagram);
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PStatClientImpl::open_shared_memory
+//       Access: Private
+//  Description: Creates a ring buffer in shared memory and tells the
+//               server its name.  Once the server has attached to it,
+//               transmit_frame_data() will write frame data there
+//               instead of sending it over the network; until then,
+//               or if the server never does, the network is used.
+////////////////////////////////////////////////////////////////////
+void PStatClientImpl::
+open_shared_memory() {
+  nassertv(_is_connected);
+
+  string name;
+  {
+    LightMutexHolder holder(_ring_lock);
+    if (!_ring.create(pstats_shared_memory_size)) {
+      return;
+    }
+    name = _ring.get_name();
+  }
+
+  PStatClientControlMessage message;
+  message._type = PStatClientControlMessage::T_shared_memory;
+  message._shared_memory_name = name;
+
+  Datagram datagram;
+  message.encode(datagram);
+  _writer.send(datagram, _tcp_connection, true);
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: PStatClientImpl::handle_server_control_message
 //       Access: Private
@@ -498,6 +804,14 @@ handle_server_control_message(const PStatServerControlMessage &message) {
 
     _server.set_port(message._udp_port);
     _got_udp_port = true;
+
+    // If the server is on this same machine, and knows how, offer
+    // to send it our frame data through shared memory instead.
+    if (message._shared_memory && pstats_shared_memory &&
+        PStatRingBuffer::is_supported() &&
+        message._server_hostname == get_hostname()) {
+      open_shared_memory();
+    }
     break;
 
   default:
@@ -21,13 +21,29 @@
 #ifdef DO_PSTATS
 
 #include "pStatFrameData.h"
+#include "pStatRingBuffer.h"
 #include "connectionManager.h"
 #include "queuedConnectionReader.h"
 #include "connectionWriter.h"
 #include "netAddress.h"
+#include "datagramOutputFile.h"
 
 #include "trueClock.h"
 #include "pmap.h"
+#include "lightMutex.h"
+#include "numeric_types.h"
+
+// The CPU's time stamp counter is the cheapest clock there is, where
+// we have one.
+#ifndef CPPPARSER
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+#include <x86intrin.h>
+#define PSTATS_HAVE_TSC 1
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <intrin.h>
+#define PSTATS_HAVE_TSC 1
+#endif
+#endif  // CPPPARSER
 
 class PStatClient;
 class PStatServerControlMessage;
@@ -64,11 +80,29 @@ public:
 
   INLINE double get_real_time() const;
 
+  // Converts the values returned by get_ticks() to the same time scale
+  // returned by get_real_time().
+  class TickScale {
+  public:
+    INLINE double get_time(PN_uint64 ticks) const;
+
+    PN_uint64 _tick_base;
+    double _time_base;
+    double _seconds_per_tick;
+  };
+
+  INLINE PN_uint64 get_ticks() const;
+  void get_tick_scale(TickScale &scale) const;
+
   INLINE void client_main_tick();
   bool client_connect(string hostname, int port);
   void client_disconnect();
   INLINE bool client_is_connected() const;
 
+  bool client_start_recording(const Filename &filename);
+  void client_stop_recording();
+  INLINE bool client_is_recording() const;
+
   INLINE void client_resume_after_pause();
 
   void new_frame(int thread_index);
@@ -79,16 +113,32 @@ private:
                            const PStatFrameData &frame_data);
 
   void transmit_control_data();
+  void calibrate_ticks();
+  void record_frame_data(int thread_index, int frame_number,
+                         const PStatFrameData &frame_data);
+  void record_new_definitions();
 
   TrueClock *_clock;
   double _delta;
   double _last_frame;
 
+  // These map get_ticks() onto the clock.  The scale is measured
+  // from _first_ticks, so it grows more accurate the longer we run,
+  // but it is anchored at the most recent calibration.
+  bool _use_tsc;
+  PN_uint64 _first_ticks;
+  double _first_tick_time;
+  TickScale _tick_scale;
+  mutable LightMutex _tick_lock;
+
   // Networking stuff
   string get_hostname();
   void send_hello();
   void report_new_collectors();
   void report_new_threads();
+  bool encode_new_collectors(int &num_reported, Datagram &datagram);
+  bool encode_new_threads(int &num_reported, Datagram &datagram);
+  void open_shared_memory();
   void handle_server_control_message(const PStatServerControlMessage &message);
 
   virtual void connection_reset(const PT(Connection) &connection,
@@ -106,9 +156,24 @@ private:
   PT(Connection) _tcp_connection;
   PT(Connection) _udp_connection;
 
+  // Frame data goes here instead, once the server has attached to it.
+  // The lock protects it from the several threads that may be
+  // sending frame data at once.
+  PStatRingBuffer _ring;
+  LightMutex _ring_lock;
+
   int _collectors_reported;
   int _threads_reported;
 
+  // While recording, every frame is also written to this file, along
+  // with the collector and thread definitions needed to interpret
+  // it.  This works whether or not we are connected to a server.
+  DatagramOutputFile _record_file;
+  bool _is_recording;
+  int _record_collectors_reported;
+  int _record_threads_reported;
+  LightMutex _record_lock;
+
   string _hostname;
   string _client_name;
   double _max_rate;
@@ -59,6 +59,22 @@ get_current_pstat_minor_version() {
   return current_pstat_minor_version;
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: get_pstats_capture_header
+//  Description: Returns the string that begins a capture file written
+//               by PStatClient::start_recording().  It is followed by
+//               the same datagrams a client would send to a server:
+//               the hello message, the collector and thread
+//               definitions, and the frame data, in the order they
+//               were generated.
+////////////////////////////////////////////////////////////////////
+string
+get_pstats_capture_header() {
+  // As with the bam header, the embedded newline and carriage return
+  // will reveal a file that has been mangled by a text-mode transfer.
+  return string("pst\0\n\r", 6);
+}
+
 
 #ifdef DO_PSTATS
 
@@ -206,6 +222,7 @@ static LevelCollectorProperties level_properties[] = {
   { 1, "System memory:Heap:Overhead",      { 0.9, 0.7, 0.8 } },
   { 1, "System memory:Heap:External",      { 0.2, 0.2, 0.5 } },
   { 1, "System memory:MMap",               { 0.9, 0.4, 0.7 } },
+  { 1, "Sampled heap",                     { 0.6, 0.6, 1.0 },  "MB", 64, 1048576 },
   { 1, "Vertex Data",                      { 1.0, 0.4, 0.0 },  "MB", 64, 1048576 },
   { 1, "Vertex Data:Independent",          { 0.9, 0.1, 0.9 } },
   { 1, "Vertex Data:Small",                { 0.2, 0.3, 0.4 } },
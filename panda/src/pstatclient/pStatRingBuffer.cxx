@@ -0,0 +1,398 @@
+// Filename: pStatRingBuffer.cxx
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "pStatRingBuffer.h"
+#include "config_pstats.h"
+#include "datagram.h"
+#include "filename.h"
+
+#if defined(WIN32_VC) || defined(WIN64_VC)
+#include <windows.h>
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+static const PN_uint32 pstat_ring_magic = 0x70737200 | sizeof(AtomicAdjust::Integer);
+
+// The smallest and largest rings we will create.  The positions are
+// kept modulo 2^32, so the ring must be well short of that.
+static const size_t pstat_ring_min_size = 0x10000;
+static const size_t pstat_ring_max_size = 0x40000000;
+
+////////////////////////////////////////////////////////////////////
+//     Function: PStatRingBuffer::Constructor
+//       Access: Public
+//  Description:
+////////////////////////////////////////////////////////////////////
+PStatRingBuffer::
+PStatRingBuffer() :
+  _header(NULL),
+  _data(NULL),
+  _data_size(0),
+  _mapping_size(0),
+  _is_owner(false)
+{
+#if defined(WIN32_VC) || defined(WIN64_VC)
+  _handle = NULL;
+#else
+  _fd = -1;
+#endif
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PStatRingBuffer::Destructor
+//       Access: Public
+//  Description:
+////////////////////////////////////////////////////////////////////
+PStatRingBuffer::
+~PStatRingBuffer() {
+  close();
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PStatRingBuffer::create
+//       Access: Public
+//  Description: Creates a new, empty ring with room for at least the
+//               indicated number of bytes of datagrams, for this
+//               process to write to.  Returns true on success, false
+//               on failure.  On success, get_name() returns the name
+//               that the reading process should pass to open().
+////////////////////////////////////////////////////////////////////
+bool PStatRingBuffer::
+create(size_t size) {
+  close();
+  if (!is_supported()) {
+    return false;
+  }
+
+  // The ring size must be a power of 2.
+  _data_size = pstat_ring_min_size;
+  while (_data_size < size && _data_size < pstat_ring_max_size) {
+    _data_size <<= 1;
+  }
+  size_t mapping_size = sizeof(Header) + _data_size;
+
+#if defined(WIN32_VC) || defined(WIN64_VC)
+  static int next_index = 0;
+  ostringstream strm;
+  strm << "Local\\pstats-" << GetCurrentProcessId() << "-" << next_index++;
+  _name = strm.str();
+
+  _handle = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+                               0, (DWORD)mapping_size, _name.c_str());
+  if (_handle == NULL) {
+    pstats_cat.warning()
+      << "Couldn't create shared memory " << _name << "\n";
+    return false;
+  }
+
+#else
+  // Put the file in /dev/shm if we can, so that it lives only in
+  // memory.  Elsewhere, it's just a temporary file on disk; since we
+  // map it, it will be read or written only when the system needs to.
+  Filename dirname = "/dev/shm";
+  if (!dirname.is_directory()) {
+    dirname = Filename();
+  }
+
+  for (int tries = 0; tries < 10 && _fd == -1; ++tries) {
+    _name = Filename::temporary(dirname, "pstats-").to_os_specific();
+    _fd = ::open(_name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+  }
+  if (_fd == -1) {
+    pstats_cat.warning()
+      << "Couldn't create shared memory file " << _name << "\n";
+    return false;
+  }
+
+  if (ftruncate(_fd, mapping_size) != 0) {
+    pstats_cat.warning()
+      << "Couldn't allocate " << mapping_size << " bytes for " << _name << "\n";
+    ::close(_fd);
+    _fd = -1;
+    unlink(_name.c_str());
+    return false;
+  }
+#endif
+
+  _is_owner = true;
+  if (!map_memory(mapping_size)) {
+    close();
+    return false;
+  }
+
+  _header->_data_size = _data_size;
+  AtomicAdjust::set(_header->_write_pos, 0);
+  AtomicAdjust::set(_header->_read_pos, 0);
+  AtomicAdjust::set(_header->_attached, 0);
+  AtomicAdjust::set(_header->_num_dropped, 0);
+  _header->_magic = pstat_ring_magic;
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PStatRingBuffer::open
+//       Access: Public
+//  Description: Maps the existing ring of the indicated name, which
+//               was created by another process, for this process to
+//               read from.  Returns true on success, false on
+//               failure.
+////////////////////////////////////////////////////////////////////
+bool PStatRingBuffer::
+open(const string &name) {
+  close();
+  if (!is_supported()) {
+    return false;
+  }
+  _name = name;
+
+#if defined(WIN32_VC) || defined(WIN64_VC)
+  _handle = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, _name.c_str());
+  if (_handle == NULL) {
+    return false;
+  }
+  // Mapping 0 bytes maps the whole thing.
+  size_t mapping_size = 0;
+
+#else
+  _fd = ::open(_name.c_str(), O_RDWR);
+  if (_fd == -1) {
+    return false;
+  }
+  struct stat st;
+  if (fstat(_fd, &st) != 0 || st.st_size < (off_t)sizeof(Header)) {
+    close();
+    return false;
+  }
+  size_t mapping_size = st.st_size;
+#endif
+
+  if (!map_memory(mapping_size)) {
+    close();
+    return false;
+  }
+
+  _data_size = _header->_data_size;
+  if (_header->_magic != pstat_ring_magic ||
+      _data_size < pstat_ring_min_size || _data_size > pstat_ring_max_size ||
+      (_data_size & (_data_size - 1)) != 0 ||
+      (mapping_size != 0 && sizeof(Header) + _data_size > mapping_size)) {
+    pstats_cat.warning()
+      << _name << " is not a PStats ring buffer.\n";
+    close();
+    return false;
+  }
+
+#if !defined(WIN32_VC) && !defined(WIN64_VC)
+  // Now that both processes have it mapped, we can remove the file,
+  // so that it won't be left behind if the writer exits uncleanly.
+  unlink(_name.c_str());
+#endif
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PStatRingBuffer::close
+//       Access: Public
+//  Description: Unmaps the ring, if it is mapped.  The ring itself
+//               goes away when neither process has it open.
+////////////////////////////////////////////////////////////////////
+void PStatRingBuffer::
+close() {
+#if defined(WIN32_VC) || defined(WIN64_VC)
+  if (_header != (Header *)NULL) {
+    UnmapViewOfFile(_header);
+  }
+  if (_handle != NULL) {
+    CloseHandle((HANDLE)_handle);
+    _handle = NULL;
+  }
+
+#else
+  if (_header != (Header *)NULL) {
+    munmap((void *)_header, _mapping_size);
+  }
+  if (_fd != -1) {
+    ::close(_fd);
+    _fd = -1;
+    if (_is_owner) {
+      // The reader may have removed it already.
+      unlink(_name.c_str());
+    }
+  }
+#endif
+
+  _header = NULL;
+  _data = NULL;
+  _data_size = 0;
+  _mapping_size = 0;
+  _is_owner = false;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PStatRingBuffer::write_datagram
+//       Access: Public
+//  Description: Appends the indicated datagram to the ring.  Returns
+//               true on success, or false if there is not enough
+//               room left in the ring for it, in which case it is
+//               dropped.
+//
+//               Only one thread may write to the ring at a time.
+////////////////////////////////////////////////////////////////////
+bool PStatRingBuffer::
+write_datagram(const Datagram &datagram) {
+  nassertr(is_valid(), false);
+
+  PN_uint32 length = (PN_uint32)datagram.get_length();
+  size_t needed = sizeof(length) + (size_t)length;
+
+  PN_uint32 write_pos = (PN_uint32)AtomicAdjust::get(_header->_write_pos);
+  PN_uint32 read_pos = (PN_uint32)AtomicAdjust::get(_header->_read_pos);
+  size_t used = (PN_uint32)(write_pos - read_pos);
+  if (needed > _data_size - used) {
+    AtomicAdjust::inc(_header->_num_dropped);
+    return false;
+  }
+
+  copy_in(write_pos, &length, sizeof(length));
+  copy_in(write_pos + sizeof(length), datagram.get_data(), length);
+
+  // Only now that the datagram is completely written may the reader
+  // see it.
+  AtomicAdjust::set(_header->_write_pos, (AtomicAdjust::Integer)(PN_uint32)(write_pos + needed));
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PStatRingBuffer::read_datagram
+//       Access: Public
+//  Description: Removes the oldest datagram from the ring and stores
+//               it in the indicated datagram.  Returns true on
+//               success, or false if the ring is empty.
+//
+//               Only one thread may read from the ring at a time.
+////////////////////////////////////////////////////////////////////
+bool PStatRingBuffer::
+read_datagram(Datagram &datagram) {
+  nassertr(is_valid(), false);
+
+  PN_uint32 read_pos = (PN_uint32)AtomicAdjust::get(_header->_read_pos);
+  PN_uint32 write_pos = (PN_uint32)AtomicAdjust::get(_header->_write_pos);
+  PN_uint32 available = write_pos - read_pos;
+  if (available == 0) {
+    return false;
+  }
+
+  PN_uint32 length;
+  if (available < sizeof(length)) {
+    // The writer would never have left it like this.
+    nassert_raise("PStats ring buffer is corrupt");
+    AtomicAdjust::set(_header->_read_pos, (AtomicAdjust::Integer)write_pos);
+    return false;
+  }
+  copy_out(read_pos, &length, sizeof(length));
+  if (length > available - sizeof(length)) {
+    nassert_raise("PStats ring buffer is corrupt");
+    AtomicAdjust::set(_header->_read_pos, (AtomicAdjust::Integer)write_pos);
+    return false;
+  }
+
+  datagram.clear();
+  size_t start = (read_pos + sizeof(length)) & (_data_size - 1);
+  if (start + length <= _data_size) {
+    datagram.append_data(_data + start, length);
+  } else {
+    size_t first = _data_size - start;
+    datagram.append_data(_data + start, first);
+    datagram.append_data(_data, length - first);
+  }
+
+  // Now the writer may reuse this space.
+  AtomicAdjust::set(_header->_read_pos, (AtomicAdjust::Integer)(PN_uint32)(read_pos + sizeof(length) + length));
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PStatRingBuffer::map_memory
+//       Access: Private
+//  Description: Maps the shared memory, which has already been
+//               created or opened, into this process, and fills in
+//               _header and _data.  A mapping_size of 0 means the
+//               whole thing, which is supported only on Windows.
+////////////////////////////////////////////////////////////////////
+bool PStatRingBuffer::
+map_memory(size_t mapping_size) {
+#if defined(WIN32_VC) || defined(WIN64_VC)
+  void *memory = MapViewOfFile((HANDLE)_handle, FILE_MAP_ALL_ACCESS, 0, 0,
+                               mapping_size);
+  if (memory == NULL) {
+    pstats_cat.warning()
+      << "Couldn't map shared memory " << _name << "\n";
+    return false;
+  }
+
+#else
+  void *memory = mmap(NULL, mapping_size, PROT_READ | PROT_WRITE,
+                      MAP_SHARED, _fd, 0);
+  if (memory == MAP_FAILED) {
+    pstats_cat.warning()
+      << "Couldn't map shared memory " << _name << "\n";
+    return false;
+  }
+#endif
+
+  _header = (Header *)memory;
+  _data = (unsigned char *)memory + sizeof(Header);
+  _mapping_size = mapping_size;
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PStatRingBuffer::copy_in
+//       Access: Private
+//  Description: Copies the indicated bytes into the ring at the
+//               indicated position, wrapping around the end if
+//               necessary.
+////////////////////////////////////////////////////////////////////
+void PStatRingBuffer::
+copy_in(size_t pos, const void *data, size_t size) {
+  size_t start = pos & (_data_size - 1);
+  size_t first = min(size, _data_size - start);
+  memcpy(_data + start, data, first);
+  if (first < size) {
+    memcpy(_data, (const unsigned char *)data + first, size - first);
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PStatRingBuffer::copy_out
+//       Access: Private
+//  Description: Copies bytes out of the ring at the indicated
+//               position, wrapping around the end if necessary.
+////////////////////////////////////////////////////////////////////
+void PStatRingBuffer::
+copy_out(size_t pos, void *data, size_t size) const {
+  size_t start = pos & (_data_size - 1);
+  size_t first = min(size, _data_size - start);
+  memcpy(data, _data + start, first);
+  if (first < size) {
+    memcpy((unsigned char *)data + first, _data, size - first);
+  }
+}
@@ -0,0 +1,109 @@
+// Filename: pStatRingBuffer.h
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#ifndef PSTATRINGBUFFER_H
+#define PSTATRINGBUFFER_H
+
+#include "pandabase.h"
+#include "atomicAdjust.h"
+#include "pnotify.h"
+#include "numeric_types.h"
+
+class Datagram;
+
+////////////////////////////////////////////////////////////////////
+//       Class : PStatRingBuffer
+// Description : A ring of datagrams in memory shared between a
+//               PStats client and a PStats server running on the same
+//               machine.  The client writes its frame data into the
+//               ring instead of sending it over the network, and the
+//               server reads it out again; neither side needs to
+//               make a system call or take a lock shared with the
+//               other process to do so.
+//
+//               There may be only one reader and one writer at a
+//               time.  The client creates the ring with create() and
+//               tells the server its name over the TCP connection;
+//               the server maps the same ring with open() and then
+//               calls set_attached() to tell the client it may begin
+//               writing to it.
+//
+//               If the server falls behind and the ring fills up,
+//               write_datagram() drops the datagram rather than
+//               waiting, just as an overflowing UDP socket would.
+//
+//               The ring relies on AtomicAdjust to order its reads
+//               and writes between the processes, so it is available
+//               only when AtomicAdjust is implemented with native
+//               atomic operations; see is_supported().
+////////////////////////////////////////////////////////////////////
+class EXPCL_PANDA_PSTATCLIENT PStatRingBuffer {
+public:
+  PStatRingBuffer();
+  ~PStatRingBuffer();
+
+  INLINE static bool is_supported();
+
+  bool create(size_t size);
+  bool open(const string &name);
+  void close();
+
+  INLINE bool is_valid() const;
+  INLINE const string &get_name() const;
+
+  INLINE bool is_attached() const;
+  INLINE void set_attached();
+  INLINE int get_num_dropped() const;
+
+  bool write_datagram(const Datagram &datagram);
+  bool read_datagram(Datagram &datagram);
+
+private:
+  bool map_memory(size_t mapping_size);
+  void copy_in(size_t pos, const void *data, size_t size);
+  void copy_out(size_t pos, void *data, size_t size) const;
+
+  // This lives at the start of the shared memory, followed by the
+  // data of the ring itself.  The positions count bytes written and
+  // read since the ring was created; each is only ever changed by one
+  // side.  Since the layout depends on the size of
+  // AtomicAdjust::Integer, the magic number does too, so that a
+  // client and server built differently won't try to share a ring.
+  class Header {
+  public:
+    PN_uint32 _magic;
+    PN_uint32 _data_size;
+    AtomicAdjust::Integer _write_pos;
+    AtomicAdjust::Integer _read_pos;
+    AtomicAdjust::Integer _attached;
+    AtomicAdjust::Integer _num_dropped;
+  };
+
+  Header *_header;
+  unsigned char *_data;
+  size_t _data_size;
+  size_t _mapping_size;
+  string _name;
+  bool _is_owner;
+
+#if defined(WIN32_VC) || defined(WIN64_VC)
+  void *_handle;
+#else
+  int _fd;
+#endif
+};
+
+#include "pStatRingBuffer.I"
+
+#endif
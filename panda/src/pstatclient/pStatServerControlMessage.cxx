@@ -26,6 +26,8 @@
 PStatServerControlMessage::
 PStatServerControlMessage() {
   _type = T_invalid;
+  _udp_port = 0;
+  _shared_memory = false;
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -42,6 +44,7 @@ encode(Datagram &datagram) const {
     datagram.add_string(_server_hostname);
     datagram.add_string(_server_progname);
     datagram.add_uint16(_udp_port);
+    datagram.add_bool(_shared_memory);
     break;
 
   default:
@@ -66,6 +69,8 @@ decode(const Datagram &datagram) {
     _server_hostname = source.get_string();
     _server_progname = source.get_string();
     _udp_port = source.get_uint16();
+    // Older servers don't say whether they support shared memory.
+    _shared_memory = (source.get_remaining_size() > 0) && source.get_bool();
     break;
 
   default:
@@ -45,6 +45,7 @@ public:
   string _server_hostname;
   string _server_progname;
   int _udp_port;
+  bool _shared_memory;
 };
 
 
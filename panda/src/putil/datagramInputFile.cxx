@@ -165,22 +165,23 @@ get_datagram(Datagram &data) {
 
   // Now, read the datagram itself.
 
-  // If the number of bytes is large, we will need to allocate a
-  // temporary buffer from the heap.  Otherwise, we can get away with
-  // allocating it on the stack, via alloca().
+  // If the number of bytes is large, we read it directly into a new
+  // array for the datagram, rather than into a temporary buffer that
+  // must then be copied; a large datagram is often mostly vertex or
+  // texture data that its reader will keep.  Otherwise, we can get
+  // away with allocating the buffer on the stack, via alloca().
   if (num_bytes > 65536) {
-    char *buffer = (char *)PANDA_MALLOC_ARRAY(num_bytes);
-    nassertr(buffer != (char *)NULL, false);
+    PTA_uchar buffer = PTA_uchar::empty_array(num_bytes);
+    nassertr(buffer.size() == (size_t)num_bytes, false);
 
-    _in->read(buffer, num_bytes);
+    _in->read((char *)buffer.p(), num_bytes);
     if (_in->fail() || _in->eof()) {
       _error = true;
-      PANDA_FREE_ARRAY(buffer);
       return false;
     }
 
-    data = Datagram(buffer, num_bytes);
-    PANDA_FREE_ARRAY(buffer);
+    data = Datagram();
+    data.set_array(buffer);
 
   } else {
     char *buffer = (char *)alloca(num_bytes);
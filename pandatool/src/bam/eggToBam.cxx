@@ -77,6 +77,36 @@ EggToBam() :
      "variable.",
      &EggToBam::dispatch_int, &_has_egg_combine_geoms, &_egg_combine_geoms);
 
+  add_option
+    ("optimize-vertex-cache", "flag", 0,
+     "Specifies whether to reorder the triangles and vertices of the "
+     "geometry for the graphics card's vertex cache.  If this is nonzero, "
+     "the geometry is written as indexed triangles, ordered so that "
+     "vertices are reused while they are still in the post-transform "
+     "cache, and the vertices themselves are stored in the order they are "
+     "first used.  The default if this is not specified is taken from the "
+     "egg-optimize-vertex-cache Config.prc variable.",
+     &EggToBam::dispatch_int, &_has_egg_optimize_vertex_cache,
+     &_egg_optimize_vertex_cache);
+
+  add_option
+    ("lod", "triangles", 0,
+     "Generates simplified levels of detail for each GeomNode with at "
+     "least the indicated number of triangles, under a new LODNode.  "
+     "Specify 0 to generate none.  The default if this is not specified "
+     "is taken from the egg-generate-lods Config.prc variable.",
+     &EggToBam::dispatch_int, &_has_egg_generate_lods, &_egg_generate_lods);
+
+  add_option
+    ("quantize", "bits", 0,
+     "Stores the vertices in compact form: positions and texture "
+     "coordinates as 16- or 8-bit integers scaled to the bounds of each "
+     "vertex table, and normals as two such integers.  Specify 0 to keep "
+     "floating-point vertices.  The default if this is not specified is "
+     "taken from the egg-quantize-vertices Config.prc variable.",
+     &EggToBam::dispatch_int, &_has_egg_quantize_vertices,
+     &_egg_quantize_vertices);
+
   add_option
     ("suppress-hidden", "flag", 0,
      "Specifies whether to suppress hidden geometry.  If this is nonzero, "
@@ -212,6 +242,9 @@ EggToBam() :
   _force_complete = true;
   _egg_flatten = 0;
   _egg_combine_geoms = 0;
+  _egg_optimize_vertex_cache = 0;
+  _egg_generate_lods = 0;
+  _egg_quantize_vertices = 0;
   _egg_suppress_hidden = 1;
   _tex_txopz = false;
   _ctex_quality = "best";
@@ -233,6 +266,15 @@ run() {
     // Ditto with -combine_geoms.
     egg_combine_geoms = (_egg_combine_geoms != 0);
   }
+  if (_has_egg_optimize_vertex_cache) {
+    egg_optimize_vertex_cache = (_egg_optimize_vertex_cache != 0);
+  }
+  if (_has_egg_generate_lods) {
+    egg_generate_lods = _egg_generate_lods;
+  }
+  if (_has_egg_quantize_vertices) {
+    egg_quantize_vertices = _egg_quantize_vertices;
+  }
 
   // We always set egg_suppress_hidden.
   egg_suppress_hidden = _egg_suppress_hidden;
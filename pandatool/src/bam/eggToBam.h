@@ -56,6 +56,12 @@ private:
   int _egg_flatten;
   bool _has_egg_combine_geoms;
   int _egg_combine_geoms;
+  bool _has_egg_optimize_vertex_cache;
+  int _egg_optimize_vertex_cache;
+  bool _has_egg_generate_lods;
+  int _egg_generate_lods;
+  bool _has_egg_quantize_vertices;
+  int _egg_quantize_vertices;
   bool _egg_suppress_hidden;
   bool _ls;
   bool _has_compression_quality;
@@ -0,0 +1,349 @@
+// Filename: pStatCapture.cxx
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "pStatCapture.h"
+#include "pStatClientControlMessage.h"
+#include "pStatFrameData.h"
+#include "pStatThreadData.h"
+#include "pStatViewLevel.h"
+#include "pStatProperties.h"
+#include "datagramInputFile.h"
+#include "datagramIterator.h"
+
+#include <algorithm>
+
+////////////////////////////////////////////////////////////////////
+//     Function: PStatCapture::Constructor
+//       Access: Public
+//  Description:
+////////////////////////////////////////////////////////////////////
+PStatCapture::
+PStatCapture() {
+  _client_data = new PStatClientData(NULL);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PStatCapture::Destructor
+//       Access: Public
+//  Description:
+////////////////////////////////////////////////////////////////////
+PStatCapture::
+~PStatCapture() {
+  Views::iterator vi;
+  for (vi = _views.begin(); vi != _views.end(); ++vi) {
+    delete (*vi).second;
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PStatCapture::read
+//       Access: Public
+//  Description: Reads the indicated capture file and accumulates its
+//               frames.  Returns true on success, false on failure.
+//               A file that ends partway through a datagram, as when
+//               the client was killed, is not an error; the frames
+//               before that point are kept.
+////////////////////////////////////////////////////////////////////
+bool PStatCapture::
+read(const Filename &filename) {
+  DatagramInputFile in;
+  string header;
+  if (!in.open(filename) ||
+      !in.read_header(header, get_pstats_capture_header().size())) {
+    nout << "Unable to read " << filename << ".\n";
+    return false;
+  }
+  if (header != get_pstats_capture_header()) {
+    nout << filename << " is not a PStats capture file.\n";
+    return false;
+  }
+
+  Datagram datagram;
+  while (in.get_datagram(datagram)) {
+    PStatClientControlMessage message;
+    if (message.decode(datagram, _client_data)) {
+      if (!handle_control_message(message)) {
+        nout << filename << " contains an unexpected message.\n";
+        return false;
+      }
+
+    } else if (message._type == PStatClientControlMessage::T_datagram) {
+      // The client writes its frame data exactly as it would send it
+      // to a server.
+      DatagramIterator source(datagram);
+      source.get_uint8();
+      int thread_index = source.get_uint16();
+      int frame_number = source.get_uint32();
+
+      PStatFrameData *frame_data = new PStatFrameData;
+      frame_data->read_datagram(source, _client_data);
+      add_frame(thread_index, frame_number, frame_data);
+
+    } else {
+      nout << filename << " contains an unexpected message.\n";
+      return false;
+    }
+  }
+
+  // Make every collector's list of times as long as the number of
+  // frames, counting the frames after it was last active as zero.
+  Threads::iterator ti;
+  for (ti = _threads.begin(); ti != _threads.end(); ++ti) {
+    Thread &thread = (*ti).second;
+    Collectors::iterator ci;
+    for (ci = thread._times.begin(); ci != thread._times.end(); ++ci) {
+      (*ci).second._values.resize(thread._num_frames, 0.0);
+    }
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PStatCapture::get_hostname
+//       Access: Public
+//  Description: Returns the hostname of the machine that recorded the
+//               capture.
+////////////////////////////////////////////////////////////////////
+const string &PStatCapture::
+get_hostname() const {
+  return _hostname;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PStatCapture::get_progname
+//       Access: Public
+//  Description: Returns the client name of the program that recorded
+//               the capture.
+////////////////////////////////////////////////////////////////////
+const string &PStatCapture::
+get_progname() const {
+  return _progname;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PStatCapture::get_threads
+//       Access: Public
+//  Description: Returns the data accumulated for each thread that
+//               reported at least one frame.
+////////////////////////////////////////////////////////////////////
+const PStatCapture::Threads &PStatCapture::
+get_threads() const {
+  return _threads;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PStatCapture::handle_control_message
+//       Access: Private
+//  Description: Handles one of the definitions that the client writes
+//               ahead of the frames that use them.  Returns false if
+//               the message can't be understood.
+////////////////////////////////////////////////////////////////////
+bool PStatCapture::
+handle_control_message(const PStatClientControlMessage &message) {
+  switch (message._type) {
+  case PStatClientControlMessage::T_hello:
+    if (message._major_version != get_current_pstat_major_version() ||
+        message._minor_version > get_current_pstat_minor_version()) {
+      nout << "Capture was written with PStats version "
+           << message._major_version << "." << message._minor_version
+           << "; this program understands version "
+           << get_current_pstat_major_version() << "."
+           << get_current_pstat_minor_version() << ".\n";
+      return false;
+    }
+    _client_data->set_version(message._major_version, message._minor_version);
+    _hostname = message._client_hostname;
+    _progname = message._client_progname;
+    return true;
+
+  case PStatClientControlMessage::T_define_collectors:
+    {
+      for (int i = 0; i < (int)message._collectors.size(); i++) {
+        _client_data->add_collector(message._collectors[i]);
+      }
+    }
+    return true;
+
+  case PStatClientControlMessage::T_define_threads:
+    {
+      for (int i = 0; i < (int)message._names.size(); i++) {
+        _client_data->define_thread(message._first_thread_index + i,
+                                    message._names[i]);
+      }
+    }
+    return true;
+
+  default:
+    return false;
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PStatCapture::add_frame
+//       Access: Private
+//  Description: Accumulates a single frame's worth of data for the
+//               indicated thread.  The PStatFrameData pointer is
+//               handed off to the client data.
+////////////////////////////////////////////////////////////////////
+void PStatCapture::
+add_frame(int thread_index, int frame_number, PStatFrameData *frame_data) {
+  if (frame_data->is_empty()) {
+    delete frame_data;
+    return;
+  }
+
+  Thread &thread = get_thread(thread_index);
+  thread._num_frames++;
+
+  int num_levels = frame_data->get_num_levels();
+  for (int i = 0; i < num_levels; i++) {
+    int collector_index = frame_data->get_level_collector(i);
+    if (_client_data->has_collector(collector_index)) {
+      string name = _client_data->get_collector_fullname(collector_index);
+      Samples &samples = thread._levels[name];
+      if (samples._values.empty()) {
+        samples._units = _client_data->get_collector_def(collector_index)._level_units;
+      }
+      samples._values.push_back(frame_data->get_level(i));
+    }
+  }
+
+  _client_data->record_new_frame(thread_index, frame_number, frame_data);
+
+  PStatView *&view = _views[thread_index];
+  if (view == (PStatView *)NULL) {
+    view = new PStatView;
+    view->set_thread_data(_client_data->get_thread_data(thread_index));
+  }
+  view->set_to_frame(*frame_data);
+
+  add_view_level(thread, view->get_top_level(), string());
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PStatCapture::add_view_level
+//       Access: Private
+//  Description: Records the time spent in the indicated level of the
+//               view, and recursively in its children, for the frame
+//               most recently added to the thread.
+////////////////////////////////////////////////////////////////////
+void PStatCapture::
+add_view_level(Thread &thread, const PStatViewLevel *level,
+               const string &stack) {
+  int collector_index = level->get_collector();
+  if (!_client_data->has_collector(collector_index)) {
+    return;
+  }
+
+  string name = _client_data->get_collector_name(collector_index);
+  string this_stack = stack.empty() ? name : stack + ";" + name;
+
+  double net_value = level->get_net_value();
+  if (net_value > 0.0) {
+    Samples &samples =
+      thread._times[_client_data->get_collector_fullname(collector_index)];
+    samples._values.resize(thread._num_frames - 1, 0.0);
+    samples._values.push_back(net_value * 1000.0);
+  }
+
+  double value_alone = level->get_value_alone();
+  if (value_alone > 0.0) {
+    thread._stacks[this_stack] += value_alone;
+  }
+
+  int num_children = level->get_num_children();
+  for (int i = 0; i < num_children; i++) {
+    add_view_level(thread, level->get_child(i), this_stack);
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PStatCapture::get_thread
+//       Access: Private
+//  Description: Returns the accumulated data for the indicated
+//               thread, creating it if necessary.
+////////////////////////////////////////////////////////////////////
+PStatCapture::Thread &PStatCapture::
+get_thread(int thread_index) {
+  string name;
+  if (_client_data->has_thread(thread_index)) {
+    name = _client_data->get_thread_name(thread_index);
+  }
+  if (name.empty()) {
+    ostringstream strm;
+    strm << "Thread " << thread_index;
+    name = strm.str();
+  }
+  return _threads[name];
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PStatCapture::Thread::Constructor
+//       Access: Public
+//  Description:
+////////////////////////////////////////////////////////////////////
+PStatCapture::Thread::
+Thread() : _num_frames(0) {
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PStatCapture::Samples::get_mean
+//       Access: Public
+//  Description: Returns the average of all of the samples.
+////////////////////////////////////////////////////////////////////
+double PStatCapture::Samples::
+get_mean() const {
+  if (_values.empty()) {
+    return 0.0;
+  }
+  double total = 0.0;
+  pvector<double>::const_iterator vi;
+  for (vi = _values.begin(); vi != _values.end(); ++vi) {
+    total += (*vi);
+  }
+  return total / (double)_values.size();
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PStatCapture::Samples::get_percentile
+//       Access: Public
+//  Description: Returns the smallest sample that is at least as
+//               large as the indicated percent of all the samples.
+////////////////////////////////////////////////////////////////////
+double PStatCapture::Samples::
+get_percentile(double percent) const {
+  if (_values.empty()) {
+    return 0.0;
+  }
+  pvector<double> sorted(_values);
+  size_t n = (size_t)(percent * 0.01 * (double)sorted.size() + 0.5);
+  n = max(n, (size_t)1);
+  n = min(n, sorted.size());
+  nth_element(sorted.begin(), sorted.begin() + (n - 1), sorted.end());
+  return sorted[n - 1];
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PStatCapture::Samples::get_max
+//       Access: Public
+//  Description: Returns the largest sample.
+////////////////////////////////////////////////////////////////////
+double PStatCapture::Samples::
+get_max() const {
+  if (_values.empty()) {
+    return 0.0;
+  }
+  return *max_element(_values.begin(), _values.end());
+}
@@ -0,0 +1,106 @@
+// Filename: pStatCapture.h
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#ifndef PSTATCAPTURE_H
+#define PSTATCAPTURE_H
+
+#include "pandatoolbase.h"
+
+#include "pStatClientData.h"
+#include "pStatView.h"
+#include "filename.h"
+#include "pmap.h"
+#include "pvector.h"
+
+class PStatClientControlMessage;
+
+////////////////////////////////////////////////////////////////////
+//       Class : PStatCapture
+// Description : Reads a capture file written by
+//               PStatClient::start_recording(), and boils it down to
+//               a set of samples per collector per thread, from which
+//               percentiles and the like may be computed.
+//
+//               Everything is keyed by thread and collector name
+//               rather than index, so that two captures from
+//               different runs may be compared.
+////////////////////////////////////////////////////////////////////
+class PStatCapture {
+public:
+  PStatCapture();
+  ~PStatCapture();
+
+  bool read(const Filename &filename);
+
+  class Samples {
+  public:
+    double get_mean() const;
+    double get_percentile(double percent) const;
+    double get_max() const;
+
+    pvector<double> _values;
+    string _units;
+  };
+
+  // Samples by collector fullname.
+  typedef pmap<string, Samples> Collectors;
+
+  // Seconds spent in each collector alone, excluding its children,
+  // summed over all frames, by the list of collector names from the
+  // top of the frame down.
+  typedef pmap<string, double> Stacks;
+
+  class Thread {
+  public:
+    Thread();
+
+    int _num_frames;
+
+    // The net time per frame, in milliseconds.  A frame in which a
+    // collector was not active counts as zero.
+    Collectors _times;
+
+    // The level values, in the collectors' own units, for each frame
+    // in which they were reported.
+    Collectors _levels;
+
+    Stacks _stacks;
+  };
+
+  // Threads by name.
+  typedef pmap<string, Thread> Threads;
+
+  const string &get_hostname() const;
+  const string &get_progname() const;
+  const Threads &get_threads() const;
+
+private:
+  bool handle_control_message(const PStatClientControlMessage &message);
+  void add_frame(int thread_index, int frame_number,
+                 PStatFrameData *frame_data);
+  void add_view_level(Thread &thread, const PStatViewLevel *level,
+                      const string &stack);
+  Thread &get_thread(int thread_index);
+
+  PT(PStatClientData) _client_data;
+
+  typedef pmap<int, PStatView *> Views;
+  Views _views;
+
+  string _hostname;
+  string _progname;
+  Threads _threads;
+};
+
+#endif
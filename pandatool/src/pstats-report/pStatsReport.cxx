@@ -0,0 +1,335 @@
+// Filename: pStatsReport.cxx
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "pStatsReport.h"
+#include "pystub.h"
+
+#include <iomanip>
+#include <algorithm>
+
+////////////////////////////////////////////////////////////////////
+//     Function: PStatsReport::Constructor
+//       Access: Public
+//  Description:
+////////////////////////////////////////////////////////////////////
+PStatsReport::
+PStatsReport() :
+  WithOutputFile(true, true, false)
+{
+  clear_runlines();
+  add_runline("[opts] capture.pstats");
+  add_runline("[opts] -b baseline.pstats capture.pstats");
+
+  set_program_description
+    ("pstats-report reads a capture file written by a Panda program that "
+     "called PStatClient::start_recording(), with or without a PStats "
+     "server attached, and reports the mean, median, 90th and 99th "
+     "percentile, and worst-case time per frame spent in each collector, "
+     "for each thread.\n\n"
+
+     "With -b, it instead compares the capture against a baseline capture "
+     "recorded earlier, and exits with status 2 if any collector has "
+     "become slower by more than the threshold given by -t.  This is "
+     "intended for use on an unattended build machine.");
+
+  add_option
+    ("b", "baseline", 0,
+     "Compare the capture against the indicated baseline capture, and "
+     "report the collectors that have become slower.",
+     &PStatsReport::dispatch_filename, &_got_baseline_filename,
+     &_baseline_filename);
+
+  add_option
+    ("t", "percent", 0,
+     "Specify how much slower, as a percentage of the baseline time, a "
+     "collector may become before it is reported as a regression.  The "
+     "default is 10.",
+     &PStatsReport::dispatch_double, NULL, &_threshold);
+
+  add_option
+    ("m", "ms", 0,
+     "Ignore collectors that take less than this many milliseconds per "
+     "frame in both captures, since small times are dominated by noise.  "
+     "The default is 0.1.",
+     &PStatsReport::dispatch_double, NULL, &_min_time);
+
+  add_option
+    ("p", "percentile", 0,
+     "Specify which percentile of the frame times to compare with -b.  "
+     "The default is 90.",
+     &PStatsReport::dispatch_double, NULL, &_percentile);
+
+  add_option
+    ("f", "filename", 0,
+     "Also write the time spent in each collector, summed over all "
+     "frames, to the indicated file as folded stacks, in microseconds.  "
+     "This is the input format of the common flame graph tools.",
+     &PStatsReport::dispatch_filename, &_got_stacks_filename,
+     &_stacks_filename);
+
+  add_option
+    ("l", "", 0,
+     "Also report the level collectors, such as memory sizes and "
+     "vertex counts, in their own units.",
+     &PStatsReport::dispatch_none, &_show_levels);
+
+  add_option
+    ("o", "filename", 0,
+     "Specify the filename to which the report will be written.  "
+     "The default is standard output.",
+     &PStatsReport::dispatch_filename, &_got_output_filename,
+     &_output_filename);
+
+  _threshold = 10.0;
+  _min_time = 0.1;
+  _percentile = 90.0;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PStatsReport::run
+//       Access: Public
+//  Description: Returns the exit status of the program.
+////////////////////////////////////////////////////////////////////
+int PStatsReport::
+run() {
+  PStatCapture capture;
+  if (!capture.read(_input_filename)) {
+    return 1;
+  }
+
+  if (_got_stacks_filename) {
+    if (!write_stacks(_stacks_filename, capture)) {
+      return 1;
+    }
+  }
+
+  ostream &out = get_output();
+  if (!_got_baseline_filename) {
+    write_report(out, capture);
+    return 0;
+  }
+
+  PStatCapture baseline;
+  if (!baseline.read(_baseline_filename)) {
+    return 1;
+  }
+  return write_comparison(out, baseline, capture);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PStatsReport::handle_args
+//       Access: Protected, Virtual
+//  Description:
+////////////////////////////////////////////////////////////////////
+bool PStatsReport::
+handle_args(ProgramBase::Args &args) {
+  if (args.size() != 1) {
+    nout << "You must specify exactly one capture file to read on the command line.\n";
+    return false;
+  }
+
+  _input_filename = Filename::binary_filename(args[0]);
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PStatsReport::write_report
+//       Access: Private
+//  Description: Writes the distribution of frame times for every
+//               collector of every thread.
+////////////////////////////////////////////////////////////////////
+void PStatsReport::
+write_report(ostream &out, const PStatCapture &capture) {
+  out << "Captured from " << capture.get_progname()
+      << " on " << capture.get_hostname() << ".\n";
+
+  out << fixed << setprecision(3);
+
+  const PStatCapture::Threads &threads = capture.get_threads();
+  PStatCapture::Threads::const_iterator ti;
+  for (ti = threads.begin(); ti != threads.end(); ++ti) {
+    const PStatCapture::Thread &thread = (*ti).second;
+    int width = max(get_name_width(thread._times),
+                    _show_levels ? get_name_width(thread._levels) : 0);
+
+    out << "\n" << (*ti).first << ": " << thread._num_frames << " frames\n"
+        << setw(width) << left << "ms per frame" << right
+        << setw(10) << "mean" << setw(10) << "p50" << setw(10) << "p90"
+        << setw(10) << "p99" << setw(10) << "max" << "\n";
+
+    PStatCapture::Collectors::const_iterator ci;
+    for (ci = thread._times.begin(); ci != thread._times.end(); ++ci) {
+      const PStatCapture::Samples &samples = (*ci).second;
+      out << setw(width) << left << (*ci).first << right
+          << setw(10) << samples.get_mean()
+          << setw(10) << samples.get_percentile(50.0)
+          << setw(10) << samples.get_percentile(90.0)
+          << setw(10) << samples.get_percentile(99.0)
+          << setw(10) << samples.get_max() << "\n";
+    }
+
+    if (_show_levels && !thread._levels.empty()) {
+      out << setw(width) << left << "levels" << right
+          << setw(10) << "mean" << setw(10) << "p50" << setw(10) << "p90"
+          << setw(10) << "p99" << setw(10) << "max" << "\n";
+      for (ci = thread._levels.begin(); ci != thread._levels.end(); ++ci) {
+        const PStatCapture::Samples &samples = (*ci).second;
+        out << setw(width) << left << (*ci).first << right
+            << setw(10) << samples.get_mean()
+            << setw(10) << samples.get_percentile(50.0)
+            << setw(10) << samples.get_percentile(90.0)
+            << setw(10) << samples.get_percentile(99.0)
+            << setw(10) << samples.get_max() << " "
+            << samples._units << "\n";
+      }
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PStatsReport::write_stacks
+//       Access: Private
+//  Description: Writes one line for each path from the top of a
+//               thread's frame down to each collector, with the
+//               collector names separated by semicolons, followed by
+//               the number of microseconds spent in that collector
+//               alone over the whole capture.  Returns true on
+//               success, false on failure.
+////////////////////////////////////////////////////////////////////
+bool PStatsReport::
+write_stacks(const Filename &filename, const PStatCapture &capture) {
+  Filename text_filename = Filename::text_filename(filename);
+  pofstream out;
+  if (!text_filename.open_write(out)) {
+    nout << "Unable to write " << text_filename << ".\n";
+    return false;
+  }
+
+  const PStatCapture::Threads &threads = capture.get_threads();
+  PStatCapture::Threads::const_iterator ti;
+  for (ti = threads.begin(); ti != threads.end(); ++ti) {
+    const PStatCapture::Stacks &stacks = (*ti).second._stacks;
+    PStatCapture::Stacks::const_iterator si;
+    for (si = stacks.begin(); si != stacks.end(); ++si) {
+      // The flame graph tools want a whole number of samples.
+      PN_int64 usec = (PN_int64)((*si).second * 1000000.0 + 0.5);
+      if (usec > 0) {
+        out << (*ti).first << ";" << (*si).first << " " << usec << "\n";
+      }
+    }
+  }
+
+  return !out.fail();
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PStatsReport::write_comparison
+//       Access: Private
+//  Description: Compares the chosen percentile of the frame times
+//               for each collector that appears in both captures.
+//               Returns 2 if any collector got slower by more than
+//               the threshold, 0 otherwise.
+////////////////////////////////////////////////////////////////////
+int PStatsReport::
+write_comparison(ostream &out, const PStatCapture &baseline,
+                 const PStatCapture &capture) {
+  int num_regressions = 0;
+
+  out << fixed << setprecision(3);
+
+  const PStatCapture::Threads &threads = capture.get_threads();
+  const PStatCapture::Threads &base_threads = baseline.get_threads();
+  PStatCapture::Threads::const_iterator ti;
+  for (ti = threads.begin(); ti != threads.end(); ++ti) {
+    PStatCapture::Threads::const_iterator bti = base_threads.find((*ti).first);
+    if (bti == base_threads.end()) {
+      continue;
+    }
+    const PStatCapture::Collectors &times = (*ti).second._times;
+    const PStatCapture::Collectors &base_times = (*bti).second._times;
+
+    int width = get_name_width(times);
+
+    ostringstream heading;
+    heading << "p" << _percentile << " ms";
+    out << "\n" << (*ti).first << ":\n"
+        << setw(width) << left << heading.str() << right
+        << setw(10) << "baseline" << setw(10) << "current"
+        << setw(10) << "change" << "\n";
+
+    PStatCapture::Collectors::const_iterator ci;
+    for (ci = times.begin(); ci != times.end(); ++ci) {
+      PStatCapture::Collectors::const_iterator bci =
+        base_times.find((*ci).first);
+      if (bci == base_times.end()) {
+        continue;
+      }
+
+      double value = (*ci).second.get_percentile(_percentile);
+      double base_value = (*bci).second.get_percentile(_percentile);
+      if (value < _min_time && base_value < _min_time) {
+        continue;
+      }
+
+      out << setw(width) << left << (*ci).first << right
+          << setw(10) << base_value << setw(10) << value;
+
+      if (base_value > 0.0) {
+        double change = (value - base_value) * 100.0 / base_value;
+        out << setw(9) << setprecision(1) << showpos << change << "%"
+            << noshowpos << setprecision(3);
+        if (change > _threshold) {
+          out << "  REGRESSION";
+          num_regressions++;
+        }
+      } else {
+        out << setw(10) << "new";
+      }
+      out << "\n";
+    }
+  }
+
+  if (num_regressions != 0) {
+    out << "\n" << num_regressions << " collector(s) regressed by more than "
+        << setprecision(1) << _threshold << "%.\n";
+    return 2;
+  }
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PStatsReport::get_name_width
+//       Access: Private, Static
+//  Description: Returns the width of the column in which the names of
+//               the indicated collectors should be written.
+////////////////////////////////////////////////////////////////////
+int PStatsReport::
+get_name_width(const PStatCapture::Collectors &collectors) {
+  size_t width = 30;
+  PStatCapture::Collectors::const_iterator ci;
+  for (ci = collectors.begin(); ci != collectors.end(); ++ci) {
+    width = max(width, (*ci).first.length() + 2);
+  }
+  return (int)width;
+}
+
+
+int main(int argc, char *argv[]) {
+  // A call to pystub() to force libpystub.so to be linked in.
+  pystub();
+
+  PStatsReport prog;
+  prog.parse_command_line(argc, argv);
+  return prog.run();
+}
@@ -0,0 +1,62 @@
+// Filename: pStatsReport.h
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#ifndef PSTATSREPORT_H
+#define PSTATSREPORT_H
+
+#include "pandatoolbase.h"
+
+#include "programBase.h"
+#include "withOutputFile.h"
+#include "pStatCapture.h"
+
+////////////////////////////////////////////////////////////////////
+//       Class : PStatsReport
+// Description : Reads a capture file recorded by
+//               PStatClient::start_recording() and reports the
+//               distribution of frame times per collector, optionally
+//               writes a flame graph, and optionally compares the
+//               capture against an earlier one, exiting with an error
+//               status if anything got slower.
+////////////////////////////////////////////////////////////////////
+class PStatsReport : public ProgramBase, public WithOutputFile {
+public:
+  PStatsReport();
+
+  int run();
+
+protected:
+  virtual bool handle_args(Args &args);
+
+private:
+  void write_report(ostream &out, const PStatCapture &capture);
+  bool write_stacks(const Filename &filename, const PStatCapture &capture);
+  int write_comparison(ostream &out, const PStatCapture &baseline,
+                       const PStatCapture &capture);
+  static int get_name_width(const PStatCapture::Collectors &collectors);
+
+  Filename _input_filename;
+
+  bool _got_baseline_filename;
+  Filename _baseline_filename;
+  bool _got_stacks_filename;
+  Filename _stacks_filename;
+
+  double _threshold;
+  double _min_time;
+  double _percentile;
+  bool _show_levels;
+};
+
+#endif
@@ -23,6 +23,8 @@
 #include "datagram.h"
 #include "datagramIterator.h"
 #include "connectionManager.h"
+#include "config_pstats.h"
+#include "mutexHolder.h"
 
 ////////////////////////////////////////////////////////////////////
 //     Function: PStatReader::Constructor
@@ -109,6 +111,7 @@ lost_connection() {
   _client_data->_is_alive = false;
   _monitor->lost_connection();
   _client_data.clear();
+  _ring.close();
 
   _manager->close_connection(_tcp_connection);
   _manager->close_connection(_udp_connection);
@@ -125,6 +128,7 @@ lost_connection() {
 void PStatReader::
 idle() {
   dequeue_frame_data();
+  read_shared_memory();
   _monitor->idle();
 }
 
@@ -166,6 +170,7 @@ send_hello() {
   message._server_hostname = get_hostname();
   message._server_progname = _monitor->get_monitor_name();
   message._udp_port = _udp_port;
+  message._shared_memory = pstats_shared_memory && PStatRingBuffer::is_supported();
 
   Datagram datagram;
   message.encode(datagram);
@@ -250,6 +255,13 @@ handle_client_control_message(const PStatClientControlMessage &message) {
     }
     break;
 
+  case PStatClientControlMessage::T_shared_memory:
+    {
+      MutexHolder holder(_ring_lock);
+      _ring_name = message._shared_memory_name;
+    }
+    break;
+
   default:
     nout << "Invalid control message received from client.\n";
   }
@@ -272,20 +284,11 @@ handle_client_udp_data(const Datagram &datagram) {
     return;
   }
 
-  DatagramIterator source(datagram);
-
-  if (_client_data->is_at_least(2, 1)) {
-    // Throw away the zero byte at the beginning.
-    int initial_byte = source.get_uint8();
-    nassertv(initial_byte == 0);
-  }
-
   if (!_queued_frame_data.full()) {
     FrameData data;
-    data._thread_index = source.get_uint16();
-    data._frame_number = source.get_uint32();
-    data._frame_data = new PStatFrameData;
-    data._frame_data->read_datagram(source, _client_data);
+    if (!read_frame_data(datagram, data)) {
+      return;
+    }
     
     // Queue up the data till we're ready to handle it in a
     // single-threaded way.
@@ -303,27 +306,104 @@ handle_client_udp_data(const Datagram &datagram) {
 void PStatReader::
 dequeue_frame_data() {
   while (!_queued_frame_data.empty()) {
-    const FrameData &data = _queued_frame_data.front();
-    nassertv(_client_data != (PStatClientData *)NULL); 
-
-    // Check to see if any new collectors have level data.
-    int num_levels = data._frame_data->get_num_levels();
-    for (int i = 0; i < num_levels; i++) {
-      int collector_index = data._frame_data->get_level_collector(i);
-      if (!_client_data->get_collector_has_level(collector_index, data._thread_index)) {
-        // This collector is now reporting level data, and it wasn't
-        // before.
-        _client_data->set_collector_has_level(collector_index, data._thread_index, true);
-        _monitor->new_collector(collector_index);
-      }
+    record_frame_data(_queued_frame_data.front());
+    _queued_frame_data.pop_front();
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PStatReader::read_shared_memory
+//       Access: Private
+//  Description: Called during the idle loop to attach to the
+//               client's shared memory, if it has offered it, and to
+//               handle all the frame data that has been written there
+//               since the last call.
+////////////////////////////////////////////////////////////////////
+void PStatReader::
+read_shared_memory() {
+  string name;
+  {
+    MutexHolder holder(_ring_lock);
+    name.swap(_ring_name);
+  }
+
+  if (!name.empty()) {
+    if (_ring.open(name)) {
+      // Tell the client to start using it.
+      _ring.set_attached();
+    } else {
+      nout << "Couldn't open shared memory " << name
+           << "; receiving frame data over the network.\n";
     }
+  }
 
-    _client_data->record_new_frame(data._thread_index, 
-                                   data._frame_number, 
-                                   data._frame_data);
-    _monitor->new_data(data._thread_index, data._frame_number);
+  if (!_ring.is_valid() || _client_data == (PStatClientData *)NULL ||
+      !_monitor->is_client_known()) {
+    return;
+  }
 
-    _queued_frame_data.pop_front();
+  // Don't take more than a queue's worth at a time, so that a very
+  // busy client can't keep us from updating the display.
+  Datagram datagram;
+  for (int i = 0; i < queued_frame_records && _ring.read_datagram(datagram); ++i) {
+    FrameData data;
+    if (read_frame_data(datagram, data)) {
+      record_frame_data(data);
+    }
   }
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: PStatReader::read_frame_data
+//       Access: Private
+//  Description: Decodes a single frame's worth of data, received by
+//               whatever means, into the indicated FrameData.
+//               Returns true on success, false if the data is
+//               invalid.
+////////////////////////////////////////////////////////////////////
+bool PStatReader::
+read_frame_data(const Datagram &datagram, FrameData &data) {
+  DatagramIterator source(datagram);
+
+  if (_client_data->is_at_least(2, 1)) {
+    // Throw away the zero byte at the beginning.
+    int initial_byte = source.get_uint8();
+    nassertr(initial_byte == 0, false);
+  }
+
+  data._thread_index = source.get_uint16();
+  data._frame_number = source.get_uint32();
+  data._frame_data = new PStatFrameData;
+  data._frame_data->read_datagram(source, _client_data);
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PStatReader::record_frame_data
+//       Access: Private
+//  Description: Hands a single frame's worth of data, decoded by
+//               read_frame_data(), to the client data and the
+//               monitor.  This must be called only from the main
+//               thread.
+////////////////////////////////////////////////////////////////////
+void PStatReader::
+record_frame_data(const FrameData &data) {
+  nassertv(_client_data != (PStatClientData *)NULL); 
+
+  // Check to see if any new collectors have level data.
+  int num_levels = data._frame_data->get_num_levels();
+  for (int i = 0; i < num_levels; i++) {
+    int collector_index = data._frame_data->get_level_collector(i);
+    if (!_client_data->get_collector_has_level(collector_index, data._thread_index)) {
+      // This collector is now reporting level data, and it wasn't
+      // before.
+      _client_data->set_collector_has_level(collector_index, data._thread_index, true);
+      _monitor->new_collector(collector_index);
+    }
+  }
+
+  _client_data->record_new_frame(data._thread_index, 
+                                 data._frame_number, 
+                                 data._frame_data);
+  _monitor->new_data(data._thread_index, data._frame_number);
+}
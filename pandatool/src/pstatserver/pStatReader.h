@@ -24,6 +24,8 @@
 #include "connectionWriter.h"
 #include "referenceCount.h"
 #include "circBuffer.h"
+#include "pStatRingBuffer.h"
+#include "pmutex.h"
 
 class PStatServer;
 class PStatMonitor;
@@ -63,6 +65,11 @@ private:
   void handle_client_control_message(const PStatClientControlMessage &message);
   void handle_client_udp_data(const Datagram &datagram);
   void dequeue_frame_data();
+  void read_shared_memory();
+
+  class FrameData;
+  bool read_frame_data(const Datagram &datagram, FrameData &data);
+  void record_frame_data(const FrameData &data);
 
 private:
   PStatServer *_manager;
@@ -85,6 +92,14 @@ private:
   };
   typedef CircBuffer<FrameData, queued_frame_records> QueuedFrameData;
   QueuedFrameData _queued_frame_data;
+
+  // If the client is on the same machine, it may send its frame data
+  // through this ring in shared memory instead.  The name arrives on
+  // the reader thread, and is picked up by the main thread in idle(),
+  // which alone reads from the ring.
+  PStatRingBuffer _ring;
+  Mutex _ring_lock;
+  string _ring_name;
 };
 
 #endif